@@ -147,6 +147,17 @@ public:
    */
   virtual IoUringResult prepareShutdown(os_fd_t fd, int how, Request* user_data) PURE;
 
+  /**
+   * Prepares a writev system call followed by a shutdown system call linked to it, and puts both
+   * into the submission queue. The shutdown is only performed once the writev has written all the
+   * data, otherwise it completes with -ECANCELED.
+   * Returns IoUringResult::Failed in case the submission queue has no room for both
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareWritevAndShutdown(os_fd_t fd, const struct iovec* iovecs,
+                                                 unsigned nr_vecs, Request* write_user_data,
+                                                 int how, Request* shutdown_user_data) PURE;
+
   /**
    * Submits the entries in the submission queue to the kernel using the
    * `io_uring_enter()` system call.
@@ -443,6 +454,16 @@ public:
    */
   virtual Request* submitShutdownRequest(IoUringSocket& socket, int how) PURE;
 
+  /**
+   * Submit a write request followed by a linked shutdown request for a socket. The shutdown is
+   * cancelled if the write doesn't write all the slices.
+   * @param shutdown_req receives the shutdown request.
+   * @return the write request.
+   */
+  virtual Request* submitWriteAndShutdownRequest(IoUringSocket& socket,
+                                                 const Buffer::RawSliceVector& slices, int how,
+                                                 Request*& shutdown_req) PURE;
+
   /**
    * Return the number of sockets in the worker.
    */
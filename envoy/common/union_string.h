@@ -125,6 +125,16 @@ public:
                    absl::get<InlinedStringVector>(buffer_).begin(), unary_op);
   }
 
+  /**
+   * Transforms the inlined vector data in place with an operation that works on the whole buffer
+   * at once, e.g. a vectorized transformation.
+   * @param buffer_op the operation, called with the buffer start and its size.
+   */
+  template <typename BufferOperation> void inlineTransformBuffer(BufferOperation&& buffer_op) {
+    ASSERT(type() == Type::Inline);
+    buffer_op(getInVec(buffer_).data(), getInVec(buffer_).size());
+  }
+
   /**
    * Trim trailing whitespaces from the InlinedString. Only supported by the "Inline" InlinedString
    * representation.
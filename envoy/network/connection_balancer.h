@@ -1,8 +1,13 @@
 #pragma once
 
+#include "envoy/common/optref.h"
 #include "envoy/network/listen_socket.h"
 
 namespace Envoy {
+namespace Event {
+class Dispatcher;
+} // namespace Event
+
 namespace Network {
 
 /**
@@ -35,6 +40,12 @@ public:
 
   virtual void onAcceptWorker(Network::ConnectionSocketPtr&& socket,
                               bool hand_off_restored_destination_connections, bool rebalanced) PURE;
+
+  /**
+   * @return the dispatcher of the worker running this handler, if any. Balancers can use it to
+   *         observe the load of the worker. It must only be used on the worker's thread.
+   */
+  virtual OptRef<Event::Dispatcher> workerDispatcher() { return {}; }
 };
 
 /**
@@ -94,6 +94,20 @@ public:
   virtual void forEachSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) const PURE;
   virtual void forEachSinkedTextReadout(SizeFn f_size, StatFn<TextReadout> f_stat) const PURE;
 
+  /**
+   * Iterate over the counters and gauges that need to be flushed to sinks and changed since the
+   * previous call, once tracking has been enabled with trackChangedStats(). Before that, this is
+   * equivalent to forEachSinkedCounter() and forEachSinkedGauge().
+   */
+  virtual void forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) PURE;
+  virtual void forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) PURE;
+
+  /**
+   * Start tracking which counters and gauges change. Stats created before this call are treated
+   * as changed.
+   */
+  virtual void trackChangedStats() PURE;
+
   /**
    * Set the predicates to filter stats for sink.
    */
@@ -24,6 +24,13 @@ public:
    * @return The buckets for the histogram. Each value is an upper bound of a bucket.
    */
   virtual ConstSupportedBuckets& buckets(absl::string_view stat_name) const PURE;
+
+  /**
+   * When worker threads record histogram values into log-linear buckets, get the precision of
+   * those buckets.
+   * @return the number of significant bits kept for each recorded value.
+   */
+  virtual uint32_t significantBits(absl::string_view stat_name) const PURE;
 };
 
 using HistogramSettingsConstPtr = std::unique_ptr<const HistogramSettings>;
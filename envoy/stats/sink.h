@@ -109,6 +109,13 @@ public:
    * @param value the value of the sample.
    */
   virtual void onHistogramComplete(const Histogram& histogram, uint64_t value) PURE;
+
+  /**
+   * @return true if the sink only needs the counters and gauges that changed since the previous
+   * flush. If all sinks return true, snapshots may leave out counters with a zero delta and gauges
+   * whose value did not change.
+   */
+  virtual bool changedStatsOnly() const { return false; }
 };
 
 using SinkPtr = std::unique_ptr<Sink>;
@@ -140,6 +140,18 @@ public:
   virtual void forEachSinkedTextReadout(SizeFn f_size, StatFn<TextReadout> f_stat) const PURE;
   virtual void forEachSinkedHistogram(SizeFn f_size, StatFn<ParentHistogram> f_stat) const PURE;
 
+  /**
+   * Iterate over the counters and gauges that need to be flushed to sinks and changed since the
+   * previous call. Unless tracking has been enabled with StoreRoot::trackChangedStats(), this
+   * iterates over all counters and gauges that need to be flushed to sinks, like
+   * forEachSinkedCounter() and forEachSinkedGauge().
+   * @param f_size functor that is provided an upper bound of the number of stats that will be
+   * flushed to sinks. Note that this is called only once, prior to any calls to f_stat.
+   * @param f_stat functor that is provided one stat that will be flushed to sinks, at a time.
+   */
+  virtual void forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) PURE;
+  virtual void forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) PURE;
+
   /**
    * Calls 'fn' for every stat. Note that in the case of overlapping scopes, the
    * implementation may call fn more than one time for each counter. Iteration
@@ -266,6 +278,14 @@ public:
   virtual void setSinkPredicates(std::unique_ptr<SinkPredicates>&& sink_predicates) PURE;
 
   virtual OptRef<SinkPredicates> sinkPredicates() PURE;
+
+  /**
+   * Start tracking which counters and gauges change, so that forEachChangedSinkedCounter() and
+   * forEachChangedSinkedGauge() only visit the stats that changed since their previous call. The
+   * first call after tracking is enabled visits all stats.
+   * @return false if the store does not support tracking changes.
+   */
+  virtual bool trackChangedStats() PURE;
 };
 
 using StoreRootPtr = std::unique_ptr<StoreRoot>;
@@ -9,6 +9,7 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/http/stream_reset_handler.h"
 
+#include "source/common/buffer/slice_pool.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/non_copyable.h"
 #include "source/common/common/utility.h"
@@ -37,7 +38,7 @@ namespace Buffer {
 class Slice {
 public:
   using Reservation = RawSlice;
-  using StoragePtr = std::unique_ptr<uint8_t[]>;
+  using StoragePtr = SliceStoragePool::StoragePtr;
 
   struct SizedStorage {
     StoragePtr mem_{};
@@ -57,7 +58,7 @@ public:
    * @param account the account to charge.
    */
   Slice(uint64_t min_capacity, const BufferMemoryAccountSharedPtr& account)
-      : capacity_(sliceSize(min_capacity)), storage_(new uint8_t[capacity_]),
+      : capacity_(sliceSize(min_capacity)), storage_(SliceStoragePool::allocate(capacity_)),
         base_(storage_.get()) {
     if (account) {
       account->charge(capacity_);
@@ -365,7 +366,7 @@ public:
    */
   static inline SizedStorage newStorage(uint64_t min_capacity) {
     const uint64_t slice_size = sliceSize(min_capacity);
-    return {StoragePtr{new uint8_t[slice_size]}, static_cast<size_t>(slice_size)};
+    return {SliceStoragePool::allocate(slice_size), static_cast<size_t>(slice_size)};
   }
 
 protected:
@@ -765,13 +766,19 @@ private:
   public:
     static constexpr uint32_t free_list_max_ = Buffer::Reservation::MAX_SLICES_;
 
-    OwnedImplReservationSlicesOwnerMultiple() : free_list_ref_(free_list_) {}
+    // Storage that ends up unused is returned to the SliceStoragePool when the owner is destroyed.
+    // Without the pool, it is kept in a thread local free list instead.
+    OwnedImplReservationSlicesOwnerMultiple()
+        : free_list_ref_(SliceStoragePool::enabled() ? nullptr : &free_list_) {}
     ~OwnedImplReservationSlicesOwnerMultiple() override {
+      if (free_list_ref_ == nullptr) {
+        return;
+      }
       for (auto r = owned_storages_.rbegin(); r != owned_storages_.rend(); r++) {
         if (r->mem_ != nullptr) {
           ASSERT(r->len_ == Slice::default_slice_size_);
-          if (free_list_ref_.size() < free_list_max_) {
-            free_list_ref_.push_back(std::move(r->mem_));
+          if (free_list_ref_->size() < free_list_max_) {
+            free_list_ref_->push_back(std::move(r->mem_));
           }
         }
       }
@@ -779,16 +786,12 @@ private:
 
     Slice::SizedStorage newStorage() {
       ASSERT(Slice::sliceSize(Slice::default_slice_size_) == Slice::default_slice_size_);
-
-      Slice::SizedStorage storage{nullptr, Slice::default_slice_size_};
-      if (!free_list_ref_.empty()) {
-        storage.mem_ = std::move(free_list_ref_.back());
-        free_list_ref_.pop_back();
-      } else {
-        storage.mem_.reset(new uint8_t[Slice::default_slice_size_]);
+      if (free_list_ref_ != nullptr && !free_list_ref_->empty()) {
+        Slice::SizedStorage storage{std::move(free_list_ref_->back()), Slice::default_slice_size_};
+        free_list_ref_->pop_back();
+        return storage;
       }
-
-      return storage;
+      return Slice::newStorage(Slice::default_slice_size_);
     }
 
     absl::Span<Slice::SizedStorage> ownedStorages() override {
@@ -798,13 +801,14 @@ private:
     absl::InlinedVector<Slice::SizedStorage, Buffer::Reservation::MAX_SLICES_> owned_storages_;
 
   private:
-    // Thread local resolving introduces additional overhead. Initialize this reference once when
-    // constructing the owner to reduce thread local resolving to improve performance.
-    absl::InlinedVector<Slice::StoragePtr, free_list_max_>& free_list_ref_;
-
-    // Simple thread local cache to reduce unnecessary memory allocation and release. This cache
-    // is currently only used for multiple slices reservation because of the additional overhead
-    // that thread local resolving would introduce.
+    // Thread local resolving introduces additional overhead. Initialize this pointer once when
+    // constructing the owner to reduce thread local resolving to improve performance. Null while
+    // the SliceStoragePool is enabled.
+    absl::InlinedVector<Slice::StoragePtr, free_list_max_>* free_list_ref_;
+
+    // Simple thread local cache to reduce unnecessary memory allocation and release when the
+    // SliceStoragePool is disabled. This cache is only used for multiple slices reservation because
+    // of the additional overhead that thread local resolving would introduce.
     static thread_local absl::InlinedVector<Slice::StoragePtr, free_list_max_> free_list_;
   };
 
@@ -0,0 +1,303 @@
+#include "source/common/buffer/slice_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/common/runtime/runtime_features.h"
+
+#include "absl/base/optimization.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+constexpr uint32_t UnpooledClass = SliceStoragePool::NumSizeClasses;
+// Low bits of an origin that hold the size class; thread caches are aligned well beyond that.
+constexpr uintptr_t SizeClassMask = 0x3;
+static_assert(SliceStoragePool::NumSizeClasses - 1 <= SizeClassMask);
+
+// Free blocks are linked through their own storage, which also holds their size class while they
+// wait on a return stack.
+struct FreeBlock {
+  FreeBlock* next_;
+  uint32_t size_class_;
+};
+
+// Return stack head of a cache whose thread exited. Blocks released to it are freed instead.
+FreeBlock closed_stack;
+
+uint32_t sizeClass(uint64_t size) {
+  if (size == 0 || size > SliceStoragePool::MaxPooledSize ||
+      size % SliceStoragePool::PageSize != 0) {
+    return UnpooledClass;
+  }
+  return size / SliceStoragePool::PageSize - 1;
+}
+
+uint64_t classSize(uint32_t size_class) { return (size_class + 1) * SliceStoragePool::PageSize; }
+
+struct ThreadCache;
+void retireCache(ThreadCache* cache);
+
+// Per-thread cache. A cache is referenced by its thread until the thread exits, and by each block
+// allocated from it until the block is freed, as releasing a block may hand it back to the cache.
+struct alignas(64) ThreadCache {
+  // Blocks released by other threads. Producers push with a CAS; the owner takes the whole stack
+  // with a single exchange, so there is no ABA problem. Set to &closed_stack when the owner exits.
+  std::atomic<FreeBlock*> remote_head_{nullptr};
+  std::atomic<uint64_t> references_{1};
+
+  // Only written by the owning thread; atomics so that stats() can read them from any thread.
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> remote_releases_{0};
+
+  // Owner-only free lists per size class.
+  std::array<FreeBlock*, SliceStoragePool::NumSizeClasses> free_{};
+  std::array<uint32_t, SliceStoragePool::NumSizeClasses> free_count_{};
+
+  static void increment(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  uintptr_t origin(uint32_t size_class) { return reinterpret_cast<uintptr_t>(this) | size_class; }
+
+  uint8_t* newBlock(uint32_t size_class) {
+    references_.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<uint8_t*>(::operator new(classSize(size_class)));
+  }
+
+  // Frees a block allocated from this cache. This may free the cache itself.
+  void freeBlock(void* mem) {
+    ::operator delete(mem);
+    unref();
+  }
+
+  void unref() {
+    if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      retireCache(this);
+    }
+  }
+
+  bool pushLocal(uint8_t* mem, uint32_t size_class) {
+    if (free_count_[size_class] >= SliceStoragePool::MaxCachedPerClass) {
+      return false;
+    }
+    free_[size_class] = new (mem) FreeBlock{free_[size_class], size_class};
+    free_count_[size_class]++;
+    return true;
+  }
+
+  uint8_t* popLocal(uint32_t size_class) {
+    FreeBlock* block = free_[size_class];
+    if (block == nullptr) {
+      return nullptr;
+    }
+    free_[size_class] = block->next_;
+    free_count_[size_class]--;
+    return reinterpret_cast<uint8_t*>(block);
+  }
+
+  // @return false if the owning thread exited, in which case the caller keeps the block.
+  bool pushRemote(uint8_t* mem, uint32_t size_class) {
+    FreeBlock* block = new (mem) FreeBlock{nullptr, size_class};
+    FreeBlock* head = remote_head_.load(std::memory_order_relaxed);
+    do {
+      if (head == &closed_stack) {
+        return false;
+      }
+      block->next_ = head;
+    } while (!remote_head_.compare_exchange_weak(head, block, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+    return true;
+  }
+
+  void drainRemote() {
+    if (remote_head_.load(std::memory_order_relaxed) == nullptr) {
+      return;
+    }
+    FreeBlock* block = remote_head_.exchange(nullptr, std::memory_order_acquire);
+    while (block != nullptr) {
+      FreeBlock* next = block->next_;
+      if (!pushLocal(reinterpret_cast<uint8_t*>(block), block->size_class_)) {
+        freeBlock(block);
+      }
+      block = next;
+    }
+  }
+
+  void clear() {
+    drainRemote();
+    for (uint32_t i = 0; i < SliceStoragePool::NumSizeClasses; i++) {
+      while (uint8_t* mem = popLocal(i)) {
+        freeBlock(mem);
+      }
+    }
+  }
+
+  // Called by the owning thread when it exits. Blocks that are still in use free themselves when
+  // they are released, and the last one frees the cache.
+  void close() {
+    clear();
+    FreeBlock* block = remote_head_.exchange(&closed_stack, std::memory_order_acquire);
+    while (block != nullptr) {
+      FreeBlock* next = block->next_;
+      freeBlock(block);
+      block = next;
+    }
+    unref();
+  }
+};
+
+struct Registry {
+  absl::Mutex mutex_;
+  std::vector<ThreadCache*> live_ ABSL_GUARDED_BY(mutex_);
+  // Totals of the caches that were freed.
+  SliceStoragePool::Stats retired_ ABSL_GUARDED_BY(mutex_);
+};
+
+Registry& registry() { MUTABLE_CONSTRUCT_ON_FIRST_USE(Registry); }
+
+ThreadCache* acquireCache() {
+  auto* cache = new ThreadCache();
+  Registry& r = registry();
+  absl::MutexLock lock(&r.mutex_);
+  r.live_.push_back(cache);
+  return cache;
+}
+
+void retireCache(ThreadCache* cache) {
+  {
+    Registry& r = registry();
+    absl::MutexLock lock(&r.mutex_);
+    r.retired_.hits_ += cache->hits_.load(std::memory_order_relaxed);
+    r.retired_.misses_ += cache->misses_.load(std::memory_order_relaxed);
+    r.retired_.remote_releases_ += cache->remote_releases_.load(std::memory_order_relaxed);
+    r.live_.erase(std::find(r.live_.begin(), r.live_.end(), cache));
+  }
+  delete cache;
+}
+
+// Plain pointer for the fast path; the guard below only exists to close the cache on thread exit.
+thread_local ThreadCache* local_cache = nullptr;
+thread_local bool local_cache_exited = false;
+
+struct ThreadCacheGuard {
+  ~ThreadCacheGuard() {
+    ThreadCache* cache = local_cache;
+    local_cache = nullptr;
+    local_cache_exited = true;
+    if (cache != nullptr) {
+      cache->close();
+    }
+  }
+};
+thread_local ThreadCacheGuard local_cache_guard;
+
+ThreadCache* localCache() {
+  if (ABSL_PREDICT_FALSE(local_cache == nullptr)) {
+    if (local_cache_exited) {
+      // Thread teardown: do not resurrect the cache.
+      return nullptr;
+    }
+    // Touch the guard so that its destructor runs when this thread exits.
+    (void)&local_cache_guard;
+    local_cache = acquireCache();
+  }
+  return local_cache;
+}
+
+} // namespace
+
+bool SliceStoragePool::enabled() {
+  return Runtime::runtimeFeatureEnabled("envoy.reloadable_features.buffer_slice_storage_pool");
+}
+
+SliceStoragePool::StoragePtr SliceStoragePool::allocate(uint64_t size) {
+  const uint32_t size_class = sizeClass(size);
+  ThreadCache* cache = size_class == UnpooledClass || !enabled() ? nullptr : localCache();
+  if (cache == nullptr) {
+    return StoragePtr(static_cast<uint8_t*>(::operator new(size)), Deleter());
+  }
+
+  uint8_t* mem = cache->popLocal(size_class);
+  if (mem == nullptr) {
+    cache->drainRemote();
+    mem = cache->popLocal(size_class);
+  }
+  if (mem != nullptr) {
+    ThreadCache::increment(cache->hits_);
+  } else {
+    ThreadCache::increment(cache->misses_);
+    mem = cache->newBlock(size_class);
+  }
+  return StoragePtr(mem, Deleter(cache->origin(size_class)));
+}
+
+void SliceStoragePool::release(uint8_t* mem, uintptr_t origin) {
+  auto* owner = reinterpret_cast<ThreadCache*>(origin & ~SizeClassMask);
+  if (owner == nullptr) {
+    ::operator delete(mem);
+    return;
+  }
+  const uint32_t size_class = origin & SizeClassMask;
+
+  ThreadCache* cache = local_cache;
+  if (owner == cache) {
+    if (!cache->pushLocal(mem, size_class)) {
+      cache->freeBlock(mem);
+    }
+    return;
+  }
+
+  // The owner must not be touched once the block is on its return stack, as it may be freed.
+  if (!owner->pushRemote(mem, size_class)) {
+    owner->freeBlock(mem);
+  }
+  // Account the release to the releasing thread, which may not have allocated anything yet.
+  if (cache != nullptr || (cache = localCache()) != nullptr) {
+    ThreadCache::increment(cache->remote_releases_);
+  }
+}
+
+SliceStoragePool::Stats SliceStoragePool::stats() {
+  Registry& r = registry();
+  absl::MutexLock lock(&r.mutex_);
+  Stats stats = r.retired_;
+  for (const ThreadCache* cache : r.live_) {
+    stats.hits_ += cache->hits_.load(std::memory_order_relaxed);
+    stats.misses_ += cache->misses_.load(std::memory_order_relaxed);
+    stats.remote_releases_ += cache->remote_releases_.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void SliceStoragePool::clearThreadCacheForTest() {
+  if (ThreadCache* cache = localCache(); cache != nullptr) {
+    cache->clear();
+  }
+}
+
+uint32_t SliceStoragePool::cachedBlocksForTest(uint64_t size) {
+  const uint32_t size_class = sizeClass(size);
+  ThreadCache* cache = localCache();
+  if (size_class == UnpooledClass || cache == nullptr) {
+    return 0;
+  }
+  return cache->free_count_[size_class];
+}
+
+uint32_t SliceStoragePool::threadCachesForTest() {
+  Registry& r = registry();
+  absl::MutexLock lock(&r.mutex_);
+  return r.live_.size();
+}
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Size-classed pool for the backing storage of Buffer::Slice. Storage sizes that are a multiple of
+ * PageSize up to MaxPooledSize are recycled through small per-thread caches; other sizes go
+ * straight to the heap. The pool is only used while the
+ * envoy.reloadable_features.buffer_slice_storage_pool runtime guard is enabled; otherwise all
+ * storage comes straight from the heap. Storage allocated from the pool returns to it when released
+ * even after the guard is disabled.
+ *
+ * Storage remembers the thread cache it was allocated from. When it is released on another thread
+ * (e.g. after a buffer was moved to a different worker) it is handed back to the owning cache
+ * through a lock-free multi-producer single-consumer return stack, which the owner drains the next
+ * time its local cache runs dry. This keeps producer threads supplied with recycled storage even
+ * when the consumers are other threads.
+ *
+ * The cache and size class of a block are kept in the deleter of its StoragePtr rather than in
+ * the block, so that pooled blocks are exactly one size class large, which is what allocators
+ * round page multiples to anyway. A cache is freed once its thread exited and all of its blocks
+ * were released.
+ */
+class SliceStoragePool {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  static constexpr uint64_t MaxPooledSize = 16384;
+  static constexpr uint32_t NumSizeClasses = MaxPooledSize / PageSize;
+  // Maximum number of free blocks each thread keeps per size class.
+  static constexpr uint32_t MaxCachedPerClass = 8;
+
+  /**
+   * unique_ptr deleter that returns storage to the pool. May run on any thread.
+   */
+  class Deleter {
+  public:
+    Deleter() = default;
+    void operator()(uint8_t* mem) const { release(mem, origin_); }
+
+  private:
+    friend class SliceStoragePool;
+    explicit Deleter(uintptr_t origin) : origin_(origin) {}
+
+    // The thread cache the storage was allocated from, with its size class in the low bits. 0 for
+    // storage that is not pooled.
+    uintptr_t origin_{};
+  };
+  using StoragePtr = std::unique_ptr<uint8_t[], Deleter>;
+
+  struct Stats {
+    // Allocations served from a thread cache.
+    uint64_t hits_{};
+    // Poolable allocations that had to go to the heap.
+    uint64_t misses_{};
+    // Pooled blocks released on a thread other than the one that allocated them.
+    uint64_t remote_releases_{};
+  };
+
+  /**
+   * @return whether new storage is allocated from the pool.
+   */
+  static bool enabled();
+
+  /**
+   * @param size the storage size in bytes.
+   * @return storage of at least the given size.
+   */
+  static StoragePtr allocate(uint64_t size);
+
+  /**
+   * @return the pool statistics summed over all threads, including the ones that exited.
+   */
+  static Stats stats();
+
+  /**
+   * Releases the free blocks cached by the calling thread, including any blocks returned to it by
+   * other threads. For tests.
+   */
+  static void clearThreadCacheForTest();
+
+  /**
+   * @return the number of free blocks of the given size cached by the calling thread, not counting
+   * blocks waiting on its return stack. For tests.
+   */
+  static uint32_t cachedBlocksForTest(uint64_t size);
+
+  /**
+   * @return the number of thread caches that have not been freed yet. For tests.
+   */
+  static uint32_t threadCachesForTest();
+
+private:
+  static void release(uint8_t* mem, uintptr_t origin);
+};
+
+} // namespace Buffer
+} // namespace Envoy
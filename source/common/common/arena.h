@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/non_copyable.h"
+
+#include "absl/container/inlined_vector.h"
+
+namespace Envoy {
+
+/**
+ * Monotonic bump allocator for objects that share a single owner lifetime, e.g. everything
+ * created for one HTTP stream. Memory is handed out from geometrically growing blocks and is
+ * never reused; all blocks are released together when the arena is destroyed. Requests larger
+ * than a block fall back to a dedicated heap allocation that is still owned by the arena.
+ *
+ * The arena does not run destructors. Objects that need one should be created with
+ * makeArenaPtr() below, which destroys them in place when the owning pointer goes away.
+ */
+class Arena : NonCopyable {
+public:
+  static constexpr size_t DefaultInitialBlockSize = 4096;
+  static constexpr size_t DefaultMaxBlockSize = 16384;
+
+  explicit Arena(size_t initial_block_size = DefaultInitialBlockSize,
+                 size_t max_block_size = DefaultMaxBlockSize)
+      : next_block_size_(initial_block_size),
+        max_block_size_(std::max(initial_block_size, max_block_size)) {}
+  ~Arena() {
+    for (void* block : blocks_) {
+      ::operator delete(block);
+    }
+  }
+
+  /**
+   * @return pointer to uninitialized memory of the given size and alignment. The memory stays
+   *         valid until the arena is destroyed.
+   */
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+    if (cursor_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(block_end_)) {
+      if (size + alignment > max_block_size_) {
+        // Oversized request: give it its own block and keep bumping in the current one.
+        ASSERT(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        void* block = ::operator new(size);
+        blocks_.push_back(block);
+        bytes_reserved_ += size;
+        bytes_allocated_ += size;
+        return block;
+      }
+      newBlock(size + alignment);
+      aligned = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+    }
+    cursor_ = reinterpret_cast<char*>(aligned + size);
+    bytes_allocated_ += size;
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  /**
+   * @return the number of bytes handed out by allocate().
+   */
+  size_t bytesAllocated() const { return bytes_allocated_; }
+
+  /**
+   * @return the number of bytes obtained from the heap.
+   */
+  size_t bytesReserved() const { return bytes_reserved_; }
+
+  /**
+   * @return the number of heap blocks owned by the arena.
+   */
+  size_t blockCount() const { return blocks_.size(); }
+
+protected:
+  /**
+   * Hands out the given memory, which must outlive the arena, before allocating any block.
+   */
+  Arena(char* initial_block, size_t initial_block_size, size_t max_block_size)
+      : next_block_size_(initial_block_size),
+        max_block_size_(std::max(initial_block_size, max_block_size)), cursor_(initial_block),
+        block_end_(initial_block + initial_block_size) {}
+
+private:
+  void newBlock(size_t min_size) {
+    const size_t size = std::max(next_block_size_, min_size);
+    next_block_size_ = std::min(next_block_size_ * 2, max_block_size_);
+    char* block = static_cast<char*>(::operator new(size));
+    blocks_.push_back(block);
+    bytes_reserved_ += size;
+    cursor_ = block;
+    block_end_ = block + size;
+  }
+
+  size_t next_block_size_;
+  const size_t max_block_size_;
+  char* cursor_{nullptr};
+  char* block_end_{nullptr};
+  size_t bytes_allocated_{0};
+  size_t bytes_reserved_{0};
+  absl::InlinedVector<void*, 4> blocks_;
+};
+
+/**
+ * Arena whose first block is embedded in the arena itself, so that owners whose usage is known to
+ * be small get their first InlineSize bytes without a separate heap allocation.
+ */
+template <size_t InlineSize> class InlineArena : public Arena {
+public:
+  explicit InlineArena(size_t max_block_size = DefaultMaxBlockSize)
+      : Arena(inline_block_, InlineSize, max_block_size) {}
+
+private:
+  alignas(std::max_align_t) char inline_block_[InlineSize];
+};
+
+/**
+ * Deleter for objects that may live either in an Arena or on the heap. Arena objects are only
+ * destroyed; their memory is reclaimed with the arena.
+ */
+template <class T> class ArenaDeleter {
+public:
+  ArenaDeleter() = default;
+  explicit ArenaDeleter(bool in_arena) : in_arena_(in_arena) {}
+  template <class U, class = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  ArenaDeleter(const ArenaDeleter<U>& other) // NOLINT(google-explicit-constructor)
+      : in_arena_(other.inArena()) {}
+
+  void operator()(T* object) const {
+    if (in_arena_) {
+      object->~T();
+    } else {
+      delete object;
+    }
+  }
+
+  bool inArena() const { return in_arena_; }
+
+private:
+  bool in_arena_{false};
+};
+
+template <class T> using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+/**
+ * Creates an object in the given arena, or on the heap if no arena is supplied. The arena must
+ * outlive the returned pointer.
+ */
+template <class T, class... Args> ArenaPtr<T> makeArenaPtr(Arena* arena, Args&&... args) {
+  if (arena == nullptr) {
+    return ArenaPtr<T>(new T(std::forward<Args>(args)...), ArenaDeleter<T>(false));
+  }
+  void* memory = arena->allocate(sizeof(T), alignof(T));
+  return ArenaPtr<T>(new (memory) T(std::forward<Args>(args)...), ArenaDeleter<T>(true));
+}
+
+} // namespace Envoy
@@ -5,6 +5,8 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/macros.h"
 
+#include "absl/hash/hash.h"
+
 namespace Envoy {
 namespace Thread {
 
@@ -101,5 +103,40 @@ SkipAsserts::~SkipAsserts() { ThreadIds::get().decSkipAsserts(); }
 
 bool SkipAsserts::skip() { return ThreadIds::get().skipAsserts(); }
 
+void StripedMutex::lock() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  // Stripes are always locked in the same order, so concurrent writers cannot deadlock.
+  for (Stripe& stripe : stripes_) {
+    stripe.mutex_.Lock();
+  }
+}
+
+bool StripedMutex::tryLock() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  for (uint32_t i = 0; i < NumStripes; ++i) {
+    if (!stripes_[i].mutex_.TryLock()) {
+      while (i > 0) {
+        stripes_[--i].mutex_.Unlock();
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void StripedMutex::unlock() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  for (Stripe& stripe : stripes_) {
+    stripe.mutex_.Unlock();
+  }
+}
+
+void StripedMutex::readerLock() ABSL_NO_THREAD_SAFETY_ANALYSIS { threadStripe().Lock(); }
+
+void StripedMutex::readerUnlock() ABSL_NO_THREAD_SAFETY_ANALYSIS { threadStripe().Unlock(); }
+
+absl::Mutex& StripedMutex::threadStripe() {
+  static thread_local const uint32_t stripe =
+      absl::Hash<std::thread::id>()(std::this_thread::get_id()) % NumStripes;
+  return stripes_[stripe].mutex_;
+}
+
 } // namespace Thread
 } // namespace Envoy
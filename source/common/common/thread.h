@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cstring>
 #include <functional>
@@ -30,6 +31,52 @@ private:
   absl::Mutex mutex_;
 };
 
+/**
+ * Reader-writer lock for data that is read far more often than it is written. The lock is
+ * split into stripes on separate cache lines: a reader only locks the stripe picked by its
+ * thread, so readers on different threads rarely touch the same cache line, while writers lock
+ * every stripe. Readers take their stripe exclusively, which is cheaper than a shared lock and
+ * only serializes the few threads that share a stripe.
+ */
+class StripedMutex : public BasicLockable {
+public:
+  // BasicLockable
+  void lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() override;
+  bool tryLock() ABSL_EXCLUSIVE_TRYLOCK_FUNCTION(true) override;
+  void unlock() ABSL_UNLOCK_FUNCTION() override;
+
+  /**
+   * Takes the lock in shared mode. Must be released by readerUnlock() on the same thread.
+   */
+  void readerLock() ABSL_SHARED_LOCK_FUNCTION();
+  void readerUnlock() ABSL_UNLOCK_FUNCTION();
+
+private:
+  static constexpr uint32_t NumStripes = 32;
+
+  struct alignas(64) Stripe {
+    absl::Mutex mutex_;
+  };
+
+  absl::Mutex& threadStripe();
+
+  std::array<Stripe, NumStripes> stripes_;
+};
+
+/**
+ * Holds a StripedMutex in shared mode for the lifetime of the guard.
+ */
+class ABSL_SCOPED_LOCKABLE ReaderLockGuard {
+public:
+  explicit ReaderLockGuard(StripedMutex& lock) ABSL_SHARED_LOCK_FUNCTION(lock) : lock_(lock) {
+    lock_.readerLock();
+  }
+  ~ReaderLockGuard() ABSL_UNLOCK_FUNCTION() { lock_.readerUnlock(); }
+
+private:
+  StripedMutex& lock_;
+};
+
 /**
  * Implementation of condvar, based on MutexLockable. This interface is a hybrid
  * between std::condition_variable and absl::CondVar.
@@ -59,7 +59,9 @@ ConnPoolImplBase::ConnPoolImplBase(
       transport_socket_options_(transport_socket_options), cluster_connectivity_state_(state),
       upstream_ready_cb_(dispatcher_.createSchedulableCallback([this]() { onUpstreamReady(); })),
       create_new_connection_load_shed_(overload_manager.getLoadShedPoint(
-          Server::LoadShedPointName::get().ConnectionPoolNewConnection)) {
+          Server::LoadShedPointName::get().ConnectionPoolNewConnection)),
+      least_loaded_client_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.conn_pool_least_loaded_client")) {
   ENVOY_LOG_ONCE_IF(trace, create_new_connection_load_shed_ == nullptr,
                     "LoadShedPoint envoy.load_shed_points.connection_pool_new_connection is not "
                     "found. Is it configured?");
@@ -273,6 +275,8 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
   host_->cluster().resourceManager(priority_).requests().inc();
 
   onPoolReady(client, context);
+  // The stream is counted by the client once it is created in onPoolReady().
+  updateReadyIndex(client);
 }
 
 void ConnPoolImplBase::onStreamClosed(Envoy::ConnectionPool::ActiveClient& client,
@@ -301,6 +305,7 @@ void ConnPoolImplBase::onStreamClosed(Envoy::ConnectionPool::ActiveClient& clien
       incrConnectingAndConnectedStreamCapacity(1, client);
     }
   }
+  updateReadyIndex(client);
   if (client.state() == ActiveClient::State::Draining && client.numActiveStreams() == 0) {
     // Close out the draining client if we no longer have active streams.
     client.close();
@@ -326,7 +331,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
   assertCapacityCountsAreCorrect();
 
   if (!ready_clients_.empty()) {
-    ActiveClient& client = *ready_clients_.front();
+    ActiveClient& client = nextReadyClient();
     ENVOY_CONN_LOG(debug, "using existing fully connected connection", client);
     attachStreamToClient(client, context);
     // Even if there's a ready client, we may want to preconnect to handle the next incoming stream.
@@ -396,11 +401,14 @@ void ConnPoolImplBase::scheduleOnUpstreamReady() {
 
 void ConnPoolImplBase::onUpstreamReady() {
   while (!pending_streams_.empty() && !ready_clients_.empty()) {
-    ActiveClientPtr& client = ready_clients_.front();
-    ENVOY_CONN_LOG(debug, "attaching to next stream", *client);
+    ActiveClient& client = nextReadyClient();
+    ENVOY_CONN_LOG(debug, "attaching to next stream", client);
     // Pending streams are pushed onto the front, so pull from the back.
-    attachStreamToClient(*client, pending_streams_.back()->context());
+    attachStreamToClient(client, pending_streams_.back()->context());
     cluster_connectivity_state_.decrPendingStreams(1);
+    if (pending_streams_.back()->can_send_early_data_) {
+      pending_early_data_streams_--;
+    }
     pending_streams_.pop_back();
   }
   if (!pending_streams_.empty()) {
@@ -408,6 +416,44 @@ void ConnPoolImplBase::onUpstreamReady() {
   }
 }
 
+ActiveClient& ConnPoolImplBase::nextReadyClient() {
+  ASSERT(!ready_clients_.empty(), dumpState());
+  if (least_loaded_client_) {
+    ASSERT(ready_index_.size() == ready_clients_.size(), dumpState());
+    return **ready_index_.begin();
+  }
+  return *ready_clients_.front();
+}
+
+void ConnPoolImplBase::updateReadyIndex(ActiveClient& client) {
+  if (!least_loaded_client_) {
+    return;
+  }
+  if (client.state() != ActiveClient::State::Ready) {
+    removeFromReadyIndex(client);
+    return;
+  }
+  const uint32_t load = client.numActiveStreams();
+  if (client.in_ready_index_) {
+    if (client.ready_index_load_ == load) {
+      return;
+    }
+    ready_index_.erase(&client);
+  } else {
+    client.ready_index_order_ = next_ready_index_order_++;
+    client.in_ready_index_ = true;
+  }
+  client.ready_index_load_ = load;
+  ready_index_.insert(&client);
+}
+
+void ConnPoolImplBase::removeFromReadyIndex(ActiveClient& client) {
+  if (client.in_ready_index_) {
+    ready_index_.erase(&client);
+    client.in_ready_index_ = false;
+  }
+}
+
 std::list<ActiveClientPtr>& ConnPoolImplBase::owningList(ActiveClient::State state) {
   switch (state) {
   case ActiveClient::State::Connecting:
@@ -439,6 +485,7 @@ void ConnPoolImplBase::transitionActiveClientState(ActiveClient& client,
   if (&old_list != &new_list) {
     client.moveBetweenLists(old_list, new_list);
   }
+  updateReadyIndex(client);
 }
 
 void ConnPoolImplBase::addIdleCallbackImpl(Instance::IdleCb cb) { idle_callbacks_.push_back(cb); }
@@ -449,9 +496,21 @@ void ConnPoolImplBase::closeIdleConnectionsForDrainingPool() {
   // Create a separate list of elements to close to avoid mutate-while-iterating problems.
   std::list<ActiveClient*> to_close;
 
-  for (auto& client : ready_clients_) {
-    if (client->numActiveStreams() == 0) {
-      to_close.push_back(client.get());
+  if (least_loaded_client_) {
+    // Idle clients are ordered first in the index, so only those are visited.
+    for (ActiveClient* client : ready_index_) {
+      if (client->ready_index_load_ > 0) {
+        break;
+      }
+      if (client->numActiveStreams() == 0) {
+        to_close.push_back(client);
+      }
+    }
+  } else {
+    for (auto& client : ready_clients_) {
+      if (client->numActiveStreams() == 0) {
+        to_close.push_back(client.get());
+      }
     }
   }
 
@@ -619,6 +678,7 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
       client.connection_duration_timer_.reset();
     }
 
+    removeFromReadyIndex(client);
     dispatcher_.deferredDelete(client.removeFromList(owningList(client.state())));
 
     // Check if the pool transitioned to idle state after removing closed client
@@ -714,6 +774,7 @@ void ConnPoolImplBase::purgePendingStreams(
   // NOTE: We move the existing pending streams to a temporary list. This is done so that
   //       if retry logic submits a new stream to the pool, we don't fail it inline.
   cluster_connectivity_state_.decrPendingStreams(pending_streams_.size());
+  pending_early_data_streams_ = 0;
   pending_streams_to_purge_ = std::move(pending_streams_);
   while (!pending_streams_to_purge_.empty()) {
     PendingStreamPtr stream =
@@ -748,6 +809,9 @@ void ConnPoolImplBase::onPendingStreamCancel(PendingStream& stream,
     stream.removeFromList(pending_streams_to_purge_);
   } else {
     cluster_connectivity_state_.decrPendingStreams(1);
+    if (stream.can_send_early_data_) {
+      pending_early_data_streams_--;
+    }
     stream.removeFromList(pending_streams_);
   }
   if (policy == Envoy::ConnectionPool::CancelPolicy::CloseExcess) {
@@ -798,13 +862,12 @@ void ConnPoolImplBase::incrConnectingAndConnectedStreamCapacity(uint32_t delta,
 
 void ConnPoolImplBase::onUpstreamReadyForEarlyData(ActiveClient& client) {
   ASSERT(!client.hasHandshakeCompleted() && client.readyForStream());
-  // Check pending streams backward for safe request.
-  // Note that this is a O(n) search, but the expected size of pending_streams_ should be small. If
-  // this becomes a problem, we could split pending_streams_ into 2 lists.
-  auto it = pending_streams_.end();
-  if (it == pending_streams_.begin()) {
+  // Check pending streams backward for safe request. This is a linear search, which is skipped
+  // when no pending stream can be sent as early data and stops once all of them are attached.
+  if (pending_early_data_streams_ == 0) {
     return;
   }
+  auto it = pending_streams_.end();
   --it;
   while (client.currentUnusedCapacity() > 0) {
     PendingStream& stream = **it;
@@ -819,9 +882,10 @@ void ConnPoolImplBase::onUpstreamReadyForEarlyData(ActiveClient& client) {
       ENVOY_CONN_LOG(debug, "creating stream for early data.", client);
       attachStreamToClient(client, stream.context());
       cluster_connectivity_state_.decrPendingStreams(1);
+      pending_early_data_streams_--;
       stream.removeFromList(pending_streams_);
     }
-    if (stop_iteration) {
+    if (stop_iteration || pending_early_data_streams_ == 0) {
       return;
     }
   }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <tuple>
+
 #include "envoy/common/conn_pool.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection.h"
@@ -11,6 +13,7 @@
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 
+#include "absl/container/btree_set.h"
 #include "absl/strings/string_view.h"
 #include "fmt/ostream.h"
 
@@ -145,6 +148,11 @@ public:
   bool timed_out_{false};
   // TODO(danzh) remove this once http codec exposes the handshake state for h3.
   bool has_handshake_completed_{false};
+  // The key under which the pool indexes this client while it is Ready: the number of active
+  // streams when last indexed, and the order in which it became Ready.
+  uint32_t ready_index_load_{0};
+  uint64_t ready_index_order_{0};
+  bool in_ready_index_{false};
 
 protected:
   // HTTP/3 subclass should override this.
@@ -347,8 +355,14 @@ protected:
 
   float perUpstreamPreconnectRatio() const;
 
+  // Returns the Ready client to attach the next stream to.
+  ActiveClient& nextReadyClient();
+
   ConnectionPool::Cancellable*
   addPendingStream(Envoy::ConnectionPool::PendingStreamPtr&& pending_stream) {
+    if (pending_stream->can_send_early_data_) {
+      pending_early_data_streams_++;
+    }
     LinkedList::moveIntoList(std::move(pending_stream), pending_streams_);
     cluster_connectivity_state_.incrPendingStreams(1);
     return pending_streams_.front().get();
@@ -392,10 +406,23 @@ protected:
   uint32_t connecting_stream_capacity_{0};
 
 private:
+  // Orders Ready clients by load and then, as ready_clients_ does, the most recently Ready first.
+  struct ReadyClientOrder {
+    bool operator()(const ActiveClient* lhs, const ActiveClient* rhs) const {
+      return std::tie(lhs->ready_index_load_, rhs->ready_index_order_) <
+             std::tie(rhs->ready_index_load_, lhs->ready_index_order_);
+    }
+  };
+
   // Drain all the clients in the given list.
   // Prerequisite: the given clients shouldn't be idle.
   void drainClients(std::list<ActiveClientPtr>& clients);
 
+  // Indexes the client under its current number of active streams if it is Ready, or removes it
+  // from the index otherwise. A no-op unless least_loaded_client_ is set.
+  void updateReadyIndex(ActiveClient& client);
+  void removeFromReadyIndex(ActiveClient& client);
+
   void assertCapacityCountsAreCorrect();
 
   Upstream::ClusterConnectivityState& cluster_connectivity_state_;
@@ -419,6 +446,15 @@ private:
   Event::SchedulableCallbackPtr upstream_ready_cb_;
   Common::DebugRecursionChecker recursion_checker_;
   Server::LoadShedPoint* create_new_connection_load_shed_{nullptr};
+
+  // True if new streams are attached to the Ready client with the fewest active streams, rather
+  // than the first one in ready_clients_.
+  const bool least_loaded_client_;
+  // The entries of ready_clients_ ordered by load. Only maintained if least_loaded_client_.
+  absl::btree_set<ActiveClient*, ReadyClientOrder> ready_index_;
+  uint64_t next_ready_index_order_{0};
+  // The number of entries in pending_streams_ which can be sent as early data.
+  uint32_t pending_early_data_streams_{0};
 };
 
 } // namespace ConnectionPool
@@ -14,6 +14,7 @@
 #include "envoy/protobuf/message_validator.h"
 
 #include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/arena.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/common/logger.h"
@@ -37,8 +38,8 @@ class DownstreamFilterManager;
 struct ActiveStreamFilterBase;
 struct ActiveStreamDecoderFilter;
 struct ActiveStreamEncoderFilter;
-using ActiveStreamDecoderFilterPtr = std::unique_ptr<ActiveStreamDecoderFilter>;
-using ActiveStreamEncoderFilterPtr = std::unique_ptr<ActiveStreamEncoderFilter>;
+using ActiveStreamDecoderFilterPtr = ArenaPtr<ActiveStreamDecoderFilter>;
+using ActiveStreamEncoderFilterPtr = ArenaPtr<ActiveStreamEncoderFilter>;
 
 constexpr absl::string_view LocalReplyFilterStateKey =
     "envoy.filters.network.http_connection_manager.local_reply_owner";
@@ -691,7 +692,11 @@ public:
                 uint32_t buffer_limit)
       : filter_manager_callbacks_(filter_manager_callbacks), dispatcher_(dispatcher),
         connection_(connection), stream_id_(stream_id), account_(std::move(account)),
-        proxy_100_continue_(proxy_100_continue), buffer_limit_(buffer_limit) {}
+        proxy_100_continue_(proxy_100_continue),
+        arena_(Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http_stream_arena")
+                   ? std::make_unique<StreamArena>()
+                   : nullptr),
+        buffer_limit_(buffer_limit) {}
 
   ~FilterManager() override {
     ASSERT(state_.destroyed_);
@@ -981,6 +986,9 @@ protected:
 
   State& state() { return state_; }
 
+  // Returns the per-stream arena, or nullptr if arena allocation is not enabled for this stream.
+  Arena* arena() { return arena_.get(); }
+
 private:
   friend class DownstreamFilterManager;
   class FilterChainFactoryCallbacksImpl : public Http::FilterChainFactoryCallbacks {
@@ -991,24 +999,24 @@ private:
     void addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr filter) override {
       manager_.filters_.push_back(filter.get());
 
-      manager_.decoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamDecoderFilter>(manager_, std::move(filter), context_));
+      manager_.decoder_filters_.entries_.emplace_back(makeArenaPtr<ActiveStreamDecoderFilter>(
+          manager_.arena_.get(), manager_, std::move(filter), context_));
     }
 
     void addStreamEncoderFilter(Http::StreamEncoderFilterSharedPtr filter) override {
       manager_.filters_.push_back(filter.get());
 
-      manager_.encoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamEncoderFilter>(manager_, std::move(filter), context_));
+      manager_.encoder_filters_.entries_.emplace_back(makeArenaPtr<ActiveStreamEncoderFilter>(
+          manager_.arena_.get(), manager_, std::move(filter), context_));
     }
 
     void addStreamFilter(Http::StreamFilterSharedPtr filter) override {
       manager_.filters_.push_back(filter.get());
 
-      manager_.decoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamDecoderFilter>(manager_, filter, context_));
-      manager_.encoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamEncoderFilter>(manager_, std::move(filter), context_));
+      manager_.decoder_filters_.entries_.emplace_back(makeArenaPtr<ActiveStreamDecoderFilter>(
+          manager_.arena_.get(), manager_, filter, context_));
+      manager_.encoder_filters_.entries_.emplace_back(makeArenaPtr<ActiveStreamEncoderFilter>(
+          manager_.arena_.get(), manager_, std::move(filter), context_));
     }
 
     void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override {
@@ -1109,6 +1117,16 @@ private:
   Buffer::BufferMemoryAccountSharedPtr account_;
   const bool proxy_100_continue_;
 
+  // The wrappers of this many stream filters fit in the inline block of the stream arena, which
+  // covers common filter chains with a single allocation. Longer chains spill into heap blocks.
+  static constexpr size_t StreamArenaInlineFilters = 4;
+  using StreamArena = InlineArena<StreamArenaInlineFilters * (sizeof(ActiveStreamDecoderFilter) +
+                                                              sizeof(ActiveStreamEncoderFilter))>;
+
+  // Per-stream arena holding the filter wrappers created for this stream, released in one shot
+  // when the stream is destroyed. Only set when envoy.reloadable_features.http_stream_arena is
+  // enabled. Must be declared before any member holding arena objects.
+  std::unique_ptr<StreamArena> arena_;
   StreamDecoderFilters decoder_filters_;
   StreamEncoderFilters encoder_filters_;
   std::vector<StreamFilterBase*> filters_;
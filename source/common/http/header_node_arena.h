@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/non_copyable.h"
+#include "source/common/runtime/runtime_features.h"
+
+#include "absl/base/optimization.h"
+#include "absl/container/inlined_vector.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Fixed-slot arena backing the node storage of HeaderMapImpl::HeaderList. Nodes are carved out of
+ * a few contiguous blocks owned by the header list, so a typical request or response header map
+ * lives in one or two allocations and iteration walks mostly adjacent memory. Released slots are
+ * kept on an intrusive free list and reused by later inserts; blocks are only returned to the
+ * heap when the arena is destroyed.
+ *
+ * The slot size is fixed by the first arena allocation. When a request does not fit a slot,
+ * allocation falls through to the global heap.
+ */
+class HeaderNodeArena : NonCopyable {
+public:
+  // The first block fits the common case of a small header map; each following block doubles
+  // in size up to MaxBlockSlots, so 24 entries fit in two blocks and 56 in three.
+  static constexpr uint32_t InitialBlockSlots = 8;
+  static constexpr uint32_t MaxBlockSlots = 64;
+
+  HeaderNodeArena() = default;
+  ~HeaderNodeArena() {
+    for (void* block : blocks_) {
+      ::operator delete(block);
+    }
+  }
+
+  void* allocate(size_t size, size_t alignment) {
+    if (!useArena(size, alignment)) {
+      return ::operator new(size);
+    }
+    if (slot_size_ == 0) {
+      slot_size_ = size;
+    }
+    if (free_list_ != nullptr) {
+      FreeSlot* slot = free_list_;
+      free_list_ = slot->next_;
+      return slot;
+    }
+    if (cursor_ == block_end_) {
+      newBlock();
+    }
+    void* slot = cursor_;
+    cursor_ += paddedSlotSize();
+    return slot;
+  }
+
+  void deallocate(void* p, size_t size, size_t alignment) {
+    if (slot_size_ == 0 || !useArena(size, alignment)) {
+      ::operator delete(p);
+      return;
+    }
+    FreeSlot* slot = static_cast<FreeSlot*>(p);
+    slot->next_ = free_list_;
+    free_list_ = slot;
+  }
+
+  size_t blockCount() const { return blocks_.size(); }
+
+  /**
+   * @return whether header maps place their entries in an arena. This is the
+   * envoy.restart_features.header_map_arena_storage restart feature, which is read the first time
+   * only, so that header maps don't pay a runtime lookup each, and changes take effect after a
+   * restart.
+   */
+  static bool enabled() {
+    int8_t enabled = latchedEnabled().load(std::memory_order_relaxed);
+    if (ABSL_PREDICT_FALSE(enabled < 0)) {
+      enabled =
+          Runtime::runtimeFeatureEnabled("envoy.restart_features.header_map_arena_storage");
+      latchedEnabled().store(enabled, std::memory_order_relaxed);
+    }
+    return enabled != 0;
+  }
+
+  /**
+   * Reads the runtime guard again on the next call to enabled(). For tests; no header map may
+   * exist meanwhile.
+   */
+  static void resetEnabledForTest() { latchedEnabled().store(-1, std::memory_order_relaxed); }
+
+private:
+  struct FreeSlot {
+    FreeSlot* next_;
+  };
+
+  // -1 until the runtime guard is read.
+  static std::atomic<int8_t>& latchedEnabled() {
+    static std::atomic<int8_t> enabled{-1};
+    return enabled;
+  }
+
+  bool useArena(size_t size, size_t alignment) const {
+    return alignment <= alignof(std::max_align_t) && size >= sizeof(FreeSlot) &&
+           (slot_size_ == 0 || slot_size_ == size);
+  }
+
+  size_t paddedSlotSize() const {
+    constexpr size_t align = alignof(std::max_align_t);
+    return (slot_size_ + align - 1) / align * align;
+  }
+
+  void newBlock() {
+    ASSERT(slot_size_ != 0);
+    const size_t bytes = next_block_slots_ * paddedSlotSize();
+    next_block_slots_ = std::min(next_block_slots_ * 2, MaxBlockSlots);
+    char* block = static_cast<char*>(::operator new(bytes));
+    blocks_.push_back(block);
+    cursor_ = block;
+    block_end_ = block + bytes;
+  }
+
+  size_t slot_size_{0};
+  uint32_t next_block_slots_{InitialBlockSlots};
+  FreeSlot* free_list_{nullptr};
+  char* cursor_{nullptr};
+  char* block_end_{nullptr};
+  absl::InlinedVector<void*, 2> blocks_;
+};
+
+/**
+ * Stateful STL allocator that places container nodes in a HeaderNodeArena owned by the container.
+ * The arena is only created by the first allocation while HeaderNodeArena::enabled(), so
+ * containers pay nothing for it otherwise. The arena must outlive the container nodes.
+ */
+template <class T> class HeaderNodeAllocator {
+public:
+  using value_type = T;
+
+  explicit HeaderNodeAllocator(std::unique_ptr<HeaderNodeArena>& arena) : arena_(&arena) {}
+  template <class U>
+  HeaderNodeAllocator(const HeaderNodeAllocator<U>& other) // NOLINT(google-explicit-constructor)
+      : arena_(other.arena_) {}
+
+  T* allocate(size_t n) {
+    HeaderNodeArena* arena = arena_->get();
+    if (arena == nullptr) {
+      if (!HeaderNodeArena::enabled()) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+      }
+      *arena_ = std::make_unique<HeaderNodeArena>();
+      arena = arena_->get();
+    }
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, size_t n) {
+    HeaderNodeArena* arena = arena_->get();
+    if (arena == nullptr) {
+      ::operator delete(p);
+      return;
+    }
+    arena->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  template <class U> bool operator==(const HeaderNodeAllocator<U>& other) const {
+    return arena_ == other.arena_;
+  }
+  template <class U> bool operator!=(const HeaderNodeAllocator<U>& other) const {
+    return arena_ != other.arena_;
+  }
+
+private:
+  template <class U> friend class HeaderNodeAllocator;
+
+  std::unique_ptr<HeaderNodeArena>* arena_;
+};
+
+} // namespace Http
+} // namespace Envoy
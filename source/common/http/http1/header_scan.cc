@@ -0,0 +1,103 @@
+#include "source/common/http/http1/header_scan.h"
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ENVOY_HTTP1_HEADER_SCAN_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ENVOY_HTTP1_HEADER_SCAN_NEON
+#endif
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+constexpr size_t VectorWidth = 16;
+
+inline bool validValueChar(uint8_t c) { return c == '\t' || (c >= 0x20 && c != 0x7f); }
+
+inline char toLowerChar(char c) {
+  // Branch-free so that the scalar tail can be auto-vectorized as well.
+  const uint8_t u = static_cast<uint8_t>(c);
+  return static_cast<char>(u + ((static_cast<uint8_t>(u - 'A') < 26) << 5));
+}
+
+} // namespace
+
+bool HeaderScan::headerValueIsValidScalar(absl::string_view value) {
+  for (const char c : value) {
+    if (!validValueChar(static_cast<uint8_t>(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HeaderScan::headerValueIsValid(absl::string_view value) {
+  const char* data = value.data();
+  size_t size = value.size();
+#if defined(ENVOY_HTTP1_HEADER_SCAN_SSE2)
+  const __m128i max_control = _mm_set1_epi8(0x1f);
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  for (; size >= VectorWidth; data += VectorWidth, size -= VectorWidth) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    // Unsigned "chunk <= 0x1f" as there is no unsigned byte compare in SSE2.
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk);
+    const __m128i invalid = _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(chunk, tab), control),
+                                         _mm_cmpeq_epi8(chunk, del));
+    if (_mm_movemask_epi8(invalid) != 0) {
+      return false;
+    }
+  }
+#elif defined(ENVOY_HTTP1_HEADER_SCAN_NEON)
+  const uint8x16_t max_control = vdupq_n_u8(0x1f);
+  const uint8x16_t tab = vdupq_n_u8('\t');
+  const uint8x16_t del = vdupq_n_u8(0x7f);
+  for (; size >= VectorWidth; data += VectorWidth, size -= VectorWidth) {
+    const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+    const uint8x16_t invalid = vorrq_u8(vbicq_u8(vcleq_u8(chunk, max_control), vceqq_u8(chunk, tab)),
+                                        vceqq_u8(chunk, del));
+    if (vmaxvq_u8(invalid) != 0) {
+      return false;
+    }
+  }
+#endif
+  return headerValueIsValidScalar({data, size});
+}
+
+void HeaderScan::toLowerInPlace(char* data, size_t size) {
+#if defined(ENVOY_HTTP1_HEADER_SCAN_SSE2)
+  // Bias the bytes so that 'A'..'Z' map onto the lowest signed values and a single signed compare
+  // selects them.
+  const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80 - 'A'));
+  const __m128i upper_bound = _mm_set1_epi8(static_cast<char>(-0x80 + 26));
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  for (; size >= VectorWidth; data += VectorWidth, size -= VectorWidth) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i is_upper = _mm_cmplt_epi8(_mm_add_epi8(chunk, bias), upper_bound);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data),
+                     _mm_or_si128(chunk, _mm_and_si128(is_upper, case_bit)));
+  }
+#elif defined(ENVOY_HTTP1_HEADER_SCAN_NEON)
+  const uint8x16_t upper_a = vdupq_n_u8('A');
+  const uint8x16_t letters = vdupq_n_u8(26);
+  const uint8x16_t case_bit = vdupq_n_u8(0x20);
+  for (; size >= VectorWidth; data += VectorWidth, size -= VectorWidth) {
+    const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+    const uint8x16_t is_upper = vcltq_u8(vsubq_u8(chunk, upper_a), letters);
+    vst1q_u8(reinterpret_cast<uint8_t*>(data), vorrq_u8(chunk, vandq_u8(is_upper, case_bit)));
+  }
+#endif
+  for (size_t i = 0; i < size; i++) {
+    data[i] = toLowerChar(data[i]);
+  }
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
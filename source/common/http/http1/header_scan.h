@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Bulk character scans used on the HTTP/1 header parsing path. Where the target supports it
+ * (SSE2 on x86-64, NEON on aarch64) these process 16 bytes per step; otherwise they fall back to
+ * a scalar loop with identical results.
+ */
+class HeaderScan {
+public:
+  /**
+   * Equivalent to HeaderUtility::headerValueIsValid(): a header value may only contain HTAB,
+   * visible ASCII, SP and obs-text (0x80-0xFF).
+   * @param value the header value to check.
+   * @return true if the value only contains valid characters.
+   */
+  static bool headerValueIsValid(absl::string_view value);
+
+  /**
+   * Lower cases the ASCII letters in place, leaving all other bytes unchanged.
+   * @param data the start of the buffer.
+   * @param size the number of bytes to transform.
+   */
+  static void toLowerInPlace(char* data, size_t size);
+
+  /**
+   * Scalar version of headerValueIsValid() used for the tail of the input and on targets without
+   * vector support. Exposed for tests.
+   */
+  static bool headerValueIsValidScalar(absl::string_view value);
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
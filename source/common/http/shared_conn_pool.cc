@@ -0,0 +1,763 @@
+#include "source/common/http/shared_conn_pool.h"
+
+#include <string>
+#include <utility>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/dump_state_utils.h"
+#include "source/common/http/codec_helper.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/network/socket_impl.h"
+#include "source/common/ssl/connection_info_snapshot.h"
+#include "source/common/stream_info/filter_state_impl.h"
+#include "source/common/stream_info/stream_info_impl.h"
+
+namespace Envoy {
+namespace Http {
+
+// What the origin learns about the owner's connection when the stream is ready. Taken on the
+// owner's thread, so that the origin never reads the owner's connection. That includes its TLS
+// information, which computes its values lazily and so can only be read on the owner's thread.
+struct SharedConnPool::ConnectionSnapshot {
+  ConnectionSnapshot(Stream& stream, const StreamInfo::StreamInfo& info)
+      : local_address_(stream.connectionInfoProvider().localAddress()),
+        remote_address_(stream.connectionInfoProvider().remoteAddress()),
+        ssl_connection_(snapshotSsl(stream.connectionInfoProvider().sslConnection())),
+        connection_id_(stream.connectionInfoProvider().connectionID()),
+        buffer_limit_(stream.bufferLimit()) {
+    if (info.upstreamInfo() != nullptr) {
+      upstream_timing_ = info.upstreamInfo()->upstreamTiming();
+      num_streams_ = info.upstreamInfo()->upstreamNumStreams();
+    }
+  }
+
+  static Ssl::ConnectionInfoConstSharedPtr
+  snapshotSsl(const Ssl::ConnectionInfoConstSharedPtr& ssl_connection) {
+    if (ssl_connection == nullptr) {
+      return nullptr;
+    }
+    return std::make_shared<const Ssl::ConnectionInfoSnapshot>(*ssl_connection);
+  }
+
+  Network::Address::InstanceConstSharedPtr local_address_;
+  Network::Address::InstanceConstSharedPtr remote_address_;
+  Ssl::ConnectionInfoConstSharedPtr ssl_connection_;
+  absl::optional<uint64_t> connection_id_;
+  uint32_t buffer_limit_;
+  StreamInfo::UpstreamTiming upstream_timing_;
+  uint64_t num_streams_{};
+};
+
+// The stream handed to the caller on the origin worker. It relays the request to its OwnerStream
+// and replays the response and the stream events it receives from there.
+class SharedConnPool::ActiveStream : public LinkedObject<ActiveStream>,
+                                     public ConnectionPool::Cancellable,
+                                     public RequestEncoder,
+                                     public Stream,
+                                     public StreamCallbackHelper,
+                                     public Event::DeferredDeletable {
+public:
+  ActiveStream(SharedConnPool& parent, ResponseDecoder& decoder,
+               ConnectionPool::Callbacks& callbacks);
+
+  // Hands the stream over to the owner.
+  // @return false if the owner has shut down, in which case the stream must be deleted.
+  bool start(const StreamOptions& options);
+  // Fails or resets the stream when the pool goes away underneath it.
+  void onPoolDestroyed();
+  // Fails the stream when the owner shut down before taking it over.
+  void onOwnerShutdown();
+
+  // ConnectionPool::Cancellable
+  void cancel(Envoy::ConnectionPool::CancelPolicy) override;
+
+  // StreamEncoder
+  void encodeData(Buffer::Instance& data, bool end_stream) override;
+  Stream& getStream() override { return *this; }
+  void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+  Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+  // RequestEncoder
+  Status encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+  void encodeTrailers(const RequestTrailerMap& trailers) override;
+  void enableTcpTunneling() override;
+
+  // Stream
+  void addCallbacks(StreamCallbacks& callbacks) override { addCallbacksHelper(callbacks); }
+  void removeCallbacks(StreamCallbacks& callbacks) override { removeCallbacksHelper(callbacks); }
+  // Codec events are only raised for downstream streams, so they are not relayed.
+  CodecEventCallbacks* registerCodecEventCallbacks(CodecEventCallbacks* codec_callbacks) override {
+    std::swap(codec_callbacks, codec_callbacks_);
+    return codec_callbacks;
+  }
+  void resetStream(StreamResetReason reason) override;
+  void readDisable(bool disable) override;
+  uint32_t bufferLimit() const override { return buffer_limit_; }
+  absl::string_view responseDetails() override { return response_details_; }
+  const Network::ConnectionInfoProvider& connectionInfoProvider() override {
+    return *connection_info_;
+  }
+  void setFlushTimeout(std::chrono::milliseconds timeout) override;
+  Buffer::BufferMemoryAccountSharedPtr account() const override { return account_; }
+  void setAccount(Buffer::BufferMemoryAccountSharedPtr account) override {
+    account_ = std::move(account);
+  }
+  const StreamInfo::BytesMeterSharedPtr& bytesMeter() override { return bytes_meter_; }
+
+  // Events relayed from the OwnerStream.
+  void onPoolFailure(ConnectionPool::PoolFailureReason reason, absl::string_view details,
+                     Upstream::HostDescriptionConstSharedPtr host);
+  void onPoolReady(ConnectionSnapshot&& snapshot, Upstream::HostDescriptionConstSharedPtr host,
+                   absl::optional<Protocol> protocol);
+  void decode1xxHeaders(ResponseHeaderMapPtr&& headers);
+  void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream);
+  void decodeData(Buffer::Instance& data, bool end_stream);
+  void decodeTrailers(ResponseTrailerMapPtr&& trailers);
+  void decodeMetadata(MetadataMapPtr&& metadata_map);
+  void onResetStream(StreamResetReason reason, absl::string_view details);
+
+private:
+  void onRemoteEndStream();
+  void done();
+
+  SharedConnPool& parent_;
+  const std::shared_ptr<Link> link_;
+  ResponseDecoder& decoder_;
+  ConnectionPool::Callbacks& callbacks_;
+  std::shared_ptr<Network::ConnectionInfoSetterImpl> connection_info_;
+  std::unique_ptr<StreamInfo::StreamInfoImpl> stream_info_;
+  CodecEventCallbacks* codec_callbacks_{};
+  Buffer::BufferMemoryAccountSharedPtr account_;
+  StreamInfo::BytesMeterSharedPtr bytes_meter_{std::make_shared<StreamInfo::BytesMeter>()};
+  std::string response_details_;
+  uint32_t buffer_limit_{};
+  bool queued_{true};
+  bool remote_end_stream_{};
+  bool done_{};
+};
+
+// The stream of the owner's pool, living on the owner worker. It deletes itself once the stream
+// is complete or reset, or the origin has given up on it.
+class SharedConnPool::OwnerStream : public ConnectionPool::Callbacks,
+                                    public ResponseDecoder,
+                                    public StreamCallbacks,
+                                    public Event::DeferredDeletable,
+                                    protected Logger::Loggable<Logger::Id::pool> {
+public:
+  explicit OwnerStream(std::shared_ptr<Link> link) : link_(std::move(link)) {}
+
+  static void create(const std::shared_ptr<Link>& link, const OwnerPoolCb& owner_pool_cb,
+                     const Upstream::HostDescriptionConstSharedPtr& host,
+                     const StreamOptions& options);
+
+  // Requests relayed from the ActiveStream.
+  void encodeHeaders(RequestHeaderMapPtr&& headers, bool end_stream);
+  void encodeData(Buffer::Instance& data, bool end_stream);
+  void encodeTrailers(RequestTrailerMapPtr&& trailers);
+  void encodeMetadata(const MetadataMapVector& metadata_map_vector);
+  void enableTcpTunneling();
+  void readDisable(bool disable);
+  void setFlushTimeout(std::chrono::milliseconds timeout);
+  void resetStream(StreamResetReason reason);
+
+  // ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                     absl::string_view transport_failure_reason,
+                     Upstream::HostDescriptionConstSharedPtr host) override;
+  void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
+                   StreamInfo::StreamInfo& info, absl::optional<Protocol> protocol) override;
+
+  // ResponseDecoder
+  void decode1xxHeaders(ResponseHeaderMapPtr&& headers) override;
+  void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) override;
+  void decodeData(Buffer::Instance& data, bool end_stream) override;
+  void decodeTrailers(ResponseTrailerMapPtr&& trailers) override;
+  void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+  void dumpState(std::ostream& os, int indent_level) const override {
+    os << spacesForLevel(indent_level) << "SharedConnPool::OwnerStream " << this
+       << DUMP_MEMBER(local_end_stream_) << DUMP_MEMBER(remote_end_stream_) << "\n";
+  }
+
+  // StreamCallbacks
+  void onResetStream(StreamResetReason reason,
+                     absl::string_view transport_failure_reason) override;
+  void onAboveWriteBufferHighWatermark() override;
+  void onBelowWriteBufferLowWatermark() override;
+
+private:
+  void onLocalEndStream();
+  void onRemoteEndStream();
+  void destroy();
+
+  const std::shared_ptr<Link> link_;
+  ConnectionPool::Cancellable* cancellable_{};
+  RequestEncoder* encoder_{};
+  // Kept alive for the lifetime of the stream, like the router does with its request headers.
+  RequestHeaderMapPtr request_headers_;
+  bool local_end_stream_{};
+  bool remote_end_stream_{};
+  bool destroyed_{};
+};
+
+// The state shared by the two halves of a stream. Each stream pointer is only accessed on the
+// thread of its worker, and is cleared there when that half goes away, after which messages
+// posted to it are dropped.
+struct SharedConnPool::Link : public std::enable_shared_from_this<Link> {
+  Link(Event::Dispatcher& origin_dispatcher, Event::Dispatcher& owner_dispatcher)
+      : origin_dispatcher_(origin_dispatcher), owner_dispatcher_(owner_dispatcher) {}
+
+  template <class Cb> void postToOwner(Cb cb) {
+    owner_dispatcher_.post([link = shared_from_this(), cb = std::move(cb)]() mutable {
+      if (link->owner_ != nullptr) {
+        cb(*link->owner_);
+      }
+    });
+  }
+
+  template <class Cb> void postToOrigin(Cb cb) {
+    origin_dispatcher_.post([link = shared_from_this(), cb = std::move(cb)]() mutable {
+      if (link->origin_ != nullptr) {
+        cb(*link->origin_);
+      }
+    });
+  }
+
+  Event::Dispatcher& origin_dispatcher_;
+  Event::Dispatcher& owner_dispatcher_;
+  ActiveStream* origin_{};
+  OwnerStream* owner_{};
+};
+
+SharedConnPool::ActiveStream::ActiveStream(SharedConnPool& parent, ResponseDecoder& decoder,
+                                           ConnectionPool::Callbacks& callbacks)
+    : parent_(parent),
+      link_(std::make_shared<Link>(parent.dispatcher_, parent.owner_->dispatcher())),
+      decoder_(decoder), callbacks_(callbacks) {
+  link_->origin_ = this;
+}
+
+bool SharedConnPool::ActiveStream::start(const StreamOptions& options) {
+  return parent_.owner_->startStream(link_, [link = link_, owner_pool_cb = parent_.owner_pool_cb_,
+                                              host = parent_.host_, options]() {
+    OwnerStream::create(link, *owner_pool_cb, host, options);
+  });
+}
+
+void SharedConnPool::ActiveStream::onPoolDestroyed() {
+  link_->postToOwner([](OwnerStream& owner) { owner.resetStream(StreamResetReason::LocalReset); });
+  if (queued_) {
+    callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                             "shared connection pool destroyed", parent_.host_);
+  } else {
+    runResetCallbacks(StreamResetReason::ConnectionTermination, "");
+  }
+  done();
+}
+
+void SharedConnPool::ActiveStream::onOwnerShutdown() {
+  onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                "shared connection pool owner shut down", parent_.host_);
+}
+
+void SharedConnPool::ActiveStream::cancel(Envoy::ConnectionPool::CancelPolicy) {
+  link_->postToOwner([](OwnerStream& owner) { owner.resetStream(StreamResetReason::LocalReset); });
+  done();
+}
+
+Status SharedConnPool::ActiveStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                   bool end_stream) {
+  ASSERT(!local_end_stream_);
+  local_end_stream_ = end_stream;
+  // Errors encoding the headers surface as a reset from the owner.
+  link_->postToOwner([headers = RequestHeaderMapPtr(createHeaderMap<RequestHeaderMapImpl>(headers)),
+                      end_stream](OwnerStream& owner) mutable {
+    owner.encodeHeaders(std::move(headers), end_stream);
+  });
+  if (end_stream && remote_end_stream_) {
+    done();
+  }
+  return okStatus();
+}
+
+void SharedConnPool::ActiveStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  ASSERT(!local_end_stream_);
+  local_end_stream_ = end_stream;
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  if (account_ != nullptr) {
+    // The slices are charged to the account, which may only be credited on this thread.
+    buffer->add(data);
+    data.drain(data.length());
+  } else {
+    buffer->move(data);
+  }
+  link_->postToOwner([buffer = std::move(buffer), end_stream](OwnerStream& owner) {
+    owner.encodeData(*buffer, end_stream);
+  });
+  if (end_stream && remote_end_stream_) {
+    done();
+  }
+}
+
+void SharedConnPool::ActiveStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  ASSERT(!local_end_stream_);
+  local_end_stream_ = true;
+  link_->postToOwner(
+      [trailers = RequestTrailerMapPtr(createHeaderMap<RequestTrailerMapImpl>(trailers))](
+          OwnerStream& owner) mutable { owner.encodeTrailers(std::move(trailers)); });
+  if (remote_end_stream_) {
+    done();
+  }
+}
+
+void SharedConnPool::ActiveStream::encodeMetadata(const MetadataMapVector& metadata_map_vector) {
+  MetadataMapVector copy;
+  copy.reserve(metadata_map_vector.size());
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    copy.push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  link_->postToOwner([copy = std::move(copy)](OwnerStream& owner) { owner.encodeMetadata(copy); });
+}
+
+void SharedConnPool::ActiveStream::enableTcpTunneling() {
+  link_->postToOwner([](OwnerStream& owner) { owner.enableTcpTunneling(); });
+}
+
+void SharedConnPool::ActiveStream::resetStream(StreamResetReason reason) {
+  if (done_) {
+    return;
+  }
+  link_->postToOwner([reason](OwnerStream& owner) { owner.resetStream(reason); });
+  runResetCallbacks(reason, "");
+  done();
+}
+
+void SharedConnPool::ActiveStream::readDisable(bool disable) {
+  link_->postToOwner([disable](OwnerStream& owner) { owner.readDisable(disable); });
+}
+
+void SharedConnPool::ActiveStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  link_->postToOwner([timeout](OwnerStream& owner) { owner.setFlushTimeout(timeout); });
+}
+
+void SharedConnPool::ActiveStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                 absl::string_view details,
+                                                 Upstream::HostDescriptionConstSharedPtr host) {
+  ConnectionPool::Callbacks& callbacks = callbacks_;
+  done();
+  callbacks.onPoolFailure(reason, details, std::move(host));
+}
+
+void SharedConnPool::ActiveStream::onPoolReady(ConnectionSnapshot&& snapshot,
+                                               Upstream::HostDescriptionConstSharedPtr host,
+                                               absl::optional<Protocol> protocol) {
+  queued_ = false;
+  parent_.onStreamReady();
+  connection_info_ = std::make_shared<Network::ConnectionInfoSetterImpl>(
+      snapshot.local_address_, snapshot.remote_address_);
+  connection_info_->setSslConnection(snapshot.ssl_connection_);
+  if (snapshot.connection_id_.has_value()) {
+    connection_info_->setConnectionID(snapshot.connection_id_.value());
+  }
+  buffer_limit_ = snapshot.buffer_limit_;
+  stream_info_ = std::make_unique<StreamInfo::StreamInfoImpl>(
+      protocol, parent_.dispatcher_.timeSource(), connection_info_,
+      std::make_shared<StreamInfo::FilterStateImpl>(StreamInfo::FilterState::LifeSpan::Connection));
+  auto upstream_info = std::make_shared<StreamInfo::UpstreamInfoImpl>();
+  upstream_info->upstreamTiming() = snapshot.upstream_timing_;
+  upstream_info->setUpstreamNumStreams(snapshot.num_streams_);
+  stream_info_->setUpstreamInfo(std::move(upstream_info));
+  callbacks_.onPoolReady(*this, std::move(host), *stream_info_, protocol);
+}
+
+void SharedConnPool::ActiveStream::decode1xxHeaders(ResponseHeaderMapPtr&& headers) {
+  decoder_.decode1xxHeaders(std::move(headers));
+}
+
+void SharedConnPool::ActiveStream::decodeHeaders(ResponseHeaderMapPtr&& headers,
+                                                 bool end_stream) {
+  if (end_stream) {
+    onRemoteEndStream();
+  }
+  decoder_.decodeHeaders(std::move(headers), end_stream);
+}
+
+void SharedConnPool::ActiveStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  if (end_stream) {
+    onRemoteEndStream();
+  }
+  decoder_.decodeData(data, end_stream);
+}
+
+void SharedConnPool::ActiveStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  onRemoteEndStream();
+  decoder_.decodeTrailers(std::move(trailers));
+}
+
+void SharedConnPool::ActiveStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  decoder_.decodeMetadata(std::move(metadata_map));
+}
+
+void SharedConnPool::ActiveStream::onResetStream(StreamResetReason reason,
+                                                 absl::string_view details) {
+  response_details_ = std::string(details);
+  done();
+  runResetCallbacks(reason, response_details_);
+}
+
+void SharedConnPool::ActiveStream::onRemoteEndStream() {
+  remote_end_stream_ = true;
+  // Like the codecs, the stream is complete once both directions have ended, and is only deleted
+  // after the decoder has seen the end of the response.
+  if (local_end_stream_) {
+    done();
+  }
+}
+
+void SharedConnPool::ActiveStream::done() {
+  if (done_) {
+    return;
+  }
+  done_ = true;
+  link_->origin_ = nullptr;
+  parent_.onStreamDone(*this, queued_);
+}
+
+void SharedConnPool::OwnerStream::create(const std::shared_ptr<Link>& link,
+                                         const OwnerPoolCb& owner_pool_cb,
+                                         const Upstream::HostDescriptionConstSharedPtr& host,
+                                         const StreamOptions& options) {
+  ASSERT(link->owner_dispatcher_.isThreadSafe());
+  ConnectionPool::Instance* pool = owner_pool_cb();
+  if (pool == nullptr) {
+    link->postToOrigin([host](ActiveStream& stream) {
+      stream.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                           "shared connection pool owner unavailable", host);
+    });
+    return;
+  }
+  auto* stream = new OwnerStream(link);
+  link->owner_ = stream;
+  ConnectionPool::Cancellable* cancellable = pool->newStream(*stream, *stream, options);
+  if (cancellable != nullptr && !stream->destroyed_) {
+    stream->cancellable_ = cancellable;
+  }
+}
+
+void SharedConnPool::OwnerStream::encodeHeaders(RequestHeaderMapPtr&& headers, bool end_stream) {
+  ASSERT(encoder_ != nullptr);
+  request_headers_ = std::move(headers);
+  const Status status = encoder_->encodeHeaders(*request_headers_, end_stream);
+  if (destroyed_) {
+    return;
+  }
+  if (!status.ok()) {
+    ENVOY_LOG(debug, "failed to encode headers of a shared connection pool stream: {}",
+              status.message());
+    link_->postToOrigin([details = std::string(status.message())](ActiveStream& stream) {
+      stream.onResetStream(StreamResetReason::LocalReset, details);
+    });
+    resetStream(StreamResetReason::LocalReset);
+    return;
+  }
+  if (end_stream) {
+    onLocalEndStream();
+  }
+}
+
+void SharedConnPool::OwnerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  ASSERT(encoder_ != nullptr);
+  encoder_->encodeData(data, end_stream);
+  if (end_stream && !destroyed_) {
+    onLocalEndStream();
+  }
+}
+
+void SharedConnPool::OwnerStream::encodeTrailers(RequestTrailerMapPtr&& trailers) {
+  ASSERT(encoder_ != nullptr);
+  encoder_->encodeTrailers(*trailers);
+  if (!destroyed_) {
+    onLocalEndStream();
+  }
+}
+
+void SharedConnPool::OwnerStream::encodeMetadata(const MetadataMapVector& metadata_map_vector) {
+  ASSERT(encoder_ != nullptr);
+  encoder_->encodeMetadata(metadata_map_vector);
+}
+
+void SharedConnPool::OwnerStream::enableTcpTunneling() {
+  ASSERT(encoder_ != nullptr);
+  encoder_->enableTcpTunneling();
+}
+
+void SharedConnPool::OwnerStream::readDisable(bool disable) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().readDisable(disable);
+  }
+}
+
+void SharedConnPool::OwnerStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().setFlushTimeout(timeout);
+  }
+}
+
+void SharedConnPool::OwnerStream::resetStream(StreamResetReason reason) {
+  if (cancellable_ != nullptr) {
+    cancellable_->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+    cancellable_ = nullptr;
+  } else if (encoder_ != nullptr) {
+    Stream& stream = encoder_->getStream();
+    stream.removeCallbacks(*this);
+    encoder_ = nullptr;
+    stream.resetStream(reason);
+  }
+  destroy();
+}
+
+void SharedConnPool::OwnerStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                absl::string_view transport_failure_reason,
+                                                Upstream::HostDescriptionConstSharedPtr host) {
+  cancellable_ = nullptr;
+  link_->postToOrigin([reason, details = std::string(transport_failure_reason),
+                       host = std::move(host)](ActiveStream& stream) {
+    stream.onPoolFailure(reason, details, host);
+  });
+  destroy();
+}
+
+void SharedConnPool::OwnerStream::onPoolReady(RequestEncoder& encoder,
+                                              Upstream::HostDescriptionConstSharedPtr host,
+                                              StreamInfo::StreamInfo& info,
+                                              absl::optional<Protocol> protocol) {
+  cancellable_ = nullptr;
+  encoder_ = &encoder;
+  encoder.getStream().addCallbacks(*this);
+  link_->postToOrigin([snapshot = ConnectionSnapshot(encoder.getStream(), info),
+                       host = std::move(host), protocol](ActiveStream& stream) mutable {
+    stream.onPoolReady(std::move(snapshot), std::move(host), protocol);
+  });
+}
+
+void SharedConnPool::OwnerStream::decode1xxHeaders(ResponseHeaderMapPtr&& headers) {
+  link_->postToOrigin([headers = std::move(headers)](ActiveStream& stream) mutable {
+    stream.decode1xxHeaders(std::move(headers));
+  });
+}
+
+void SharedConnPool::OwnerStream::decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) {
+  link_->postToOrigin([headers = std::move(headers), end_stream](ActiveStream& stream) mutable {
+    stream.decodeHeaders(std::move(headers), end_stream);
+  });
+  if (end_stream) {
+    onRemoteEndStream();
+  }
+}
+
+void SharedConnPool::OwnerStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  buffer->move(data);
+  link_->postToOrigin([buffer = std::move(buffer), end_stream](ActiveStream& stream) {
+    stream.decodeData(*buffer, end_stream);
+  });
+  if (end_stream) {
+    onRemoteEndStream();
+  }
+}
+
+void SharedConnPool::OwnerStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  link_->postToOrigin([trailers = std::move(trailers)](ActiveStream& stream) mutable {
+    stream.decodeTrailers(std::move(trailers));
+  });
+  onRemoteEndStream();
+}
+
+void SharedConnPool::OwnerStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  link_->postToOrigin([metadata_map = std::move(metadata_map)](ActiveStream& stream) mutable {
+    stream.decodeMetadata(std::move(metadata_map));
+  });
+}
+
+void SharedConnPool::OwnerStream::onResetStream(StreamResetReason reason,
+                                                absl::string_view transport_failure_reason) {
+  encoder_ = nullptr;
+  link_->postToOrigin([reason, details = std::string(transport_failure_reason)](
+                          ActiveStream& stream) { stream.onResetStream(reason, details); });
+  destroy();
+}
+
+void SharedConnPool::OwnerStream::onAboveWriteBufferHighWatermark() {
+  link_->postToOrigin([](ActiveStream& stream) { stream.runHighWatermarkCallbacks(); });
+}
+
+void SharedConnPool::OwnerStream::onBelowWriteBufferLowWatermark() {
+  link_->postToOrigin([](ActiveStream& stream) { stream.runLowWatermarkCallbacks(); });
+}
+
+void SharedConnPool::OwnerStream::onLocalEndStream() {
+  local_end_stream_ = true;
+  if (remote_end_stream_) {
+    destroy();
+  }
+}
+
+void SharedConnPool::OwnerStream::onRemoteEndStream() {
+  remote_end_stream_ = true;
+  if (local_end_stream_) {
+    destroy();
+  }
+}
+
+void SharedConnPool::OwnerStream::destroy() {
+  if (destroyed_) {
+    return;
+  }
+  destroyed_ = true;
+  if (encoder_ != nullptr) {
+    encoder_->getStream().removeCallbacks(*this);
+    encoder_ = nullptr;
+  }
+  link_->owner_ = nullptr;
+  link_->owner_dispatcher_.deferredDelete(std::unique_ptr<OwnerStream>(this));
+}
+
+bool SharedConnPool::Owner::startStream(const std::shared_ptr<Link>& link,
+                                        std::function<void()> start) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (shut_down_) {
+      return false;
+    }
+    pending_.insert(link);
+  }
+  dispatcher_.post([owner = shared_from_this(), link, start = std::move(start)]() {
+    {
+      absl::MutexLock lock(&owner->mutex_);
+      if (owner->pending_.erase(link) == 0) {
+        return;
+      }
+    }
+    start();
+  });
+  return true;
+}
+
+void SharedConnPool::Owner::shutdown() {
+  ASSERT(dispatcher_.isThreadSafe());
+  absl::flat_hash_set<std::shared_ptr<Link>> pending;
+  {
+    absl::MutexLock lock(&mutex_);
+    shut_down_ = true;
+    pending.swap(pending_);
+  }
+  for (const std::shared_ptr<Link>& link : pending) {
+    link->postToOrigin([](ActiveStream& stream) { stream.onOwnerShutdown(); });
+  }
+}
+
+SharedConnPool::SharedConnPool(Event::Dispatcher& dispatcher, OwnerSharedPtr owner,
+                               Upstream::HostConstSharedPtr host, OwnerPoolCb owner_pool_cb,
+                               LocalPoolCb local_pool_cb, uint32_t max_queued_streams)
+    : dispatcher_(dispatcher), owner_(std::move(owner)), host_(std::move(host)),
+      owner_pool_cb_(std::make_shared<const OwnerPoolCb>(std::move(owner_pool_cb))),
+      local_pool_cb_(std::move(local_pool_cb)), max_queued_streams_(max_queued_streams) {
+  ASSERT(&dispatcher_ != &owner_->dispatcher());
+}
+
+SharedConnPool::~SharedConnPool() {
+  destroying_ = true;
+  while (!streams_.empty()) {
+    streams_.front()->onPoolDestroyed();
+  }
+}
+
+void SharedConnPool::addIdleCallback(IdleCb cb) { idle_callbacks_.push_back(std::move(cb)); }
+
+bool SharedConnPool::isIdle() const {
+  return streams_.empty() && (local_pool_ == nullptr || local_pool_->isIdle());
+}
+
+bool SharedConnPool::hasActiveConnections() const {
+  return !streams_.empty() || (local_pool_ != nullptr && local_pool_->hasActiveConnections());
+}
+
+void SharedConnPool::drainConnections(Envoy::ConnectionPool::DrainBehavior drain_behavior) {
+  // The owner drains its own pool as it sees the same cluster and host changes.
+  if (drain_behavior == Envoy::ConnectionPool::DrainBehavior::DrainAndDelete) {
+    draining_ = true;
+  }
+  if (local_pool_ != nullptr) {
+    local_pool_->drainConnections(drain_behavior);
+  }
+  checkForIdleAndNotify();
+}
+
+ConnectionPool::Cancellable* SharedConnPool::newStream(ResponseDecoder& response_decoder,
+                                                       ConnectionPool::Callbacks& callbacks,
+                                                       const StreamOptions& options) {
+  ASSERT(!draining_);
+  if (queued_streams_ >= max_queued_streams_) {
+    ENVOY_LOG(trace, "{} streams queued for the owner, using a local pool", queued_streams_);
+    return newLocalStream(response_decoder, callbacks, options);
+  }
+
+  auto stream = std::make_unique<ActiveStream>(*this, response_decoder, callbacks);
+  if (!stream->start(options)) {
+    ENVOY_LOG(debug, "owner of the shared connection pool has shut down, using a local pool");
+    return newLocalStream(response_decoder, callbacks, options);
+  }
+  ActiveStream& ref = *stream;
+  LinkedList::moveIntoList(std::move(stream), streams_);
+  queued_streams_++;
+  return &ref;
+}
+
+ConnectionPool::Cancellable* SharedConnPool::newLocalStream(ResponseDecoder& response_decoder,
+                                                            ConnectionPool::Callbacks& callbacks,
+                                                            const StreamOptions& options) {
+  if (local_pool_ == nullptr) {
+    local_pool_ = local_pool_cb_();
+    local_pool_->addIdleCallback([this]() { onLocalPoolIdle(); });
+  }
+  return local_pool_->newStream(response_decoder, callbacks, options);
+}
+
+void SharedConnPool::onStreamReady() {
+  ASSERT(queued_streams_ > 0);
+  queued_streams_--;
+}
+
+void SharedConnPool::onStreamDone(ActiveStream& stream, bool queued) {
+  if (queued) {
+    onStreamReady();
+  }
+  dispatcher_.deferredDelete(stream.removeFromList(streams_));
+  if (!destroying_) {
+    checkForIdleAndNotify();
+  }
+}
+
+void SharedConnPool::onLocalPoolIdle() {
+  if (destroying_) {
+    return;
+  }
+  // Only keep a local pool around while it has connections.
+  dispatcher_.deferredDelete(std::move(local_pool_));
+  checkForIdleAndNotify();
+}
+
+void SharedConnPool::checkForIdleAndNotify() {
+  // Without connections of its own, the pool is cheap to keep, so it only reports being idle once
+  // it is drained for deletion rather than after every stream.
+  if (!draining_ || !isIdle()) {
+    return;
+  }
+  for (const IdleCb& cb : idle_callbacks_) {
+    cb();
+  }
+  idle_callbacks_.clear();
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/linked_object.h"
+#include "source/common/common/logger.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Http {
+
+// An HTTP connection pool which hands its streams over to the pool of another worker, so that
+// several workers multiplex their streams over the same HTTP/2 or HTTP/3 connections to a host.
+//
+// Each stream is created on the owning worker by a message posted to its dispatcher. From then
+// on, the request, the response and the stream events are relayed between the two workers by
+// posting to the dispatcher of the other side, and neither side ever touches the objects of the
+// other. The callers of this pool see a RequestEncoder and a StreamInfo of this worker, whose
+// connection information is a snapshot of the owner's connection taken when the stream was ready.
+//
+// The number of streams waiting for the owner is bounded. Streams beyond the bound are served by
+// a pool of this worker's own, which is created on demand and released once it is idle, so that
+// a busy owner cannot hold up new streams indefinitely. The same pool serves all the streams once
+// the owner has shut down.
+class SharedConnPool : public ConnectionPool::Instance,
+                       protected Logger::Loggable<Logger::Id::pool> {
+public:
+  class Owner;
+  using OwnerSharedPtr = std::shared_ptr<Owner>;
+
+  // Returns the pool of the owning worker. Called on the owner's thread. Returning nullptr fails
+  // the stream.
+  using OwnerPoolCb = std::function<ConnectionPool::Instance*()>;
+  // Creates the pool of this worker used for the streams exceeding the queue bound.
+  using LocalPoolCb = std::function<ConnectionPool::InstancePtr()>;
+
+  SharedConnPool(Event::Dispatcher& dispatcher, OwnerSharedPtr owner,
+                 Upstream::HostConstSharedPtr host, OwnerPoolCb owner_pool_cb,
+                 LocalPoolCb local_pool_cb, uint32_t max_queued_streams);
+  ~SharedConnPool() override;
+
+  // ConnectionPool::Instance
+  void addIdleCallback(IdleCb cb) override;
+  bool isIdle() const override;
+  void drainConnections(Envoy::ConnectionPool::DrainBehavior drain_behavior) override;
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+  // Connections are established by the owner.
+  bool maybePreconnect(float) override { return false; }
+  bool hasActiveConnections() const override;
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks,
+                                         const StreamOptions& options) override;
+  absl::string_view protocolDescription() const override { return "shared"; }
+
+  // @return the number of streams waiting for the owner.
+  uint32_t queuedStreams() const { return queued_streams_; }
+
+private:
+  class ActiveStream;
+  class OwnerStream;
+  struct ConnectionSnapshot;
+  struct Link;
+  using ActiveStreamPtr = std::unique_ptr<ActiveStream>;
+
+  ConnectionPool::Cancellable* newLocalStream(ResponseDecoder& response_decoder,
+                                              ConnectionPool::Callbacks& callbacks,
+                                              const StreamOptions& options);
+  void onStreamReady();
+  void onStreamDone(ActiveStream& stream, bool queued);
+  void onLocalPoolIdle();
+  void checkForIdleAndNotify();
+
+  Event::Dispatcher& dispatcher_;
+  const OwnerSharedPtr owner_;
+  const Upstream::HostConstSharedPtr host_;
+  // Shared with the messages posted to the owner, which may outlive this pool.
+  const std::shared_ptr<const OwnerPoolCb> owner_pool_cb_;
+  const LocalPoolCb local_pool_cb_;
+  const uint32_t max_queued_streams_;
+  ConnectionPool::InstancePtr local_pool_;
+  std::list<ActiveStreamPtr> streams_;
+  std::list<IdleCb> idle_callbacks_;
+  uint32_t queued_streams_{};
+  bool draining_{};
+  bool destroying_{};
+};
+
+// The side of a worker owning connections, shared by all the pools handing their streams over to
+// it. Streams are handed over by posting to the owner's dispatcher, and once the owner stops
+// running its dispatcher such posts never run, so the owner has to be shut down before then.
+class SharedConnPool::Owner : public std::enable_shared_from_this<Owner> {
+public:
+  explicit Owner(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  Event::Dispatcher& dispatcher() const { return dispatcher_; }
+
+  // Fails the streams that were handed over but not taken over yet, and makes the pools serve
+  // further streams with connections of their own. Called on the owner's thread.
+  void shutdown();
+
+private:
+  friend class SharedConnPool;
+
+  // Posts the start of a stream to the owner.
+  // @return false if the owner has shut down, in which case nothing is posted.
+  bool startStream(const std::shared_ptr<Link>& link, std::function<void()> start);
+
+  Event::Dispatcher& dispatcher_;
+  absl::Mutex mutex_;
+  bool shut_down_ ABSL_GUARDED_BY(mutex_){};
+  // The streams posted to the owner which it hasn't started yet.
+  absl::flat_hash_set<std::shared_ptr<Link>> pending_ ABSL_GUARDED_BY(mutex_);
+};
+
+} // namespace Http
+} // namespace Envoy
@@ -195,6 +195,31 @@ IoUringResult IoUringImpl::prepareShutdown(os_fd_t fd, int how, Request* user_da
   return IoUringResult::Ok;
 }
 
+IoUringResult IoUringImpl::prepareWritevAndShutdown(os_fd_t fd, const struct iovec* iovecs,
+                                                    unsigned nr_vecs, Request* write_user_data,
+                                                    int how, Request* shutdown_user_data) {
+  ENVOY_LOG(trace, "prepare writev and shutdown for fd = {}, how = {}", fd, how);
+  // TODO (soulxu): Handling the case of CQ ring is overflow.
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  // Both entries have to be queued, a link ending in the next submission's first entry would
+  // chain unrelated requests.
+  if (io_uring_sq_space_left(&ring_) < 2) {
+    ENVOY_LOG(trace, "failed to prepare writev and shutdown for fd = {}", fd);
+    return IoUringResult::Failed;
+  }
+
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  io_uring_prep_writev(sqe, fd, iovecs, nr_vecs, 0);
+  io_uring_sqe_set_data(sqe, write_user_data);
+  // A short or failed write breaks the link, which cancels the shutdown.
+  io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+
+  sqe = io_uring_get_sqe(&ring_);
+  io_uring_prep_shutdown(sqe, fd, how);
+  io_uring_sqe_set_data(sqe, shutdown_user_data);
+  return IoUringResult::Ok;
+}
+
 IoUringResult IoUringImpl::submit() {
   int res = io_uring_submit(&ring_);
   RELEASE_ASSERT(res >= 0 || res == -EBUSY, "unable to submit io_uring queue entries");
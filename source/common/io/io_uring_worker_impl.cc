@@ -1,5 +1,9 @@
 #include "source/common/io/io_uring_worker_impl.h"
 
+#include <algorithm>
+
+#include "source/common/runtime/runtime_features.h"
+
 namespace Envoy {
 namespace Io {
 
@@ -78,11 +82,27 @@ IoUringWorkerImpl::IoUringWorkerImpl(IoUringPtr&& io_uring, uint32_t read_buffer
         return absl::OkStatus();
       },
       Event::PlatformDefaultTriggerType, Event::FileReadyType::Read);
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.io_uring_batched_writes")) {
+    submit_cb_ = dispatcher_.createSchedulableCallback([this]() {
+      delay_submit_ = true;
+      flushWrites();
+      delay_submit_ = false;
+      io_uring_->submit();
+    });
+  }
 }
 
 IoUringWorkerImpl::~IoUringWorkerImpl() {
   ENVOY_LOG(trace, "destruct io uring worker, existing sockets = {}", sockets_.size());
 
+  // The event loop may no longer run, so prepare the scheduled writes and submit everything that
+  // is still waiting for submit_cb_ directly. Later requests are submitted right away.
+  if (submit_cb_ != nullptr) {
+    flushWrites();
+    submit_cb_.reset();
+    io_uring_->submit();
+  }
+
   for (auto& socket : sockets_) {
     if (socket->getStatus() != Closed) {
       socket->close(false);
@@ -144,7 +164,7 @@ IoUringWorkerImpl::submitConnectRequest(IoUringSocket& socket,
   auto res = io_uring_->prepareConnect(socket.fd(), address, req);
   if (res == IoUringResult::Failed) {
     // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
-    submit();
+    submitForRetry();
     res = io_uring_->prepareConnect(socket.fd(), address, req);
     RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare connect");
   }
@@ -160,7 +180,7 @@ Request* IoUringWorkerImpl::submitReadRequest(IoUringSocket& socket) {
   auto res = io_uring_->prepareReadv(socket.fd(), req->iov_.get(), 1, 0, req);
   if (res == IoUringResult::Failed) {
     // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
-    submit();
+    submitForRetry();
     res = io_uring_->prepareReadv(socket.fd(), req->iov_.get(), 1, 0, req);
     RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare readv");
   }
@@ -177,7 +197,7 @@ Request* IoUringWorkerImpl::submitWriteRequest(IoUringSocket& socket,
   auto res = io_uring_->prepareWritev(socket.fd(), req->iov_.get(), slices.size(), 0, req);
   if (res == IoUringResult::Failed) {
     // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
-    submit();
+    submitForRetry();
     res = io_uring_->prepareWritev(socket.fd(), req->iov_.get(), slices.size(), 0, req);
     RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare writev");
   }
@@ -193,7 +213,7 @@ Request* IoUringWorkerImpl::submitCloseRequest(IoUringSocket& socket) {
   auto res = io_uring_->prepareClose(socket.fd(), req);
   if (res == IoUringResult::Failed) {
     // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
-    submit();
+    submitForRetry();
     res = io_uring_->prepareClose(socket.fd(), req);
     RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare close");
   }
@@ -210,7 +230,7 @@ Request* IoUringWorkerImpl::submitCancelRequest(IoUringSocket& socket, Request*
   auto res = io_uring_->prepareCancel(request_to_cancel, req);
   if (res == IoUringResult::Failed) {
     // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
-    submit();
+    submitForRetry();
     res = io_uring_->prepareCancel(request_to_cancel, req);
     RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare cancel");
   }
@@ -227,7 +247,7 @@ Request* IoUringWorkerImpl::submitShutdownRequest(IoUringSocket& socket, int how
   auto res = io_uring_->prepareShutdown(socket.fd(), how, req);
   if (res == IoUringResult::Failed) {
     // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
-    submit();
+    submitForRetry();
     res = io_uring_->prepareShutdown(socket.fd(), how, req);
     RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare cancel");
   }
@@ -235,6 +255,28 @@ Request* IoUringWorkerImpl::submitShutdownRequest(IoUringSocket& socket, int how
   return req;
 }
 
+Request* IoUringWorkerImpl::submitWriteAndShutdownRequest(IoUringSocket& socket,
+                                                          const Buffer::RawSliceVector& slices,
+                                                          int how, Request*& shutdown_req) {
+  WriteRequest* req = new WriteRequest(socket, slices);
+  shutdown_req = new Request(Request::RequestType::Shutdown, socket);
+
+  ENVOY_LOG(trace, "submit write and shutdown request, fd = {}, req = {}, shutdown req = {}",
+            socket.fd(), fmt::ptr(req), fmt::ptr(shutdown_req));
+
+  auto res = io_uring_->prepareWritevAndShutdown(socket.fd(), req->iov_.get(), slices.size(), req,
+                                                 how, shutdown_req);
+  if (res == IoUringResult::Failed) {
+    // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
+    submitForRetry();
+    res = io_uring_->prepareWritevAndShutdown(socket.fd(), req->iov_.get(), slices.size(), req,
+                                              how, shutdown_req);
+    RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare writev and shutdown");
+  }
+  submit();
+  return req;
+}
+
 IoUringSocketEntryPtr IoUringWorkerImpl::removeSocket(IoUringSocketEntry& socket) {
   // Remove all the injection completion for this socket.
   io_uring_->removeInjectedCompletion(socket.fd());
@@ -301,9 +343,45 @@ void IoUringWorkerImpl::onFileEvent() {
 }
 
 void IoUringWorkerImpl::submit() {
-  if (!delay_submit_) {
+  if (delay_submit_) {
+    return;
+  }
+  if (submit_cb_ != nullptr) {
+    submit_cb_->scheduleCallbackCurrentIteration();
+    return;
+  }
+  io_uring_->submit();
+}
+
+void IoUringWorkerImpl::submitForRetry() {
+  // With batched writes, submit() only schedules submit_cb_, which would leave the submission queue
+  // full. Without them, keep the previous behavior, which skips the submit while completions are
+  // being handled.
+  if (batchWrites()) {
     io_uring_->submit();
+  } else {
+    submit();
+  }
+}
+
+void IoUringWorkerImpl::scheduleWrite(IoUringServerSocket& socket) {
+  ASSERT(batchWrites());
+  pending_writes_.push_back(&socket);
+  submit_cb_->scheduleCallbackCurrentIteration();
+}
+
+void IoUringWorkerImpl::unscheduleWrite(IoUringServerSocket& socket) {
+  auto it = std::find(pending_writes_.begin(), pending_writes_.end(), &socket);
+  ASSERT(it != pending_writes_.end());
+  pending_writes_.erase(it);
+}
+
+void IoUringWorkerImpl::flushWrites() {
+  // Only prepares the requests, so no socket is closed or scheduled meanwhile.
+  for (IoUringServerSocket* socket : pending_writes_) {
+    socket->flushWrite();
   }
+  pending_writes_.clear();
 }
 
 IoUringServerSocket::IoUringServerSocket(os_fd_t fd, IoUringWorkerImpl& parent,
@@ -321,6 +399,7 @@ IoUringServerSocket::IoUringServerSocket(os_fd_t fd, Buffer::Instance& read_buf,
 }
 
 IoUringServerSocket::~IoUringServerSocket() {
+  ASSERT(!write_scheduled_);
   if (write_timeout_timer_) {
     write_timeout_timer_->disableTimer();
   }
@@ -329,6 +408,12 @@ IoUringServerSocket::~IoUringServerSocket() {
 void IoUringServerSocket::close(bool keep_fd_open, IoUringSocketOnClosedCb cb) {
   ENVOY_LOG(trace, "close the socket, fd = {}, status = {}", fd_, static_cast<int>(status_));
 
+  // Submit the scheduled write right away, so that the close waits for it.
+  if (write_scheduled_) {
+    parent_.unscheduleWrite(*this);
+    flushWrite();
+  }
+
   IoUringSocketEntry::close(keep_fd_open, cb);
   keep_fd_open_ = keep_fd_open;
 
@@ -383,7 +468,7 @@ void IoUringServerSocket::write(Buffer::Instance& data) {
   // release the drain trackers.
   write_buf_.move(data, data.length(), true);
 
-  submitWriteOrShutdownRequest();
+  scheduleWriteOrShutdownRequest();
 }
 
 uint64_t IoUringServerSocket::write(const Buffer::RawSlice* slices, uint64_t num_slice) {
@@ -396,7 +481,7 @@ uint64_t IoUringServerSocket::write(const Buffer::RawSlice* slices, uint64_t num
     bytes_written += slices[i].len_;
   }
 
-  submitWriteOrShutdownRequest();
+  scheduleWriteOrShutdownRequest();
   return bytes_written;
 }
 
@@ -404,7 +489,7 @@ void IoUringServerSocket::shutdown(int how) {
   ENVOY_LOG(trace, "shutdown the socket, fd = {}, how = {}", fd_, how);
   ASSERT(how == SHUT_WR);
   shutdown_ = false;
-  submitWriteOrShutdownRequest();
+  scheduleWriteOrShutdownRequest();
 }
 
 void IoUringServerSocket::onClose(Request* req, int32_t result, bool injected) {
@@ -562,7 +647,9 @@ void IoUringServerSocket::onWrite(Request* req, int32_t result, bool injected) {
   ENVOY_LOG(trace, "onWrite with result {}, fd = {}, injected = {}, status_ = {}", result, fd_,
             injected, static_cast<int>(status_));
   if (!injected) {
-    write_or_shutdown_req_ = nullptr;
+    // A linked shutdown request is still in flight after the write completed.
+    write_or_shutdown_req_ = linked_shutdown_req_;
+    linked_shutdown_req_ = nullptr;
   }
 
   // Notify the handler directly since it is an injected request.
@@ -602,7 +689,10 @@ void IoUringServerSocket::onShutdown(Request* req, int32_t result, bool injected
   ENVOY_LOG(trace, "onShutdown with result {}, fd = {}, injected = {}", result, fd_, injected);
   ASSERT(!injected);
   write_or_shutdown_req_ = nullptr;
-  shutdown_ = true;
+  // A shutdown linked to a short write is cancelled, retry it after writing the remaining data.
+  if (result != -ECANCELED || write_buf_.length() == 0) {
+    shutdown_ = true;
+  }
 
   submitWriteOrShutdownRequest();
 }
@@ -632,7 +722,19 @@ void IoUringServerSocket::submitWriteOrShutdownRequest() {
       Buffer::RawSliceVector slices = write_buf_.getRawSlices(IOV_MAX);
       ENVOY_LOG(trace, "submit write request, write_buf size = {}, num_iovecs = {}, fd = {}",
                 write_buf_.length(), slices.size(), fd_);
-      write_or_shutdown_req_ = parent_.submitWriteRequest(*this, slices);
+      uint64_t slices_length = 0;
+      for (const Buffer::RawSlice& slice : slices) {
+        slices_length += slice.len_;
+      }
+      // Once the write covers all the remaining data, the pending shutdown can be linked to it
+      // instead of waiting for the write completion.
+      if (parent_.batchWrites() && shutdown_.has_value() && !shutdown_.value() &&
+          slices_length == write_buf_.length()) {
+        write_or_shutdown_req_ =
+            parent_.submitWriteAndShutdownRequest(*this, slices, SHUT_WR, linked_shutdown_req_);
+      } else {
+        write_or_shutdown_req_ = parent_.submitWriteRequest(*this, slices);
+      }
     } else if (shutdown_.has_value() && !shutdown_.value()) {
       write_or_shutdown_req_ = parent_.submitShutdownRequest(*this, SHUT_WR);
     } else if (status_ == Closed && read_req_ == nullptr && read_cancel_req_ == nullptr &&
@@ -642,6 +744,23 @@ void IoUringServerSocket::submitWriteOrShutdownRequest() {
   }
 }
 
+void IoUringServerSocket::scheduleWriteOrShutdownRequest() {
+  if (!parent_.batchWrites()) {
+    submitWriteOrShutdownRequest();
+    return;
+  }
+  // Coalesce the writes of this event loop iteration into a single write request.
+  if (!write_scheduled_) {
+    write_scheduled_ = true;
+    parent_.scheduleWrite(*this);
+  }
+}
+
+void IoUringServerSocket::flushWrite() {
+  write_scheduled_ = false;
+  submitWriteOrShutdownRequest();
+}
+
 IoUringClientSocket::IoUringClientSocket(os_fd_t fd, IoUringWorkerImpl& parent,
                                          Event::FileReadyCb cb, uint32_t write_timeout_ms,
                                          bool enable_close_event)
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include "envoy/common/io/io_uring.h"
+#include "envoy/event/schedulable_cb.h"
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/linked_object.h"
@@ -26,6 +29,7 @@ public:
 };
 
 class IoUringSocketEntry;
+class IoUringServerSocket;
 using IoUringSocketEntryPtr = std::unique_ptr<IoUringSocketEntry>;
 
 class IoUringWorkerImpl : public IoUringWorker, private Logger::Loggable<Logger::Id::io> {
@@ -52,6 +56,9 @@ public:
   Request* submitCloseRequest(IoUringSocket& socket) override;
   Request* submitCancelRequest(IoUringSocket& socket, Request* request_to_cancel) override;
   Request* submitShutdownRequest(IoUringSocket& socket, int how) override;
+  Request* submitWriteAndShutdownRequest(IoUringSocket& socket,
+                                         const Buffer::RawSliceVector& slices, int how,
+                                         Request*& shutdown_req) override;
 
   Event::Dispatcher& dispatcher() override;
 
@@ -64,11 +71,21 @@ public:
   // Return the number of sockets in this worker.
   uint32_t getNumOfSockets() const override { return sockets_.size(); }
 
+  // Whether the writes of the sockets are submitted at the end of the event loop iteration.
+  bool batchWrites() const { return submit_cb_ != nullptr; }
+  // Submit the write requests of a socket at the end of the event loop iteration.
+  void scheduleWrite(IoUringServerSocket& socket);
+  // Remove a socket from the sockets waiting for their writes to be submitted.
+  void unscheduleWrite(IoUringServerSocket& socket);
+
 protected:
   // Add a socket to the worker.
   IoUringSocketEntry& addSocket(IoUringSocketEntryPtr&& socket);
   void onFileEvent();
   void submit();
+  // Submit the queue to make room for a request that failed to be prepared.
+  void submitForRetry();
+  void flushWrites();
 
   // The iouring instance.
   IoUringPtr io_uring_;
@@ -84,6 +101,11 @@ protected:
   // The IoUringWorker will delay the submit the requests which are submitted in request completion
   // callback.
   bool delay_submit_{false};
+  // When writes are batched, submits all the requests prepared during an event loop iteration with
+  // a single io_uring_enter at the end of it.
+  Event::SchedulableCallbackPtr submit_cb_;
+  // The sockets whose write or shutdown requests are submitted by submit_cb_.
+  std::vector<IoUringServerSocket*> pending_writes_;
 };
 
 class IoUringSocketEntry : public IoUringSocket,
@@ -203,6 +225,9 @@ public:
 
   Buffer::OwnedImpl& getReadBuffer() { return read_buf_; }
 
+  // Submit the write or shutdown request scheduled with the worker.
+  void flushWrite();
+
 protected:
   // Since the write of IoUringSocket is async, there may have write request is on the fly when
   // close the socket. This timeout is setting for a time to wait the write request done.
@@ -233,6 +258,11 @@ protected:
   // we can make sure all SQEs bounding to the iouring socket is completed and the socket can be
   // closed successfully.
   Request* write_or_shutdown_req_{nullptr};
+  // A shutdown request linked to the write_or_shutdown_req_ write request. It becomes the
+  // write_or_shutdown_req_ once the write completes.
+  Request* linked_shutdown_req_{nullptr};
+  // Whether the socket is waiting for the worker to submit its write or shutdown request.
+  bool write_scheduled_{false};
   Event::TimerPtr write_timeout_timer_{nullptr};
   // Whether keep the fd open when close the IoUringSocket.
   bool keep_fd_open_{false};
@@ -246,6 +276,7 @@ protected:
   void closeInternal();
   void submitReadRequest();
   void submitWriteOrShutdownRequest();
+  void scheduleWriteOrShutdownRequest();
   void moveReadDataToBuffer(Request* req, size_t data_length);
   void onReadCompleted(int32_t result);
   void onWriteCompleted(int32_t result);
@@ -222,7 +222,8 @@ absl::Status ListenSocketFactoryImpl::doFinalPreWorkerInit() {
     }
     return absl::OkStatus();
   };
-  // On all platforms we should listen on the first socket.
+  // On all platforms we should listen on the first socket. The sockets listen in worker index
+  // order, which is the order of the SO_REUSEPORT group that reuse_port_cpu_steering relies on.
   auto iterator = sockets_.begin();
   RETURN_IF_NOT_OK(listen_and_apply_options(*iterator, tcp_backlog_size_));
   ++iterator;
@@ -290,6 +291,7 @@ ListenerImpl::ListenerImpl(const envoy::config::listener::v3::Listener& config,
                        ? Network::Socket::Type::Stream
                        : Network::Utility::protobufAddressSocketType(config.address())),
       bind_to_port_(shouldBindToPort(config)), mptcp_enabled_(config.enable_mptcp()),
+      reuse_port_cpu_steering_(config.reuse_port_cpu_steering()),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
@@ -428,6 +430,7 @@ ListenerImpl::ListenerImpl(ListenerImpl& origin,
                            uint64_t hash, absl::Status& creation_status)
     : parent_(parent), addresses_(origin.addresses_), socket_type_(origin.socket_type_),
       bind_to_port_(shouldBindToPort(config)), mptcp_enabled_(config.enable_mptcp()),
+      reuse_port_cpu_steering_(config.reuse_port_cpu_steering()),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
@@ -520,6 +523,18 @@ absl::Status ListenerImpl::validateConfig() {
           name_));
     }
   }
+  if (reuse_port_cpu_steering_) {
+    if (socket_type_ != Network::Socket::Type::Stream || !reuse_port_) {
+      return absl::InvalidArgumentError(fmt::format(
+          "listener {}: reuse_port_cpu_steering can only be used with TCP listeners using "
+          "reuse_port",
+          name_));
+    }
+    if (!ENVOY_ATTACH_REUSEPORT_CBPF.hasValue()) {
+      return absl::InvalidArgumentError(fmt::format(
+          "listener {}: reuse_port_cpu_steering is not supported by the operating system", name_));
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -688,6 +703,11 @@ void ListenerImpl::buildListenSocketOptions(
     if (reuse_port_) {
       addListenSocketOptions(listen_socket_options_list_[i],
                              Network::SocketOptionFactory::buildReusePortOptions());
+      if (reuse_port_cpu_steering_) {
+        addListenSocketOptions(listen_socket_options_list_[i],
+                               Network::SocketOptionFactory::buildReusePortCpuSteeringOptions(
+                                   parent_.server_.options().concurrency()));
+      }
     }
     if (!address_opts_list[i].get().empty()) {
       addListenSocketOptions(
@@ -1205,7 +1225,8 @@ bool ListenerMessageUtil::socketOptionsEqual(const envoy::config::listener::v3::
       (PROTOBUF_GET_WRAPPED_OR_DEFAULT(lhs, freebind, false) !=
        PROTOBUF_GET_WRAPPED_OR_DEFAULT(rhs, freebind, false)) ||
       (PROTOBUF_GET_WRAPPED_OR_DEFAULT(lhs, tcp_fast_open_queue_length, 0) !=
-       PROTOBUF_GET_WRAPPED_OR_DEFAULT(rhs, tcp_fast_open_queue_length, 0))) {
+       PROTOBUF_GET_WRAPPED_OR_DEFAULT(rhs, tcp_fast_open_queue_length, 0)) ||
+      lhs.reuse_port_cpu_steering() != rhs.reuse_port_cpu_steering()) {
     return false;
   }
 
@@ -1,5 +1,7 @@
 #include "source/common/network/socket_option_factory.h"
 
+#include <array>
+
 #include "envoy/config/core/v3/base.pb.h"
 
 #include "source/common/common/fmt.h"
@@ -7,8 +9,52 @@
 #include "source/common/network/socket_option_impl.h"
 #include "source/common/network/win32_redirect_records_option_impl.h"
 
+#if defined(__linux__)
+#include <linux/filter.h>
+#endif
+
 namespace Envoy {
 namespace Network {
+namespace {
+
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(__linux__)
+// The program must outlive the sock_fprog copied into the option value, so it is held in a base
+// class which is constructed before SocketOptionImpl.
+class CpuSteeringProgram {
+protected:
+  explicit CpuSteeringProgram(uint32_t concurrency)
+      : filter_{{
+            // SPELLCHECKER(off)
+            {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+            {BPF_ALU | BPF_MOD | BPF_K, 0, 0, concurrency}, // mod #socket_count
+            {BPF_RET | BPF_A, 0, 0, 0},                     // ret a
+            // SPELLCHECKER(on)
+        }},
+        prog_{static_cast<unsigned short>(filter_.size()), filter_.data()} {}
+
+  std::array<sock_filter, 3> filter_;
+  sock_fprog prog_;
+};
+
+// The program returns an index into the SO_REUSEPORT group of the socket, which the kernel orders
+// by the time each socket called listen(), not by bind order. The index only maps to the worker
+// index, i.e. the worker running on the receiving CPU, because
+// ListenSocketFactoryImpl::doFinalPreWorkerInit() calls listen() on the worker sockets in worker
+// index order.
+class CpuSteeringSocketOptionImpl : private CpuSteeringProgram, public SocketOptionImpl {
+public:
+  explicit CpuSteeringSocketOptionImpl(uint32_t concurrency)
+      : CpuSteeringProgram(concurrency),
+        SocketOptionImpl(envoy::config::core::v3::SocketOption::STATE_BOUND,
+                         ENVOY_ATTACH_REUSEPORT_CBPF,
+                         absl::string_view(reinterpret_cast<const char*>(&prog_), sizeof(prog_)),
+                         Socket::Type::Stream) {}
+  CpuSteeringSocketOptionImpl(const CpuSteeringSocketOptionImpl&) = delete;
+  CpuSteeringSocketOptionImpl& operator=(const CpuSteeringSocketOptionImpl&) = delete;
+};
+#endif
+
+} // namespace
 
 std::unique_ptr<Socket::Options>
 SocketOptionFactory::buildTcpKeepaliveOptions(Network::TcpKeepaliveConfig keepalive_config) {
@@ -154,6 +200,20 @@ std::unique_ptr<Socket::Options> SocketOptionFactory::buildReusePortOptions() {
   return options;
 }
 
+std::unique_ptr<Socket::Options>
+SocketOptionFactory::buildReusePortCpuSteeringOptions(uint32_t concurrency) {
+  ASSERT(concurrency > 0);
+  std::unique_ptr<Socket::Options> options = std::make_unique<Socket::Options>();
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(__linux__)
+  options->push_back(std::make_shared<CpuSteeringSocketOptionImpl>(concurrency));
+#else
+  // Unsupported, so that binding the listener fails instead of silently ignoring the option.
+  options->push_back(std::make_shared<SocketOptionImpl>(
+      envoy::config::core::v3::SocketOption::STATE_BOUND, ENVOY_ATTACH_REUSEPORT_CBPF, 1));
+#endif
+  return options;
+}
+
 std::unique_ptr<Socket::Options> SocketOptionFactory::buildUdpGroOptions() {
   std::unique_ptr<Socket::Options> options = std::make_unique<Socket::Options>();
   options->push_back(std::make_shared<SocketOptionImpl>(
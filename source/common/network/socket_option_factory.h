@@ -35,6 +35,12 @@ public:
   static std::unique_ptr<Socket::Options> buildIpPacketInfoOptions();
   static std::unique_ptr<Socket::Options> buildRxQueueOverFlowOptions();
   static std::unique_ptr<Socket::Options> buildReusePortOptions();
+  /**
+   * @param concurrency supplies the number of sockets in the SO_REUSEPORT group, one per worker.
+   * @return options attaching a classic BPF program to the SO_REUSEPORT group of a bound socket,
+   * which hands each new connection to the socket of index (receiving CPU % concurrency).
+   */
+  static std::unique_ptr<Socket::Options> buildReusePortCpuSteeringOptions(uint32_t concurrency);
   static std::unique_ptr<Socket::Options> buildUdpGroOptions();
   static std::unique_ptr<Socket::Options> buildZeroSoLingerOptions();
   static std::unique_ptr<Socket::Options> buildIpRecvTosOptions();
@@ -1997,6 +1997,58 @@ CommonVirtualHostImpl::create(const envoy::config::route::v3::VirtualHost& virtu
   return ret;
 }
 
+namespace {
+
+// Builds a path index over the routes of a virtual host. Case sensitive prefix and exact path
+// routes are indexed if index_paths is set, and RE2 regex routes if index_regexes is set; every
+// other route is evaluated for every request. Returns nullptr if there is nothing to index.
+std::unique_ptr<const RoutePathIndex>
+buildRoutePathIndex(const envoy::config::route::v3::VirtualHost& virtual_host, bool index_paths,
+                    bool index_regexes, const Regex::Engine& regex_engine) {
+  // A regex set can only stand in for the per route matchers if those use RE2 too.
+  const bool default_engine_is_re2 =
+      dynamic_cast<const Regex::GoogleReEngine*>(&regex_engine) != nullptr;
+  auto index = std::make_unique<RoutePathIndex>();
+  bool indexed_any = false;
+  for (int i = 0; i < virtual_host.routes_size(); i++) {
+    const auto& match = virtual_host.routes(i).match();
+    const bool case_sensitive = PROTOBUF_GET_WRAPPED_OR_DEFAULT(match, case_sensitive, true);
+    switch (match.path_specifier_case()) {
+    case envoy::config::route::v3::RouteMatch::kPrefix:
+      if (index_paths && case_sensitive) {
+        index->addPrefix(match.prefix(), i);
+        indexed_any = true;
+        continue;
+      }
+      break;
+    case envoy::config::route::v3::RouteMatch::kPath:
+      if (index_paths && case_sensitive) {
+        index->addExact(match.path(), i);
+        indexed_any = true;
+        continue;
+      }
+      break;
+    case envoy::config::route::v3::RouteMatch::kSafeRegex:
+      if (index_regexes && (default_engine_is_re2 || match.safe_regex().has_google_re2()) &&
+          index->addRegex(match.safe_regex().regex(), i)) {
+        indexed_any = true;
+        continue;
+      }
+      break;
+    default:
+      break;
+    }
+    index->addUnindexed(i);
+  }
+  if (!indexed_any) {
+    return nullptr;
+  }
+  index->finalize();
+  return index;
+}
+
+} // namespace
+
 VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& virtual_host,
                                  const CommonConfigSharedPtr& global_route_config,
                                  Server::Configuration::ServerFactoryContext& factory_context,
@@ -2044,6 +2096,14 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
       SET_AND_RETURN_IF_NOT_OK(route_or_error.status(), creation_status);
       routes_.emplace_back(route_or_error.value());
     }
+    const bool index_paths =
+        Runtime::runtimeFeatureEnabled("envoy.reloadable_features.route_path_index");
+    const bool index_regexes =
+        Runtime::runtimeFeatureEnabled("envoy.reloadable_features.route_regex_set");
+    if (index_paths || index_regexes) {
+      route_index_ = buildRoutePathIndex(virtual_host, index_paths, index_regexes,
+                                         factory_context.regexEngine());
+    }
   }
 }
 
@@ -2086,6 +2146,29 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromRoutes(
   return nullptr;
 }
 
+RouteConstSharedPtr VirtualHostImpl::getRouteFromIndex(const Http::RequestHeaderMap& headers,
+                                                       const StreamInfo::StreamInfo& stream_info,
+                                                       uint64_t random_value) const {
+  // Strip the path the same way the path matchers of the indexed routes do.
+  absl::string_view path = headers.getPathValue();
+  if (shared_virtual_host_->globalRouteConfig().ignorePathParametersInPathMatching()) {
+    path = path.substr(0, path.find_first_of(';'));
+  }
+  path = Http::PathUtil::removeQueryAndFragment(path);
+
+  RoutePathIndex::Candidates candidates;
+  route_index_->candidates(path, candidates);
+  for (const uint32_t i : candidates) {
+    RouteConstSharedPtr route_entry = routes_[i]->matches(headers, stream_info, random_value);
+    if (route_entry != nullptr) {
+      return route_entry;
+    }
+  }
+
+  ENVOY_LOG(debug, "route was resolved but final route list did not match incoming request");
+  return nullptr;
+}
+
 RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb,
                                                          const Http::RequestHeaderMap& headers,
                                                          const StreamInfo::StreamInfo& stream_info,
@@ -2136,7 +2219,11 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
     return nullptr;
   }
 
-  // Check for a route that matches the request.
+  // Check for a route that matches the request. The index does not know which routes follow the
+  // candidates, so it is only used when there is no callback that needs to be told about them.
+  if (route_index_ != nullptr && cb == nullptr && headers.Path() != nullptr) {
+    return getRouteFromIndex(headers, stream_info, random_value);
+  }
   return getRouteFromRoutes(cb, headers, stream_info, random_value, routes_);
 }
 
@@ -31,6 +31,7 @@
 #include "source/common/router/config_utility.h"
 #include "source/common/router/header_parser.h"
 #include "source/common/router/metadatamatchcriteria_impl.h"
+#include "source/common/router/route_path_index.h"
 #include "source/common/router/router_ratelimit.h"
 #include "source/common/router/tls_context_match_criteria_impl.h"
 #include "source/common/stats/symbol_table.h"
@@ -415,7 +416,14 @@ private:
   std::shared_ptr<const SslRedirectRoute> ssl_redirect_route_;
   SslRequirements ssl_requirements_;
 
+  RouteConstSharedPtr getRouteFromIndex(const Http::RequestHeaderMap& headers,
+                                        const StreamInfo::StreamInfo& stream_info,
+                                        uint64_t random_value) const;
+
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Only built when envoy.reloadable_features.route_path_index or
+  // envoy.reloadable_features.route_regex_set is enabled.
+  std::unique_ptr<const RoutePathIndex> route_index_;
   Matcher::MatchTreeSharedPtr<Http::HttpMatchingData> matcher_;
 };
 
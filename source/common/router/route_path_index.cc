@@ -0,0 +1,147 @@
+#include "source/common/router/route_path_index.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+// Appends a sorted list of route indices to a sorted candidate list, keeping it sorted.
+void mergeInto(const std::vector<uint32_t>& routes, RoutePathIndex::Candidates& candidates) {
+  if (routes.empty()) {
+    return;
+  }
+  const size_t middle = candidates.size();
+  candidates.insert(candidates.end(), routes.begin(), routes.end());
+  if (middle != 0 && candidates[middle - 1] > candidates[middle]) {
+    std::inplace_merge(candidates.begin(), candidates.begin() + middle, candidates.end());
+  }
+}
+
+} // namespace
+
+void RoutePathIndex::addPrefix(absl::string_view prefix, uint32_t route_index) {
+  checkOrder(route_index);
+  insert(prefix).prefix_routes_.push_back(route_index);
+}
+
+void RoutePathIndex::addExact(absl::string_view path, uint32_t route_index) {
+  checkOrder(route_index);
+  insert(path).exact_routes_.push_back(route_index);
+}
+
+bool RoutePathIndex::addRegex(const std::string& regex, uint32_t route_index) {
+  if (regex_set_ == nullptr) {
+    re2::RE2::Options options;
+    options.set_log_errors(false);
+    regex_set_ = std::make_unique<re2::RE2::Set>(options, re2::RE2::ANCHOR_BOTH);
+  }
+  if (regex_set_->Add(regex, nullptr) < 0) {
+    return false;
+  }
+  checkOrder(route_index);
+  regex_routes_.push_back(route_index);
+  return true;
+}
+
+void RoutePathIndex::addUnindexed(uint32_t route_index) {
+  checkOrder(route_index);
+  unindexed_routes_.push_back(route_index);
+}
+
+void RoutePathIndex::finalize() {
+  if (regex_set_ == nullptr || (!regex_routes_.empty() && regex_set_->Compile())) {
+    return;
+  }
+  // Nothing to match, or the set does not fit RE2's memory budget.
+  regex_set_.reset();
+  const size_t middle = unindexed_routes_.size();
+  unindexed_routes_.insert(unindexed_routes_.end(), regex_routes_.begin(), regex_routes_.end());
+  std::inplace_merge(unindexed_routes_.begin(), unindexed_routes_.begin() + middle,
+                     unindexed_routes_.end());
+  regex_routes_.clear();
+}
+
+void RoutePathIndex::checkOrder(uint32_t route_index) {
+  ASSERT(route_index > last_route_index_, "routes must be added in order");
+  last_route_index_ = route_index;
+}
+
+RoutePathIndex::Node& RoutePathIndex::insert(absl::string_view key) {
+  Node* node = &root_;
+  while (!key.empty()) {
+    auto it = node->children_.find(key[0]);
+    if (it == node->children_.end()) {
+      auto child = std::make_unique<Node>();
+      child->label_ = std::string(key);
+      Node& ret = *child;
+      node->children_.emplace(key[0], std::move(child));
+      node_count_++;
+      return ret;
+    }
+
+    Node* child = it->second.get();
+    const absl::string_view label = child->label_;
+    const size_t common =
+        std::mismatch(label.begin(), label.end(), key.begin(), key.end()).first - label.begin();
+    if (common < label.size()) {
+      // The key diverges from, or ends inside, the child's label: split the edge.
+      auto middle = std::make_unique<Node>();
+      middle->label_ = std::string(label.substr(0, common));
+      child->label_.erase(0, common);
+      const char child_key = child->label_[0];
+      middle->children_.emplace(child_key, std::move(it->second));
+      it->second = std::move(middle);
+      child = it->second.get();
+      node_count_++;
+    }
+    key.remove_prefix(common);
+    node = child;
+  }
+  return *node;
+}
+
+void RoutePathIndex::addRegexCandidates(absl::string_view path, Candidates& candidates) const {
+  std::vector<int> matches;
+  re2::RE2::Set::ErrorInfo error;
+  if (!regex_set_->Match({path.data(), path.size()}, &matches, &error) &&
+      error.kind != re2::RE2::Set::kNoError) {
+    // The DFA ran out of memory. Fall back to evaluating every regex route.
+    candidates.insert(candidates.end(), regex_routes_.begin(), regex_routes_.end());
+    return;
+  }
+  for (const int pattern : matches) {
+    candidates.push_back(regex_routes_[pattern]);
+  }
+  // Patterns were added in route order, but RE2 does not report them in any particular order.
+  std::sort(candidates.begin(), candidates.end());
+}
+
+void RoutePathIndex::candidates(absl::string_view path, Candidates& candidates) const {
+  candidates.clear();
+  if (regex_set_ != nullptr) {
+    addRegexCandidates(path, candidates);
+  }
+  mergeInto(unindexed_routes_, candidates);
+  const Node* node = &root_;
+  while (true) {
+    mergeInto(node->prefix_routes_, candidates);
+    if (path.empty()) {
+      mergeInto(node->exact_routes_, candidates);
+      return;
+    }
+    auto it = node->children_.find(path[0]);
+    if (it == node->children_.end() || !absl::StartsWith(path, it->second->label_)) {
+      return;
+    }
+    path.remove_prefix(it->second->label_.size());
+    node = it->second.get();
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
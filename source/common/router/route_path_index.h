@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "re2/set.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Radix trie over the path specifiers of a virtual host's routes, used to skip routes that cannot
+ * match a request path. Routes are identified by their position in the virtual host's route list
+ * and must be added in that order.
+ *
+ * A lookup walks the trie along the request path and collects every prefix route whose prefix is
+ * a prefix of the path, the exact routes whose path equals it, and all routes that could not be
+ * indexed. Regex routes can optionally be compiled into a single RE2::Set, so that one pass over
+ * the path finds all regex routes that match it. The candidates are returned in route order, so
+ * evaluating them in turn preserves the first-match semantics of the full route list.
+ */
+class RoutePathIndex {
+public:
+  using Candidates = absl::InlinedVector<uint32_t, 16>;
+
+  /**
+   * Adds a route that can only match paths starting with the given case sensitive prefix.
+   */
+  void addPrefix(absl::string_view prefix, uint32_t route_index);
+
+  /**
+   * Adds a route that can only match the given case sensitive path.
+   */
+  void addExact(absl::string_view path, uint32_t route_index);
+
+  /**
+   * Adds a route that can only match paths fully matching the given RE2 regex.
+   * @return false if the regex could not be added to the regex set, in which case the route has
+   *         not been added.
+   */
+  bool addRegex(const std::string& regex, uint32_t route_index);
+
+  /**
+   * Adds a route that has to be evaluated for every path.
+   */
+  void addUnindexed(uint32_t route_index);
+
+  /**
+   * Compiles the regex set. Must be called after all routes have been added and before the first
+   * lookup. If the set cannot be compiled, the regex routes become unindexed.
+   */
+  void finalize();
+
+  /**
+   * Finds the routes that may match a path.
+   * @param path the request path with query, fragment and, where configured, path parameters
+   *        already removed.
+   * @param candidates receives the candidate route indices in ascending order.
+   */
+  void candidates(absl::string_view path, Candidates& candidates) const;
+
+  /**
+   * @return the number of trie nodes, including the root.
+   */
+  uint32_t nodeCount() const { return node_count_; }
+
+  /**
+   * @return the number of routes matched through the regex set.
+   */
+  uint32_t regexSetSize() const { return regex_set_ != nullptr ? regex_routes_.size() : 0; }
+
+private:
+  struct Node {
+    // Edge label from the parent node. Empty only for the root.
+    std::string label_;
+    // Children keyed by the first character of their label.
+    absl::flat_hash_map<char, std::unique_ptr<Node>> children_;
+    std::vector<uint32_t> prefix_routes_;
+    std::vector<uint32_t> exact_routes_;
+  };
+
+  Node& insert(absl::string_view key);
+  void checkOrder(uint32_t route_index);
+  void addRegexCandidates(absl::string_view path, Candidates& candidates) const;
+
+  Node root_;
+  std::vector<uint32_t> unindexed_routes_;
+  // Route index of each pattern in regex_set_, by pattern index.
+  std::vector<uint32_t> regex_routes_;
+  std::unique_ptr<re2::RE2::Set> regex_set_;
+  uint32_t node_count_{1};
+  int64_t last_route_index_{-1};
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -168,6 +168,40 @@ FALSE_RUNTIME_GUARD(envoy_reloadable_features_ext_proc_graceful_grpc_close);
 
 FALSE_RUNTIME_GUARD(envoy_reloadable_features_getaddrinfo_no_ai_flags);
 
+// Recycles buffer slice storage through a cross-thread size-classed pool. Evaluate and either flip
+// to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_buffer_slice_storage_pool);
+// Places header map entries in a per-map arena. Read once per process, so it is a restart feature.
+// Evaluate and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_restart_features_header_map_arena_storage);
+// Places per-stream filter manager objects in a stream arena. Evaluate and either flip to true or
+// remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_http_stream_arena);
+// Skips routes that cannot match the request path using a per virtual host path index. Evaluate
+// and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_route_path_index);
+// Matches the regex routes of a virtual host with a single RE2::Set. Evaluate and either flip to
+// true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_route_regex_set);
+// Records histogram values on worker threads into lock-free log-linear buckets. Evaluate and
+// either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_log_linear_tls_histograms);
+// Only flushes the counters and gauges that changed since the previous flush when all stats sinks
+// support it. Evaluate and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_changed_stats_flush);
+// Submits the io_uring writes of an event loop iteration together and links a pending shutdown to
+// the last write of a socket. Evaluate and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_io_uring_batched_writes);
+// Updates the EDF schedules of the round robin and least request load balancers in place on host
+// set changes instead of rebuilding them. Evaluate and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_edf_lb_incremental_refresh);
+// Attaches new streams to the ready connection pool client with the fewest active streams, found
+// through an index ordered by load. Evaluate and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_conn_pool_least_loaded_client);
+// Only creates the child load balancer of a subset when a request first selects it, and releases it
+// again when a host update finds it unused. Evaluate and either flip to true or remove.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_subset_lb_lazy_subsets);
+
 // Block of non-boolean flags. Use of int flags is deprecated. Do not add more.
 ABSL_FLAG(uint64_t, re2_max_program_size_error_level, 100, ""); // NOLINT
 ABSL_FLAG(uint64_t, re2_max_program_size_warn_level,            // NOLINT
@@ -0,0 +1,53 @@
+#include "source/common/ssl/connection_info_snapshot.h"
+
+namespace Envoy {
+namespace Ssl {
+
+namespace {
+
+std::vector<std::string> toVector(absl::Span<const std::string> values) {
+  return {values.begin(), values.end()};
+}
+
+} // namespace
+
+ConnectionInfoSnapshot::ConnectionInfoSnapshot(const ConnectionInfo& info)
+    : peer_certificate_presented_(info.peerCertificatePresented()),
+      peer_certificate_validated_(info.peerCertificateValidated()),
+      uri_san_local_certificate_(toVector(info.uriSanLocalCertificate())),
+      subject_local_certificate_(info.subjectLocalCertificate()),
+      sha256_peer_certificate_digest_(info.sha256PeerCertificateDigest()),
+      sha1_peer_certificate_digest_(info.sha1PeerCertificateDigest()),
+      serial_number_peer_certificate_(info.serialNumberPeerCertificate()),
+      sha256_peer_certificate_chain_digests_(toVector(info.sha256PeerCertificateChainDigests())),
+      sha1_peer_certificate_chain_digests_(toVector(info.sha1PeerCertificateChainDigests())),
+      serial_numbers_peer_certificates_(toVector(info.serialNumbersPeerCertificates())),
+      issuer_peer_certificate_(info.issuerPeerCertificate()),
+      subject_peer_certificate_(info.subjectPeerCertificate()),
+      uri_san_peer_certificate_(toVector(info.uriSanPeerCertificate())),
+      url_encoded_pem_encoded_peer_certificate_(info.urlEncodedPemEncodedPeerCertificate()),
+      url_encoded_pem_encoded_peer_certificate_chain_(
+          info.urlEncodedPemEncodedPeerCertificateChain()),
+      dns_sans_peer_certificate_(toVector(info.dnsSansPeerCertificate())),
+      dns_sans_local_certificate_(toVector(info.dnsSansLocalCertificate())),
+      ip_sans_peer_certificate_(toVector(info.ipSansPeerCertificate())),
+      ip_sans_local_certificate_(toVector(info.ipSansLocalCertificate())),
+      email_sans_peer_certificate_(toVector(info.emailSansPeerCertificate())),
+      email_sans_local_certificate_(toVector(info.emailSansLocalCertificate())),
+      othername_sans_peer_certificate_(toVector(info.othernameSansPeerCertificate())),
+      othername_sans_local_certificate_(toVector(info.othernameSansLocalCertificate())),
+      oids_peer_certificate_(toVector(info.oidsPeerCertificate())),
+      oids_local_certificate_(toVector(info.oidsLocalCertificate())),
+      valid_from_peer_certificate_(info.validFromPeerCertificate()),
+      expiration_peer_certificate_(info.expirationPeerCertificate()),
+      session_id_(info.sessionId()), ciphersuite_id_(info.ciphersuiteId()),
+      ciphersuite_string_(info.ciphersuiteString()), tls_version_(info.tlsVersion()),
+      alpn_(info.alpn()), sni_(info.sni()) {
+  ParsedX509NameOptConstRef parsed_subject = info.parsedSubjectPeerCertificate();
+  if (parsed_subject.has_value()) {
+    parsed_subject_peer_certificate_ = *parsed_subject;
+  }
+}
+
+} // namespace Ssl
+} // namespace Envoy
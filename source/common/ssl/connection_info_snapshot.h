@@ -0,0 +1,152 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "envoy/ssl/connection.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * An immutable copy of the information of a TLS connection. Unlike the connection's own
+ * ConnectionInfo, which computes and caches its values on first use, it can be read from any
+ * thread, e.g. by a stream relayed to another worker than the one owning the connection.
+ */
+class ConnectionInfoSnapshot : public ConnectionInfo {
+public:
+  // Must be called on the thread owning the connection of the given info.
+  explicit ConnectionInfoSnapshot(const ConnectionInfo& info);
+
+  // Ssl::ConnectionInfo
+  bool peerCertificatePresented() const override { return peer_certificate_presented_; }
+  bool peerCertificateValidated() const override { return peer_certificate_validated_; }
+  absl::Span<const std::string> uriSanLocalCertificate() const override {
+    return uri_san_local_certificate_;
+  }
+  const std::string& subjectLocalCertificate() const override {
+    return subject_local_certificate_;
+  }
+  const std::string& sha256PeerCertificateDigest() const override {
+    return sha256_peer_certificate_digest_;
+  }
+  const std::string& sha1PeerCertificateDigest() const override {
+    return sha1_peer_certificate_digest_;
+  }
+  const std::string& serialNumberPeerCertificate() const override {
+    return serial_number_peer_certificate_;
+  }
+  absl::Span<const std::string> sha256PeerCertificateChainDigests() const override {
+    return sha256_peer_certificate_chain_digests_;
+  }
+  absl::Span<const std::string> sha1PeerCertificateChainDigests() const override {
+    return sha1_peer_certificate_chain_digests_;
+  }
+  absl::Span<const std::string> serialNumbersPeerCertificates() const override {
+    return serial_numbers_peer_certificates_;
+  }
+  const std::string& issuerPeerCertificate() const override { return issuer_peer_certificate_; }
+  const std::string& subjectPeerCertificate() const override {
+    return subject_peer_certificate_;
+  }
+  ParsedX509NameOptConstRef parsedSubjectPeerCertificate() const override {
+    return parsed_subject_peer_certificate_.has_value()
+               ? ParsedX509NameOptConstRef(*parsed_subject_peer_certificate_)
+               : absl::nullopt;
+  }
+  absl::Span<const std::string> uriSanPeerCertificate() const override {
+    return uri_san_peer_certificate_;
+  }
+  const std::string& urlEncodedPemEncodedPeerCertificate() const override {
+    return url_encoded_pem_encoded_peer_certificate_;
+  }
+  const std::string& urlEncodedPemEncodedPeerCertificateChain() const override {
+    return url_encoded_pem_encoded_peer_certificate_chain_;
+  }
+  // The certificate itself isn't copied, and matching is only needed while validating the peer,
+  // which is done by the connection.
+  bool peerCertificateSanMatches(const SanMatcher&) const override { return false; }
+  absl::Span<const std::string> dnsSansPeerCertificate() const override {
+    return dns_sans_peer_certificate_;
+  }
+  absl::Span<const std::string> dnsSansLocalCertificate() const override {
+    return dns_sans_local_certificate_;
+  }
+  absl::Span<const std::string> ipSansPeerCertificate() const override {
+    return ip_sans_peer_certificate_;
+  }
+  absl::Span<const std::string> ipSansLocalCertificate() const override {
+    return ip_sans_local_certificate_;
+  }
+  absl::Span<const std::string> emailSansPeerCertificate() const override {
+    return email_sans_peer_certificate_;
+  }
+  absl::Span<const std::string> emailSansLocalCertificate() const override {
+    return email_sans_local_certificate_;
+  }
+  absl::Span<const std::string> othernameSansPeerCertificate() const override {
+    return othername_sans_peer_certificate_;
+  }
+  absl::Span<const std::string> othernameSansLocalCertificate() const override {
+    return othername_sans_local_certificate_;
+  }
+  absl::Span<const std::string> oidsPeerCertificate() const override {
+    return oids_peer_certificate_;
+  }
+  absl::Span<const std::string> oidsLocalCertificate() const override {
+    return oids_local_certificate_;
+  }
+  absl::optional<SystemTime> validFromPeerCertificate() const override {
+    return valid_from_peer_certificate_;
+  }
+  absl::optional<SystemTime> expirationPeerCertificate() const override {
+    return expiration_peer_certificate_;
+  }
+  const std::string& sessionId() const override { return session_id_; }
+  uint16_t ciphersuiteId() const override { return ciphersuite_id_; }
+  std::string ciphersuiteString() const override { return ciphersuite_string_; }
+  const std::string& tlsVersion() const override { return tls_version_; }
+  const std::string& alpn() const override { return alpn_; }
+  const std::string& sni() const override { return sni_; }
+
+private:
+  const bool peer_certificate_presented_;
+  const bool peer_certificate_validated_;
+  const std::vector<std::string> uri_san_local_certificate_;
+  const std::string subject_local_certificate_;
+  const std::string sha256_peer_certificate_digest_;
+  const std::string sha1_peer_certificate_digest_;
+  const std::string serial_number_peer_certificate_;
+  const std::vector<std::string> sha256_peer_certificate_chain_digests_;
+  const std::vector<std::string> sha1_peer_certificate_chain_digests_;
+  const std::vector<std::string> serial_numbers_peer_certificates_;
+  const std::string issuer_peer_certificate_;
+  const std::string subject_peer_certificate_;
+  absl::optional<ParsedX509Name> parsed_subject_peer_certificate_;
+  const std::vector<std::string> uri_san_peer_certificate_;
+  const std::string url_encoded_pem_encoded_peer_certificate_;
+  const std::string url_encoded_pem_encoded_peer_certificate_chain_;
+  const std::vector<std::string> dns_sans_peer_certificate_;
+  const std::vector<std::string> dns_sans_local_certificate_;
+  const std::vector<std::string> ip_sans_peer_certificate_;
+  const std::vector<std::string> ip_sans_local_certificate_;
+  const std::vector<std::string> email_sans_peer_certificate_;
+  const std::vector<std::string> email_sans_local_certificate_;
+  const std::vector<std::string> othername_sans_peer_certificate_;
+  const std::vector<std::string> othername_sans_local_certificate_;
+  const std::vector<std::string> oids_peer_certificate_;
+  const std::vector<std::string> oids_local_certificate_;
+  const absl::optional<SystemTime> valid_from_peer_certificate_;
+  const absl::optional<SystemTime> expiration_peer_certificate_;
+  const std::string session_id_;
+  const uint16_t ciphersuite_id_;
+  const std::string ciphersuite_string_;
+  const std::string tls_version_;
+  const std::string alpn_;
+  const std::string sni_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
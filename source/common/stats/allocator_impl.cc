@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <utility>
 
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
@@ -21,6 +22,20 @@
 namespace Envoy {
 namespace Stats {
 
+namespace {
+
+template <class StatType, class StatSetType>
+void forEachStatInSet(const StatSetType& stats, SizeFn f_size, StatFn<StatType> f_stat) {
+  if (f_size != nullptr) {
+    f_size(stats.size());
+  }
+  for (StatType* stat : stats) {
+    f_stat(*stat);
+  }
+}
+
+} // namespace
+
 const char AllocatorImpl::DecrementToZeroSyncPoint[] = "decrement-zero";
 
 AllocatorImpl::~AllocatorImpl() {
@@ -112,6 +127,21 @@ public:
   }
   uint32_t use_count() const override { return ref_count_; }
 
+  /**
+   * Sets the Changed flag if the allocator tracks changes.
+   * @return true if the flag was not set before, in which case the stat must be added to the
+   *         allocator's set of changed stats.
+   */
+  bool markChanged() {
+    if (!alloc_.track_changes_.load(std::memory_order_relaxed) ||
+        (flags_ & Metric::Flags::Changed)) {
+      return false;
+    }
+    return !(flags_.fetch_or(Metric::Flags::Changed) & Metric::Flags::Changed);
+  }
+  void clearChanged() { flags_ &= ~Metric::Flags::Changed; }
+  bool changed() const { return flags_ & Metric::Flags::Changed; }
+
   /**
    * We must atomically remove the counter/gauges from the allocator's sets when
    * our ref-count decrement hits zero. The counters and gauges are held in
@@ -146,6 +176,10 @@ public:
     const size_t count = alloc_.counters_.erase(statName());
     ASSERT(count == 1);
     alloc_.sinked_counters_.erase(this);
+    if (changed()) {
+      Thread::LockGuard lock(alloc_.changed_mutex_);
+      alloc_.changed_counters_.erase(this);
+    }
   }
 
   // Stats::Counter
@@ -155,6 +189,10 @@ public:
     value_ += amount;
     pending_increment_ += amount;
     flags_ |= Flags::Used;
+    // Marked after the update, so that a flush clearing the flag sees the update.
+    if (markChanged()) {
+      alloc_.addChangedCounter(this);
+    }
   }
   void inc() override { add(1); }
   uint64_t latch() override { return pending_increment_.exchange(0); }
@@ -195,23 +233,30 @@ public:
     const size_t count = alloc_.gauges_.erase(statName());
     ASSERT(count == 1);
     alloc_.sinked_gauges_.erase(this);
+    if (changed()) {
+      Thread::LockGuard lock(alloc_.changed_mutex_);
+      alloc_.changed_gauges_.erase(this);
+    }
   }
 
   // Stats::Gauge
   void add(uint64_t amount) override {
     child_value_ += amount;
     flags_ |= Flags::Used;
+    onChange();
   }
   void dec() override { sub(1); }
   void inc() override { add(1); }
   void set(uint64_t value) override {
     child_value_ = value;
     flags_ |= Flags::Used;
+    onChange();
   }
   void sub(uint64_t amount) override {
     ASSERT(child_value_ >= amount);
     ASSERT(used() || amount == 0);
     child_value_ -= amount;
+    onChange();
   }
   uint64_t value() const override { return child_value_ + parent_value_; }
 
@@ -251,6 +296,7 @@ public:
       parent_value_ = 0;
       flags_ &= ~Flags::Used;
       flags_ |= Flags::NeverImport;
+      onChange();
       break;
     case ImportMode::HiddenAccumulate:
       ASSERT(current == ImportMode::Uninitialized);
@@ -260,9 +306,18 @@ public:
     }
   }
 
-  void setParentValue(uint64_t value) override { parent_value_ = value; }
+  void setParentValue(uint64_t value) override {
+    parent_value_ = value;
+    onChange();
+  }
 
 private:
+  void onChange() {
+    if (markChanged()) {
+      alloc_.addChangedGauge(this);
+    }
+  }
+
   std::atomic<uint64_t> parent_value_{0};
   std::atomic<uint64_t> child_value_{0};
 };
@@ -439,6 +494,92 @@ void AllocatorImpl::forEachSinkedTextReadout(SizeFn f_size, StatFn<TextReadout>
   }
 }
 
+void AllocatorImpl::forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) {
+  if (!track_changes_) {
+    forEachSinkedCounter(f_size, f_stat);
+    return;
+  }
+  Thread::LockGuard lock(mutex_);
+  StatPointerSet<Counter> changed;
+  {
+    Thread::LockGuard changed_lock(changed_mutex_);
+    changed.swap(changed_counters_);
+  }
+  // Flags are cleared before the counters are read, so that a concurrent change is either seen
+  // by this flush or adds the counter back for the next one. Only CounterImpl adds itself.
+  for (Counter* counter : changed) {
+    static_cast<CounterImpl*>(counter)->clearChanged();
+  }
+  if (std::exchange(flush_all_counters_, false)) {
+    if (sink_predicates_ != nullptr) {
+      forEachStatInSet(sinked_counters_, f_size, f_stat);
+    } else {
+      forEachStatInSet(counters_, f_size, f_stat);
+    }
+    return;
+  }
+  if (sink_predicates_ != nullptr) {
+    absl::erase_if(changed,
+                   [this](Counter* counter) { return !sinked_counters_.contains(counter); });
+  }
+  forEachStatInSet(changed, f_size, f_stat);
+}
+
+void AllocatorImpl::forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) {
+  if (!track_changes_) {
+    forEachSinkedGauge(f_size, f_stat);
+    return;
+  }
+  Thread::LockGuard lock(mutex_);
+  StatPointerSet<Gauge> changed;
+  {
+    Thread::LockGuard changed_lock(changed_mutex_);
+    changed.swap(changed_gauges_);
+  }
+  for (Gauge* gauge : changed) {
+    static_cast<GaugeImpl*>(gauge)->clearChanged();
+  }
+  if (sink_predicates_ == nullptr) {
+    f_stat = [f_stat](Gauge& gauge) {
+      if (!gauge.hidden()) {
+        f_stat(gauge);
+      }
+    };
+  }
+  if (std::exchange(flush_all_gauges_, false)) {
+    if (sink_predicates_ != nullptr) {
+      forEachStatInSet(sinked_gauges_, f_size, f_stat);
+    } else {
+      forEachStatInSet(gauges_, f_size, f_stat);
+    }
+    return;
+  }
+  if (sink_predicates_ != nullptr) {
+    absl::erase_if(changed, [this](Gauge* gauge) { return !sinked_gauges_.contains(gauge); });
+  }
+  forEachStatInSet(changed, f_size, f_stat);
+}
+
+void AllocatorImpl::trackChangedStats() {
+  Thread::LockGuard lock(mutex_);
+  if (track_changes_) {
+    return;
+  }
+  flush_all_counters_ = true;
+  flush_all_gauges_ = true;
+  track_changes_ = true;
+}
+
+void AllocatorImpl::addChangedCounter(Counter* counter) {
+  Thread::LockGuard lock(changed_mutex_);
+  changed_counters_.insert(counter);
+}
+
+void AllocatorImpl::addChangedGauge(Gauge* gauge) {
+  Thread::LockGuard lock(changed_mutex_);
+  changed_gauges_.insert(gauge);
+}
+
 void AllocatorImpl::setSinkPredicates(std::unique_ptr<SinkPredicates>&& sink_predicates) {
   Thread::LockGuard lock(mutex_);
   ASSERT(sink_predicates_ == nullptr);
@@ -478,6 +619,8 @@ void AllocatorImpl::markCounterForDeletion(const CounterSharedPtr& counter) {
   deleted_counters_.emplace_back(*iter);
   counters_.erase(iter);
   sinked_counters_.erase(counter.get());
+  Thread::LockGuard changed_lock(changed_mutex_);
+  changed_counters_.erase(counter.get());
 }
 
 void AllocatorImpl::markGaugeForDeletion(const GaugeSharedPtr& gauge) {
@@ -492,6 +635,8 @@ void AllocatorImpl::markGaugeForDeletion(const GaugeSharedPtr& gauge) {
   deleted_gauges_.emplace_back(*iter);
   gauges_.erase(iter);
   sinked_gauges_.erase(gauge.get());
+  Thread::LockGuard changed_lock(changed_mutex_);
+  changed_gauges_.erase(gauge.get());
 }
 
 void AllocatorImpl::markTextReadoutForDeletion(const TextReadoutSharedPtr& text_readout) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "envoy/common/optref.h"
@@ -43,6 +44,9 @@ public:
   void forEachSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) const override;
   void forEachSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) const override;
   void forEachSinkedTextReadout(SizeFn f_size, StatFn<TextReadout> f_stat) const override;
+  void forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) override;
+  void forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) override;
+  void trackChangedStats() override;
 
   void setSinkPredicates(std::unique_ptr<SinkPredicates>&& sink_predicates) override;
 #ifndef ENVOY_CONFIG_COVERAGE
@@ -90,6 +94,23 @@ private:
   StatPointerSet<Gauge> sinked_gauges_ ABSL_GUARDED_BY(mutex_);
   StatPointerSet<TextReadout> sinked_text_readouts_ ABSL_GUARDED_BY(mutex_);
 
+  // Called by counters and gauges the first time they change after a flush.
+  void addChangedCounter(Counter* counter);
+  void addChangedGauge(Gauge* gauge);
+
+  // Read on every counter and gauge update, so it is checked before taking changed_mutex_.
+  std::atomic<bool> track_changes_{false};
+  // Set when tracking starts, as stats may have changed before. The next flush then visits all
+  // stats.
+  bool flush_all_counters_ ABSL_GUARDED_BY(mutex_){false};
+  bool flush_all_gauges_ ABSL_GUARDED_BY(mutex_){false};
+  // Taken on its own when a stat changes, and while holding mutex_ when flushing or removing
+  // stats. Stats are only added when their Changed flag is first set, so each stat is added at
+  // most once per flush.
+  mutable Thread::MutexBasicLockable changed_mutex_;
+  StatPointerSet<Counter> changed_counters_ ABSL_GUARDED_BY(changed_mutex_);
+  StatPointerSet<Gauge> changed_gauges_ ABSL_GUARDED_BY(changed_mutex_);
+
   // Predicates used to filter stats to be flushed.
   std::unique_ptr<SinkPredicates> sink_predicates_;
   SymbolTable& symbol_table_;
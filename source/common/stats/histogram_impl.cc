@@ -4,6 +4,7 @@
 #include <string>
 
 #include "source/common/common/utility.h"
+#include "source/common/stats/log_linear_histogram.h"
 
 #include "absl/strings/str_join.h"
 
@@ -106,8 +107,10 @@ HistogramSettingsImpl::HistogramSettingsImpl(const envoy::config::metrics::v3::S
         for (const auto& matcher : config.histogram_bucket_settings()) {
           std::vector<double> buckets{matcher.buckets().begin(), matcher.buckets().end()};
           std::sort(buckets.begin(), buckets.end());
-          configs.emplace_back(Matchers::StringMatcherImpl(matcher.match(), context),
-                               std::move(buckets));
+          configs.push_back({Matchers::StringMatcherImpl(matcher.match(), context),
+                             std::move(buckets),
+                             matcher.has_significant_bits() ? matcher.significant_bits().value()
+                                                            : 0});
         }
 
         return configs;
@@ -115,13 +118,26 @@ HistogramSettingsImpl::HistogramSettingsImpl(const envoy::config::metrics::v3::S
 
 const ConstSupportedBuckets& HistogramSettingsImpl::buckets(absl::string_view stat_name) const {
   for (const auto& config : configs_) {
-    if (config.first.match(stat_name)) {
-      return config.second;
+    if (config.matcher_.match(stat_name)) {
+      return config.buckets_;
     }
   }
   return defaultBuckets();
 }
 
+uint32_t HistogramSettingsImpl::significantBits(absl::string_view stat_name) const {
+  // Like buckets(), the first matching rule applies.
+  for (const auto& config : configs_) {
+    if (config.matcher_.match(stat_name)) {
+      if (config.significant_bits_ != 0) {
+        return config.significant_bits_;
+      }
+      break;
+    }
+  }
+  return LogLinearHistogram::DefaultSignificantBits;
+}
+
 const ConstSupportedBuckets& HistogramSettingsImpl::defaultBuckets() {
   CONSTRUCT_ON_FIRST_USE(ConstSupportedBuckets,
                          {0.5, 1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000,
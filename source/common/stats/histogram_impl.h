@@ -25,11 +25,17 @@ public:
 
   // HistogramSettings
   const ConstSupportedBuckets& buckets(absl::string_view stat_name) const override;
+  uint32_t significantBits(absl::string_view stat_name) const override;
 
   static ConstSupportedBuckets& defaultBuckets();
 
 private:
-  using Config = std::pair<Matchers::StringMatcherImpl, ConstSupportedBuckets>;
+  struct Config {
+    Matchers::StringMatcherImpl matcher_;
+    ConstSupportedBuckets buckets_;
+    // 0 if not configured.
+    uint32_t significant_bits_;
+  };
   const std::vector<Config> configs_{};
 };
 
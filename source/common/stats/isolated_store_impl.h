@@ -220,6 +220,14 @@ public:
     UNREFERENCED_PARAMETER(f_stat);
   }
 
+  void forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) override {
+    forEachSinkedCounter(f_size, f_stat);
+  }
+
+  void forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) override {
+    forEachSinkedGauge(f_size, f_stat);
+  }
+
   NullCounterImpl& nullCounter() override { return *null_counter_; }
   NullGaugeImpl& nullGauge() override { return *null_gauge_; }
 
@@ -0,0 +1,121 @@
+#include "source/common/stats/log_linear_histogram.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "source/common/common/assert.h"
+
+#include "absl/numeric/bits.h"
+
+namespace Envoy {
+namespace Stats {
+
+LogLinearHistogram::LogLinearHistogram(uint32_t significant_bits)
+    : significant_bits_(std::clamp(significant_bits, MinSignificantBits, MaxSignificantBits)),
+      linear_size_(1U << significant_bits_), num_groups_(65 - significant_bits_),
+      groups_(new std::atomic<Counter*>[num_groups_]),
+      merged_(new std::unique_ptr<uint32_t[]>[num_groups_]) {
+  for (uint32_t group = 0; group < num_groups_; group++) {
+    groups_[group].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+LogLinearHistogram::~LogLinearHistogram() {
+  for (uint32_t group = 0; group < num_groups_; group++) {
+    delete[] groups_[group].load(std::memory_order_relaxed);
+  }
+}
+
+void LogLinearHistogram::locate(uint64_t value, uint32_t& group, uint32_t& offset) const {
+  if (value < linear_size_) {
+    group = 0;
+    offset = value;
+    return;
+  }
+  // For a value with its most significant bit at position msb >= significant_bits_, group
+  // msb - significant_bits_ + 1 holds the values sharing the same significant_bits_ top bits.
+  const uint32_t msb = 63 - absl::countl_zero(value);
+  group = msb + 1 - significant_bits_;
+  offset = (value >> group) - linear_size_ / 2;
+}
+
+uint64_t LogLinearHistogram::bucketValue(uint32_t group, uint32_t offset) const {
+  if (group == 0) {
+    return offset;
+  }
+  // The midpoint of the bucket.
+  const uint64_t lower_bound = static_cast<uint64_t>(linear_size_ / 2 + offset) << group;
+  return lower_bound + (uint64_t(1) << (group - 1));
+}
+
+uint64_t LogLinearHistogram::bucketValue(uint64_t value) const {
+  uint32_t group;
+  uint32_t offset;
+  locate(value, group, offset);
+  return bucketValue(group, offset);
+}
+
+void LogLinearHistogram::recordValue(uint64_t value) {
+  uint32_t group;
+  uint32_t offset;
+  locate(value, group, offset);
+  // Only this thread stores to groups_, so a relaxed load sees its own stores.
+  Counter* counters = groups_[group].load(std::memory_order_relaxed);
+  if (counters == nullptr) {
+    counters = new Counter[groupSize(group)]();
+    groups_[group].store(counters, std::memory_order_release);
+  }
+  Counter& counter = counters[offset];
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void LogLinearHistogram::mergeIntervals(absl::Span<LogLinearHistogram* const> histograms,
+                                        histogram_t* target) {
+  if (histograms.empty()) {
+    return;
+  }
+  const LogLinearHistogram& first = *histograms[0];
+  uint32_t snapshot[1U << MaxSignificantBits];
+  uint64_t interval[1U << MaxSignificantBits];
+  for (uint32_t group = 0; group < first.num_groups_; group++) {
+    const uint32_t size = first.groupSize(group);
+    bool recorded = false;
+    for (LogLinearHistogram* histogram : histograms) {
+      ASSERT(histogram->significant_bits_ == first.significant_bits_);
+      const Counter* counters = histogram->groups_[group].load(std::memory_order_acquire);
+      if (counters == nullptr) {
+        continue;
+      }
+      std::unique_ptr<uint32_t[]>& merged = histogram->merged_[group];
+      if (merged == nullptr) {
+        merged = std::make_unique<uint32_t[]>(size);
+      }
+      if (!recorded) {
+        std::fill_n(interval, size, 0);
+        recorded = true;
+      }
+      for (uint32_t i = 0; i < size; i++) {
+        snapshot[i] = counters[i].load(std::memory_order_relaxed);
+      }
+      // Plain arithmetic on arrays, which the compiler vectorizes.
+      uint32_t* last = merged.get();
+      for (uint32_t i = 0; i < size; i++) {
+        interval[i] += static_cast<uint32_t>(snapshot[i] - last[i]);
+        last[i] = snapshot[i];
+      }
+    }
+    if (!recorded) {
+      continue;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+      if (interval[i] != 0) {
+        const uint64_t value = std::min<uint64_t>(first.bucketValue(group, i),
+                                                  std::numeric_limits<int64_t>::max());
+        hist_insert_intscale(target, value, 0, interval[i]);
+      }
+    }
+  }
+}
+
+} // namespace Stats
+} // namespace Envoy
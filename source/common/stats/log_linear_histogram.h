@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "source/common/common/non_copyable.h"
+
+#include "absl/types/span.h"
+#include "circllhist.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Per-thread histogram with fixed log-linear buckets, in the style of HdrHistogram. Values below
+ * 2^significant_bits get a bucket each; above that, every power of two is split into
+ * 2^(significant_bits - 1) equally sized buckets, so the bucket width relative to the value is at
+ * most 2^-(significant_bits - 1).
+ *
+ * Buckets are grouped by power of two and a group is only allocated once a value falls into it.
+ * The recording thread is the only writer and updates counters with relaxed atomic stores, so
+ * recording needs neither a lock nor a read-modify-write instruction. Another thread merges the
+ * values recorded since its previous merge by comparing the counters with the snapshot taken at
+ * that merge; the recording thread does not need to take part in the merge.
+ */
+class LogLinearHistogram : NonCopyable {
+public:
+  static constexpr uint32_t MinSignificantBits = 3;
+  static constexpr uint32_t MaxSignificantBits = 8;
+  static constexpr uint32_t DefaultSignificantBits = 5;
+
+  explicit LogLinearHistogram(uint32_t significant_bits);
+  ~LogLinearHistogram();
+
+  /**
+   * Records a value. Must always be called from the same thread.
+   */
+  void recordValue(uint64_t value);
+
+  /**
+   * Adds the values recorded into the given histograms since the previous merge to target. The
+   * histograms must all use the same number of significant bits. Can be called from any thread,
+   * but not concurrently for the same histogram.
+   */
+  static void mergeIntervals(absl::Span<LogLinearHistogram* const> histograms,
+                             histogram_t* target);
+
+  uint32_t significantBits() const { return significant_bits_; }
+
+  /**
+   * @return the value recorded into target for values in the same bucket as the given value.
+   */
+  uint64_t bucketValue(uint64_t value) const;
+
+private:
+  // Counters never exceed 32 bits: merges only look at the difference to the previous snapshot,
+  // which stays correct across wrap-around as long as fewer than 2^32 values are recorded into a
+  // bucket between two merges.
+  using Counter = std::atomic<uint32_t>;
+
+  uint32_t groupSize(uint32_t group) const { return group == 0 ? linear_size_ : linear_size_ / 2; }
+  void locate(uint64_t value, uint32_t& group, uint32_t& offset) const;
+  uint64_t bucketValue(uint32_t group, uint32_t offset) const;
+
+  const uint32_t significant_bits_;
+  // Number of buckets of group 0, which holds the values below 2^significant_bits_.
+  const uint32_t linear_size_;
+  const uint32_t num_groups_;
+  // Written by the recording thread only; read by the merging thread.
+  std::unique_ptr<std::atomic<Counter*>[]> groups_;
+  // Counter values at the previous merge. Only accessed by the merging thread.
+  std::unique_ptr<std::unique_ptr<uint32_t[]>[]> merged_;
+};
+
+} // namespace Stats
+} // namespace Envoy
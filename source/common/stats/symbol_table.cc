@@ -261,7 +261,7 @@ bool StatName::startsWith(StatName prefix) const {
 
 std::vector<absl::string_view> SymbolTable::decodeStrings(StatName stat_name) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
+  Thread::ReaderLockGuard lock(lock_);
   Encoding::decodeTokens(
       stat_name,
       [this, &strings](Symbol symbol)
@@ -313,16 +313,31 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
   symbols.reserve(tokens.size());
 
   // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
+  // ref-counts in this. Tokens that are already in the table only need the
+  // lock in shared mode.
+  recordLookup(name);
+  absl::InlinedVector<uint32_t, 8> missing;
   {
-    Thread::LockGuard lock(lock_);
-    recent_lookups_.lookup(name);
+    Thread::ReaderLockGuard lock(lock_);
     for (auto& token : tokens) {
+      auto encode_find = encode_map_.find(token);
+      if (encode_find == encode_map_.end()) {
+        missing.push_back(symbols.size());
+        symbols.push_back(0);
+      } else {
+        ++encode_find->second.ref_count_;
+        symbols.push_back(encode_find->second.symbol_);
+      }
+    }
+  }
+  if (!missing.empty()) {
+    Thread::LockGuard lock(writer_lock_);
+    for (uint32_t index : missing) {
       // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
       // length below some threshold, say 4 bytes. It might be preferable not to
       // reserve Symbols for every 3 digit number found (for example) in ipv4
       // addresses.
-      symbols.push_back(toSymbol(token));
+      symbols[index] = toSymbol(tokens[index]);
     }
   }
 
@@ -330,8 +345,17 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
   encoding.addSymbols(symbols);
 }
 
+void SymbolTable::recordLookup(absl::string_view name) {
+  if (!remember_lookups_.load(std::memory_order_relaxed)) {
+    unremembered_lookups_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Thread::LockGuard lock(recent_lookups_lock_);
+  recent_lookups_.lookup(name);
+}
+
 uint64_t SymbolTable::numSymbols() const {
-  Thread::LockGuard lock(lock_);
+  Thread::ReaderLockGuard lock(lock_);
   ASSERT(encode_map_.size() == decode_map_.size());
   return encode_map_.size();
 }
@@ -344,7 +368,7 @@ void SymbolTable::incRefCount(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
 
-  Thread::LockGuard lock(lock_);
+  Thread::ReaderLockGuard lock(lock_);
   for (Symbol symbol : symbols) {
     auto decode_search = decode_map_.find(symbol);
 
@@ -366,24 +390,52 @@ void SymbolTable::free(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
 
-  Thread::LockGuard lock(lock_);
-  for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
+  absl::InlinedVector<Symbol, 8> unreferenced;
+  {
+    Thread::ReaderLockGuard lock(lock_);
+    for (Symbol symbol : symbols) {
+      auto decode_search = decode_map_.find(symbol);
+      ASSERT(decode_search != decode_map_.end());
+
+      auto encode_search = encode_map_.find(decode_search->second->toStringView());
+      ASSERT(encode_search != encode_map_.end());
+
+      // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
+      // symbol_table_speed_test.cc, relative to breaking out the decrement into a
+      // separate step, likely due to the non-trivial dereferences in EXPR.
+      if (--encode_search->second.ref_count_ == 0) {
+        unreferenced.push_back(symbol);
+      }
+    }
+  }
+  if (unreferenced.empty()) {
+    return;
+  }
 
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
+  // If that was the last remaining client usage of a symbol, erase the current
+  // mappings and add the now-unused symbol to the reuse pool. Between releasing
+  // the shared lock and taking the exclusive one, another thread may have
+  // encoded the token again, or erased the symbol and reused it for another
+  // token, so only symbols that are still unreferenced are erased. lock_ is
+  // only held exclusively for the erasures; the erased strings are destroyed
+  // after it is released.
+  Thread::LockGuard writer_lock(writer_lock_);
+  absl::InlinedVector<InlineStringPtr, 8> erased;
+  {
+    Thread::LockGuard lock(lock_);
+    for (Symbol symbol : unreferenced) {
+      auto decode_search = decode_map_.find(symbol);
+      if (decode_search == decode_map_.end()) {
+        continue;
+      }
+      auto encode_search = encode_map_.find(decode_search->second->toStringView());
+      ASSERT(encode_search != encode_map_.end());
+      if (encode_search->second.ref_count_ == 0) {
+        encode_map_.erase(encode_search);
+        erased.push_back(std::move(decode_search->second));
+        decode_map_.erase(decode_search);
+        pool_.push(symbol);
+      }
     }
   }
 }
@@ -392,15 +444,16 @@ uint64_t SymbolTable::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold recent_lookups_lock_ while calling the iterator, but
+  // we need it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
     total += recent_lookups_.total();
   }
+  total += unremembered_lookups_.load(std::memory_order_relaxed);
 
   // Now we have the collated name-count map data: we need to vectorize and
   // sort. We define the pair with the count first as std::pair::operator<
@@ -444,17 +497,19 @@ DynamicSpans SymbolTable::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTable::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  remember_lookups_ = capacity != 0;
 }
 
 void SymbolTable::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.clear();
+  unremembered_lookups_ = 0;
 }
 
 uint64_t SymbolTable::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -465,39 +520,44 @@ StatNameSetPtr SymbolTable::makeSet(absl::string_view name) {
 }
 
 Symbol SymbolTable::toSymbol(absl::string_view sv) {
-  Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
-    InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
+  {
+    Thread::ReaderLockGuard lock(lock_);
+    auto encode_find = encode_map_.find(sv);
+    // If the string segment already exists, up the refcount at that location.
+    if (encode_find != encode_map_.end()) {
+      ++(encode_find->second.ref_count_);
+      return encode_find->second.symbol_;
+    }
+  }
+
+  // Otherwise we create the actual string, place it in the decode_map_, and
+  // then insert a string_view pointing to it in the encode_map_. This allows us
+  // to only store the string once. We use unique_ptr so copies are not made as
+  // flat_hash_map moves values around. The caller holds writer_lock_, so no
+  // other thread can add the token in between, and lock_ is only taken
+  // exclusively for the insertions.
+  InlineStringPtr str = InlineString::create(sv);
+  const absl::string_view token = str->toStringView();
+  const Symbol result = next_symbol_;
+  {
+    Thread::LockGuard lock(lock_);
+    auto encode_insert = encode_map_.insert({token, SharedSymbol(result)});
     ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
+    auto decode_insert = decode_map_.insert({result, std::move(str)});
     ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
-  } else {
-    // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
   }
+  newSymbol();
   return result;
 }
 
 absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    ABSL_SHARED_LOCKS_REQUIRED(lock_) {
   auto search = decode_map_.find(symbol);
   RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
   return search->second->toStringView();
 }
 
-void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(writer_lock_) {
   if (pool_.empty()) {
     next_symbol_ = ++monotonic_counter_;
   } else {
@@ -512,12 +572,12 @@ bool SymbolTable::lessThan(const StatName& a, const StatName& b) const {
   // Proactively take the table lock in anticipation that we'll need to
   // convert at least one symbol to a string_view, and it's easier not to
   // bother to lazily take the lock.
-  Thread::LockGuard lock(lock_);
+  Thread::ReaderLockGuard lock(lock_);
   return lessThanLockHeld(a, b);
 }
 
 bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    ABSL_SHARED_LOCKS_REQUIRED(lock_) {
   Encoding::TokenIter a_iter(a), b_iter(b);
   while (true) {
     Encoding::TokenIter::TokenType a_type = a_iter.next();
@@ -547,7 +607,7 @@ bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTable::debugPrint() const {
-  Thread::LockGuard lock(lock_);
+  Thread::ReaderLockGuard lock(lock_);
   std::vector<Symbol> symbols;
   for (const auto& p : decode_map_) {
     symbols.push_back(p.first);
@@ -556,7 +616,8 @@ void SymbolTable::debugPrint() const {
   for (Symbol symbol : symbols) {
     const InlineString& token = *decode_map_.find(symbol)->second;
     const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(),
+                   shared_symbol.ref_count_.load());
   }
 }
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <stack>
 #include <string>
@@ -349,7 +350,7 @@ public:
   void sortByStatNames(Iter begin, Iter end, GetStatName get_stat_name) const {
     // Grab the lock once before sorting begins, so we don't have to re-take
     // it on every comparison.
-    Thread::LockGuard lock(lock_);
+    Thread::ReaderLockGuard lock(lock_);
     StatNameCompare<GetStatName, Obj> compare(*this, get_stat_name);
     std::sort(begin, end, compare);
   }
@@ -397,13 +398,26 @@ private:
 
   struct SharedSymbol {
     SharedSymbol(Symbol symbol) : symbol_(symbol) {}
+    // Moves only happen when the encode map rehashes, which requires the
+    // exclusive lock.
+    SharedSymbol(SharedSymbol&& src) noexcept
+        : symbol_(src.symbol_), ref_count_(src.ref_count_.load(std::memory_order_relaxed)) {}
 
     Symbol symbol_;
-    uint32_t ref_count_{1};
+    // Incremented and decremented with lock_ held in shared mode, so that
+    // encoding and freeing names made of existing symbols never serialize.
+    // A symbol is only erased with lock_ held exclusively.
+    std::atomic<uint32_t> ref_count_{1};
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  // Held in shared mode to look up and reference-count existing symbols in
+  // encode() and free(), and exclusively while inserting or erasing map entries.
+  mutable Thread::StripedMutex lock_;
+
+  // Serializes adding and erasing symbols, and guards the symbol allocation
+  // state, so that lock_ is only held exclusively around the map mutations
+  // themselves. Acquired before lock_.
+  mutable Thread::MutexBasicLockable writer_lock_ ABSL_ACQUIRED_BEFORE(lock_);
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -426,7 +440,7 @@ private:
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(writer_lock_);
 
   /**
    * Convenience function for decode(), decoding one symbol at a time.
@@ -434,12 +448,12 @@ private:
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const ABSL_SHARED_LOCKS_REQUIRED(lock_);
 
   /**
    * Stages a new symbol for use. To be called after a successful insertion.
    */
-  void newSymbol();
+  void newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(writer_lock_);
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -451,13 +465,15 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(writer_lock_);
     return monotonic_counter_;
   }
 
+  void recordLookup(absl::string_view name);
+
   // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
   // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ ABSL_GUARDED_BY(lock_);
+  Symbol next_symbol_ ABSL_GUARDED_BY(writer_lock_);
 
   // If the free pool is exhausted, we monotonically increase this counter.
   Symbol monotonic_counter_;
@@ -473,8 +489,14 @@ private:
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ ABSL_GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ ABSL_GUARDED_BY(writer_lock_);
+
+  mutable Thread::MutexBasicLockable recent_lookups_lock_;
+  RecentLookups recent_lookups_ ABSL_GUARDED_BY(recent_lookups_lock_);
+  // While recent lookups are not tracked, encode() only counts lookups here
+  // rather than taking recent_lookups_lock_.
+  std::atomic<bool> remember_lookups_{false};
+  std::atomic<uint64_t> unremembered_lookups_{0};
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
@@ -12,12 +12,14 @@
 #include "envoy/stats/stats.h"
 
 #include "source/common/common/lock_guard.h"
+#include "source/common/common/thread.h"
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/stats/histogram_impl.h"
 #include "source/common/stats/stats_matcher_impl.h"
 #include "source/common/stats/tag_producer_impl.h"
 #include "source/common/stats/tag_utility.h"
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/str_join.h"
 
 namespace Envoy {
@@ -233,6 +235,17 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
     ASSERT(!merge_in_progress_);
     merge_in_progress_ = true;
+    if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.log_linear_tls_histograms") &&
+        !worker_circllhist_histograms_) {
+      // Log-linear histograms are merged without their recording thread, so only the circllhists
+      // recorded on this thread, e.g. before runtime was loaded, need their buffers swapped.
+      ASSERT_IS_MAIN_OR_TEST_THREAD();
+      for (const auto& id_hist : tlsCache().tls_histogram_cache_) {
+        id_hist.second->beginMerge();
+      }
+      mergeInternal(merge_complete_cb);
+      return;
+    }
     tls_cache_->runOnAllThreads(
         [](OptRef<TlsCache> tls_cache) {
           for (const auto& id_hist : tls_cache->tls_histogram_cache_) {
@@ -672,8 +685,12 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogramFromStatNameWithTags(
   } else {
     StatNameTagHelper tag_helper(parent_, joiner.tagExtractedName(), stat_name_tags);
 
-    ConstSupportedBuckets* buckets = nullptr;
-    buckets = &parent_.histogram_settings_->buckets(symbolTable().toString(final_stat_name));
+    const std::string stat_name = symbolTable().toString(final_stat_name);
+    ConstSupportedBuckets* buckets = &parent_.histogram_settings_->buckets(stat_name);
+    const uint32_t significant_bits =
+        Runtime::runtimeFeatureEnabled("envoy.reloadable_features.log_linear_tls_histograms")
+            ? parent_.histogram_settings_->significantBits(stat_name)
+            : 0;
 
     RefcountPtr<ParentHistogramImpl> stat;
     {
@@ -684,7 +701,7 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogramFromStatNameWithTags(
       } else {
         stat = new ParentHistogramImpl(final_stat_name, unit, parent_,
                                        tag_helper.tagExtractedName(), tag_helper.statNameTags(),
-                                       *buckets, parent_.next_histogram_id_++);
+                                       *buckets, parent_.next_histogram_id_++, significant_bits);
         if (!parent_.shutting_down_) {
           parent_.histogram_set_.insert(stat.get());
           if (parent_.sink_predicates_.has_value() &&
@@ -791,7 +808,11 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 
   TlsHistogramSharedPtr hist_tls_ptr(
       new ThreadLocalHistogramImpl(parent.statName(), parent.unit(), tag_helper.tagExtractedName(),
-                                   tag_helper.statNameTags(), symbolTable()));
+                                   tag_helper.statNameTags(), symbolTable(),
+                                   parent.significantBits()));
+  if (parent.significantBits() == 0 && !Thread::MainThread::isMainOrTestThread()) {
+    worker_circllhist_histograms_ = true;
+  }
 
   parent.addTlsHistogram(hist_tls_ptr);
 
@@ -805,26 +826,38 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit,
                                                    StatName tag_extracted_name,
                                                    const StatNameTagVector& stat_name_tags,
-                                                   SymbolTable& symbol_table)
+                                                   SymbolTable& symbol_table,
+                                                   uint32_t significant_bits)
     : HistogramImplHelper(name, tag_extracted_name, stat_name_tags, symbol_table), unit_(unit),
       used_(false), created_thread_id_(std::this_thread::get_id()), symbol_table_(symbol_table) {
-  histograms_[0] = hist_alloc();
-  histograms_[1] = hist_alloc();
+  if (significant_bits != 0) {
+    log_linear_histogram_ = std::make_unique<LogLinearHistogram>(significant_bits);
+  } else {
+    histograms_[0] = hist_alloc();
+    histograms_[1] = hist_alloc();
+  }
 }
 
 ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
   MetricImpl::clear(symbol_table_);
-  hist_free(histograms_[0]);
-  hist_free(histograms_[1]);
+  if (log_linear_histogram_ == nullptr) {
+    hist_free(histograms_[0]);
+    hist_free(histograms_[1]);
+  }
 }
 
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
-  hist_insert_intscale(histograms_[current_active_], value, 0, 1);
+  if (log_linear_histogram_ != nullptr) {
+    log_linear_histogram_->recordValue(value);
+  } else {
+    hist_insert_intscale(histograms_[current_active_], value, 0, 1);
+  }
   used_ = true;
 }
 
 void ThreadLocalHistogramImpl::merge(histogram_t* target) {
+  ASSERT(log_linear_histogram_ == nullptr);
   histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
   hist_accumulate(target, other_histogram, 1);
   hist_clear(*other_histogram);
@@ -834,12 +867,14 @@ ParentHistogramImpl::ParentHistogramImpl(StatName name, Histogram::Unit unit,
                                          ThreadLocalStoreImpl& thread_local_store,
                                          StatName tag_extracted_name,
                                          const StatNameTagVector& stat_name_tags,
-                                         ConstSupportedBuckets& supported_buckets, uint64_t id)
+                                         ConstSupportedBuckets& supported_buckets, uint64_t id,
+                                         uint32_t significant_bits)
     : MetricImpl(name, tag_extracted_name, stat_name_tags, thread_local_store.symbolTable()),
       unit_(unit), thread_local_store_(thread_local_store), interval_histogram_(hist_alloc()),
       cumulative_histogram_(hist_alloc()),
       interval_statistics_(interval_histogram_, unit, supported_buckets),
-      cumulative_statistics_(cumulative_histogram_, unit, supported_buckets), id_(id) {}
+      cumulative_statistics_(cumulative_histogram_, unit, supported_buckets), id_(id),
+      significant_bits_(significant_bits) {}
 
 ParentHistogramImpl::~ParentHistogramImpl() {
   thread_local_store_.releaseHistogramCrossThread(id_);
@@ -920,8 +955,16 @@ void ParentHistogramImpl::merge() {
     // then release the lock before we do the actual merge. However it is not a big deal
     // because the tls_histogram merge is not that expensive as it is a single histogram
     // merge and adding TLS histograms is rare.
-    for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+    if (significant_bits_ != 0) {
+      absl::InlinedVector<LogLinearHistogram*, 16> log_linear_histograms;
+      for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
+        log_linear_histograms.push_back(tls_histogram->logLinearHistogram());
+      }
+      LogLinearHistogram::mergeIntervals(log_linear_histograms, interval_histogram_);
+    } else {
+      for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
+        tls_histogram->merge(interval_histogram_);
+      }
     }
     // Since TLS merge is done, we can release the lock here.
     lock.release();
@@ -1079,6 +1122,19 @@ void ThreadLocalStoreImpl::forEachSinkedHistogram(SizeFn f_size,
   }
 }
 
+void ThreadLocalStoreImpl::forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) {
+  alloc_.forEachChangedSinkedCounter(f_size, f_stat);
+}
+
+void ThreadLocalStoreImpl::forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) {
+  alloc_.forEachChangedSinkedGauge(f_size, f_stat);
+}
+
+bool ThreadLocalStoreImpl::trackChangedStats() {
+  alloc_.trackChangedStats();
+  return true;
+}
+
 void ThreadLocalStoreImpl::setSinkPredicates(std::unique_ptr<SinkPredicates>&& sink_predicates) {
   ASSERT(sink_predicates != nullptr);
   if (sink_predicates != nullptr) {
@@ -14,6 +14,7 @@
 #include "source/common/common/thread_synchronizer.h"
 #include "source/common/stats/allocator_impl.h"
 #include "source/common/stats/histogram_impl.h"
+#include "source/common/stats/log_linear_histogram.h"
 #include "source/common/stats/null_counter.h"
 #include "source/common/stats/null_gauge.h"
 #include "source/common/stats/null_text_readout.h"
@@ -33,8 +34,13 @@ namespace Stats {
  */
 class ThreadLocalHistogramImpl : public HistogramImplHelper {
 public:
+  /**
+   * @param significant_bits if non-zero, values are recorded into a LogLinearHistogram with the
+   *        given precision instead of a circllhist.
+   */
   ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit, StatName tag_extracted_name,
-                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table);
+                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table,
+                           uint32_t significant_bits = 0);
   ~ThreadLocalHistogramImpl() override;
 
   void merge(histogram_t* target);
@@ -49,6 +55,12 @@ public:
     current_active_ = otherHistogramIndex();
   }
 
+  /**
+   * @return the log-linear histogram values are recorded into, or nullptr if values are recorded
+   *         into circllhists. A log-linear histogram is merged without calling beginMerge().
+   */
+  LogLinearHistogram* logLinearHistogram() { return log_linear_histogram_.get(); }
+
   // Stats::Histogram
   Histogram::Unit unit() const override {
     // If at some point ThreadLocalHistogramImpl will hold a pointer to its parent we can just
@@ -66,7 +78,8 @@ private:
   Histogram::Unit unit_;
   uint64_t otherHistogramIndex() const { return 1 - current_active_; }
   uint64_t current_active_{0};
-  histogram_t* histograms_[2];
+  histogram_t* histograms_[2]{};
+  std::unique_ptr<LogLinearHistogram> log_linear_histogram_;
   std::atomic<bool> used_;
   std::thread::id created_thread_id_;
   SymbolTable& symbol_table_;
@@ -83,7 +96,8 @@ class ParentHistogramImpl : public MetricImpl<ParentHistogram> {
 public:
   ParentHistogramImpl(StatName name, Histogram::Unit unit, ThreadLocalStoreImpl& parent,
                       StatName tag_extracted_name, const StatNameTagVector& stat_name_tags,
-                      ConstSupportedBuckets& supported_buckets, uint64_t id);
+                      ConstSupportedBuckets& supported_buckets, uint64_t id,
+                      uint32_t significant_bits = 0);
   ~ParentHistogramImpl() override;
 
   void addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr);
@@ -100,6 +114,11 @@ public:
    */
   void merge() override;
 
+  /**
+   * @return the precision of the log-linear TLS histograms, or 0 if TLS histograms use circllhist.
+   */
+  uint32_t significantBits() const { return significant_bits_; }
+
   const HistogramStatistics& intervalStatistics() const override { return interval_statistics_; }
   const HistogramStatistics& cumulativeStatistics() const override {
     return cumulative_statistics_;
@@ -144,6 +163,7 @@ private:
   std::atomic<bool> shutting_down_{false};
   std::atomic<uint32_t> ref_count_{0};
   const uint64_t id_; // Index into TlsCache::histogram_cache_.
+  const uint32_t significant_bits_;
 };
 
 using ParentHistogramImplSharedPtr = RefcountPtr<ParentHistogramImpl>;
@@ -203,9 +223,12 @@ public:
   void forEachSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) const override;
   void forEachSinkedTextReadout(SizeFn f_size, StatFn<TextReadout> f_stat) const override;
   void forEachSinkedHistogram(SizeFn f_size, StatFn<ParentHistogram> f_stat) const override;
+  void forEachChangedSinkedCounter(SizeFn f_size, StatFn<Counter> f_stat) override;
+  void forEachChangedSinkedGauge(SizeFn f_size, StatFn<Gauge> f_stat) override;
 
   void setSinkPredicates(std::unique_ptr<SinkPredicates>&& sink_predicates) override;
   OptRef<SinkPredicates> sinkPredicates() override { return sink_predicates_; }
+  bool trackChangedStats() override;
 
   /**
    * @return a thread synchronizer object used for controlling thread behavior in tests.
@@ -540,6 +563,10 @@ private:
   std::atomic<bool> threading_ever_initialized_{};
   std::atomic<bool> shutting_down_{};
   std::atomic<bool> merge_in_progress_{};
+  // Set once a thread other than the main thread records into a circllhist TLS histogram, which
+  // then needs that thread to swap its buffers before every merge. Histograms keep the
+  // representation they were created with, so this stays set until restart.
+  std::atomic<bool> worker_circllhist_histograms_{};
   OptRef<ThreadLocal::Instance> tls_;
 
   NullCounterImpl null_counter_;
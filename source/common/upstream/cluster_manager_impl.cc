@@ -1,5 +1,6 @@
 #include "source/common/upstream/cluster_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -23,6 +24,7 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/enum_to_int.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/hash.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/null_grpc_mux_impl.h"
 #include "source/common/config/utility.h"
@@ -1006,7 +1008,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPool(
     HostConstSharedPtr host, ResourcePriority priority, absl::optional<Http::Protocol> protocol,
     LoadBalancerContext* context) {
   // Select a host and create a connection pool for it if it does not already exist.
-  auto pool = httpConnPoolImpl(host, priority, protocol, context);
+  auto pool = httpConnPoolImpl(host, priority, protocol, context, true);
   if (pool == nullptr) {
     return absl::nullopt;
   }
@@ -1017,7 +1019,8 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPool(
         maybePreconnect(
             *this, parent_.cluster_manager_state_, [this, &priority, &protocol, &context]() {
               HostConstSharedPtr peek_host = peekAnotherHost(context);
-              return peek_host ? httpConnPoolImpl(peek_host, priority, protocol, context) : nullptr;
+              return peek_host ? httpConnPoolImpl(peek_host, priority, protocol, context, true)
+                               : nullptr;
             });
       },
       pool);
@@ -1172,7 +1175,10 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(ClusterManagerCluster& cm_
                                                         load_balancer_factory, host_map,
                                                         drop_overload, drop_category);
 
-  tls_.runOnAllThreads([info = cm_cluster.cluster().info(), params = std::move(params),
+  // Each worker gets a copy of the callback below, so share the update between them instead of
+  // copying the added and removed hosts, which include every host on a cluster update, per worker.
+  auto shared_params = std::make_shared<const ThreadLocalClusterUpdateParams>(std::move(params));
+  tls_.runOnAllThreads([info = cm_cluster.cluster().info(), params = std::move(shared_params),
                         add_or_update_cluster, load_balancer_factory, map = std::move(host_map),
                         cluster_initialization_object = std::move(cluster_initialization_object),
                         drop_overload, drop_category = std::move(drop_category)](
@@ -1236,7 +1242,7 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(ClusterManagerCluster& cm_
         cluster_manager->thread_local_clusters_[info->name()]->setDropOverload(drop_overload);
         cluster_manager->thread_local_clusters_[info->name()]->setDropCategory(drop_category);
       }
-      for (const auto& per_priority : params.per_priority_update_params_) {
+      for (const auto& per_priority : params->per_priority_update_params_) {
         cluster_manager->updateClusterMembership(
             info->name(), per_priority.priority_, per_priority.update_hosts_params_,
             per_priority.locality_weights_, per_priority.hosts_added_, per_priority.hosts_removed_,
@@ -1707,11 +1713,61 @@ ClusterManagerImpl::dumpClusterConfigs(const Matchers::StringMatcher& name_match
   return config_dump;
 }
 
+void ClusterManagerImpl::addSharedPoolWorker(const Http::SharedConnPool::OwnerSharedPtr& owner,
+                                             const std::shared_ptr<SharedPoolWorker>& worker) {
+  absl::MutexLock lock(&shared_pool_workers_mutex_);
+  auto it = std::upper_bound(shared_pool_workers_.begin(), shared_pool_workers_.end(),
+                             owner->dispatcher().name(),
+                             [](const std::string& name, const SharedPoolOwner& worker_owner) {
+                               return name < worker_owner.owner_->dispatcher().name();
+                             });
+  shared_pool_workers_.insert(it, SharedPoolOwner{owner, worker});
+}
+
+void ClusterManagerImpl::removeSharedPoolWorker(Event::Dispatcher& dispatcher) {
+  absl::MutexLock lock(&shared_pool_workers_mutex_);
+  shared_pool_workers_.erase(std::remove_if(shared_pool_workers_.begin(),
+                                            shared_pool_workers_.end(),
+                                            [&dispatcher](const SharedPoolOwner& owner) {
+                                              return &owner.owner_->dispatcher() == &dispatcher;
+                                            }),
+                             shared_pool_workers_.end());
+}
+
+absl::optional<ClusterManagerImpl::SharedPoolOwner>
+ClusterManagerImpl::sharedPoolOwner(Event::Dispatcher& dispatcher, const Host& host,
+                                    uint32_t owner_workers) {
+  absl::MutexLock lock(&shared_pool_workers_mutex_);
+  const size_t num_workers = shared_pool_workers_.size();
+  auto self = std::find_if(
+      shared_pool_workers_.begin(), shared_pool_workers_.end(),
+      [&dispatcher](const SharedPoolOwner& owner) {
+        return &owner.owner_->dispatcher() == &dispatcher;
+      });
+  if (self == shared_pool_workers_.end() || num_workers < 2) {
+    return absl::nullopt;
+  }
+  // The owners of a host are the owner_workers workers starting at the one its address hashes
+  // to. Each of the other workers always hands over to the same one of them.
+  const size_t owners = std::min<size_t>(owner_workers, num_workers);
+  const size_t first_owner = HashUtil::xxHash64(host.address()->asStringView()) % num_workers;
+  const size_t self_index = self - shared_pool_workers_.begin();
+  if ((self_index + num_workers - first_owner) % num_workers < owners) {
+    return absl::nullopt;
+  }
+  return shared_pool_workers_[(first_owner + self_index % owners) % num_workers];
+}
+
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl(
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<LocalClusterParams>& local_cluster_params)
     : parent_(parent), thread_local_dispatcher_(dispatcher), cdm_(dispatcher.name(), *this),
       local_stats_(generateStats(*parent.stats_.rootScope(), dispatcher.name())) {
+  if (&dispatcher != &parent.dispatcher_) {
+    shared_pool_worker_ = std::make_shared<SharedPoolWorker>(SharedPoolWorker{*this});
+    shared_pool_owner_ = std::make_shared<Http::SharedConnPool::Owner>(dispatcher);
+    parent.addSharedPoolWorker(shared_pool_owner_, shared_pool_worker_);
+  }
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_params.has_value()) {
     const auto& local_cluster_name = local_cluster_params->info_->name();
@@ -1730,6 +1786,15 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   // member update callback registered with the local cluster.
   ENVOY_LOG(debug, "shutting down thread local cluster manager");
   destroying_ = true;
+  if (shared_pool_worker_ != nullptr) {
+    parent_.removeSharedPoolWorker(thread_local_dispatcher_);
+    // The dispatcher no longer runs, so the streams handed over to this worker that it hasn't
+    // taken over yet never will be. They are failed, and the other workers use connections of
+    // their own from now on. The streams it has taken over are reset when its pools are
+    // destroyed below.
+    shared_pool_owner_->shutdown();
+    shared_pool_worker_.reset();
+  }
   host_http_conn_pool_map_.clear();
   host_tcp_conn_pool_map_.clear();
   ASSERT(host_tcp_conn_map_.empty());
@@ -1920,7 +1985,8 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry()
 Http::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImpl(
     HostConstSharedPtr host, ResourcePriority priority,
-    absl::optional<Http::Protocol> downstream_protocol, LoadBalancerContext* context) {
+    absl::optional<Http::Protocol> downstream_protocol, LoadBalancerContext* context,
+    bool allow_shared) {
   if (!host) {
     return nullptr;
   }
@@ -1965,18 +2031,36 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     context->downstreamConnection()->hashKey(hash_key);
   }
 
+  // Streams can only be handed over to another worker if they would be multiplexed over the same
+  // connections there, i.e. they don't need connections of their own.
+  const auto& http_protocol_options = cluster_info_->upstreamHttpProtocolOptions();
+  const bool share_pool =
+      allow_shared && http_protocol_options.has_value() &&
+      http_protocol_options->has_shared_connection_pool() && upstream_options->empty() &&
+      !have_transport_socket_options && !cluster_info_->connectionPoolPerDownstreamConnection() &&
+      std::none_of(upstream_protocols.begin(), upstream_protocols.end(), [](Http::Protocol p) {
+        return p == Http::Protocol::Http10 || p == Http::Protocol::Http11;
+      });
+
   ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
 
   // Note: to simplify this, we assume that the factory is only called in the scope of this
   // function. Otherwise, we'd need to capture a few of these variables by value.
   ConnPoolsContainer::ConnPools::PoolOptRef pool =
       container.pools_->getPool(priority, hash_key, [&]() {
-        auto pool = parent_.parent_.factory_.allocateConnPool(
-            parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
-            alternate_protocol_options, !upstream_options->empty() ? upstream_options : nullptr,
-            have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
-            parent_.parent_.time_source_, parent_.cluster_manager_state_, quic_info_,
-            parent_.getNetworkObserverRegistry());
+        Http::ConnectionPool::InstancePtr pool;
+        if (share_pool) {
+          pool = allocateSharedConnPool(host, priority, downstream_protocol, upstream_protocols,
+                                        alternate_protocol_options);
+        }
+        if (pool == nullptr) {
+          pool = parent_.parent_.factory_.allocateConnPool(
+              parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
+              alternate_protocol_options, !upstream_options->empty() ? upstream_options : nullptr,
+              have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
+              parent_.parent_.time_source_, parent_.cluster_manager_state_, quic_info_,
+              parent_.getNetworkObserverRegistry());
+        }
 
         pool->addIdleCallback([&parent = parent_, host, priority, hash_key]() {
           parent.httpConnPoolIsIdle(host, priority, hash_key);
@@ -1992,6 +2076,59 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
   }
 }
 
+Http::ConnectionPool::InstancePtr
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::allocateSharedConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority,
+    absl::optional<Http::Protocol> downstream_protocol,
+    const std::vector<Http::Protocol>& upstream_protocols,
+    const absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>&
+        alternate_protocol_options) {
+  const auto& config = cluster_info_->upstreamHttpProtocolOptions()->shared_connection_pool();
+  absl::optional<SharedPoolOwner> owner = parent_.parent_.sharedPoolOwner(
+      parent_.thread_local_dispatcher_, *host,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, owner_workers, 1));
+  if (!owner.has_value()) {
+    return nullptr;
+  }
+
+  // Runs on the owner's thread, where it is the only place the owner's worker is locked.
+  auto owner_pool_cb = [worker = std::move(owner->worker_), cluster_name = cluster_info_->name(),
+                        host, priority,
+                        downstream_protocol]() -> Http::ConnectionPool::Instance* {
+    std::shared_ptr<SharedPoolWorker> owner_worker = worker.lock();
+    if (owner_worker == nullptr) {
+      return nullptr;
+    }
+    ThreadLocalClusterManagerImpl& cluster_manager = owner_worker->cluster_manager_;
+    auto it = cluster_manager.thread_local_clusters_.find(cluster_name);
+    if (it == cluster_manager.thread_local_clusters_.end()) {
+      return nullptr;
+    }
+    // Don't create connections to hosts the owner has already removed.
+    const HostMapConstSharedPtr host_map = it->second->prioritySet().crossPriorityHostMap();
+    if (host_map != nullptr) {
+      auto host_it = host_map->find(host->address()->asStringView());
+      if (host_it == host_map->end() || host_it->second != host) {
+        return nullptr;
+      }
+    }
+    return it->second->httpConnPoolImpl(host, priority, downstream_protocol, nullptr, false);
+  };
+
+  // The local pool is only created from newStream(), which is only called through this entry.
+  auto local_pool_cb = [this, host, priority, upstream_protocols = upstream_protocols,
+                        alternate_protocol_options]() mutable {
+    return parent_.parent_.factory_.allocateConnPool(
+        parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
+        alternate_protocol_options, nullptr, nullptr, parent_.parent_.time_source_,
+        parent_.cluster_manager_state_, quic_info_, parent_.getNetworkObserverRegistry());
+  };
+
+  return std::make_unique<Http::SharedConnPool>(
+      parent_.thread_local_dispatcher_, owner->owner_, host, std::move(owner_pool_cb),
+      std::move(local_pool_cb), PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_queued_streams, 1024));
+}
+
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::httpConnPoolIsIdle(
     HostConstSharedPtr host, ResourcePriority priority, const std::vector<uint8_t>& hash_key) {
   if (destroying_) {
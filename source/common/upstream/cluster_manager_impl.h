@@ -33,6 +33,7 @@
 #include "source/common/http/async_client_impl.h"
 #include "source/common/http/http_server_properties_cache_impl.h"
 #include "source/common/http/http_server_properties_cache_manager_impl.h"
+#include "source/common/http/shared_conn_pool.h"
 #include "source/common/quic/envoy_quic_network_observer_registry_factory.h"
 #include "source/common/quic/quic_stat_names.h"
 #include "source/common/tcp/async_tcp_client_impl.h"
@@ -42,6 +43,8 @@
 #include "source/common/upstream/priority_conn_pool_map.h"
 #include "source/common/upstream/upstream_impl.h"
 
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -517,6 +520,8 @@ private:
   // To enable access to the protected constructor.
   friend ProdClusterManagerFactory;
 
+  struct SharedPoolWorker;
+
   /**
    * Thread local cached cluster data. Each thread local cluster gets updates from the parent
    * central dynamic cluster (if applicable). It maintains load balancer state and any created
@@ -637,7 +642,16 @@ private:
       Http::ConnectionPool::Instance*
       httpConnPoolImpl(HostConstSharedPtr host, ResourcePriority priority,
                        absl::optional<Http::Protocol> downstream_protocol,
-                       LoadBalancerContext* context);
+                       LoadBalancerContext* context, bool allow_shared);
+
+      // Creates a pool handing its streams over to the worker owning the connections to the
+      // host, or returns nullptr if this worker is an owner itself.
+      Http::ConnectionPool::InstancePtr allocateSharedConnPool(
+          const HostConstSharedPtr& host, ResourcePriority priority,
+          absl::optional<Http::Protocol> downstream_protocol,
+          const std::vector<Http::Protocol>& upstream_protocols,
+          const absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>&
+              alternate_protocol_options);
 
       Tcp::ConnectionPool::Instance* tcpConnPoolImpl(HostConstSharedPtr host,
                                                      ResourcePriority priority,
@@ -755,6 +769,9 @@ private:
     bool destroying_{};
     ClusterDiscoveryManager cdm_;
     ThreadLocalClusterManagerStats local_stats_;
+    // Set on workers, which can own the connections of shared HTTP connection pools.
+    std::shared_ptr<SharedPoolWorker> shared_pool_worker_;
+    Http::SharedConnPool::OwnerSharedPtr shared_pool_owner_;
 
   private:
     static ThreadLocalClusterManagerStats generateStats(Stats::Scope& scope,
@@ -903,6 +920,35 @@ private:
 protected:
   ClusterInitializationMap cluster_initialization_map_;
 
+  // A worker which can own the connections of shared HTTP connection pools.
+  struct SharedPoolWorker {
+    ThreadLocalClusterManagerImpl& cluster_manager_;
+  };
+
+  struct SharedPoolOwner {
+    Http::SharedConnPool::OwnerSharedPtr owner_;
+    // Only locked on the owner's thread, which is also where it expires.
+    std::weak_ptr<SharedPoolWorker> worker_;
+  };
+
+  void addSharedPoolWorker(const Http::SharedConnPool::OwnerSharedPtr& owner,
+                           const std::shared_ptr<SharedPoolWorker>& worker);
+  void removeSharedPoolWorker(Event::Dispatcher& dispatcher);
+  /**
+   * Picks the worker that streams from the given worker to a host are handed over to.
+   * @return absl::nullopt if the given worker is one of the owner_workers owners of the host, or
+   *         if there is no other worker.
+   */
+  absl::optional<SharedPoolOwner> sharedPoolOwner(Event::Dispatcher& dispatcher, const Host& host,
+                                                  uint32_t owner_workers);
+
+  // Declared before tls_, as the thread local cluster managers unregister themselves when they are
+  // destroyed along with it.
+  absl::Mutex shared_pool_workers_mutex_;
+  // Sorted by the name of their dispatcher, so that hosts are assigned to the same workers
+  // across restarts.
+  std::vector<SharedPoolOwner> shared_pool_workers_ ABSL_GUARDED_BY(shared_pool_workers_mutex_);
+
 private:
   /**
    * Builds the cluster initialization object for this given cluster.
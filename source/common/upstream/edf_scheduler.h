@@ -1,12 +1,19 @@
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <iosfwd>
+#include <list>
 #include <queue>
+#include <type_traits>
+#include <vector>
 
 #include "envoy/upstream/scheduler.h"
 
 #include "source/common/common/assert.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -25,16 +32,24 @@ namespace Upstream {
 // Each pick from the schedule has the earliest deadline entry selected. Entries have deadlines set
 // at current time + 1 / weight, providing weighted round robin behavior with floating point
 // weights and an O(log n) pick time.
-template <class C> class EdfScheduler : public Scheduler<C> {
+//
+// When Updatable is set (see UpdatableEdfScheduler below), the scheduler keeps track of its
+// entries: an entry is scheduled at most once, and besides being dropped lazily once it expires,
+// it can be removed or given a new weight in place, so that a schedule can follow changes to its
+// entries without being rebuilt. Entries that are removed or rescheduled are left in the queue and
+// skipped when they reach its top; once they outnumber the scheduled entries, the queue is
+// compacted. Otherwise, entries are only added and none of this bookkeeping is paid for.
+template <class C, bool Updatable = false> class EdfScheduler : public Scheduler<C> {
 public:
   EdfScheduler() = default;
 
   // See scheduler.h for an explanation of each public method.
   std::shared_ptr<C> peekAgain(std::function<double(const C&)> calculate_weight) override {
-    std::shared_ptr<C> ret = popEntry();
+    uint64_t generation;
+    std::shared_ptr<C> ret = popEntry(generation);
     if (ret) {
       prepick_list_.push_back(ret);
-      add(calculate_weight(*ret), ret);
+      push(calculate_weight(*ret), ret, generation);
     }
     return ret;
   }
@@ -48,24 +63,101 @@ public:
         return ret;
       }
     }
-    std::shared_ptr<C> ret = popEntry();
+    uint64_t generation;
+    std::shared_ptr<C> ret = popEntry(generation);
     if (ret) {
-      add(calculate_weight(*ret), ret);
+      push(calculate_weight(*ret), ret, generation);
     }
     return ret;
   }
 
+  // With Updatable, adding an entry that is already scheduled reschedules it with the given weight.
   void add(double weight, std::shared_ptr<C> entry) override {
-    ASSERT(weight > 0);
-    const double deadline = current_time_ + 1.0 / weight;
-    EDF_TRACE("Insertion {} in queue with deadline {} and weight {}.",
-              static_cast<const void*>(entry.get()), deadline, weight);
-    queue_.push({deadline, order_offset_++, entry});
-    ASSERT(queue_.top().deadline_ >= current_time_);
+    if constexpr (Updatable) {
+      auto [it, inserted] = tracked_.try_emplace(entry.get());
+      if (!inserted) {
+        // The entry, or an expired entry that lived at the same address, is still queued.
+        staleEntryAdded();
+      }
+      schedule(it->second, weight, std::move(entry));
+    } else {
+      push(weight, std::move(entry), 0);
+    }
   }
 
   bool empty() const override { return queue_.empty(); }
 
+  /**
+   * Reschedules an entry with a new weight, as if it had just been added with that weight.
+   * O(log n).
+   * @return false if the entry is not scheduled.
+   */
+  bool update(double weight, const std::shared_ptr<C>& entry) {
+    static_assert(Updatable, "only an UpdatableEdfScheduler can update its entries");
+    auto it = tracked_.find(entry.get());
+    if (it == tracked_.end() || it->second.entry_.expired()) {
+      return false;
+    }
+    staleEntryAdded();
+    schedule(it->second, weight, entry);
+    return true;
+  }
+
+  /**
+   * Removes an entry from the schedule. O(1) amortized.
+   * @return false if the entry is not scheduled.
+   */
+  bool remove(const C& entry) {
+    static_assert(Updatable, "only an UpdatableEdfScheduler can remove its entries");
+    auto it = tracked_.find(&entry);
+    if (it == tracked_.end() || it->second.entry_.expired()) {
+      return false;
+    }
+    tracked_.erase(it);
+    removeFromPrepickList([&entry](const C& prepicked) { return &prepicked == &entry; });
+    staleEntryAdded();
+    return true;
+  }
+
+  /**
+   * Removes all scheduled entries matching a predicate, as well as any expired entries. O(n).
+   */
+  template <class Predicate> void removeIf(Predicate predicate) {
+    static_assert(Updatable, "only an UpdatableEdfScheduler can remove its entries");
+    const size_t tracked = tracked_.size();
+    absl::erase_if(tracked_, [&predicate](const auto& it) {
+      std::shared_ptr<C> entry = it.second.entry_.lock();
+      return entry == nullptr || predicate(*entry);
+    });
+    if (tracked_.size() != tracked) {
+      removeFromPrepickList(predicate);
+      stale_entries_ += tracked - tracked_.size();
+      maybeCompact();
+    }
+  }
+
+  /**
+   * @return the weight an entry was last added or updated with, or nullopt if it is not scheduled.
+   *         This is not the weight that picks reschedule the entry with.
+   */
+  absl::optional<double> weight(const C& entry) const {
+    static_assert(Updatable, "only an UpdatableEdfScheduler keeps track of its entries");
+    auto it = tracked_.find(&entry);
+    if (it == tracked_.end() || it->second.entry_.expired()) {
+      return absl::nullopt;
+    }
+    return it->second.weight_;
+  }
+
+  /**
+   * @return the number of scheduled entries, including expired entries that have not been dropped
+   *         yet.
+   */
+  size_t size() const {
+    static_assert(Updatable, "only an UpdatableEdfScheduler keeps track of its entries");
+    return tracked_.size();
+  }
+
   // Creates an EdfScheduler with the given weights and their corresponding
   // entries, and emulating a number of initial picks to be performed. Note that
   // the internal state of the scheduler will be very similar to creating an empty
@@ -75,9 +167,9 @@ public:
   // may be chosen a bit differently (the order_offset_ values may be different).
   // Breaking the ties of same weight entries will be kept in future picks from
   // the scheduler.
-  static EdfScheduler<C> createWithPicks(const std::vector<std::shared_ptr<C>>& entries,
-                                         std::function<double(const C&)> calculate_weight,
-                                         uint32_t picks) {
+  static EdfScheduler createWithPicks(const std::vector<std::shared_ptr<C>>& entries,
+                                      std::function<double(const C&)> calculate_weight,
+                                      uint32_t picks) {
     // Limiting the number of picks, as over 400M picks should be sufficient
     // for most scenarios.
     picks = picks % 429496729; // % UINT_MAX/10
@@ -90,9 +182,17 @@ public:
 
     // Nothing to do if there are no entries.
     if (entries.empty()) {
-      return EdfScheduler<C>();
+      return EdfScheduler();
     }
 
+    // Take a snapshot of entry weights so they remain consistent during scheduling.
+    std::vector<double> entry_weights;
+    entry_weights.reserve(entries.size());
+    std::transform(entries.cbegin(), entries.cend(), std::back_inserter(entry_weights),
+                   [&calculate_weight](const std::shared_ptr<C>& entry) {
+                     return calculate_weight(*entry);
+                   });
+
     // Augment the weight computation to add some epsilon to each entry's
     // weight to avoid cases where weights are multiplies of each other. For
     // example if there are 2 weights: 25 and 75, and picks=23, then the
@@ -102,17 +202,10 @@ public:
     // and picking 23 times. Adding a small value to each weight circumvents
     // this problem. This was added as a result of the following comment:
     // https://github.com/envoyproxy/envoy/pull/31592#issuecomment-1877663769.
-    auto aug_calculate_weight = [&calculate_weight](const C& entry) -> double {
-      return calculate_weight(entry) + 1e-13;
-    };
-
-    // Take a snapshot of entry weights so they remain consistent during scheduling.
     std::vector<double> weights;
     weights.reserve(entries.size());
-    std::transform(entries.cbegin(), entries.cend(), std::back_inserter(weights),
-                   [&aug_calculate_weight](const std::shared_ptr<C>& entry) {
-                     return aug_calculate_weight(*entry);
-                   });
+    std::transform(entry_weights.cbegin(), entry_weights.cend(), std::back_inserter(weights),
+                   [](double weight) { return weight + 1e-13; });
     // Let weights {w_1, w_2, ..., w_N} be the per-entry weight where (w_i > 0),
     // W = sum(w_i), and P be the number of times to "pick" from the scheduler.
     // Let p'_i = floor(P * w_i/W), then the number of times each entry is being
@@ -132,6 +225,11 @@ public:
     // Pre-compute the priority-queue entries to use an O(N) initialization c'tor.
     std::vector<EdfEntry> scheduler_entries;
     scheduler_entries.reserve(entries.size());
+    absl::flat_hash_map<const C*, Tracked> tracked;
+    if constexpr (Updatable) {
+      tracked.reserve(entries.size());
+    }
+    uint64_t stale_entries = 0;
     uint32_t picks_so_far = 0;
     double max_pick_time = 0.0;
     // Emulate a per-entry addition to a deadline that is applicable to N picks.
@@ -151,12 +249,22 @@ public:
       const double deadline = (floor_picks[i] + 1) / weight;
       EDF_TRACE("Insertion {} in queue with emualted {} picks, deadline {} and weight {}.",
                 static_cast<const void*>(entries[i].get()), floor_picks[i], deadline, weight);
-      scheduler_entries.emplace_back(EdfEntry{deadline, i, entries[i]});
+      const uint64_t generation = i + 1;
+      if constexpr (Updatable) {
+        if (!tracked
+                 .try_emplace(entries[i].get(), Tracked{entries[i], generation, entry_weights[i]})
+                 .second) {
+          // Only the first occurrence of a duplicated entry remains scheduled.
+          stale_entries++;
+        }
+      }
+      scheduler_entries.emplace_back(makeEntry(deadline, i, entries[i], generation));
       max_pick_time = std::max(max_pick_time, pick_time);
       picks_so_far += floor_picks[i];
     }
     // The scheduler's current_time_ needs to be the largest time that some entry was picked.
-    EdfScheduler<C> scheduler(std::move(scheduler_entries), max_pick_time, entries.size());
+    EdfScheduler scheduler(std::move(scheduler_entries), std::move(tracked), stale_entries,
+                           max_pick_time, entries.size());
     ASSERT(scheduler.queue_.top().deadline_ >= scheduler.current_time_);
 
     // Left to do some picks, execute them one after the other.
@@ -172,10 +280,101 @@ public:
 private:
   friend class EdfSchedulerTest;
 
+  struct QueueEntryId {
+    // Identifies the queue entry among the ones for the same entry. Entries that were removed or
+    // rescheduled since this queue entry was pushed are stale and skipped.
+    uint64_t generation_;
+    // Address of the entry, which identifies it even after it expired.
+    const C* address_;
+  };
+  struct NoQueueEntryId {};
+
+  struct EdfEntry : public std::conditional_t<Updatable, QueueEntryId, NoQueueEntryId> {
+    double deadline_;
+    // Tie breaker for entries with the same deadline. This is used to provide FIFO behavior.
+    uint64_t order_offset_;
+    // We only hold a weak pointer, which allows entries to be lazily unloaded from the queue once
+    // they expire.
+    std::weak_ptr<C> entry_;
+
+    // Flip < direction to make this a min queue.
+    bool operator<(const EdfEntry& other) const {
+      return deadline_ > other.deadline_ ||
+             (deadline_ == other.deadline_ && order_offset_ > other.order_offset_);
+    }
+  };
+
+  struct Tracked {
+    std::weak_ptr<C> entry_;
+    // Generation of the queue entry that currently schedules the entry.
+    uint64_t generation_{};
+    // Weight the entry was last added or updated with.
+    double weight_{};
+  };
+
+  static EdfEntry makeEntry(double deadline, uint64_t order_offset, std::shared_ptr<C> entry,
+                            uint64_t generation) {
+    if constexpr (Updatable) {
+      const C* address = entry.get();
+      return {{generation, address}, deadline, order_offset, std::move(entry)};
+    } else {
+      return {{}, deadline, order_offset, std::move(entry)};
+    }
+  }
+
+  void schedule(Tracked& tracked, double weight, std::shared_ptr<C> entry) {
+    tracked.entry_ = entry;
+    tracked.generation_ = ++generation_;
+    tracked.weight_ = weight;
+    push(weight, std::move(entry), generation_);
+  }
+
+  void push(double weight, std::shared_ptr<C> entry, uint64_t generation) {
+    ASSERT(weight > 0);
+    const double deadline = current_time_ + 1.0 / weight;
+    EDF_TRACE("Insertion {} in queue with deadline {} and weight {}.",
+              static_cast<const void*>(entry.get()), deadline, weight);
+    queue_.push(makeEntry(deadline, order_offset_++, std::move(entry), generation));
+    ASSERT(queue_.top().deadline_ >= current_time_);
+  }
+
+  bool isCurrent(const C* entry, uint64_t generation) const {
+    auto it = tracked_.find(entry);
+    return it != tracked_.end() && it->second.generation_ == generation;
+  }
+
+  void staleEntryAdded() {
+    stale_entries_++;
+    maybeCompact();
+  }
+
+  // Drops the stale queue entries once they make up more than half of the queue, so that the queue
+  // stays within twice the number of scheduled entries at an amortized O(1) cost per stale entry.
+  void maybeCompact() {
+    if (stale_entries_ <= tracked_.size()) {
+      return;
+    }
+    std::vector<EdfEntry>& entries = queue_.entries();
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [this](const EdfEntry& edf_entry) {
+                                   return !isCurrent(edf_entry.address_, edf_entry.generation_);
+                                 }),
+                  entries.end());
+    std::make_heap(entries.begin(), entries.end());
+    stale_entries_ = 0;
+  }
+
+  template <class Predicate> void removeFromPrepickList(Predicate predicate) {
+    prepick_list_.remove_if([&predicate](const std::weak_ptr<C>& prepicked) {
+      std::shared_ptr<C> entry = prepicked.lock();
+      return entry != nullptr && predicate(*entry);
+    });
+  }
+
   /**
-   * Clears expired entries and pops the next unexpired entry in the queue.
+   * Clears expired and stale entries and pops the next scheduled entry in the queue.
    */
-  std::shared_ptr<C> popEntry() {
+  std::shared_ptr<C> popEntry(uint64_t& generation) {
     EDF_TRACE("Queue pick: queue_.size()={}, current_time_={}.", queue_.size(), current_time_);
     while (true) {
       if (queue_.empty()) {
@@ -187,9 +386,24 @@ private:
       std::shared_ptr<C> ret = edf_entry.entry_.lock();
       if (!ret) {
         EDF_TRACE("Entry has expired, repick.");
+        if constexpr (Updatable) {
+          dropExpired(edf_entry);
+        }
         queue_.pop();
         continue;
       }
+      if constexpr (Updatable) {
+        // Only look the entry up when there may be stale entries, to keep picks cheap otherwise.
+        if (stale_entries_ > 0 && !isCurrent(ret.get(), edf_entry.generation_)) {
+          EDF_TRACE("Entry has been removed or rescheduled, repick.");
+          stale_entries_--;
+          queue_.pop();
+          continue;
+        }
+        generation = edf_entry.generation_;
+      } else {
+        generation = 0;
+      }
       ASSERT(edf_entry.deadline_ >= current_time_);
       current_time_ = edf_entry.deadline_;
       EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()), current_time_);
@@ -198,25 +412,31 @@ private:
     }
   }
 
-  struct EdfEntry {
-    double deadline_;
-    // Tie breaker for entries with the same deadline. This is used to provide FIFO behavior.
-    uint64_t order_offset_;
-    // We only hold a weak pointer, since we don't support a remove operator. This allows entries to
-    // be lazily unloaded from the queue.
-    std::weak_ptr<C> entry_;
-
-    // Flip < direction to make this a min queue.
-    bool operator<(const EdfEntry& other) const {
-      return deadline_ > other.deadline_ ||
-             (deadline_ == other.deadline_ && order_offset_ > other.order_offset_);
+  void dropExpired(const EdfEntry& edf_entry) {
+    // The tracked entry may already belong to a new entry at the same address.
+    auto it = tracked_.find(edf_entry.address_);
+    if (it != tracked_.end() && it->second.generation_ == edf_entry.generation_) {
+      tracked_.erase(it);
+    } else {
+      ASSERT(stale_entries_ > 0);
+      stale_entries_--;
     }
+  }
+
+  // std::priority_queue with access to its container, so that stale entries can be dropped.
+  class Queue : public std::priority_queue<EdfEntry> {
+  public:
+    using std::priority_queue<EdfEntry>::priority_queue;
+    std::vector<EdfEntry>& entries() { return this->c; }
   };
 
-  EdfScheduler(std::vector<EdfEntry>&& scheduler_entries, double current_time,
-               uint32_t order_offset)
-      : current_time_(current_time), order_offset_(order_offset),
-        queue_(scheduler_entries.cbegin(), scheduler_entries.cend()) {}
+  EdfScheduler(std::vector<EdfEntry>&& scheduler_entries,
+               absl::flat_hash_map<const C*, Tracked>&& tracked, uint64_t stale_entries,
+               double current_time, uint32_t order_offset)
+      : current_time_(current_time), order_offset_(order_offset), generation_(order_offset),
+        stale_entries_(stale_entries),
+        queue_(scheduler_entries.cbegin(), scheduler_entries.cend()), tracked_(std::move(tracked)) {
+  }
 
   // Current time in EDF scheduler.
   // TODO(htuch): Is it worth the small extra complexity to use integer time for performance
@@ -225,11 +445,21 @@ private:
   // Offset used during addition to break ties when entries have the same weight but should reflect
   // FIFO insertion order in picks.
   uint64_t order_offset_{};
+  // Last generation assigned to a queue entry.
+  uint64_t generation_{};
+  // Number of queue entries for entries that have since been removed or rescheduled. Always 0
+  // unless Updatable.
+  uint64_t stale_entries_{};
   // Min priority queue for EDF.
-  std::priority_queue<EdfEntry> queue_;
+  Queue queue_;
+  // Scheduled entries, by address. Only used with Updatable.
+  absl::flat_hash_map<const C*, Tracked> tracked_;
   std::list<std::weak_ptr<C>> prepick_list_;
 };
 
+// An EdfScheduler that keeps track of its entries, so that they can be removed or rescheduled.
+template <class C> using UpdatableEdfScheduler = EdfScheduler<C, true>;
+
 #undef EDF_DEBUG
 
 } // namespace Upstream
@@ -356,8 +356,8 @@ void DetectorImpl::armIntervalTimer() {
       runtime_.snapshot().getInteger(IntervalMsRuntime, config_.intervalMs())));
 }
 
-void DetectorImpl::checkHostForUneject(HostSharedPtr host, DetectorHostMonitorImpl* monitor,
-                                       MonotonicTime now) {
+void DetectorImpl::checkHostForUneject(const HostSharedPtr& host,
+                                       DetectorHostMonitorImpl* monitor, MonotonicTime now) {
   if (!host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
     return;
   }
@@ -616,6 +616,18 @@ void DetectorImpl::onConsecutiveErrorWorker(HostSharedPtr host,
 DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
     double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
     double success_rate_stdev_factor) {
+  std::vector<double> success_rates;
+  success_rates.reserve(valid_success_rate_hosts.size());
+  for (const HostSuccessRatePair& host_success_rate_pair : valid_success_rate_hosts) {
+    success_rates.push_back(host_success_rate_pair.success_rate_);
+  }
+  return successRateEjectionThreshold(success_rate_sum, success_rates, success_rate_stdev_factor);
+}
+
+DetectorImpl::EjectionPair
+DetectorImpl::successRateEjectionThreshold(double success_rate_sum,
+                                           absl::Span<const double> success_rates,
+                                           double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
   // number of data points. Then variance is calculated by taking the mean of the
@@ -631,14 +643,14 @@ DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
+  const double mean = success_rate_sum / success_rates.size();
   double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  for (const double success_rate : success_rates) {
+    const double deviation = success_rate - mean;
+    variance += deviation * deviation;
+  }
+  variance /= success_rates.size();
+  const double stdev = std::sqrt(variance);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
@@ -654,8 +666,11 @@ void DetectorImpl::processSuccessRateEjections(
   uint64_t failure_percentage_request_volume = runtime_.snapshot().getInteger(
       FailurePercentageRequestVolumeRuntime, config_.failurePercentageRequestVolume());
 
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  std::vector<HostSuccessRatePair> valid_failure_percentage_hosts;
+  // The success rates of the valid hosts are kept in a contiguous array, so that computing the
+  // statistics of large clusters only walks over doubles. Hosts are only copied when ejected.
+  std::vector<double> success_rates;
+  std::vector<const HostSharedPtr*> success_rate_hosts;
+  std::vector<std::pair<const HostSharedPtr*, double>> failure_percentage_hosts;
   double success_rate_sum = 0;
 
   // Reset the Detector's success rate mean and stdev.
@@ -668,16 +683,15 @@ void DetectorImpl::processSuccessRateEjections(
   }
 
   // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-  valid_failure_percentage_hosts.reserve(host_monitors_.size());
+  success_rates.reserve(host_monitors_.size());
+  success_rate_hosts.reserve(host_monitors_.size());
+  failure_percentage_hosts.reserve(host_monitors_.size());
 
-  for (const auto& host : host_monitors_) {
+  for (const auto& [host, monitor] : host_monitors_) {
     // Don't do work if the host is already ejected.
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+    if (!host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
       absl::optional<std::pair<double, uint64_t>> host_success_rate_and_volume =
-          host.second->getSRMonitor(monitor_type)
-              .successRateAccumulator()
-              .getSuccessRateAndVolume();
+          monitor->getSRMonitor(monitor_type).successRateAccumulator().getSuccessRateAndVolume();
 
       if (!host_success_rate_and_volume) {
         continue;
@@ -687,89 +701,97 @@ void DetectorImpl::processSuccessRateEjections(
 
       if (request_volume >=
           std::min(success_rate_request_volume, failure_percentage_request_volume)) {
-        host.second->successRate(monitor_type, success_rate);
+        monitor->successRate(monitor_type, success_rate);
       }
 
       if (request_volume >= success_rate_request_volume) {
-        valid_success_rate_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
+        success_rates.push_back(success_rate);
+        success_rate_hosts.push_back(&host);
         success_rate_sum += success_rate;
       }
       if (request_volume >= failure_percentage_request_volume) {
-        valid_failure_percentage_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
+        failure_percentage_hosts.emplace_back(&host, success_rate);
       }
     }
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  // Outliers are collected before any of them is ejected, as ejecting runs callbacks.
+  std::vector<HostSharedPtr> success_rate_outliers;
+  if (!success_rates.empty() && success_rates.size() >= success_rate_minimum_hosts) {
     const double success_rate_stdev_factor =
         runtime_.snapshot().getInteger(SuccessRateStdevFactorRuntime,
                                        config_.successRateStdevFactor()) /
         1000.0;
-    getSRNums(monitor_type) = successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+    getSRNums(monitor_type) =
+        successRateEjectionThreshold(success_rate_sum, success_rates, success_rate_stdev_factor);
     const double success_rate_ejection_threshold = getSRNums(monitor_type).ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold) {
-        stats_.ejections_success_rate_.inc(); // Deprecated.
-        const envoy::data::cluster::v3::OutlierEjectionType type =
-            host_monitors_[host_success_rate_pair.host_]
-                ->getSRMonitor(monitor_type)
-                .getEjectionType();
-        updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+    for (size_t i = 0; i < success_rates.size(); ++i) {
+      if (success_rates[i] < success_rate_ejection_threshold) {
+        success_rate_outliers.push_back(*success_rate_hosts[i]);
       }
     }
   }
 
-  if (!valid_failure_percentage_hosts.empty() &&
-      valid_failure_percentage_hosts.size() >= failure_percentage_minimum_hosts) {
+  std::vector<HostSharedPtr> failure_percentage_outliers;
+  if (!failure_percentage_hosts.empty() &&
+      failure_percentage_hosts.size() >= failure_percentage_minimum_hosts) {
     const double failure_percentage_threshold = runtime_.snapshot().getInteger(
         FailurePercentageThresholdRuntime, config_.failurePercentageThreshold());
 
-    for (const auto& host_success_rate_pair : valid_failure_percentage_hosts) {
-      if ((100.0 - host_success_rate_pair.success_rate_) >= failure_percentage_threshold) {
-        // We should eject.
-
-        // The ejection type returned by the SuccessRateMonitor's getEjectionType() will be a
-        // SUCCESS_RATE type, so we need to figure it out for ourselves.
-        const envoy::data::cluster::v3::OutlierEjectionType type =
-            (monitor_type == DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)
-                ? envoy::data::cluster::v3::FAILURE_PERCENTAGE
-                : envoy::data::cluster::v3::FAILURE_PERCENTAGE_LOCAL_ORIGIN;
-        updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+    for (const auto& [host, success_rate] : failure_percentage_hosts) {
+      if ((100.0 - success_rate) >= failure_percentage_threshold) {
+        failure_percentage_outliers.push_back(*host);
       }
     }
   }
+
+  for (const HostSharedPtr& host : success_rate_outliers) {
+    stats_.ejections_success_rate_.inc(); // Deprecated.
+    const envoy::data::cluster::v3::OutlierEjectionType type =
+        host_monitors_[host]->getSRMonitor(monitor_type).getEjectionType();
+    updateDetectedEjectionStats(type);
+    ejectHost(host, type);
+  }
+
+  for (const HostSharedPtr& host : failure_percentage_outliers) {
+    // We should eject.
+
+    // The ejection type returned by the SuccessRateMonitor's getEjectionType() will be a
+    // SUCCESS_RATE type, so we need to figure it out for ourselves.
+    const envoy::data::cluster::v3::OutlierEjectionType type =
+        (monitor_type == DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)
+            ? envoy::data::cluster::v3::FAILURE_PERCENTAGE
+            : envoy::data::cluster::v3::FAILURE_PERCENTAGE_LOCAL_ORIGIN;
+    updateDetectedEjectionStats(type);
+    ejectHost(host, type);
+  }
 }
 
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
 
-  for (auto host : host_monitors_) {
-    checkHostForUneject(host.first, host.second, now);
+  for (const auto& [host, monitor] : host_monitors_) {
+    checkHostForUneject(host, monitor, now);
 
     // Need to update the writer bucket to keep the data valid.
-    host.second->updateCurrentSuccessRateBucket();
+    monitor->updateCurrentSuccessRateBucket();
     // Refresh host success rate stat for the /clusters endpoint. If there is a new valid value, it
     // will get updated in processSuccessRateEjections().
-    host.second->successRate(DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin, -1);
-    host.second->successRate(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin, -1);
+    monitor->successRate(DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin, -1);
+    monitor->successRate(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin, -1);
   }
 
   processSuccessRateEjections(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin);
   processSuccessRateEjections(DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin);
 
   // Decrement time backoff for all hosts which have not been ejected.
-  for (auto host : host_monitors_) {
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-      auto& monitor = host.second;
+  const std::chrono::milliseconds interval(
+      runtime_.snapshot().getInteger(IntervalMsRuntime, config_.intervalMs()));
+  for (const auto& [host, monitor] : host_monitors_) {
+    if (!host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
       // Node is healthy and was not ejected since the last check.
       if (monitor->lastUnejectionTime().has_value() &&
-          ((now - monitor->lastUnejectionTime().value()) >=
-           std::chrono::milliseconds(
-               runtime_.snapshot().getInteger(IntervalMsRuntime, config_.intervalMs())))) {
+          ((now - monitor->lastUnejectionTime().value()) >= interval)) {
         if (monitor->ejectTimeBackoff() != 0) {
           monitor->ejectTimeBackoff()--;
         }
@@ -24,6 +24,7 @@
 #include "source/common/upstream/upstream_impl.h"
 
 #include "absl/container/node_hash_map.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -100,9 +101,15 @@ public:
   void updateCurrentSuccessRateBucket() {
     success_rate_accumulator_bucket_.store(success_rate_accumulator_.updateCurrentWriter());
   }
-  void incTotalReqCounter() { success_rate_accumulator_bucket_.load()->total_request_counter_++; }
+  // The counters are only read on the main thread once the bucket has been swapped out at the end
+  // of an interval, so workers do not need to order their increments with anything else.
+  void incTotalReqCounter() {
+    success_rate_accumulator_bucket_.load(std::memory_order_relaxed)
+        ->total_request_counter_.fetch_add(1, std::memory_order_relaxed);
+  }
   void incSuccessReqCounter() {
-    success_rate_accumulator_bucket_.load()->success_request_counter_++;
+    success_rate_accumulator_bucket_.load(std::memory_order_relaxed)
+        ->success_request_counter_.fetch_add(1, std::memory_order_relaxed);
   }
 
   envoy::data::cluster::v3::OutlierEjectionType getEjectionType() const { return ejection_type_; }
@@ -416,6 +423,12 @@ public:
   successRateEjectionThreshold(double success_rate_sum,
                                const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
                                double success_rate_stdev_factor);
+  /**
+   * Same as above, over the success rates of the valid hosts only.
+   */
+  static EjectionPair successRateEjectionThreshold(double success_rate_sum,
+                                                   absl::Span<const double> success_rates,
+                                                   double success_rate_stdev_factor);
 
   const absl::node_hash_map<HostSharedPtr, DetectorHostMonitorImpl*>& getHostMonitors() {
     return host_monitors_;
@@ -428,7 +441,8 @@ private:
 
   void addHostMonitor(HostSharedPtr host);
   void armIntervalTimer();
-  void checkHostForUneject(HostSharedPtr host, DetectorHostMonitorImpl* monitor, MonotonicTime now);
+  void checkHostForUneject(const HostSharedPtr& host, DetectorHostMonitorImpl* monitor,
+                           MonotonicTime now);
   void ejectHost(HostSharedPtr host, envoy::data::cluster::v3::OutlierEjectionType type);
   static DetectionStats generateStats(Stats::Scope& scope);
   void initialize(Cluster& cluster);
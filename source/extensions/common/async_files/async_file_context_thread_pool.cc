@@ -1,7 +1,10 @@
 #include "source/extensions/common/async_files/async_file_context_thread_pool.h"
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -19,6 +22,23 @@ namespace AsyncFiles {
 
 namespace {
 
+absl::StatusOr<Buffer::InstancePtr> readIntoBuffer(Api::OsSysCalls& posix, int fd, off_t offset,
+                                                   size_t length) {
+  auto result = std::make_unique<Buffer::OwnedImpl>();
+  auto reservation = result->reserveSingleSlice(length);
+  auto bytes_read = posix.pread(fd, reservation.slice().mem_, length, offset);
+  if (bytes_read.return_value_ == -1) {
+    return statusAfterFileError(bytes_read);
+  }
+  if (static_cast<size_t>(bytes_read.return_value_) != length) {
+    result =
+        std::make_unique<Buffer::OwnedImpl>(reservation.slice().mem_, bytes_read.return_value_);
+  } else {
+    reservation.commit(bytes_read.return_value_);
+  }
+  return result;
+}
+
 template <typename T> class AsyncFileActionThreadPool : public AsyncFileActionWithResult<T> {
 public:
   explicit AsyncFileActionThreadPool(AsyncFileHandle handle,
@@ -118,18 +138,64 @@ public:
 
   absl::StatusOr<Buffer::InstancePtr> executeImpl() override {
     ASSERT(fileDescriptor() != -1);
+    return readIntoBuffer(posix(), fileDescriptor(), offset_, length_);
+  }
+
+private:
+  const off_t offset_;
+  const size_t length_;
+};
+
+class ActionReadMappedFile
+    : public AsyncFileActionThreadPool<absl::StatusOr<Buffer::InstancePtr>> {
+public:
+  ActionReadMappedFile(AsyncFileHandle handle, off_t offset, size_t length,
+                       absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete)
+      : AsyncFileActionThreadPool<absl::StatusOr<Buffer::InstancePtr>>(handle,
+                                                                       std::move(on_complete)),
+        offset_(offset), length_(length) {}
+
+  absl::StatusOr<Buffer::InstancePtr> executeImpl() override {
+    ASSERT(fileDescriptor() != -1);
+    struct stat stat_result;
+    auto stat = posix().fstat(fileDescriptor(), &stat_result);
+    if (stat.return_value_ != 0) {
+      return statusAfterFileError(stat);
+    }
     auto result = std::make_unique<Buffer::OwnedImpl>();
-    auto reservation = result->reserveSingleSlice(length_);
-    auto bytes_read = posix().pread(fileDescriptor(), reservation.slice().mem_, length_, offset_);
-    if (bytes_read.return_value_ == -1) {
-      return statusAfterFileError(bytes_read);
+    if (offset_ >= stat_result.st_size || length_ == 0) {
+      return result;
     }
-    if (static_cast<size_t>(bytes_read.return_value_) != length_) {
-      result =
-          std::make_unique<Buffer::OwnedImpl>(reservation.slice().mem_, bytes_read.return_value_);
-    } else {
-      reservation.commit(bytes_read.return_value_);
+    // Like pread, a read past the end of the file is short.
+    const size_t length = std::min<uint64_t>(length_, stat_result.st_size - offset_);
+    // Mappings must start on a page boundary.
+    static const off_t page_size = sysconf(_SC_PAGESIZE);
+    const off_t map_offset = offset_ - offset_ % page_size;
+    const size_t map_length = length + (offset_ - map_offset);
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // Fault the pages in on this thread, so that the thread consuming the buffer doesn't block on
+    // the disk.
+    flags |= MAP_POPULATE;
+#endif
+    auto mapped = posix().mmap(nullptr, map_length, PROT_READ, flags, fileDescriptor(), map_offset);
+    if (mapped.return_value_ == MAP_FAILED) {
+      if (mapped.errno_ == ENOMEM) {
+        // Out of mappings (or address space); the contents are still readable by copying them.
+        return readIntoBuffer(posix(), fileDescriptor(), offset_, length);
+      }
+      return statusAfterFileError(mapped);
     }
+    void* mem = mapped.return_value_;
+    // The buffer may outlive the file handle, so it holds on to the OS interface, which outlives
+    // the manager (it's either the process-wide singleton, or a substitute owned by a test).
+    result->addBufferFragment(*new Buffer::BufferFragmentImpl(
+        static_cast<const char*>(mem) + (offset_ - map_offset), length,
+        [posix = &posix(), mem, map_length](const void*, size_t,
+                                            const Buffer::BufferFragmentImpl* fragment) {
+          posix->munmap(mem, map_length);
+          delete fragment;
+        }));
     return result;
   }
 
@@ -248,6 +314,13 @@ absl::StatusOr<CancelFunction> AsyncFileContextThreadPool::read(
                                                                           std::move(on_complete)));
 }
 
+absl::StatusOr<CancelFunction> AsyncFileContextThreadPool::readMapped(
+    Event::Dispatcher* dispatcher, off_t offset, size_t length,
+    absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionReadMappedFile>(
+                                             handle(), offset, length, std::move(on_complete)));
+}
+
 absl::StatusOr<CancelFunction>
 AsyncFileContextThreadPool::write(Event::Dispatcher* dispatcher, Buffer::Instance& contents,
                                   off_t offset,
@@ -52,6 +52,17 @@ public:
   read(Event::Dispatcher* dispatcher, off_t offset, size_t length,
        absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) PURE;
 
+  // Enqueues an action like read, except that the buffer passed to on_complete references the
+  // file contents mapped into memory instead of a copy of them, so that serving a large read does
+  // not copy it through a user-space buffer. The pages are faulted in by the action, and unmapped
+  // once the buffer is drained; the mapping stays valid after the file is closed or unlinked.
+  // If the process is out of mappings, the contents are copied as by read instead.
+  //
+  // The file must not be truncated while any part of it is mapped, or accessing the buffer faults.
+  virtual absl::StatusOr<CancelFunction>
+  readMapped(Event::Dispatcher* dispatcher, off_t offset, size_t length,
+             absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) PURE;
+
   // Enqueues an action to write to the currently open file, at position offset, the bytes contained
   // by contents. It is an error to call write on an AsyncFileContext that does not have a file
   // open.
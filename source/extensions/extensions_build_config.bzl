@@ -336,7 +336,9 @@ EXTENSIONS = {
     # CacheFilter plugins
     #
     "envoy.extensions.http.cache.file_system_http_cache": "//source/extensions/http/cache/file_system_http_cache:config",
+    "envoy.extensions.http.cache.memory_http_cache":    "//source/extensions/http/cache/memory_http_cache:config",
     "envoy.extensions.http.cache.simple":               "//source/extensions/http/cache/simple_http_cache:config",
+    "envoy.extensions.http.cache.tiered_http_cache":    "//source/extensions/http/cache/tiered_http_cache:config",
 
     #
     # Internal redirect predicates
@@ -484,6 +486,12 @@ EXTENSIONS = {
     # getaddrinfo DNS resolver extension can be used when the system resolver is desired (e.g., Android)
     "envoy.network.dns_resolver.getaddrinfo":          "//source/extensions/network/dns_resolver/getaddrinfo:config",
 
+    #
+    # Connection balancers
+    #
+
+    "envoy.network.connection_balance.load_aware":     "//source/extensions/network/connection_balance/load_aware:config",
+
     #
     # Custom matchers
     #
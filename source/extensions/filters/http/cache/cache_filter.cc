@@ -43,7 +43,10 @@ CacheFilterConfig::CacheFilterConfig(
     Server::Configuration::CommonFactoryContext& context)
     : vary_allow_list_(config.allowed_vary_headers(), context), time_source_(context.timeSource()),
       ignore_request_cache_control_header_(config.ignore_request_cache_control_header()),
-      cluster_manager_(context.clusterManager()) {}
+      cluster_manager_(context.clusterManager()),
+      in_flight_inserts_(config.has_request_coalescing()
+                             ? std::make_shared<InFlightInserts>(config.request_coalescing())
+                             : nullptr) {}
 
 CacheFilter::CacheFilter(std::shared_ptr<const CacheFilterConfig> config,
                          std::shared_ptr<HttpCache> http_cache)
@@ -127,6 +130,10 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
                                config_->ignoreRequestCacheControlHeader());
   request_allows_inserts_ = !lookup_request.requestCacheControl().no_store_;
   is_head_request_ = headers.getMethodValue() == Http::Headers::get().MethodValues.Head;
+  // Only requests that would insert the response into the cache can lead a coalesced cache miss.
+  if (config_->inFlightInserts() != nullptr && request_allows_inserts_ && !is_head_request_) {
+    coalescing_key_ = lookup_request.key();
+  }
   lookup_ = cache_->makeLookupContext(std::move(lookup_request), *decoder_callbacks_);
 
   ASSERT(lookup_);
@@ -157,7 +164,7 @@ Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::ResponseHeaderMap& he
     return Http::FilterHeadersStatus::Continue;
   }
 
-  if (lookup_result_ == nullptr) {
+  if (lookup_result_ == nullptr || awaiting_in_flight_insert_) {
     // Filter chain iteration is paused while a lookup is outstanding, but the filter chain manager
     // can still generate a local reply. One case where this can happen is when a downstream idle
     // timeout fires, which may mean that the HttpCache isn't correctly setting deadlines on its
@@ -244,6 +251,49 @@ CacheFilter::resolveLookupStatus(absl::optional<CacheEntryStatus> cache_entry_st
   return LookupStatus::Unknown;
 }
 
+void CacheFilter::joinInFlightInsert(Http::RequestHeaderMap& request_headers) {
+  const Key key = std::move(coalescing_key_.value());
+  coalescing_key_.reset();
+  awaiting_in_flight_insert_ = true;
+  InFlightInsertLeasePtr lease = config_->inFlightInserts()->join(
+      key, decoder_callbacks_->dispatcher(),
+      [weak_self = weak_from_this(), &request_headers](bool lookup_again) {
+        if (CacheFilterSharedPtr self = weak_self.lock()) {
+          self->onInFlightInsertReleased(request_headers, lookup_again);
+        }
+      });
+  if (lease != nullptr) {
+    awaiting_in_flight_insert_ = false;
+    in_flight_lease_ = std::move(lease);
+    sendUpstreamRequest(request_headers);
+  }
+}
+
+void CacheFilter::onInFlightInsertReleased(Http::RequestHeaderMap& request_headers,
+                                           bool lookup_again) {
+  if (!awaiting_in_flight_insert_ || filter_state_ != FilterState::Initial || lookup_ == nullptr) {
+    // The filter was destroyed, or a response was injected into the filter chain while waiting.
+    return;
+  }
+  awaiting_in_flight_insert_ = false;
+  if (!lookup_again) {
+    sendUpstreamRequest(request_headers);
+    return;
+  }
+  // The response has just been inserted, so look it up again. coalescing_key_ has been cleared,
+  // so if the lookup misses anyway the request goes upstream.
+  ENVOY_STREAM_LOG(debug, "CacheFilter looking up again after a coalesced insert",
+                   *decoder_callbacks_);
+  lookup_->onDestroy();
+  lookup_result_ = nullptr;
+  cache_entry_status_.reset();
+  LookupRequest lookup_request(request_headers, config_->timeSource().systemTime(),
+                               config_->varyAllowList(),
+                               config_->ignoreRequestCacheControlHeader());
+  lookup_ = cache_->makeLookupContext(std::move(lookup_request), *decoder_callbacks_);
+  getHeaders(request_headers);
+}
+
 void CacheFilter::getHeaders(Http::RequestHeaderMap& request_headers) {
   ASSERT(lookup_, "CacheFilter is trying to call getHeaders with no LookupContext");
   callback_called_directly_ = true;
@@ -327,6 +377,10 @@ void CacheFilter::onHeaders(LookupResult&& result, Http::RequestHeaderMap& reque
     handleCacheHit(/* end_stream_after_headers = */ end_stream);
     return;
   case CacheEntryStatus::Unusable:
+    if (coalescing_key_.has_value()) {
+      joinInFlightInsert(request_headers);
+      return;
+    }
     sendUpstreamRequest(request_headers);
     return;
   case CacheEntryStatus::LookupError:
@@ -10,6 +10,7 @@
 #include "source/extensions/filters/http/cache/cache_headers_utils.h"
 #include "source/extensions/filters/http/cache/filter_state.h"
 #include "source/extensions/filters/http/cache/http_cache.h"
+#include "source/extensions/filters/http/cache/in_flight_inserts.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
 
 namespace Envoy {
@@ -30,6 +31,8 @@ public:
   const Http::AsyncClient::StreamOptions& upstreamOptions() const { return upstream_options_; }
   Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
   bool ignoreRequestCacheControlHeader() const { return ignore_request_cache_control_header_; }
+  // The cache misses in flight, if request coalescing is configured.
+  const InFlightInsertsSharedPtr& inFlightInserts() const { return in_flight_inserts_; }
 
 private:
   const VaryAllowList vary_allow_list_;
@@ -37,6 +40,7 @@ private:
   const bool ignore_request_cache_control_header_;
   Upstream::ClusterManager& cluster_manager_;
   Http::AsyncClient::StreamOptions upstream_options_;
+  const InFlightInsertsSharedPtr in_flight_inserts_;
 };
 
 /**
@@ -82,6 +86,15 @@ private:
   // CacheFilter must make no more calls to upstream_request_ once this has been called.
   void onUpstreamRequestComplete();
 
+  // For a cache miss that may be coalesced with the other misses on the same key, either becomes
+  // the request that goes upstream, or waits for the insertion in flight to be released.
+  void joinInFlightInsert(Http::RequestHeaderMap& request_headers);
+
+  // Called once the insertion in flight that this request waited for is released. If lookup_again
+  // is true the response has been inserted and is looked up again, otherwise the request is sent
+  // upstream.
+  void onInFlightInsertReleased(Http::RequestHeaderMap& request_headers, bool lookup_again);
+
   // Utility functions; make any necessary checks and call the corresponding lookup_ functions
   void getHeaders(Http::RequestHeaderMap& request_headers);
   void getBody();
@@ -142,6 +155,11 @@ private:
   LookupContextPtr lookup_;
   LookupResultPtr lookup_result_;
   absl::optional<CacheEntryStatus> cache_entry_status_;
+  // Set if a cache miss for this request may be coalesced with the other misses on the same key.
+  absl::optional<Key> coalescing_key_;
+  // Held if this request is the one that went upstream for a coalesced cache miss; handed over to
+  // the UpstreamRequest.
+  InFlightInsertLeasePtr in_flight_lease_;
 
   // Tracks what body bytes still need to be read from the cache. This is
   // currently only one Range, but will expand when full range support is added. Initialized by
@@ -159,6 +177,8 @@ private:
   bool is_head_request_ = false;
   // This toggle is used to detect callbacks being called directly and not posted.
   bool callback_called_directly_ = false;
+  // True while waiting for an insertion in flight for the same key.
+  bool awaiting_in_flight_insert_ = false;
   // The status of the insert operation or header update, or decision not to insert or update.
   // If it's too early to determine the final status, this is empty.
   absl::optional<InsertStatus> insert_status_;
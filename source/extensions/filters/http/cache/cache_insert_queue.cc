@@ -186,6 +186,11 @@ void CacheInsertQueue::onFragmentComplete(bool cache_success, bool end_stream, s
   if (end_stream) {
     ASSERT(fragments_.empty(), "ending a stream with the queue not empty is a bug");
     ASSERT(!watermarked_, "being over the high watermark when the queue is empty makes no sense");
+    if (in_flight_lease_ != nullptr) {
+      // Let the requests waiting for this insertion look it up right away.
+      in_flight_lease_->onInsertComplete();
+      in_flight_lease_ = nullptr;
+    }
     self_ownership_.reset();
     return;
   }
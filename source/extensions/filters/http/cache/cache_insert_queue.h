@@ -4,6 +4,7 @@
 #include <functional>
 
 #include "source/extensions/filters/http/cache/http_cache.h"
+#include "source/extensions/filters/http/cache/in_flight_inserts.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -46,6 +47,8 @@ public:
   void insertBody(const Buffer::Instance& fragment, bool end_stream);
   void insertTrailers(const Http::ResponseTrailerMap& trailers);
   void setSelfOwned(std::unique_ptr<CacheInsertQueue> self);
+  // Holds on to the lease of a coalesced cache miss until the insertion completes or is aborted.
+  void setInFlightLease(InFlightInsertLeasePtr lease) { in_flight_lease_ = std::move(lease); }
   ~CacheInsertQueue();
 
 private:
@@ -81,6 +84,7 @@ private:
   // while a cache action is still in flight, which can cause the cache to be
   // deleted prematurely.
   std::shared_ptr<HttpCache> cache_;
+  InFlightInsertLeasePtr in_flight_lease_;
 };
 
 } // namespace Cache
@@ -80,6 +80,9 @@ public:
                 const VaryAllowList& vary_allow_list,
                 bool ignore_request_cache_control_header = false);
 
+  // Copies the request, for caches which look it up in more than one place.
+  LookupRequest(const LookupRequest& other);
+
   const RequestCacheControl& requestCacheControl() const { return request_cache_control_; }
 
   // Caches may modify the key according to local needs, though care must be
@@ -0,0 +1,95 @@
+#include "source/extensions/filters/http/cache/in_flight_inserts.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+constexpr uint64_t DefaultMaxSmallResponseBytes = 1024 * 1024;
+} // namespace
+
+InFlightInsertLease::InFlightInsertLease(std::shared_ptr<InFlightInserts> in_flight,
+                                         const Key& key)
+    : in_flight_(std::move(in_flight)), key_(key) {}
+
+InFlightInsertLease::~InFlightInsertLease() { in_flight_->release(key_, inserted_); }
+
+void InFlightInsertLease::onInsertStarted(absl::optional<uint64_t> content_length) {
+  in_flight_->onInsertStarted(key_, content_length);
+}
+
+InFlightInserts::InFlightInserts(const Config& config)
+    : max_small_response_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_small_response_bytes,
+                                                                DefaultMaxSmallResponseBytes)),
+      small_response_action_(config.small_response_action()),
+      large_response_action_(config.large_response_action()),
+      unknown_length_response_action_(config.unknown_length_response_action()) {}
+
+InFlightInsertLeasePtr InFlightInserts::join(const Key& key, Event::Dispatcher& dispatcher,
+                                             ReleaseCallback cb) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto [it, inserted] = entries_.try_emplace(key);
+    if (inserted) {
+      return std::make_unique<InFlightInsertLease>(shared_from_this(), key);
+    }
+    Entry& entry = it->second;
+    if (!entry.action_.has_value() || entry.action_.value() == Config::WAIT_FOR_INSERT) {
+      entry.waiters_.push_back({&dispatcher, std::move(cb)});
+      return nullptr;
+    }
+  }
+  cb(false);
+  return nullptr;
+}
+
+InFlightInserts::Config::Action
+InFlightInserts::actionFor(absl::optional<uint64_t> content_length) const {
+  if (!content_length.has_value()) {
+    return unknown_length_response_action_;
+  }
+  return content_length.value() <= max_small_response_bytes_ ? small_response_action_
+                                                             : large_response_action_;
+}
+
+void InFlightInserts::onInsertStarted(const Key& key, absl::optional<uint64_t> content_length) {
+  const Config::Action action = actionFor(content_length);
+  std::vector<Waiter> bypassing;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    ASSERT(it != entries_.end());
+    it->second.action_ = action;
+    if (action == Config::BYPASS) {
+      bypassing.swap(it->second.waiters_);
+    }
+  }
+  notify(std::move(bypassing), false);
+}
+
+void InFlightInserts::release(const Key& key, bool inserted) {
+  std::vector<Waiter> waiters;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    ASSERT(it != entries_.end());
+    waiters.swap(it->second.waiters_);
+    entries_.erase(it);
+  }
+  notify(std::move(waiters), inserted);
+}
+
+void InFlightInserts::notify(std::vector<Waiter>&& waiters, bool lookup_again) {
+  for (Waiter& waiter : waiters) {
+    waiter.dispatcher_->post(
+        [cb = std::move(waiter.cb_), lookup_again]() mutable { cb(lookup_again); });
+  }
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/filters/http/cache/v3/cache.pb.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache/key.pb.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+class InFlightInserts;
+
+// Held by the request which went upstream for a cache miss, until its response has been inserted
+// into the cache or it gives up on inserting it. Destroying the lease releases the requests which
+// missed on the same key in the meantime.
+class InFlightInsertLease {
+public:
+  InFlightInsertLease(std::shared_ptr<InFlightInserts> in_flight, const Key& key);
+  ~InFlightInsertLease();
+
+  // Called once the response headers are known, and the response is being inserted.
+  void onInsertStarted(absl::optional<uint64_t> content_length);
+
+  // Called once the whole response has been inserted successfully.
+  void onInsertComplete() { inserted_ = true; }
+
+private:
+  const std::shared_ptr<InFlightInserts> in_flight_;
+  const Key key_;
+  bool inserted_ = false;
+};
+using InFlightInsertLeasePtr = std::unique_ptr<InFlightInsertLease>;
+
+// Tracks the cache misses that are being fetched from upstream and inserted into the cache, so
+// that concurrent misses for the same key, from any worker, can wait for the insertion instead of
+// all going upstream.
+class InFlightInserts : public std::enable_shared_from_this<InFlightInserts> {
+public:
+  using Config = envoy::extensions::filters::http::cache::v3::CacheConfig::RequestCoalescing;
+
+  // Called on the dispatcher of a waiting request once it may proceed. lookup_again is true if the
+  // response has been inserted, so that the request can be served from the cache, and false if the
+  // request should be sent upstream.
+  using ReleaseCallback = absl::AnyInvocable<void(bool lookup_again)>;
+
+  explicit InFlightInserts(const Config& config);
+
+  // Returns a lease if there is no insertion in flight for key; the caller must then go upstream
+  // and hold on to the lease until its insertion completes or is abandoned.
+  //
+  // Otherwise returns nullptr, and either calls cb inline with false if the caller should go
+  // upstream right away, or posts cb to dispatcher once the insertion in flight completes.
+  InFlightInsertLeasePtr join(const Key& key, Event::Dispatcher& dispatcher, ReleaseCallback cb);
+
+private:
+  friend class InFlightInsertLease;
+
+  struct Waiter {
+    Event::Dispatcher* dispatcher_;
+    ReleaseCallback cb_;
+  };
+
+  struct Entry {
+    // Set once the response headers of the leader are known.
+    absl::optional<Config::Action> action_;
+    std::vector<Waiter> waiters_;
+  };
+
+  Config::Action actionFor(absl::optional<uint64_t> content_length) const;
+  void onInsertStarted(const Key& key, absl::optional<uint64_t> content_length);
+  void release(const Key& key, bool inserted);
+  static void notify(std::vector<Waiter>&& waiters, bool lookup_again);
+
+  const uint64_t max_small_response_bytes_;
+  const Config::Action small_response_action_;
+  const Config::Action large_response_action_;
+  const Config::Action unknown_length_response_action_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<Key, Entry, MessageUtil, MessageUtil> entries_ ABSL_GUARDED_BY(mutex_);
+};
+using InFlightInsertsSharedPtr = std::shared_ptr<InFlightInserts>;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -6,6 +6,8 @@
 #include "source/extensions/filters/http/cache/cache_filter.h"
 #include "source/extensions/filters/http/cache/cacheability_utils.h"
 
+#include "absl/strings/numbers.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -129,7 +131,8 @@ UpstreamRequest::UpstreamRequest(CacheFilter* filter, LookupContextPtr lookup,
       is_head_request_(filter->is_head_request_),
       request_allows_inserts_(filter->request_allows_inserts_), config_(filter->config_),
       filter_state_(filter->filter_state_), cache_(std::move(cache)),
-      stream_(async_client.start(*this, options)) {
+      stream_(async_client.start(*this, options)),
+      in_flight_lease_(std::move(filter->in_flight_lease_)) {
   ASSERT(stream_ != nullptr);
 }
 
@@ -217,6 +220,17 @@ void UpstreamRequest::onHeaders(Http::ResponseHeaderMapPtr&& headers, bool end_s
                                                          std::move(insert_context), *this);
       // Add metadata associated with the cached response. Right now this is only response_time;
       const ResponseMetadata metadata = {config_->timeSource().systemTime()};
+      if (in_flight_lease_ != nullptr) {
+        absl::optional<uint64_t> content_length;
+        uint64_t length;
+        if (end_stream) {
+          content_length = 0;
+        } else if (absl::SimpleAtoi(headers->getContentLengthValue(), &length)) {
+          content_length = length;
+        }
+        in_flight_lease_->onInsertStarted(content_length);
+        insert_queue_->setInFlightLease(std::move(in_flight_lease_));
+      }
       insert_queue_->insertHeaders(*headers, metadata, end_stream);
       // insert_status_ remains absl::nullopt if end_stream == false, as we have not completed the
       // insertion yet.
@@ -227,6 +241,8 @@ void UpstreamRequest::onHeaders(Http::ResponseHeaderMapPtr&& headers, bool end_s
   } else {
     setInsertStatus(InsertStatus::NoInsertResponseNotCacheable);
   }
+  // Nothing is being inserted, so the requests waiting for this one go upstream too.
+  in_flight_lease_ = nullptr;
   setFilterState(FilterState::NotServingFromCache);
   if (filter_) {
     filter_->decoder_callbacks_->encodeHeaders(std::move(headers), is_head_request_ || end_stream,
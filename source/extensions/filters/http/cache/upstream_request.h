@@ -3,6 +3,7 @@
 #include "source/common/common/logger.h"
 #include "source/extensions/filters/http/cache/cache_filter_logging_info.h"
 #include "source/extensions/filters/http/cache/cache_insert_queue.h"
+#include "source/extensions/filters/http/cache/in_flight_inserts.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -76,6 +77,9 @@ private:
   std::shared_ptr<HttpCache> cache_;
   Http::AsyncClient::Stream* stream_ = nullptr;
   std::unique_ptr<CacheInsertQueue> insert_queue_;
+  // Held if this is the request that went upstream for a coalesced cache miss, until the response
+  // headers are known; then handed over to insert_queue_, or released if there is no insertion.
+  InFlightInsertLeasePtr in_flight_lease_;
 };
 
 } // namespace Cache
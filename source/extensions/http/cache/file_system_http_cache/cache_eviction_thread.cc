@@ -1,6 +1,10 @@
 #include "source/extensions/http/cache/file_system_http_cache/cache_eviction_thread.h"
 
-#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <string>
+#include <vector>
 
 #include "envoy/thread/thread.h"
 
@@ -8,6 +12,9 @@
 #include "source/common/filesystem/directory.h"
 #include "source/extensions/http/cache/file_system_http_cache/file_system_http_cache.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/strip.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -15,13 +22,30 @@ namespace Cache {
 namespace FileSystemHttpCache {
 
 namespace {
+
+// The most threads scanning the subdirectories of a cache at once.
+constexpr size_t MaxScanThreads = 8;
+
+// The most files taken out of the index by one batch of an eviction pass, so that the index is
+// not locked for long, and the files used while a batch is unlinked are spared by the next one.
+constexpr size_t MaxEvictionBatchSize = 1000;
+
 bool isCacheFile(const Filesystem::DirectoryEntry& entry) {
   return entry.type_ == Filesystem::FileType::Regular && absl::StartsWith(entry.name_, "cache-");
 }
+
+struct ScannedFile {
+  // The name of the file, relative to the cache path.
+  std::string name_;
+  uint64_t size_;
+  Envoy::SystemTime last_touch_;
+};
+
 } // namespace
 
 CacheEvictionThread::CacheEvictionThread(Thread::ThreadFactory& thread_factory)
-    : thread_(thread_factory.createThread([this]() { work(); })) {}
+    : thread_factory_(thread_factory),
+      thread_(thread_factory.createThread([this]() { work(); })) {}
 
 CacheEvictionThread::~CacheEvictionThread() {
   terminate();
@@ -68,94 +92,226 @@ bool CacheEvictionThread::waitForSignal() {
   return !terminating_;
 }
 
-void CacheShared::initStats() {
+void CacheShared::initStats(Thread::ThreadFactory& thread_factory) {
   if (config_.has_max_cache_size_bytes()) {
     stats_.size_limit_bytes_.set(config_.max_cache_size_bytes().value());
   }
   if (config_.has_max_cache_entry_count()) {
     stats_.size_limit_count_.set(config_.max_cache_entry_count().value());
   }
-  // TODO(ravenblack): Add support for directory tree structure.
-  for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(std::string{cachePath()})) {
-    if (!isCacheFile(entry)) {
-      continue;
-    }
-    size_count_++;
-    size_bytes_ += entry.size_bytes_.value_or(0);
-  }
-  stats_.size_count_.set(size_count_);
-  stats_.size_bytes_.set(size_bytes_);
+  scanCacheFiles(thread_factory);
   needs_init_ = false;
 }
 
-void CacheShared::evict() {
-  stats_.eviction_runs_.add(1);
+void CacheShared::scanCacheFiles(Thread::ThreadFactory& thread_factory) {
   auto os_sys_calls = Api::OsSysCallsSingleton::get();
-  uint64_t size = 0;
-  uint64_t count = 0;
-  struct CacheFile {
-    std::string name_;
-    uint64_t size_;
-    Envoy::SystemTime last_touch_;
-  };
-  std::vector<CacheFile> cache_files;
-
-  // TODO(ravenblack): Add support for directory tree structure.
+  // Cache files are all directly in the cache path, or all in subdirectories of it. Scanning the
+  // subdirectories left over from a previous configuration removes the files found there.
+  std::vector<std::string> directories{""};
   for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(std::string{cachePath()})) {
-    if (!isCacheFile(entry)) {
-      continue;
+    if (entry.type_ == Filesystem::FileType::Directory &&
+        absl::StartsWith(entry.name_, "cache-")) {
+      directories.push_back(absl::StrCat(entry.name_, "/"));
     }
-    count++;
-    size += entry.size_bytes_.value_or(0);
-    struct stat s;
-    if (os_sys_calls.stat(absl::StrCat(cachePath(), entry.name_).c_str(), &s).return_value_ != -1) {
+  }
+
+  std::vector<std::vector<ScannedFile>> scanned(directories.size());
+  std::atomic<size_t> next_directory = 0;
+  auto scan = [&]() {
+    for (size_t i = next_directory++; i < directories.size(); i = next_directory++) {
+      const std::string& directory = directories[i];
+      for (const Filesystem::DirectoryEntry& entry :
+           Filesystem::Directory(absl::StrCat(cachePath(), directory))) {
+        if (!isCacheFile(entry)) {
+          continue;
+        }
+        std::string name = absl::StrCat(directory, entry.name_);
+        const std::string path = absl::StrCat(cachePath(), name);
+        uint64_t hash;
+        const std::string expected_directory =
+            absl::SimpleAtoi(absl::StripPrefix(entry.name_, "cache-"), &hash)
+                ? subdirectoryFor(hash)
+                : "";
+        if (directory != expected_directory) {
+          // The file can never be looked up where it is, so there's no point keeping it.
+          os_sys_calls.unlink(path.c_str());
+          continue;
+        }
+        struct stat s;
+        if (os_sys_calls.stat(path.c_str(), &s).return_value_ == -1) {
+          continue;
+        }
 #ifdef _DARWIN_FEATURE_64_BIT_INODE
-      Envoy::SystemTime last_touch =
-          std::max(timespecToChrono(s.st_atimespec), timespecToChrono(s.st_ctimespec));
+        Envoy::SystemTime last_touch =
+            std::max(timespecToChrono(s.st_atimespec), timespecToChrono(s.st_ctimespec));
 #else
-      Envoy::SystemTime last_touch =
-          std::max(timespecToChrono(s.st_atim), timespecToChrono(s.st_ctim));
+        Envoy::SystemTime last_touch =
+            std::max(timespecToChrono(s.st_atim), timespecToChrono(s.st_ctim));
 #endif
-
-      cache_files.push_back(CacheFile{entry.name_, entry.size_bytes_.value_or(0), last_touch});
+        scanned[i].push_back(
+            ScannedFile{std::move(name), entry.size_bytes_.value_or(0), last_touch});
+      }
     }
+  };
+  // With millions of files, a scan is dominated by waiting on the file system, so subdirectories
+  // are scanned concurrently.
+  std::vector<Thread::ThreadPtr> threads;
+  for (size_t i = 1; i < std::min(directories.size(), MaxScanThreads); i++) {
+    threads.push_back(thread_factory.createThread(scan));
+  }
+  scan();
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+
+  std::vector<ScannedFile> cache_files;
+  for (std::vector<ScannedFile>& files : scanned) {
+    std::move(files.begin(), files.end(), std::back_inserter(cache_files));
   }
   // Sort the vector by last-touch timestamp, highest (i.e. youngest) first.
-  std::sort(cache_files.begin(), cache_files.end(), [](CacheFile& a, CacheFile& b) {
+  std::sort(cache_files.begin(), cache_files.end(), [](ScannedFile& a, ScannedFile& b) {
     return std::tie(a.last_touch_, a.name_) > std::tie(b.last_touch_, b.name_);
   });
+  // All the shards are locked while the scanned files are merged in and the totals are reset, so
+  // that no file added or removed by a worker in the meantime is counted twice, or not at all.
+  // Scans are rare, so the workers briefly waiting on every shard is no concern.
+  for (IndexShard& shard : shards_) {
+    shard.mu_.Lock();
+  }
+  // Files that are already indexed were used since the scan began, or before it, by this
+  // process, which makes them younger than the files that are only known from the scan.
+  for (ScannedFile& file : cache_files) {
+    IndexShard& shard = shardFor(file.name_);
+    if (shard.index_.contains(file.name_)) {
+      continue;
+    }
+    shard.lru_.push_front(IndexedFile{std::move(file.name_), file.size_});
+    shard.index_.emplace(shard.lru_.front().name_, shard.lru_.begin());
+  }
+  uint64_t size = 0;
+  uint64_t count = 0;
+  for (IndexShard& shard : shards_) {
+    for (const IndexedFile& file : shard.lru_) {
+      size += file.size_;
+    }
+    count += shard.lru_.size();
+  }
   size_bytes_ = size;
   size_count_ = count;
-  stats_.size_bytes_.set(size);
-  stats_.size_count_.set(count);
-  uint64_t size_kept = 0;
-  uint64_t count_kept = 0;
-  uint64_t max_size = config_.has_max_cache_size_bytes() ? config_.max_cache_size_bytes().value()
-                                                         : std::numeric_limits<uint64_t>::max();
-  uint64_t max_count = config_.has_max_cache_entry_count() ? config_.max_cache_entry_count().value()
-                                                           : std::numeric_limits<uint64_t>::max();
-  auto it = cache_files.begin();
-  // Keep the youngest files that won't exceed the limit.
-  while (it != cache_files.end() && size_kept + it->size_ <= max_size &&
-         count_kept + 1 <= max_count) {
-    size_kept += it->size_;
-    count_kept++;
-    ++it;
-  }
-  // Evict the rest.
-  while (it != cache_files.end()) {
-    if (os_sys_calls.unlink(absl::StrCat(cachePath(), it->name_).c_str()).return_value_ != -1) {
-      // May want to add logging here for cache eviction failure, but it's expected sometimes,
-      // e.g. if another instance of Envoy is performing cleanup at the same time, or some external
-      // operator deleted the file. If it fails we don't reduce the estimated cache size, so another
-      // eviction run will happen sooner.
-      // TODO(ravenblack): might be worth checking the type of the error, or whether the file is
-      // gone - if there's a permissions issue, for example, then the cache might remain oversized
-      // and the eviction thread will be churning, trying and failing to remove a file, which would
-      // be worth logging a warning, versus if the file is already gone then there's no problem.
-      trackFileRemoved(it->size_);
+  updateSizeStats();
+  for (IndexShard& shard : shards_) {
+    shard.mu_.Unlock();
+  }
+}
+
+std::vector<CacheShared::IndexedFile> CacheShared::takeEvictionBatch() {
+  uint64_t excess_size = 0;
+  uint64_t excess_count = 0;
+  if (config_.has_max_cache_size_bytes() && size_bytes_ > config_.max_cache_size_bytes().value()) {
+    excess_size = size_bytes_ - config_.max_cache_size_bytes().value();
+  }
+  if (config_.has_max_cache_entry_count() &&
+      size_count_ > config_.max_cache_entry_count().value()) {
+    excess_count = size_count_ - config_.max_cache_entry_count().value();
+  }
+  std::vector<IndexedFile> batch;
+  uint64_t batch_size = 0;
+  auto wants_more = [&]() {
+    return batch.size() < MaxEvictionBatchSize &&
+           (batch_size < excess_size || batch.size() < excess_count);
+  };
+  // Take the least recently used file of each shard in turn, until a round finds every shard
+  // empty. Only one shard is locked at a time.
+  size_t empty_shards = 0;
+  while (empty_shards < shards_.size() && wants_more()) {
+    IndexShard& shard = shards_[next_eviction_shard_];
+    next_eviction_shard_ = (next_eviction_shard_ + 1) % shards_.size();
+    absl::MutexLock lock(&shard.mu_);
+    if (shard.lru_.empty()) {
+      empty_shards++;
+      continue;
+    }
+    empty_shards = 0;
+    shard.index_.erase(shard.lru_.front().name_);
+    batch_size += shard.lru_.front().size_;
+    untrackFileSize(shard.lru_.front().size_);
+    batch.push_back(std::move(shard.lru_.front()));
+    shard.lru_.pop_front();
+  }
+  updateSizeStats();
+  return batch;
+}
+
+bool CacheShared::unlinkEvictionBatch(std::vector<IndexedFile> batch) {
+  auto os_sys_calls = Api::OsSysCallsSingleton::get();
+  bool removed_any = false;
+  std::vector<IndexedFile> failures;
+  for (IndexedFile& file : batch) {
+    IndexShard& shard = shardFor(file.name_);
+    // The shard stays locked until the file is unlinked, so that a worker can't re-add the file
+    // between the check and the unlink. A file that is back in the index was re-inserted since
+    // the batch was taken, so the file on disk is the new cache entry, and it is already counted.
+    absl::MutexLock lock(&shard.mu_);
+    if (shard.index_.contains(file.name_)) {
+      removed_any = true;
+      continue;
+    }
+    Api::SysCallIntResult result =
+        os_sys_calls.unlink(absl::StrCat(cachePath(), file.name_).c_str());
+    // The files of the batch were uncounted when they were taken from the index. If the file is
+    // already gone, e.g. if another instance of Envoy is performing cleanup at the same time,
+    // or some external operator deleted the file, it no longer takes up space either. If it
+    // fails for another reason the file goes back into the index.
+    if (result.return_value_ != -1 || result.errno_ == ENOENT) {
+      removed_any = true;
+    } else {
+      failures.push_back(std::move(file));
+    }
+  }
+  if (!failures.empty()) {
+    restoreEvictionFailures(std::move(failures));
+  }
+  return removed_any;
+}
+
+void CacheShared::restoreEvictionFailures(std::vector<IndexedFile> files) {
+  for (IndexedFile& file : files) {
+    IndexShard& shard = shardFor(file.name_);
+    absl::MutexLock lock(&shard.mu_);
+    // If the file was re-added while it was being evicted, the new entry is already counted.
+    if (shard.index_.contains(file.name_)) {
+      continue;
+    }
+    // The files go to the most recently used end so that they don't stand in the way of the
+    // files that can be evicted.
+    size_count_++;
+    size_bytes_ += file.size_;
+    shard.lru_.push_back(std::move(file));
+    shard.index_.emplace(shard.lru_.back().name_, std::prev(shard.lru_.end()));
+  }
+  updateSizeStats();
+}
+
+void CacheShared::evict(Thread::ThreadFactory& thread_factory) {
+  stats_.eviction_runs_.add(1);
+  bool scanned = false;
+  while (needsEviction()) {
+    std::vector<IndexedFile> batch = takeEvictionBatch();
+    if (batch.empty()) {
+      // The cache is oversized with nothing left to evict in the index, which happens if files
+      // were added by another process; catch up with the file system.
+      if (scanned) {
+        return;
+      }
+      scanCacheFiles(thread_factory);
+      scanned = true;
+      continue;
+    }
+    if (!unlinkEvictionBatch(std::move(batch))) {
+      // Keep the eviction thread from churning, e.g. if there's a permissions issue; another
+      // eviction pass will happen when the cache grows.
+      return;
     }
-    ++it;
   }
 }
 
@@ -172,10 +328,10 @@ void CacheEvictionThread::work() {
 
     for (const std::shared_ptr<CacheShared>& cache : caches) {
       if (cache->needs_init_) {
-        cache->initStats();
+        cache->initStats(thread_factory_);
       }
       if (cache->needsEviction()) {
-        cache->evict();
+        cache->evict(thread_factory_);
       }
     }
   }
@@ -110,6 +110,9 @@ private:
   bool idle_ ABSL_GUARDED_BY(mu_) = false;
   void waitForIdle();
 
+  // Used for the threads scanning the cache directories in parallel.
+  Thread::ThreadFactory& thread_factory_;
+
   // It is important that thread_ be last, as the new thread runs with 'this' and
   // may access any other members. If thread_ is not last, there can be a race between
   // that thread and the initialization of other members.
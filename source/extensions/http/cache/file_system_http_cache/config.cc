@@ -3,6 +3,7 @@
 
 #include "envoy/extensions/http/cache/file_system_http_cache/v3/file_system_http_cache.pb.h"
 #include "envoy/extensions/http/cache/file_system_http_cache/v3/file_system_http_cache.pb.validate.h"
+#include "envoy/filesystem/filesystem.h"
 #include "envoy/registry/registry.h"
 
 #include "source/extensions/common/async_files/async_file_manager_factory.h"
@@ -43,8 +44,8 @@ class CacheSingleton : public Envoy::Singleton::Instance {
 public:
   CacheSingleton(
       std::shared_ptr<Common::AsyncFiles::AsyncFileManagerFactory>&& async_file_manager_factory,
-      Thread::ThreadFactory& thread_factory)
-      : async_file_manager_factory_(async_file_manager_factory),
+      Thread::ThreadFactory& thread_factory, Filesystem::Instance& file_system)
+      : async_file_manager_factory_(async_file_manager_factory), file_system_(file_system),
         cache_eviction_thread_(thread_factory) {}
 
   std::shared_ptr<FileSystemHttpCache> get(std::shared_ptr<CacheSingleton> singleton,
@@ -59,6 +60,7 @@ public:
       cache = it->second.lock();
     }
     if (!cache) {
+      createSubdirectories(config);
       std::shared_ptr<Common::AsyncFiles::AsyncFileManager> async_file_manager =
           async_file_manager_factory_->getAsyncFileManager(config.manager_config());
       cache = std::make_shared<FileSystemHttpCache>(singleton, cache_eviction_thread_,
@@ -74,7 +76,27 @@ public:
   }
 
 private:
+  /**
+   * Creates the subdirectories the cache files are spread over, if the cache is subdivided, so
+   * that inserting a cache entry never has to.
+   * @param config the normalized config of the cache.
+   */
+  void createSubdirectories(const ConfigProto& config) {
+    if (config.cache_subdivisions() <= 1) {
+      return;
+    }
+    for (uint32_t i = 0; i < config.cache_subdivisions(); i++) {
+      std::string path = absl::StrCat(config.cache_path(), CacheShared::subdirectoryName(i));
+      Api::IoCallBoolResult result = file_system_.createPath(path);
+      if (!result.ok()) {
+        throw EnvoyException(fmt::format("failed to create cache subdirectory {}: {}", path,
+                                         result.err_->getErrorDetails()));
+      }
+    }
+  }
+
   std::shared_ptr<Common::AsyncFiles::AsyncFileManagerFactory> async_file_manager_factory_;
+  Filesystem::Instance& file_system_;
   CacheEvictionThread cache_eviction_thread_;
   absl::Mutex mu_;
   // We keep weak_ptr here so the caches can be destroyed if the config is updated to stop using
@@ -106,7 +128,8 @@ public:
               return std::make_shared<CacheSingleton>(
                   Common::AsyncFiles::AsyncFileManagerFactory::singleton(
                       &context.serverFactoryContext().singletonManager()),
-                  context.serverFactoryContext().api().threadFactory());
+                  context.serverFactoryContext().api().threadFactory(),
+                  context.serverFactoryContext().api().fileSystem());
             });
     return caches->get(caches, config, context.scope());
   }
@@ -11,6 +11,10 @@
 #include "source/extensions/http/cache/file_system_http_cache/lookup_context.h"
 #include "source/extensions/http/cache/file_system_http_cache/stats.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -89,7 +93,7 @@ FileSystemHttpCache::FileSystemHttpCache(
 
 CacheShared::CacheShared(ConfigProto config, Stats::Scope& stats_scope)
     : config_(config), stat_names_(stats_scope.symbolTable()),
-      stats_(generateStats(stat_names_, stats_scope, cachePath())) {}
+      stats_(generateStats(stat_names_, stats_scope, cachePath())), shards_(subdivisions()) {}
 
 FileSystemHttpCache::~FileSystemHttpCache() { cache_eviction_thread_.removeCache(shared_); }
 
@@ -346,8 +350,32 @@ FileSystemHttpCache::setCacheEntryToVary(Event::Dispatcher& dispatcher, const Ke
 }
 
 std::string FileSystemHttpCache::generateFilename(const Key& key) const {
-  // TODO(ravenblack): Add support for directory tree structure.
-  return absl::StrCat("cache-", stableHashKey(key));
+  const uint64_t hash = stableHashKey(key);
+  return absl::StrCat(shared_->subdirectoryFor(hash), "cache-", hash);
+}
+
+std::string CacheShared::subdirectoryName(uint32_t index) {
+  return absl::StrFormat("cache-%04x/", index);
+}
+
+std::string CacheShared::subdirectoryFor(uint64_t hash) const {
+  if (subdivisions() == 1) {
+    return "";
+  }
+  return subdirectoryName(hash % subdivisions());
+}
+
+CacheShared::IndexShard& CacheShared::shardFor(absl::string_view filename) {
+  if (shards_.size() == 1) {
+    return shards_[0];
+  }
+  // The name starts with the subdirectory, as formatted by subdirectoryName, which is cheaper to
+  // parse than the hash at the end of the name.
+  uint32_t index = 0;
+  absl::string_view directory = filename.substr(0, filename.find('/'));
+  bool parsed = absl::SimpleHexAtoi(absl::StripPrefix(directory, "cache-"), &index);
+  ASSERT(parsed);
+  return shards_[index % shards_.size()];
 }
 
 InsertContextPtr FileSystemHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
@@ -363,46 +391,73 @@ InsertContextPtr FileSystemHttpCache::makeInsertContext(LookupContextPtr&& looku
   return std::make_unique<FileInsertContext>(shared_from_this(), std::move(file_lookup_context));
 }
 
-void FileSystemHttpCache::trackFileAdded(uint64_t file_size) {
-  shared_->trackFileAdded(file_size);
+void FileSystemHttpCache::trackFileAdded(absl::string_view filename, uint64_t file_size) {
+  shared_->trackFileAdded(filename, file_size);
   if (shared_->needsEviction()) {
     cache_eviction_thread_.signal();
   }
 }
-void CacheShared::trackFileAdded(uint64_t file_size) {
-  size_count_++;
-  size_bytes_ += file_size;
-  stats_.size_count_.inc();
-  stats_.size_bytes_.add(file_size);
+void CacheShared::trackFileAdded(absl::string_view filename, uint64_t file_size) {
+  IndexShard& shard = shardFor(filename);
+  absl::MutexLock lock(&shard.mu_);
+  auto it = shard.index_.find(filename);
+  if (it != shard.index_.end()) {
+    // The file was replaced without being removed first, e.g. by another process, so it replaces
+    // the size that was counted for it rather than adding to it.
+    size_bytes_ -= it->second->size_;
+    size_bytes_ += file_size;
+    it->second->size_ = file_size;
+    shard.lru_.splice(shard.lru_.end(), shard.lru_, it->second);
+  } else {
+    shard.lru_.push_back(IndexedFile{std::string{filename}, file_size});
+    shard.index_.emplace(shard.lru_.back().name_, std::prev(shard.lru_.end()));
+    size_count_++;
+    size_bytes_ += file_size;
+  }
+  updateSizeStats();
+}
+
+void FileSystemHttpCache::trackFileRemoved(absl::string_view filename) {
+  shared_->trackFileRemoved(filename);
+}
+void CacheShared::trackFileRemoved(absl::string_view filename) {
+  IndexShard& shard = shardFor(filename);
+  absl::MutexLock lock(&shard.mu_);
+  auto it = shard.index_.find(filename);
+  if (it == shard.index_.end()) {
+    // Either the file was never counted, or whoever took it out of the index, e.g. an eviction
+    // pass, has already uncounted it.
+    return;
+  }
+  auto node = it->second;
+  shard.index_.erase(it);
+  untrackFileSize(node->size_);
+  shard.lru_.erase(node);
+  updateSizeStats();
+}
+
+void FileSystemHttpCache::trackFileTouched(absl::string_view filename) {
+  shared_->trackFileTouched(filename);
+}
+void CacheShared::trackFileTouched(absl::string_view filename) {
+  IndexShard& shard = shardFor(filename);
+  absl::MutexLock lock(&shard.mu_);
+  auto it = shard.index_.find(filename);
+  if (it != shard.index_.end()) {
+    shard.lru_.splice(shard.lru_.end(), shard.lru_, it->second);
+  }
 }
 
-void FileSystemHttpCache::trackFileRemoved(uint64_t file_size) {
-  shared_->trackFileRemoved(file_size);
+void CacheShared::untrackFileSize(uint64_t file_size) {
+  // Every file is counted once, when it enters the index, and uncounted once, by whoever takes it
+  // out of the index, so the totals can't drop below zero.
+  ASSERT(size_count_ > 0 && size_bytes_ >= file_size);
+  size_count_--;
+  size_bytes_ -= file_size;
 }
-void CacheShared::trackFileRemoved(uint64_t file_size) {
-  // Atomically decrement-but-clamp-at-zero the count of files in the cache.
-  //
-  // It is an error to try to set a gauge to less than zero, so we must actively
-  // prevent that underflow.
-  //
-  // See comment on size_bytes and size_count in stats.h for explanation of how stat
-  // values can be out of sync with the actionable cache.
-  uint64_t count, size;
-  do {
-    count = size_count_;
-  } while (count > 0 && !size_count_.compare_exchange_weak(count, count - 1));
 
+void CacheShared::updateSizeStats() {
   stats_.size_count_.set(size_count_);
-  // Atomically decrease-but-clamp-at-zero the size of files in the cache, by file_size.
-  //
-  // See comment above for why; the same rationale applies here.
-  do {
-    size = size_bytes_;
-  } while (size >= file_size && !size_bytes_.compare_exchange_weak(size, size - file_size));
-
-  if (size < file_size) {
-    size_bytes_ = 0;
-  }
   stats_.size_bytes_.set(size_bytes_);
 }
 
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <list>
 #include <memory>
+#include <vector>
 
 #include "envoy/extensions/http/cache/file_system_http_cache/v3/file_system_http_cache.pb.h"
+#include "envoy/thread/thread.h"
 
 #include "source/common/common/logger.h"
 #include "source/extensions/common/async_files/async_file_manager.h"
@@ -147,9 +151,10 @@ public:
   static absl::string_view name();
 
   /**
-   * Returns a filename for the cache entry with the given key.
+   * Returns a filename for the cache entry with the given key, relative to cachePath(). If the
+   * cache is subdivided, the filename is prefixed with the subdirectory of the entry.
    * @param key the key for which to generate a filename.
-   * @return a filename for that cache entry (path not included).
+   * @return a filename for that cache entry (cache path not included).
    */
   std::string generateFilename(const Key& key) const;
 
@@ -168,16 +173,25 @@ public:
   }
 
   /**
-   * Updates stats to reflect that a file has been added to the cache.
+   * Updates stats and the eviction index to reflect that a file has been added to the cache.
+   * @param filename The name of the file that was added, as returned by generateFilename.
    * @param file_size The size in bytes of the file that was added.
    */
-  void trackFileAdded(uint64_t file_size);
+  void trackFileAdded(absl::string_view filename, uint64_t file_size);
 
   /**
-   * Updates stats to reflect that a file has been removed from the cache.
-   * @param file_size The size in bytes of the file that was removed.
+   * Updates stats and the eviction index to reflect that a file has been removed from the cache.
+   * Does nothing if the file is not in the index, e.g. if an eviction pass already removed it.
+   * @param filename The name of the file that was removed, as returned by generateFilename.
    */
-  void trackFileRemoved(uint64_t file_size);
+  void trackFileRemoved(absl::string_view filename);
+
+  /**
+   * Updates the eviction index to reflect that a file has been used, so that it is evicted
+   * after the files that were used less recently.
+   * @param filename The name of the file that was used, as returned by generateFilename.
+   */
+  void trackFileTouched(absl::string_view filename);
 
   // UpdateHeaders copies an existing cache entry to a new file. This value is
   // the size of a copy-chunk. It's public for unit tests only, as the chunk size
@@ -241,10 +255,9 @@ struct CacheShared {
   const ConfigProto config_;
   CacheStatNames stat_names_;
   CacheStats stats_;
-  // These are part of stats, but we have to track them separately because there is
-  // potential to go "less than zero" due to not having sole control of the file cache;
-  // gauge values don't have fine enough control to prevent that, and aren't allowed to
-  // be negative.
+  // These are part of stats, but we have to track them separately so that needsEviction can
+  // read them without taking a shard lock. They are the totals of the files in the index, and are
+  // only modified while holding the lock of the shard the file is in.
   //
   // See comment on size_bytes and size_count in stats.h for explanation of how stat
   // values can be out of sync with the actionable cache.
@@ -252,6 +265,33 @@ struct CacheShared {
   std::atomic<uint64_t> size_bytes_ = 0;
   bool needs_init_ = true;
 
+  struct IndexedFile {
+    // The name of the file, relative to cachePath().
+    std::string name_;
+    uint64_t size_;
+  };
+  // The files of one subdirectory of the cache in the order they were last used, least recently
+  // used first, so that eviction can pick its victims without scanning the cache directories.
+  // Built at startup from the file access times, and kept up to date by the trackFile functions.
+  //
+  // The index is split by subdirectory so that workers touching files in different
+  // subdirectories don't contend for one lock on every cache hit.
+  //
+  // Files added to the cache path by other processes are not in the index until the next scan,
+  // which happens when eviction runs out of indexed files while the cache is still oversized.
+  struct IndexShard {
+    absl::Mutex mu_;
+    std::list<IndexedFile> lru_ ABSL_GUARDED_BY(mu_);
+    // The keys are views of the names in lru_, whose nodes never move.
+    absl::flat_hash_map<absl::string_view, std::list<IndexedFile>::iterator>
+        index_ ABSL_GUARDED_BY(mu_);
+  };
+  // One shard per subdivision; never resized after construction.
+  std::vector<IndexShard> shards_;
+  // The shard the next eviction batch starts from, so that batches smaller than the number of
+  // shards don't always favour the first ones. Only used by the CacheEvictionThread.
+  size_t next_eviction_shard_ = 0;
+
   /**
    * @return true if the eviction thread should do a pass over this cache.
    */
@@ -264,26 +304,116 @@ struct CacheShared {
   absl::string_view cachePath() const { return config_.cache_path(); }
 
   /**
-   * Updates stats (size and count) to reflect that a file has been added to the cache.
+   * @return the number of subdirectories the cache files are spread over, or 1 if the cache
+   *     files are all directly in cachePath().
+   */
+  uint32_t subdivisions() const { return std::max(config_.cache_subdivisions(), 1u); }
+
+  /**
+   * Returns the name of a subdirectory of the cache.
+   * @param index the index of the subdirectory, less than subdivisions().
+   * @return the name of the subdirectory, ending in a path-separator.
+   */
+  static std::string subdirectoryName(uint32_t index);
+
+  /**
+   * Returns the subdirectory in which the cache file for the given hash belongs.
+   * @param hash the stable hash of the key of the cache entry.
+   * @return the name of the subdirectory, ending in a path-separator, or an empty string if
+   *     the cache is not subdivided.
+   */
+  std::string subdirectoryFor(uint64_t hash) const;
+
+  /**
+   * Returns the shard of the eviction index that a cache file belongs in.
+   * @param filename the name of the file, relative to cachePath(), as returned by
+   *     FileSystemHttpCache::generateFilename.
+   * @return the shard of the subdirectory the file is in.
+   */
+  IndexShard& shardFor(absl::string_view filename);
+
+  /**
+   * Updates stats (size and count) and the eviction index to reflect that a file has been added
+   * to the cache.
+   * @param filename The name of the file that was added, relative to cachePath().
    * @param file_size The size in bytes of the file that was added.
    */
-  void trackFileAdded(uint64_t file_size);
+  void trackFileAdded(absl::string_view filename, uint64_t file_size);
 
   /**
-   * Updates stats (size and count) to reflect that a file has been removed from the cache.
-   * @param file_size The size in bytes of the file that was removed.
+   * Updates stats (size and count) and the eviction index to reflect that a file has been
+   * removed from the cache. The stats only change if the file was in the index, so that a file
+   * that was already taken out of the index, e.g. by an eviction pass, isn't uncounted twice.
+   * @param filename The name of the file that was removed, relative to cachePath().
    */
-  void trackFileRemoved(uint64_t file_size);
+  void trackFileRemoved(absl::string_view filename);
+
+  /**
+   * Moves a file to the most recently used end of its shard of the eviction index.
+   * @param filename The name of the file that was used, relative to cachePath().
+   */
+  void trackFileTouched(absl::string_view filename);
+
+  /**
+   * Updates the size and count to reflect that a file has been taken out of the eviction index.
+   * Must be called while holding the lock of the shard the file was in.
+   * @param file_size The size in bytes of the file.
+   */
+  void untrackFileSize(uint64_t file_size);
+
+  /**
+   * Copies the size and count to the stats. As shards update the totals concurrently, the stats
+   * may briefly lag behind the totals until the next update.
+   */
+  void updateSizeStats();
 
   /**
    * Performs an eviction pass over this cache. Runs in the CacheEvictionThread.
+   * @param thread_factory the factory for the threads of a scan, if one is needed.
+   */
+  void evict(Thread::ThreadFactory& thread_factory);
+
+  /**
+   * Initializes the stats and the eviction index for this cache. Runs in the
+   * CacheEvictionThread.
+   * @param thread_factory the factory for the threads scanning the subdirectories.
+   */
+  void initStats(Thread::ThreadFactory& thread_factory);
+
+  /**
+   * Scans the cache directories, in parallel if the cache is subdivided, removing cache files
+   * that are in the wrong subdirectory, then adds the files that are not yet indexed to the
+   * least recently used end of the index, ordered by their access times, and resets the stats
+   * to match the index. The thread safety analysis is off as all the shards are locked at once,
+   * which it can't follow.
+   * @param thread_factory the factory for the threads scanning the subdirectories.
+   */
+  void scanCacheFiles(Thread::ThreadFactory& thread_factory) ABSL_NO_THREAD_SAFETY_ANALYSIS;
+
+  /**
+   * Removes the least recently used files from the index, as many as the cache is over its
+   * limits by, up to a batch size, and uncounts them from the size and count. The files are
+   * taken from the shards in turn, which approximates the least recently used files of the
+   * whole cache as the files are spread evenly over the subdirectories.
+   * @return the files to be unlinked.
+   */
+  std::vector<IndexedFile> takeEvictionBatch();
+
+  /**
+   * Unlinks the files of an eviction batch, except for those that were re-added to the index
+   * since the batch was taken, as the file on disk is then the new cache entry.
+   * @param batch the files returned by takeEvictionBatch.
+   * @return true if any file left the cache, or was re-added to it, i.e. if eviction made
+   *     progress.
    */
-  void evict();
+  bool unlinkEvictionBatch(std::vector<IndexedFile> batch);
 
   /**
-   * Initializes the stats for this cache. Runs in the CacheEvictionThread.
+   * Puts files that could not be unlinked back into the index, at the most recently used end,
+   * unless they were re-added in the meantime.
+   * @param files the files of an eviction batch that are still in the cache.
    */
-  void initStats();
+  void restoreEvictionFailures(std::vector<IndexedFile> files);
 };
 
 } // namespace FileSystemHttpCache
@@ -213,7 +213,7 @@ void FileInsertContext::commit() {
               writeFailureMessage("header block", write_result, CacheFileFixedBlock::size()));
           return;
         }
-        commitMeasureExisting();
+        commitUnlinkExisting();
       });
   ASSERT(queued.ok(), queued.status().ToString());
   cancel_action_in_flight_ = std::move(queued.value());
@@ -223,28 +223,14 @@ std::string FileInsertContext::pathAndFilename() {
   return absl::StrCat(cache_->cachePath(), cache_->generateFilename(key_));
 }
 
-void FileInsertContext::commitMeasureExisting() {
-  ASSERT(!cancel_action_in_flight_);
-  ASSERT(callback_in_flight_ != nullptr);
-  cancel_action_in_flight_ = cache_->asyncFileManager()->stat(
-      dispatcher(), pathAndFilename(), [this](absl::StatusOr<struct stat> stat_result) {
-        cancel_action_in_flight_ = nullptr;
-        if (stat_result.ok()) {
-          commitUnlinkExisting(stat_result.value().st_size);
-        } else {
-          commitUnlinkExisting(0);
-        }
-      });
-}
-
-void FileInsertContext::commitUnlinkExisting(size_t file_size) {
+void FileInsertContext::commitUnlinkExisting() {
   ASSERT(!cancel_action_in_flight_);
   ASSERT(callback_in_flight_ != nullptr);
   cancel_action_in_flight_ = cache_->asyncFileManager()->unlink(
-      dispatcher(), pathAndFilename(), [this, file_size](absl::Status unlink_result) {
+      dispatcher(), pathAndFilename(), [this](absl::Status unlink_result) {
         cancel_action_in_flight_ = nullptr;
         if (unlink_result.ok()) {
-          cache_->trackFileRemoved(file_size);
+          cache_->trackFileRemoved(cache_->generateFilename(key_));
         }
         commitCreateHardLink();
       });
@@ -264,7 +250,7 @@ void FileInsertContext::commitCreateHardLink() {
         ENVOY_LOG(debug, "created cache file {}", cache_->generateFilename(key_));
         succeedCurrentAction();
         uint64_t file_size = header_block_.offsetToTrailers() + header_block_.trailerSize();
-        cache_->trackFileAdded(file_size);
+        cache_->trackFileAdded(cache_->generateFilename(key_), file_size);
         // By clearing cleanup before destructor, we prevent logging an error.
         cleanup_ = nullptr;
       });
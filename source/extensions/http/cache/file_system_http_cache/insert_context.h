@@ -75,17 +75,13 @@ private:
   // Returns the full path for the cache file matching key_.
   std::string pathAndFilename();
   // Starts the commit process; rewrites the header block of the current file. On
-  // success calls commitMeasureExisting. On failure calls the InsertCallback with false
+  // success calls commitUnlinkExisting. On failure calls the InsertCallback with false
   // which should abort the operation.
   void commit();
-  // Checks for the presence and size of a pre-existing cache entry at the destination
-  // path. If the file does not exist or on failure, calls commitUnlinkExisting, as it
-  // doesn't hurt to try the delete in case the stat failure was e.g. a lack of read
-  // permission. On success passes the size from stat, on failure passes 0.
-  void commitMeasureExisting();
   // Deletes the pre-existing file in the pathAndFilename() location. On success updates
-  // cache metrics with the measured size. Regardless of success calls commitCreateHardLink.
-  void commitUnlinkExisting(size_t file_size);
+  // cache metrics with the indexed size of that file. Regardless of success calls
+  // commitCreateHardLink.
+  void commitUnlinkExisting();
   // Creates a hard link at pathAndFilename() to the current file. On success calls
   // InsertCallback with true. On failure calls it with false which should abort the
   // operation.
@@ -11,9 +11,7 @@ namespace HttpFilters {
 namespace Cache {
 namespace FileSystemHttpCache {
 
-std::string FileLookupContext::filepath() {
-  return absl::StrCat(cache_.cachePath(), cache_.generateFilename(key_));
-}
+std::string FileLookupContext::filepath() { return absl::StrCat(cache_.cachePath(), filename_); }
 
 bool FileLookupContext::workInProgress() const { return cache_.workInProgress(key()); }
 
@@ -23,6 +21,7 @@ void FileLookupContext::getHeaders(LookupHeadersCallback&& cb) {
 }
 
 void FileLookupContext::tryOpenCacheFile() {
+  filename_ = cache_.generateFilename(key_);
   cancel_action_in_flight_ = cache_.asyncFileManager()->openExistingFile(
       dispatcher(), filepath(), Common::AsyncFiles::AsyncFileManager::Mode::ReadOnly,
       [this](absl::StatusOr<AsyncFileHandle> open_result) {
@@ -32,6 +31,7 @@ void FileLookupContext::tryOpenCacheFile() {
         }
         ASSERT(!file_handle_);
         file_handle_ = std::move(open_result.value());
+        cache_.trackFileTouched(filename_);
         getHeaderBlockFromFile();
       });
 }
@@ -115,21 +115,13 @@ void FileLookupContext::invalidateCacheEntry() {
   ASSERT(dispatcher()->isThreadSafe());
   // We don't capture the cancel action here because we want these operations to continue even
   // if the filter was destroyed in the meantime. For the same reason, we must not capture 'this'.
-  cache_.asyncFileManager()->stat(
+  cache_.asyncFileManager()->unlink(
       dispatcher(), filepath(),
-      [file = filepath(), cache = cache_.shared_from_this(),
-       dispatcher = dispatcher()](absl::StatusOr<struct stat> stat_result) {
-        ASSERT(dispatcher->isThreadSafe());
-        size_t file_size = 0;
-        if (stat_result.ok()) {
-          file_size = stat_result.value().st_size;
+      [filename = filename_,
+       cache = cache_.shared_from_this()](absl::Status unlink_result) {
+        if (unlink_result.ok()) {
+          cache->trackFileRemoved(filename);
         }
-        cache->asyncFileManager()->unlink(dispatcher, file,
-                                          [cache, file_size](absl::Status unlink_result) {
-                                            if (unlink_result.ok()) {
-                                              cache->trackFileRemoved(file_size);
-                                            }
-                                          });
       });
 }
 
@@ -138,21 +130,30 @@ void FileLookupContext::getBody(const AdjustedByteRange& range, LookupBodyCallba
   ASSERT(cb);
   ASSERT(!cancel_action_in_flight_);
   ASSERT(file_handle_);
-  auto queued = file_handle_->read(
-      dispatcher(), header_block_.offsetToBody() + range.begin(), range.length(),
-      [this, cb = std::move(cb), range](absl::StatusOr<Buffer::InstancePtr> read_result) mutable {
-        ASSERT(dispatcher()->isThreadSafe());
-        cancel_action_in_flight_ = nullptr;
-        if (!read_result.ok() || read_result.value()->length() != range.length()) {
-          invalidateCacheEntry();
-          // Calling callback with nullptr fails the request.
-          std::move(cb)(nullptr, /* end_stream (ignored) = */ false);
-          return;
-        }
-        std::move(cb)(std::move(read_result.value()),
-                      /* end_stream = */ range.end() == header_block_.bodySize() &&
-                          header_block_.trailerSize() == 0);
-      });
+  auto on_read = [this, cb = std::move(cb),
+                  range](absl::StatusOr<Buffer::InstancePtr> read_result) mutable {
+    ASSERT(dispatcher()->isThreadSafe());
+    cancel_action_in_flight_ = nullptr;
+    if (!read_result.ok() || read_result.value()->length() != range.length()) {
+      invalidateCacheEntry();
+      // Calling callback with nullptr fails the request.
+      std::move(cb)(nullptr, /* end_stream (ignored) = */ false);
+      return;
+    }
+    std::move(cb)(std::move(read_result.value()),
+                  /* end_stream = */ range.end() == header_block_.bodySize() &&
+                      header_block_.trailerSize() == 0);
+  };
+  const off_t offset = header_block_.offsetToBody() + range.begin();
+  const ConfigProto& config = cache_.config();
+  absl::StatusOr<CancelFunction> queued;
+  if (config.has_min_memory_mapped_read_bytes() &&
+      range.length() >= config.min_memory_mapped_read_bytes().value()) {
+    // Large reads are served from the page cache, without copying.
+    queued = file_handle_->readMapped(dispatcher(), offset, range.length(), std::move(on_read));
+  } else {
+    queued = file_handle_->read(dispatcher(), offset, range.length(), std::move(on_read));
+  }
   ASSERT(queued.ok(), queued.status().ToString());
   cancel_action_in_flight_ = std::move(queued.value());
 }
@@ -61,6 +61,9 @@ private:
   CancelFunction cancel_action_in_flight_;
   CacheFileFixedBlock header_block_;
   Key key_;
+  // The name of the cache file for key_, relative to the cache path. Set each time the file is
+  // opened, as the key changes when a vary entry leads to the varied key.
+  std::string filename_;
 
   LookupHeadersCallback lookup_headers_callback_;
   const LookupRequest lookup_;
@@ -88,8 +91,9 @@ private:
 // clients could get past the lookup before either creates an InsertContext).
 //
 // The current, early implementation simply allows requests to bypass the cache when
-// the cache entry is in the process of being populated. It is therefore subject to
-// the "thundering herd" problem.
+// the cache entry is in the process of being populated. The cache filter's
+// request_coalescing option mitigates the "thundering herd" problem by making such
+// requests wait for the insertion in flight instead.
 
 } // namespace FileSystemHttpCache
 } // namespace Cache
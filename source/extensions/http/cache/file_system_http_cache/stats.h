@@ -11,10 +11,10 @@ namespace FileSystemHttpCache {
 /**
  * All cache stats. @see stats_macros.h
  *
- * Note that size_bytes and size_count may drift away from true values, due to:
+ * Note that size_bytes and size_count are the totals of the files in the eviction index, which
+ * may drift away from true values, due to:
  * - Changes to the filesystem may be made outside of the process, which will not be
  *   accounted for. (Including, during hot restart, overlapping envoy processes.)
- * - Files completed while pre-cache-purge measurement is in progress may not be counted.
  * - Changes in file size due to header updates are assumed to be negligible, and are ignored.
  *
  * Drift will eventually be reconciled at the next pre-cache-purge measurement.
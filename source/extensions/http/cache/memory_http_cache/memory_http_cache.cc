@@ -0,0 +1,451 @@
+#include "source/extensions/http/cache/memory_http_cache/memory_http_cache.h"
+
+#include <algorithm>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/http/headers.h"
+#include "source/extensions/filters/http/cache/cache_entry_utils.h"
+#include "source/extensions/filters/http/cache/cache_headers_utils.h"
+
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace MemoryHttpCache {
+namespace {
+
+constexpr uint32_t DefaultShards = 16;
+// Frequencies are capped, so that an entry which was popular once is evicted after going around
+// the main queue a few times without lookups.
+constexpr uint8_t MaxFrequency = 3;
+// The part of a shard held by its small queue, as a divisor of the capacity.
+constexpr uint64_t SmallQueueDivisor = 10;
+
+// Returns a Key with the vary header added to custom_fields, or nullopt if the vary headers in the
+// response are not compatible with the VaryAllowList of the request.
+absl::optional<Key> variedRequestKey(const LookupRequest& request,
+                                     const Http::ResponseHeaderMap& response_headers) {
+  absl::btree_set<absl::string_view> vary_header_values =
+      VaryHeaderUtils::getVaryValues(response_headers);
+  ASSERT(!vary_header_values.empty());
+  const absl::optional<std::string> vary_identifier = VaryHeaderUtils::createVaryIdentifier(
+      request.varyAllowList(), vary_header_values, request.requestHeaders());
+  if (!vary_identifier.has_value()) {
+    return absl::nullopt;
+  }
+  Key varied_request_key = request.key();
+  varied_request_key.add_custom_fields(vary_identifier.value());
+  return varied_request_key;
+}
+
+uint64_t entrySizeBytes(const MemoryHttpCache::Entry& entry) {
+  return entry.response_headers_->byteSize() + (entry.body_ ? entry.body_->size() : 0) +
+         (entry.trailers_ ? entry.trailers_->byteSize() : 0);
+}
+
+// A slice of a cached body, which keeps the body alive until the buffer it was added to is done
+// with it.
+class BodyFragment : public Buffer::BufferFragment {
+public:
+  BodyFragment(std::shared_ptr<const std::string> body, uint64_t begin, uint64_t length)
+      : body_(std::move(body)), begin_(begin), length_(length) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return body_->data() + begin_; }
+  size_t size() const override { return length_; }
+  void done() override { delete this; }
+
+private:
+  const std::shared_ptr<const std::string> body_;
+  const uint64_t begin_;
+  const uint64_t length_;
+};
+
+class MemoryLookupContext : public LookupContext {
+public:
+  MemoryLookupContext(Event::Dispatcher& dispatcher, MemoryHttpCache& cache,
+                      LookupRequest&& request)
+      : dispatcher_(dispatcher), cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    MemoryHttpCache::Entry entry = cache_.lookup(request_);
+    body_ = std::move(entry.body_);
+    trailers_ = std::move(entry.trailers_);
+    const uint64_t body_size = body_ ? body_->size() : 0;
+    LookupResult result = entry.response_headers_
+                              ? request_.makeLookupResult(std::move(entry.response_headers_),
+                                                          std::move(entry.metadata_), body_size)
+                              : LookupResult{};
+    const bool end_stream = body_size == 0 && trailers_ == nullptr;
+    dispatcher_.post([result = std::move(result), cb = std::move(cb), end_stream,
+                      cancelled = cancelled_]() mutable {
+      if (!*cancelled) {
+        std::move(cb)(std::move(result), end_stream);
+      }
+    });
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(body_ != nullptr && range.end() <= body_->size(), "Attempt to read past end of body.");
+    auto result = std::make_unique<Buffer::OwnedImpl>();
+    result->addBufferFragment(*new BodyFragment(body_, range.begin(), range.length()));
+    const bool end_stream = trailers_ == nullptr && range.end() == body_->size();
+    dispatcher_.post([result = std::move(result), cb = std::move(cb), end_stream,
+                      cancelled = cancelled_]() mutable {
+      if (!*cancelled) {
+        std::move(cb)(std::move(result), end_stream);
+      }
+    });
+  }
+
+  void getTrailers(LookupTrailersCallback&& cb) override {
+    ASSERT(trailers_);
+    dispatcher_.post(
+        [cb = std::move(cb), trailers = std::move(trailers_), cancelled = cancelled_]() mutable {
+          if (!*cancelled) {
+            std::move(cb)(std::move(trailers));
+          }
+        });
+  }
+
+  const LookupRequest& request() const { return request_; }
+  void onDestroy() override { *cancelled_ = true; }
+  Event::Dispatcher& dispatcher() const { return dispatcher_; }
+
+private:
+  Event::Dispatcher& dispatcher_;
+  std::shared_ptr<bool> cancelled_ = std::make_shared<bool>(false);
+  MemoryHttpCache& cache_;
+  const LookupRequest request_;
+  std::shared_ptr<const std::string> body_;
+  Http::ResponseTrailerMapPtr trailers_;
+};
+
+class MemoryInsertContext : public InsertContext {
+public:
+  MemoryInsertContext(LookupContextPtr&& lookup_context, MemoryHttpCache& cache)
+      : lookup_context_(std::move(lookup_context)),
+        dispatcher_(static_cast<MemoryLookupContext&>(*lookup_context_).dispatcher()),
+        cache_(cache) {}
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, InsertCallback insert_success,
+                     bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    metadata_ = metadata;
+    post(std::move(insert_success), end_stream ? commit() : fits(0));
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+    // Give up early on responses that can't fit, rather than buffering all of them.
+    if (!fits(chunk.length())) {
+      post(std::move(ready_for_next_chunk), false);
+      return;
+    }
+    const uint64_t size = body_.size();
+    body_.resize(size + chunk.length());
+    chunk.copyOut(0, chunk.length(), body_.data() + size);
+    post(std::move(ready_for_next_chunk), end_stream ? commit() : true);
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap& trailers,
+                      InsertCallback insert_complete) override {
+    ASSERT(!committed_);
+    trailers_ = Http::createHeaderMap<Http::ResponseTrailerMapImpl>(trailers);
+    post(std::move(insert_complete), commit());
+  }
+
+  void onDestroy() override { *cancelled_ = true; }
+
+private:
+  void post(InsertCallback cb, bool result) {
+    dispatcher_.post([cb = std::move(cb), result = result, cancelled = cancelled_]() mutable {
+      if (!*cancelled) {
+        std::move(cb)(result);
+      }
+    });
+  }
+
+  bool fits(uint64_t more_bytes) const {
+    return response_headers_->byteSize() + body_.size() + more_bytes <= cache_.maxEntrySizeBytes();
+  }
+
+  bool commit() {
+    committed_ = true;
+    return cache_.insert(static_cast<MemoryLookupContext&>(*lookup_context_).request(),
+                         {std::move(response_headers_), std::move(metadata_),
+                          std::make_shared<const std::string>(std::move(body_)),
+                          std::move(trailers_)});
+  }
+
+  // Keeps the request alive, for its key and its headers to vary on.
+  const LookupContextPtr lookup_context_;
+  Event::Dispatcher& dispatcher_;
+  std::shared_ptr<bool> cancelled_ = std::make_shared<bool>(false);
+  MemoryHttpCache& cache_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  ResponseMetadata metadata_;
+  std::string body_;
+  Http::ResponseTrailerMapPtr trailers_;
+  bool committed_ = false;
+};
+
+} // namespace
+
+MemoryHttpCache::Shard::Shard(uint64_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+MemoryHttpCache::Entry MemoryHttpCache::Shard::lookup(const Key& key) {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    return Entry{};
+  }
+  Node& node = it->second;
+  // Racing lookups may lose an increment, which is harmless for an eviction heuristic.
+  const uint8_t frequency = node.frequency_.load(std::memory_order_relaxed);
+  if (frequency < MaxFrequency) {
+    node.frequency_.store(frequency + 1, std::memory_order_relaxed);
+  }
+  const Entry& entry = node.entry_;
+  return Entry{Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*entry.response_headers_),
+               entry.metadata_, entry.body_,
+               entry.trailers_
+                   ? Http::createHeaderMap<Http::ResponseTrailerMapImpl>(*entry.trailers_)
+                   : nullptr};
+}
+
+void MemoryHttpCache::Shard::insert(const Key& key, uint64_t hash, Entry&& entry) {
+  const uint64_t size_bytes = entrySizeBytes(entry);
+  absl::WriterMutexLock lock(&mutex_);
+  auto [it, inserted] = map_.try_emplace(key);
+  Node& node = it->second;
+  if (!inserted) {
+    // A replaced entry keeps its place and its frequency.
+    size_bytes_ -= node.size_bytes_;
+    if (!node.in_main_) {
+      small_size_bytes_ -= node.size_bytes_;
+    }
+  } else if (ghost_set_.erase(hash) > 0) {
+    node.in_main_ = true;
+    node.position_ = main_.insert(main_.end(), &it->first);
+  } else {
+    node.position_ = small_.insert(small_.end(), &it->first);
+  }
+  node.entry_ = std::move(entry);
+  node.size_bytes_ = size_bytes;
+  node.hash_ = hash;
+  size_bytes_ += size_bytes;
+  if (!node.in_main_) {
+    small_size_bytes_ += size_bytes;
+  }
+  evictLocked(&it->first);
+}
+
+bool MemoryHttpCache::Shard::updateHeaders(const Key& key,
+                                           const Http::ResponseHeaderMap& response_headers,
+                                           const ResponseMetadata& metadata) {
+  absl::WriterMutexLock lock(&mutex_);
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    return false;
+  }
+  Node& node = it->second;
+  applyHeaderUpdate(response_headers, *node.entry_.response_headers_);
+  node.entry_.metadata_ = metadata;
+  // The headers may have grown or shrunk a little; account for it without evicting anything.
+  const uint64_t size_bytes = entrySizeBytes(node.entry_);
+  size_bytes_ = size_bytes_ - node.size_bytes_ + size_bytes;
+  if (!node.in_main_) {
+    small_size_bytes_ = small_size_bytes_ - node.size_bytes_ + size_bytes;
+  }
+  node.size_bytes_ = size_bytes;
+  return true;
+}
+
+uint64_t MemoryHttpCache::Shard::sizeBytes() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return size_bytes_;
+}
+
+uint64_t MemoryHttpCache::Shard::entryCount() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return map_.size();
+}
+
+void MemoryHttpCache::Shard::evictLocked(const Key* inserted) {
+  while (size_bytes_ > capacity_bytes_) {
+    // The entry just inserted is not evicted right away, even if it is larger than the small queue
+    // should be, or it could never be looked up again to earn its place.
+    const bool small_queue_full = !small_.empty() && small_.front() != inserted &&
+                                  small_size_bytes_ >= capacity_bytes_ / SmallQueueDivisor;
+    if (main_.empty() || small_queue_full) {
+      evictFromSmallLocked();
+    } else {
+      evictFromMainLocked();
+    }
+  }
+}
+
+void MemoryHttpCache::Shard::evictFromSmallLocked() {
+  auto it = map_.find(*small_.front());
+  ASSERT(it != map_.end());
+  Node& node = it->second;
+  small_.pop_front();
+  small_size_bytes_ -= node.size_bytes_;
+  if (node.frequency_.load(std::memory_order_relaxed) > 0) {
+    // Looked up again while in the small queue, so worth keeping.
+    node.in_main_ = true;
+    node.frequency_.store(0, std::memory_order_relaxed);
+    node.position_ = main_.insert(main_.end(), &it->first);
+    return;
+  }
+  addGhostLocked(node.hash_);
+  size_bytes_ -= node.size_bytes_;
+  map_.erase(it);
+}
+
+void MemoryHttpCache::Shard::evictFromMainLocked() {
+  auto it = map_.find(*main_.front());
+  ASSERT(it != map_.end());
+  Node& node = it->second;
+  const uint8_t frequency = node.frequency_.load(std::memory_order_relaxed);
+  if (frequency > 0) {
+    node.frequency_.store(frequency - 1, std::memory_order_relaxed);
+    main_.splice(main_.end(), main_, main_.begin());
+    return;
+  }
+  main_.pop_front();
+  size_bytes_ -= node.size_bytes_;
+  map_.erase(it);
+}
+
+void MemoryHttpCache::Shard::addGhostLocked(uint64_t hash) {
+  if (!ghost_set_.insert(hash).second) {
+    return;
+  }
+  ghosts_.push_back(hash);
+  // Remember about as many evicted keys as there are entries in the main queue.
+  while (ghosts_.size() > std::max<size_t>(main_.size(), 1)) {
+    ghost_set_.erase(ghosts_.front());
+    ghosts_.pop_front();
+  }
+}
+
+MemoryHttpCache::MemoryHttpCache(const ConfigProto& config) : config_(config) {
+  const uint32_t shards = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, shards, DefaultShards);
+  const uint64_t shard_capacity_bytes =
+      std::max<uint64_t>(config.max_cache_size_bytes() / shards, 1);
+  max_entry_size_bytes_ = std::min(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_cache_entry_size_bytes, shard_capacity_bytes),
+      shard_capacity_bytes);
+  shards_.reserve(shards);
+  for (uint32_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(shard_capacity_bytes));
+  }
+}
+
+LookupContextPtr MemoryHttpCache::makeLookupContext(LookupRequest&& request,
+                                                    Http::StreamFilterCallbacks& callbacks) {
+  return std::make_unique<MemoryLookupContext>(callbacks.dispatcher(), *this, std::move(request));
+}
+
+InsertContextPtr MemoryHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
+                                                    Http::StreamFilterCallbacks&) {
+  ASSERT(lookup_context != nullptr);
+  // Pending lookup callbacks must not run once the lookup has turned into an insertion.
+  lookup_context->onDestroy();
+  return std::make_unique<MemoryInsertContext>(std::move(lookup_context), *this);
+}
+
+void MemoryHttpCache::updateHeaders(const LookupContext& lookup_context,
+                                    const Http::ResponseHeaderMap& response_headers,
+                                    const ResponseMetadata& metadata,
+                                    UpdateHeadersCallback on_complete) {
+  const auto& memory_lookup_context = static_cast<const MemoryLookupContext&>(lookup_context);
+  const LookupRequest& request = memory_lookup_context.request();
+  bool updated = false;
+  Entry entry = shardFor(stableHashKey(request.key())).lookup(request.key());
+  if (entry.response_headers_ != nullptr) {
+    if (VaryHeaderUtils::hasVary(*entry.response_headers_)) {
+      absl::optional<Key> varied_key = variedRequestKey(request, *entry.response_headers_);
+      updated = varied_key.has_value() &&
+                shardFor(stableHashKey(varied_key.value()))
+                    .updateHeaders(varied_key.value(), response_headers, metadata);
+    } else {
+      updated = shardFor(stableHashKey(request.key()))
+                    .updateHeaders(request.key(), response_headers, metadata);
+    }
+  }
+  memory_lookup_context.dispatcher().post(
+      [on_complete = std::move(on_complete), updated]() mutable {
+        std::move(on_complete)(updated);
+      });
+}
+
+CacheInfo MemoryHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = name();
+  return cache_info;
+}
+
+MemoryHttpCache::Entry MemoryHttpCache::lookup(const LookupRequest& request) {
+  Entry entry = shardFor(stableHashKey(request.key())).lookup(request.key());
+  if (entry.response_headers_ == nullptr || !VaryHeaderUtils::hasVary(*entry.response_headers_)) {
+    return entry;
+  }
+  absl::optional<Key> varied_key = variedRequestKey(request, *entry.response_headers_);
+  if (!varied_key.has_value()) {
+    return Entry{};
+  }
+  return shardFor(stableHashKey(varied_key.value())).lookup(varied_key.value());
+}
+
+bool MemoryHttpCache::insert(const LookupRequest& request, Entry&& entry) {
+  if (entrySizeBytes(entry) > max_entry_size_bytes_) {
+    return false;
+  }
+  if (!VaryHeaderUtils::hasVary(*entry.response_headers_)) {
+    insertIntoShard(request.key(), std::move(entry));
+    return true;
+  }
+  absl::optional<Key> varied_key = variedRequestKey(request, *entry.response_headers_);
+  if (!varied_key.has_value()) {
+    // Skip the insert if we are unable to create a vary key.
+    return false;
+  }
+  // Add a special entry to flag that this request generates varied responses.
+  Http::ResponseHeaderMapPtr vary_only_map =
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>({});
+  vary_only_map->setCopy(Http::CustomHeaders::get().Vary,
+                         absl::StrJoin(VaryHeaderUtils::getVaryValues(*entry.response_headers_),
+                                       ","));
+  insertIntoShard(varied_key.value(), std::move(entry));
+  insertIntoShard(request.key(), Entry{std::move(vary_only_map), {}, nullptr, nullptr});
+  return true;
+}
+
+uint64_t MemoryHttpCache::sizeBytes() const {
+  uint64_t size_bytes = 0;
+  for (const auto& shard : shards_) {
+    size_bytes += shard->sizeBytes();
+  }
+  return size_bytes;
+}
+
+void MemoryHttpCache::insertIntoShard(const Key& key, Entry&& entry) {
+  const uint64_t hash = stableHashKey(key);
+  shardFor(hash).insert(key, hash, std::move(entry));
+}
+
+} // namespace MemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/http/cache/memory_http_cache/v3/memory_http_cache.pb.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace MemoryHttpCache {
+
+using ConfigProto = envoy::extensions::http::cache::memory_http_cache::v3::MemoryHttpCacheConfig;
+
+/**
+ * An in-memory cache bounded by size. Entries are spread over shards by the hash of their key,
+ * and each shard has its own lock and evicts its own entries, so that workers only contend when
+ * they use entries of the same shard.
+ *
+ * Cached bodies are immutable and reference counted, so that a hit hands out slices of the cached
+ * body instead of copies, and an entry can be evicted while responses are still served from it.
+ */
+class MemoryHttpCache : public HttpCache {
+public:
+  struct Entry {
+    Http::ResponseHeaderMapPtr response_headers_;
+    ResponseMetadata metadata_;
+    std::shared_ptr<const std::string> body_;
+    Http::ResponseTrailerMapPtr trailers_;
+  };
+
+  /**
+   * A part of the cache, evicting entries with the S3-FIFO policy: an entry is first inserted
+   * into a small queue, which holds about a tenth of the shard. When it reaches the head of the
+   * small queue, it moves to the main queue if it was looked up since it was inserted, and is
+   * evicted otherwise, leaving its hash in a queue of ghosts. An entry whose hash is a ghost is
+   * inserted straight into the main queue. When an entry reaches the head of the main queue, it
+   * is evicted unless it was looked up since it was last there, in which case it goes around
+   * again.
+   */
+  class Shard {
+  public:
+    explicit Shard(uint64_t capacity_bytes);
+
+    // Returns a copy of the entry for key, sharing its body, or an entry without response headers
+    // if there is none.
+    Entry lookup(const Key& key);
+
+    // Inserts or replaces the entry for key, then evicts entries until the shard fits in its
+    // capacity.
+    void insert(const Key& key, uint64_t hash, Entry&& entry);
+
+    // Updates the headers of the entry for key. Returns false if there is no such entry.
+    bool updateHeaders(const Key& key, const Http::ResponseHeaderMap& response_headers,
+                       const ResponseMetadata& metadata);
+
+    uint64_t sizeBytes() const;
+    uint64_t entryCount() const;
+
+  private:
+    struct Node {
+      Entry entry_;
+      uint64_t size_bytes_ = 0;
+      uint64_t hash_ = 0;
+      // The number of lookups since the entry was inserted or last went around the main queue,
+      // capped at MaxFrequency. Bumped with the lock held for reading.
+      std::atomic<uint8_t> frequency_{0};
+      bool in_main_ = false;
+      std::list<const Key*>::iterator position_;
+    };
+
+    // Evicts entries until the shard fits in its capacity, sparing the entry just inserted.
+    void evictLocked(const Key* inserted) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+    void evictFromSmallLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+    void evictFromMainLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+    void addGhostLocked(uint64_t hash) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+    const uint64_t capacity_bytes_;
+    mutable absl::Mutex mutex_;
+    // Nodes are not moved by rehashing, so the queues can point at their keys.
+    absl::node_hash_map<Key, Node, MessageUtil, MessageUtil> map_ ABSL_GUARDED_BY(mutex_);
+    std::list<const Key*> small_ ABSL_GUARDED_BY(mutex_);
+    std::list<const Key*> main_ ABSL_GUARDED_BY(mutex_);
+    std::list<uint64_t> ghosts_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_set<uint64_t> ghost_set_ ABSL_GUARDED_BY(mutex_);
+    uint64_t size_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+    uint64_t small_size_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  };
+
+  explicit MemoryHttpCache(const ConfigProto& config);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request,
+                                     Http::StreamFilterCallbacks& callbacks) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Http::StreamFilterCallbacks& callbacks) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, UpdateHeadersCallback on_complete) override;
+  CacheInfo cacheInfo() const override;
+
+  // Looks up the entry for the request, following the vary headers of the response if any.
+  Entry lookup(const LookupRequest& request);
+
+  // Inserts the response for the request, under a key varied by the request headers if the
+  // response has a vary header. Returns false if the response is too large, or varies on headers
+  // that are not allowed.
+  bool insert(const LookupRequest& request, Entry&& entry);
+
+  const ConfigProto& config() const { return config_; }
+  uint64_t maxEntrySizeBytes() const { return max_entry_size_bytes_; }
+
+  // The total size of the entries in all the shards.
+  uint64_t sizeBytes() const;
+
+  static absl::string_view name() { return "envoy.extensions.http.cache.memory_http_cache"; }
+
+private:
+  Shard& shardFor(uint64_t hash) { return *shards_[hash % shards_.size()]; }
+  void insertIntoShard(const Key& key, Entry&& entry);
+
+  const ConfigProto config_;
+  uint64_t max_entry_size_bytes_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace MemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,62 @@
+#include <memory>
+
+#include "envoy/extensions/http/cache/tiered_http_cache/v3/tiered_http_cache.pb.h"
+#include "envoy/extensions/http/cache/tiered_http_cache/v3/tiered_http_cache.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/extensions/filters/http/cache/http_cache.h"
+#include "source/extensions/http/cache/tiered_http_cache/tiered_http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace TieredHttpCache {
+namespace {
+
+class TieredHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string{TieredHttpCache::name()}; }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ConfigProto>();
+  }
+  // From HttpCacheFactory
+  std::shared_ptr<HttpCache>
+  getCache(const envoy::extensions::filters::http::cache::v3::CacheConfig& filter_config,
+           Server::Configuration::FactoryContext& context) override {
+    ConfigProto config;
+    THROW_IF_NOT_OK(MessageUtil::unpackTo(filter_config.typed_config(), config));
+    MessageUtil::validate(config, context.messageValidationVisitor());
+    // Each tier is created by its own factory, so that it is shared with other filters configured
+    // with the same cache, tiered or not.
+    return std::make_shared<TieredHttpCache>(tierCache(filter_config, config.l1_cache(), context),
+                                             tierCache(filter_config, config.l2_cache(), context));
+  }
+
+private:
+  static std::shared_ptr<HttpCache>
+  tierCache(const envoy::extensions::filters::http::cache::v3::CacheConfig& filter_config,
+            const ProtobufWkt::Any& tier_config, Server::Configuration::FactoryContext& context) {
+    const std::string type{TypeUtil::typeUrlToDescriptorFullName(tier_config.type_url())};
+    HttpCacheFactory* const http_cache_factory =
+        Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(type);
+    if (http_cache_factory == nullptr) {
+      throw EnvoyException(
+          fmt::format("Didn't find a registered implementation for type: '{}'", type));
+    }
+    envoy::extensions::filters::http::cache::v3::CacheConfig tier_filter_config = filter_config;
+    *tier_filter_config.mutable_typed_config() = tier_config;
+    return http_cache_factory->getCache(tier_filter_config, context);
+  }
+};
+
+static Registry::RegisterFactory<TieredHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace
+} // namespace TieredHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,304 @@
+#include "source/extensions/http/cache/tiered_http_cache/tiered_http_cache.h"
+
+#include <array>
+#include <vector>
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace TieredHttpCache {
+namespace {
+
+class TieredLookupContext : public LookupContext {
+public:
+  TieredLookupContext(HttpCache& l1, HttpCache& l2, LookupRequest&& request,
+                      Http::StreamFilterCallbacks& callbacks)
+      : l1_(l1), l2_(l2), callbacks_(callbacks), request_(std::move(request)),
+        l1_context_(l1_.makeLookupContext(LookupRequest(request_), callbacks_)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    l1_context_->getHeaders(
+        [this, cb = std::move(cb)](LookupResult&& result, bool end_stream) mutable {
+          if (result.cache_entry_status_ == CacheEntryStatus::Ok ||
+              result.cache_entry_status_ == CacheEntryStatus::FoundNotModified) {
+            serving_ = l1_context_.get();
+            std::move(cb)(std::move(result), end_stream);
+            return;
+          }
+          l1_result_ = std::move(result);
+          l1_end_stream_ = end_stream;
+          l2_context_ = l2_.makeLookupContext(LookupRequest(request_), callbacks_);
+          l2_context_->getHeaders(
+              [this, cb = std::move(cb)](LookupResult&& result, bool end_stream) mutable {
+                onL2Headers(std::move(cb), std::move(result), end_stream);
+              });
+        });
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    // Only a body read in order from its start can be inserted into l1.
+    if (range.begin() != promoted_bytes_) {
+      promotion_failed_ = true;
+    }
+    if (!promoting()) {
+      serving_->getBody(range, std::move(cb));
+      return;
+    }
+    serving_->getBody(range, [this, cb = std::move(cb)](Buffer::InstancePtr&& body,
+                                                        bool end_stream) mutable {
+      promoteBody(body.get(), end_stream);
+      std::move(cb)(std::move(body), end_stream);
+    });
+  }
+
+  void getTrailers(LookupTrailersCallback&& cb) override {
+    if (!promoting()) {
+      serving_->getTrailers(std::move(cb));
+      return;
+    }
+    serving_->getTrailers(
+        [this, cb = std::move(cb)](Http::ResponseTrailerMapPtr&& trailers) mutable {
+          if (promoting() && promotion_ready_) {
+            promotion_ready_ = false;
+            promotion_->insertTrailers(*trailers, [this](bool ready) { onPromotionReady(ready); });
+          }
+          std::move(cb)(std::move(trailers));
+        });
+  }
+
+  void onDestroy() override {
+    if (l1_context_ != nullptr) {
+      l1_context_->onDestroy();
+    }
+    if (l2_context_ != nullptr) {
+      l2_context_->onDestroy();
+    }
+    if (promotion_ != nullptr) {
+      promotion_->onDestroy();
+    }
+  }
+
+  // The lookups of each tier, or nullptr if the tier was not looked up, or its lookup was handed
+  // over to an insertion.
+  const LookupContext* l1Context() const { return l1_context_.get(); }
+  const LookupContext* l2Context() const { return l2_context_.get(); }
+  LookupContextPtr takeL1Context() { return std::move(l1_context_); }
+  LookupContextPtr takeL2Context() { return std::move(l2_context_); }
+
+private:
+  void onL2Headers(LookupHeadersCallback&& cb, LookupResult&& result, bool end_stream) {
+    if (result.cache_entry_status_ != CacheEntryStatus::Ok &&
+        l1_result_.cache_entry_status_ == CacheEntryStatus::RequiresValidation) {
+      // l2 has nothing better than the stale entry of l1, which is closer to validate.
+      serving_ = l1_context_.get();
+      std::move(cb)(std::move(l1_result_), l1_end_stream_);
+      return;
+    }
+    serving_ = l2_context_.get();
+    if (result.cache_entry_status_ == CacheEntryStatus::Ok) {
+      startPromotion(*result.headers_, end_stream);
+    }
+    std::move(cb)(std::move(result), end_stream);
+  }
+
+  void startPromotion(const Http::ResponseHeaderMap& response_headers, bool end_stream) {
+    promotion_ = l1_.makeInsertContext(std::move(l1_context_), callbacks_);
+    if (promotion_ == nullptr) {
+      return;
+    }
+    // The headers carry the age of the entry as of now, so it keeps ageing from there in l1.
+    promotion_->insertHeaders(
+        response_headers, ResponseMetadata{callbacks_.dispatcher().timeSource().systemTime()},
+        [this](bool ready) { onPromotionReady(ready); }, end_stream);
+  }
+
+  void promoteBody(const Buffer::Instance* body, bool end_stream) {
+    // l1 sets the pace of the insertion. Rather than buffering a chunk it is not ready for, or
+    // waiting for it before serving the chunk, the promotion is given up.
+    if (!promoting() || body == nullptr || !promotion_ready_) {
+      promotion_failed_ = true;
+      return;
+    }
+    promotion_ready_ = false;
+    promoted_bytes_ += body->length();
+    promotion_->insertBody(*body, [this](bool ready) { onPromotionReady(ready); }, end_stream);
+  }
+
+  void onPromotionReady(bool ready) {
+    promotion_ready_ = ready;
+    promotion_failed_ = promotion_failed_ || !ready;
+  }
+
+  bool promoting() const { return promotion_ != nullptr && !promotion_failed_; }
+
+  HttpCache& l1_;
+  HttpCache& l2_;
+  Http::StreamFilterCallbacks& callbacks_;
+  const LookupRequest request_;
+  LookupContextPtr l1_context_;
+  LookupContextPtr l2_context_;
+  // The result of l1 when it had no fresh entry, kept in case l2 has none either.
+  LookupResult l1_result_;
+  bool l1_end_stream_ = false;
+  LookupContext* serving_ = nullptr;
+  // Inserts the entry being served from l2 into l1.
+  InsertContextPtr promotion_;
+  bool promotion_ready_ = false;
+  bool promotion_failed_ = false;
+  uint64_t promoted_bytes_ = 0;
+};
+
+// Inserts into both tiers, calling back once both have, and carrying on with the tier which is
+// still willing if the other one gives up.
+class TieredInsertContext : public InsertContext {
+public:
+  TieredInsertContext(InsertContextPtr l1, InsertContextPtr l2) {
+    tiers_[0].context_ = std::move(l1);
+    tiers_[1].context_ = std::move(l2);
+    for (Tier& tier : tiers_) {
+      tier.live_ = tier.context_ != nullptr;
+    }
+  }
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, InsertCallback insert_complete,
+                     bool end_stream) override {
+    forEachLiveTier(std::move(insert_complete), [&](InsertContext& tier, InsertCallback cb) {
+      tier.insertHeaders(response_headers, metadata, std::move(cb), end_stream);
+    });
+  }
+
+  void insertBody(const Buffer::Instance& fragment, InsertCallback ready_for_next_fragment,
+                  bool end_stream) override {
+    forEachLiveTier(std::move(ready_for_next_fragment),
+                    [&](InsertContext& tier, InsertCallback cb) {
+                      tier.insertBody(fragment, std::move(cb), end_stream);
+                    });
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap& trailers,
+                      InsertCallback insert_complete) override {
+    forEachLiveTier(std::move(insert_complete), [&](InsertContext& tier, InsertCallback cb) {
+      tier.insertTrailers(trailers, std::move(cb));
+    });
+  }
+
+  void onDestroy() override {
+    for (Tier& tier : tiers_) {
+      if (tier.context_ != nullptr) {
+        tier.context_->onDestroy();
+      }
+    }
+  }
+
+private:
+  struct Tier {
+    InsertContextPtr context_;
+    // False once the tier gave up on the insertion.
+    bool live_ = false;
+  };
+
+  template <class InsertFn> void forEachLiveTier(InsertCallback cb, InsertFn insert) {
+    ASSERT(pending_ == 0);
+    cb_ = std::move(cb);
+    for (const Tier& tier : tiers_) {
+      pending_ += tier.live_ ? 1 : 0;
+    }
+    // The filter stops inserting once it has been called back with false.
+    ASSERT(pending_ > 0);
+    for (Tier& tier : tiers_) {
+      if (tier.live_) {
+        insert(*tier.context_, [this, &tier](bool ready) { onTierReady(tier, ready); });
+      }
+    }
+  }
+
+  void onTierReady(Tier& tier, bool ready) {
+    tier.live_ = ready;
+    if (--pending_ > 0) {
+      return;
+    }
+    // The tiers post their callbacks, so this already runs on the filter's dispatcher. The
+    // callback may destroy this context.
+    InsertCallback cb = std::move(cb_);
+    std::move(cb)(tiers_[0].live_ || tiers_[1].live_);
+  }
+
+  std::array<Tier, 2> tiers_;
+  InsertCallback cb_;
+  uint32_t pending_ = 0;
+};
+
+} // namespace
+
+TieredHttpCache::TieredHttpCache(std::shared_ptr<HttpCache> l1, std::shared_ptr<HttpCache> l2)
+    : l1_(std::move(l1)), l2_(std::move(l2)) {}
+
+LookupContextPtr TieredHttpCache::makeLookupContext(LookupRequest&& request,
+                                                    Http::StreamFilterCallbacks& callbacks) {
+  return std::make_unique<TieredLookupContext>(*l1_, *l2_, std::move(request), callbacks);
+}
+
+InsertContextPtr TieredHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
+                                                    Http::StreamFilterCallbacks& callbacks) {
+  ASSERT(lookup_context != nullptr);
+  auto& tiered_lookup_context = static_cast<TieredLookupContext&>(*lookup_context);
+  LookupContextPtr l1_context = tiered_lookup_context.takeL1Context();
+  LookupContextPtr l2_context = tiered_lookup_context.takeL2Context();
+  lookup_context->onDestroy();
+  InsertContextPtr l1 =
+      l1_context != nullptr ? l1_->makeInsertContext(std::move(l1_context), callbacks) : nullptr;
+  InsertContextPtr l2 =
+      l2_context != nullptr ? l2_->makeInsertContext(std::move(l2_context), callbacks) : nullptr;
+  if (l1 == nullptr && l2 == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<TieredInsertContext>(std::move(l1), std::move(l2));
+}
+
+void TieredHttpCache::updateHeaders(const LookupContext& lookup_context,
+                                    const Http::ResponseHeaderMap& response_headers,
+                                    const ResponseMetadata& metadata,
+                                    UpdateHeadersCallback on_complete) {
+  const auto& tiered_lookup_context = static_cast<const TieredLookupContext&>(lookup_context);
+  std::vector<std::pair<HttpCache*, const LookupContext*>> tiers;
+  if (tiered_lookup_context.l1Context() != nullptr) {
+    tiers.emplace_back(l1_.get(), tiered_lookup_context.l1Context());
+  }
+  if (tiered_lookup_context.l2Context() != nullptr) {
+    tiers.emplace_back(l2_.get(), tiered_lookup_context.l2Context());
+  }
+  ASSERT(!tiers.empty());
+
+  struct State {
+    size_t pending_;
+    bool updated_;
+    UpdateHeadersCallback on_complete_;
+  };
+  auto state = std::make_shared<State>(State{tiers.size(), false, std::move(on_complete)});
+  for (const auto& [cache, context] : tiers) {
+    cache->updateHeaders(*context, response_headers, metadata, [state](bool updated) {
+      state->updated_ = state->updated_ || updated;
+      if (--state->pending_ == 0) {
+        std::move(state->on_complete_)(state->updated_);
+      }
+    });
+  }
+}
+
+CacheInfo TieredHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = name();
+  cache_info.supports_range_requests_ =
+      l1_->cacheInfo().supports_range_requests_ && l2_->cacheInfo().supports_range_requests_;
+  return cache_info;
+}
+
+} // namespace TieredHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
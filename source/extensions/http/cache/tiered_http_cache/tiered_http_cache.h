@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/extensions/http/cache/tiered_http_cache/v3/tiered_http_cache.pb.h"
+
+#include "source/extensions/filters/http/cache/http_cache.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace TieredHttpCache {
+
+using ConfigProto = envoy::extensions::http::cache::tiered_http_cache::v3::TieredHttpCacheConfig;
+
+/**
+ * A cache made of two caches, typically a small and fast one in front of a large and slow one.
+ *
+ * Lookups try l1 first, and fall back to l2 unless l1 has a fresh entry. An entry found fresh in
+ * l2 is inserted into l1 as its body is read, so hot entries end up being served from l1 while
+ * the long tail stays in l2. Insertions go to both caches, so l2 still holds what l1 evicts and
+ * nothing needs to be written back on eviction.
+ */
+class TieredHttpCache : public HttpCache {
+public:
+  TieredHttpCache(std::shared_ptr<HttpCache> l1, std::shared_ptr<HttpCache> l2);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request,
+                                     Http::StreamFilterCallbacks& callbacks) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Http::StreamFilterCallbacks& callbacks) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, UpdateHeadersCallback on_complete) override;
+  CacheInfo cacheInfo() const override;
+
+  static absl::string_view name() { return "envoy.extensions.http.cache.tiered_http_cache"; }
+
+private:
+  const std::shared_ptr<HttpCache> l1_;
+  const std::shared_ptr<HttpCache> l2_;
+};
+
+} // namespace TieredHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -64,7 +64,7 @@ ClientSideWeightedRoundRobinLoadBalancer::WorkerLocalLb::WorkerLocalLb(
                              getRoundRobinConfig(common_config), time_source) {
   if (tls_shim.has_value()) {
     apply_weights_cb_handle_ = tls_shim->apply_weights_cb_helper_.add([this](uint32_t priority) {
-      refresh(priority);
+      refresh(priority, {}, {});
       return absl::OkStatus();
     });
   }
@@ -19,6 +19,7 @@
 #include "source/common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_set.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -853,6 +854,8 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
                                 healthy_panic_threshold, locality_config),
       seed_(random_.random()),
+      incremental_edf_refresh_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.edf_lb_incremental_refresh")),
       slow_start_window_(slow_start_config.has_value()
                              ? std::chrono::milliseconds(DurationUtil::durationToMilliseconds(
                                    slow_start_config.value().slow_start_window()))
@@ -867,14 +870,13 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
                                                slow_start_config.value(), min_weight_percent, 10) /
                                                100.0
                                          : 0.1) {
-  // We fully recompute the schedulers for a given host set here on membership change, which is
-  // consistent with what other LB implementations do (e.g. thread aware).
-  // The downside of a full recompute is that time complexity is O(n * log n),
-  // so we will need to do better at delta tracking to scale (see
-  // https://github.com/envoyproxy/envoy/issues/2874).
+  // We refresh the schedulers for a given host set here on membership change. Unless
+  // incremental_edf_refresh_ is set, they are fully recomputed, which is consistent with what
+  // other LB implementations do (e.g. thread aware). The downside of a full recompute is that time
+  // complexity is O(n * log n), see https://github.com/envoyproxy/envoy/issues/2874.
   priority_update_cb_ = priority_set.addPriorityUpdateCb(
-      [this](uint32_t priority, const HostVector&, const HostVector&) {
-        refresh(priority);
+      [this](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
+        refresh(priority, hosts_added, hosts_removed);
         return absl::OkStatus();
       });
   member_update_cb_ = priority_set.addMemberUpdateCb(
@@ -888,7 +890,7 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
 
 void EdfLoadBalancerBase::initialize() {
   for (uint32_t priority = 0; priority < priority_set_.hostSetsPerPriority().size(); ++priority) {
-    refresh(priority);
+    refresh(priority, {}, {});
   }
 }
 
@@ -916,20 +918,58 @@ void EdfLoadBalancerBase::recalculateHostsInSlowStart(const HostVector& hosts) {
   }
 }
 
-void EdfLoadBalancerBase::refresh(uint32_t priority) {
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
+void EdfLoadBalancerBase::refresh(uint32_t priority, const HostVector& hosts_added,
+                                  const HostVector& hosts_removed) {
+  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
+  // Changes to the health or weight of existing hosts are not reported as added or removed hosts,
+  // so updates without any are applied by rescanning the sources.
+  const bool hosts_changed = !hosts_added.empty() || !hosts_removed.empty();
+  // Every other source is a subset of all hosts, so when all hosts have the same weight, the
+  // sources don't have to be scanned again. All hosts are only scanned once a source needs it.
+  absl::optional<bool> all_host_weights_are_equal;
+  const auto host_weights_are_equal = [&host_set,
+                                       &all_host_weights_are_equal](const HostVector& hosts) {
+    if (!all_host_weights_are_equal.has_value()) {
+      all_host_weights_are_equal = hostWeightsAreEqual(host_set->hosts());
+    }
+    return all_host_weights_are_equal.value() ||
+           (&hosts != &host_set->hosts() && hostWeightsAreEqual(hosts));
+  };
+  const auto add_hosts_source = [this, hosts_changed, &hosts_added, &hosts_removed,
+                                 &host_weights_are_equal](HostsSource source,
+                                                          const HostVector& hosts) {
+    auto& scheduler = scheduler_[source];
+    // Nuke existing scheduler if it exists, unless it can be updated in place below.
+    std::unique_ptr<Upstream::Scheduler<Host>> edf = std::move(scheduler.edf_);
     refreshHostSource(source);
     if (isSlowStartEnabled()) {
       recalculateHostsInSlowStart(hosts);
     }
 
+    // Update the existing schedule with the changes to the hosts and their weights. This is
+    // skipped while hosts are in slow start, as their weights change over time.
+    const bool update_in_place =
+        incremental_edf_refresh_ && edf != nullptr && noHostsAreInSlowStart();
+    auto keep_updated_scheduler = [&](bool rescan) {
+      auto& updatable_edf = static_cast<UpdatableEdfScheduler<Host>&>(*edf);
+      if (rescan || !updateScheduler(updatable_edf, source, hosts, hosts_added, hosts_removed)) {
+        rescanScheduler(updatable_edf, hosts);
+      }
+      scheduler.edf_ = std::move(edf);
+    };
+    // Added and removed hosts are applied without scanning the weights of the source: should they
+    // have become equal, the schedule picks the hosts in turn like the unweighted pick does, until
+    // the next update without added or removed hosts drops it.
+    if (update_in_place && hosts_changed && hosts.size() > 1) {
+      keep_updated_scheduler(false);
+      return;
+    }
+
     // Check if the original host weights are equal and no hosts are in slow start mode, in that
     // case EDF creation is skipped. When all original weights are equal and no hosts are in slow
     // start mode we can rely on unweighted host pick to do optimal round robin and least-loaded
     // host selection with lower memory and CPU overhead.
-    if (hostWeightsAreEqual(hosts) && noHostsAreInSlowStart()) {
+    if (host_weights_are_equal(hosts) && noHostsAreInSlowStart()) {
       // Skip edf creation.
       return;
     }
@@ -941,21 +981,30 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
       return;
     }
 
+    if (update_in_place) {
+      keep_updated_scheduler(true);
+      return;
+    }
+
     // Populate the scheduler with the host list with a randomized starting point.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
     // weighted 1. This is because currently we don't refresh host sets if only weights change.
     // We should probably change this to refresh at all times. See the comment in
     // BaseDynamicClusterImpl::updateDynamicHostList about this.
-    scheduler.edf_ = std::make_unique<EdfScheduler<Host>>(EdfScheduler<Host>::createWithPicks(
-        hosts,
-        // We use a fixed weight here. While the weight may change without
-        // notification, this will only be stale until this host is next picked,
-        // at which point it is reinserted into the EdfScheduler with its new
-        // weight in chooseHost().
-        [this](const Host& host) { return hostWeight(host); }, seed_));
+    // We use a fixed weight here. While the weight may change without
+    // notification, this will only be stale until this host is next picked,
+    // at which point it is reinserted into the EdfScheduler with its new
+    // weight in chooseHost().
+    const auto calculate_weight = [this](const Host& host) { return hostWeight(host); };
+    if (incremental_edf_refresh_) {
+      scheduler.edf_ = std::make_unique<UpdatableEdfScheduler<Host>>(
+          UpdatableEdfScheduler<Host>::createWithPicks(hosts, calculate_weight, seed_));
+    } else {
+      scheduler.edf_ = std::make_unique<EdfScheduler<Host>>(
+          EdfScheduler<Host>::createWithPicks(hosts, calculate_weight, seed_));
+    }
   };
   // Populate EdfSchedulers for each valid HostsSource value for the host set at this priority.
-  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
   add_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts), host_set->hosts());
   add_hosts_source(HostsSource(priority, HostsSource::SourceType::HealthyHosts),
                    host_set->healthyHosts());
@@ -975,6 +1024,75 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
   }
 }
 
+bool EdfLoadBalancerBase::updateScheduler(UpdatableEdfScheduler<Host>& edf,
+                                          const HostsSource& source, const HostVector& hosts,
+                                          const HostVector& hosts_added,
+                                          const HostVector& hosts_removed) {
+  for (const auto& host : hosts_removed) {
+    edf.remove(*host);
+  }
+  // The weights of the other hosts may have changed too, which is picked up when they are next
+  // picked, as with a scheduler that was just created.
+  for (const auto& host : hosts_added) {
+    bool in_source = true;
+    switch (source.source_type_) {
+    case HostsSource::SourceType::AllHosts:
+      break;
+    case HostsSource::SourceType::HealthyHosts:
+      in_source = host->coarseHealth() == Host::Health::Healthy;
+      break;
+    case HostsSource::SourceType::DegradedHosts:
+      in_source = host->coarseHealth() == Host::Health::Degraded;
+      break;
+    case HostsSource::SourceType::LocalityHealthyHosts:
+      in_source = host->coarseHealth() == Host::Health::Healthy &&
+                  LocalityEqualTo()(host->locality(), hosts.front()->locality());
+      break;
+    case HostsSource::SourceType::LocalityDegradedHosts:
+      in_source = host->coarseHealth() == Host::Health::Degraded &&
+                  LocalityEqualTo()(host->locality(), hosts.front()->locality());
+      break;
+    }
+    if (in_source) {
+      edf.add(hostWeight(*host), host);
+    }
+  }
+  if (edf.size() != hosts.size()) {
+    return false;
+  }
+  if (source.source_type_ == HostsSource::SourceType::AllHosts) {
+    return true;
+  }
+  // Health changes of the other hosts are not part of the changes, and the health of the added
+  // hosts may have changed since they were sorted into the sources. Make sure that the sizes don't
+  // match by chance, without touching the schedule.
+  return std::all_of(hosts.begin(), hosts.end(),
+                     [&edf](const HostSharedPtr& host) { return edf.weight(*host).has_value(); });
+}
+
+void EdfLoadBalancerBase::rescanScheduler(UpdatableEdfScheduler<Host>& edf,
+                                          const HostVector& hosts) {
+  // Add new hosts and reschedule the hosts whose weight changed, each in O(log n).
+  for (const auto& host : hosts) {
+    const double weight = hostWeight(*host);
+    const absl::optional<double> scheduled_weight = edf.weight(*host);
+    if (!scheduled_weight.has_value()) {
+      edf.add(weight, host);
+    } else if (scheduled_weight.value() != weight) {
+      edf.update(weight, host);
+    }
+  }
+  // Every host is scheduled now, so only look for hosts to remove if there are others.
+  if (edf.size() != hosts.size()) {
+    absl::flat_hash_set<const Host*> current_hosts;
+    current_hosts.reserve(hosts.size());
+    for (const auto& host : hosts) {
+      current_hosts.insert(host.get());
+    }
+    edf.removeIf([&current_hosts](const Host& host) { return !current_hosts.contains(&host); });
+  }
+}
+
 bool EdfLoadBalancerBase::isSlowStartEnabled() const {
   return slow_start_window_ > std::chrono::milliseconds(0);
 }
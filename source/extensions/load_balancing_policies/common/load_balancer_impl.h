@@ -503,19 +503,32 @@ protected:
   struct Scheduler {
     // EdfScheduler for weighted LB. The edf_ is only created when the original
     // host weights of 2 or more hosts differ. When not present, the
-    // implementation of chooseHostOnce falls back to unweightedHostPick.
-    std::unique_ptr<EdfScheduler<Host>> edf_;
+    // implementation of chooseHostOnce falls back to unweightedHostPick. It is an
+    // UpdatableEdfScheduler iff incremental_edf_refresh_ is set.
+    std::unique_ptr<Upstream::Scheduler<Host>> edf_;
   };
 
   void initialize();
 
-  virtual void refresh(uint32_t priority);
+  // Refreshes the schedulers of a priority, given the hosts that were added to and removed from
+  // it. Changes to the health or weight of the other hosts are not part of these.
+  virtual void refresh(uint32_t priority, const HostVector& hosts_added,
+                       const HostVector& hosts_removed);
 
   bool isSlowStartEnabled() const;
   bool noHostsAreInSlowStart() const;
 
   virtual void recalculateHostsInSlowStart(const HostVector& hosts_added);
 
+  // Applies the hosts added to and removed from a priority to the scheduler of one of its sources,
+  // in O(log n) per host. Returns false if that leaves the scheduler with other hosts than the
+  // source.
+  bool updateScheduler(UpdatableEdfScheduler<Host>& edf, const HostsSource& source,
+                       const HostVector& hosts, const HostVector& hosts_added,
+                       const HostVector& hosts_removed);
+  // Brings an existing scheduler up to date with the given hosts and their current weights.
+  void rescanScheduler(UpdatableEdfScheduler<Host>& edf, const HostVector& hosts);
+
   // Seed to allow us to desynchronize load balancers across a fleet. If we don't
   // do this, multiple Envoys that receive an update at the same time (or even
   // multiple load balancers on the same host) will send requests to
@@ -538,6 +551,8 @@ private:
   absl::flat_hash_map<HostsSource, Scheduler, HostsSourceHash> scheduler_;
   Common::CallbackHandlePtr priority_update_cb_;
   Common::CallbackHandlePtr member_update_cb_;
+  // Whether existing schedulers are updated with the changes on refresh instead of being rebuilt.
+  const bool incremental_edf_refresh_;
 
 protected:
   // Slow start related config
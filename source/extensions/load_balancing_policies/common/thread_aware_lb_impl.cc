@@ -260,10 +260,14 @@ ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::chooseHost(uint64_t
   // next one in the ring. The random sequence is seeded by the hash, so the same input gets the
   // same sequence of hosts all the time.
   const uint32_t num_hosts = normalized_host_weights_.size();
-  auto host_index = std::vector<uint32_t>(num_hosts);
-  for (uint32_t i = 0; i < num_hosts; i++) {
-    host_index[i] = i;
-  }
+  // The shuffle is only materialized for the positions it swapped, which makes each probe O(1)
+  // instead of initializing an index of all hosts before the first probe. Positions which are not
+  // in the map hold their own index.
+  absl::flat_hash_map<uint32_t, uint32_t> swapped_host_index;
+  auto host_index = [&swapped_host_index](uint32_t i) -> uint32_t {
+    const auto it = swapped_host_index.find(i);
+    return it == swapped_host_index.end() ? i : it->second;
+  };
 
   // Not using Random::RandomGenerator as it does not take a seed. Seeded RNG is a requirement
   // here as we need the same shuffle sequence for the same hash every time.
@@ -286,9 +290,10 @@ ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::chooseHost(uint64_t
   for (uint32_t i = 0; i < num_hosts; i++) {
     // The random shuffle algorithm
     const uint32_t j = uniform_int(random, num_hosts - i);
-    std::swap(host_index[i], host_index[i + j]);
+    // Position i is never visited again, so only position i + j needs to be updated.
+    const uint32_t k = host_index(i + j);
+    swapped_host_index[i + j] = host_index(i);
 
-    const uint32_t k = host_index[i];
     alt_host = normalized_host_weights_[k].first;
     if (alt_host == host) {
       continue;
@@ -45,7 +45,8 @@ public:
   }
 
 protected:
-  void refresh(uint32_t priority) override {
+  void refresh(uint32_t priority, const HostVector& hosts_added,
+               const HostVector& hosts_removed) override {
     active_request_bias_ = active_request_bias_runtime_ != absl::nullopt
                                ? active_request_bias_runtime_.value().value()
                                : 1.0;
@@ -57,7 +58,7 @@ protected:
       active_request_bias_ = 1.0;
     }
 
-    EdfLoadBalancerBase::refresh(priority);
+    EdfLoadBalancerBase::refresh(priority, hosts_added, hosts_removed);
   }
 
 private:
@@ -73,7 +74,7 @@ private:
   const uint32_t choice_count_;
 
   // The exponent used to calculate host weights can be configured via runtime. We cache it for
-  // performance reasons and refresh it in `LeastRequestLoadBalancer::refresh(uint32_t priority)`
+  // performance reasons and refresh it in `LeastRequestLoadBalancer::refresh()`
   // whenever a `HostSet` is updated.
   double active_request_bias_{};
 
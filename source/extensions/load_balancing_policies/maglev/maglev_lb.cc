@@ -118,12 +118,13 @@ void MaglevTable::constructMaglevTableInternal(
   // Implementation of pseudocode listing 1 in the paper (see header file for more info).
   std::vector<TableBuildEntry> table_build_entries;
   table_build_entries.reserve(normalized_host_weights.size());
-  for (const auto& sorted_host_weight : sorted_host_weights) {
+  for (auto& sorted_host_weight : sorted_host_weights) {
     const auto& key_to_hash = std::get<0>(sorted_host_weight);
-    const auto& host = std::get<1>(sorted_host_weight);
+    auto& host = std::get<1>(sorted_host_weight);
     const auto& weight = std::get<2>(sorted_host_weight);
 
-    table_build_entries.emplace_back(host, HashUtil::xxHash64(key_to_hash) % table_size_,
+    table_build_entries.emplace_back(std::move(host),
+                                     HashUtil::xxHash64(key_to_hash) % table_size_,
                                      (HashUtil::xxHash64(key_to_hash, 1) % (table_size_ - 1)) + 1,
                                      weight);
   }
@@ -163,14 +164,12 @@ void OriginalMaglevTable::constructImplementationInternals(
         continue;
       }
       entry.target_weight_ += max_normalized_weight;
-      uint64_t c = permutation(entry);
+      uint64_t c = nextPermutation(entry);
       while (table_[c] != nullptr) {
-        entry.next_++;
-        c = permutation(entry);
+        c = nextPermutation(entry);
       }
 
       table_[c] = entry.host_;
-      entry.next_++;
       entry.count_++;
       table_index++;
     }
@@ -191,8 +190,8 @@ void CompactMaglevTable::constructImplementationInternals(
   // Populate the host table. Index into table_build_entries[i] will align with
   // the host here.
   host_table_.reserve(table_build_entries.size());
-  for (const auto& entry : table_build_entries) {
-    host_table_.emplace_back(entry.host_);
+  for (auto& entry : table_build_entries) {
+    host_table_.emplace_back(std::move(entry.host_));
   }
   host_table_.shrink_to_fit();
 
@@ -215,17 +214,15 @@ void CompactMaglevTable::constructImplementationInternals(
       entry.target_weight_ += max_normalized_weight;
       // As we're using the compact implementation, our table size is limited to
       // 32-bit, hence static_cast here should be safe.
-      uint32_t c = static_cast<uint32_t>(permutation(entry));
+      uint32_t c = static_cast<uint32_t>(nextPermutation(entry));
       while (occupied[c]) {
-        entry.next_++;
-        c = static_cast<uint32_t>(permutation(entry));
+        c = static_cast<uint32_t>(nextPermutation(entry));
       }
 
       // Record the index of the given host.
       table_.set(c, i);
       occupied[c] = true;
 
-      entry.next_++;
       entry.count_++;
       table_index++;
     }
@@ -288,8 +285,15 @@ HostSelectionResponse CompactMaglevTable::chooseHost(uint64_t hash, uint32_t att
   return {host_table_[index]};
 }
 
-uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
-  return (entry.offset_ + (entry.skip_ * entry.next_)) % table_size_;
+uint64_t MaglevTable::nextPermutation(TableBuildEntry& entry) {
+  const uint64_t slot = entry.next_;
+  // Both the slot and the skip are smaller than the table size, so a single subtraction keeps the
+  // next slot in range.
+  entry.next_ += entry.skip_;
+  if (entry.next_ >= table_size_) {
+    entry.next_ -= table_size_;
+  }
+  return slot;
 }
 
 MaglevLoadBalancer::MaglevLoadBalancer(
@@ -73,19 +73,24 @@ public:
 
 protected:
   struct TableBuildEntry {
-    TableBuildEntry(const HostConstSharedPtr& host, uint64_t offset, uint64_t skip, double weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(HostConstSharedPtr host, uint64_t offset, uint64_t skip, double weight)
+        : host_(std::move(host)), offset_(offset), skip_(skip), weight_(weight), next_(offset) {}
 
     HostConstSharedPtr host_;
     const uint64_t offset_;
     const uint64_t skip_;
     const double weight_;
     double target_weight_{};
-    uint64_t next_{};
+    // The next slot in the permutation of the entry.
+    uint64_t next_;
     uint64_t count_{};
   };
 
-  uint64_t permutation(const TableBuildEntry& entry);
+  /**
+   * @return the next slot in the permutation of the entry, i.e. (offset + skip * j) % table_size
+   * on the j-th call. The slots are computed incrementally, without a division per probe.
+   */
+  uint64_t nextPermutation(TableBuildEntry& entry);
 
   /**
    * Template method for constructing the Maglev table.
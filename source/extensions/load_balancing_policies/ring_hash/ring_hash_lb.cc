@@ -1,7 +1,9 @@
 #include "source/extensions/load_balancing_policies/ring_hash/ring_hash_lb.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -10,6 +12,7 @@
 #include "source/common/common/assert.h"
 
 #include "absl/container/inlined_vector.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -74,48 +77,28 @@ HostSelectionResponse RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_
     return {nullptr};
   }
 
-  // Ported from https://github.com/RJ/ketama/blob/master/libketama/ketama.c (ketama_get_server)
-  // I've generally kept the variable names to make the code easier to compare.
-  // NOTE: The algorithm depends on using signed integers for lowp, midp, and highp. Do not
-  //       change them!
-  int64_t lowp = 0;
-  int64_t highp = ring_.size();
-  int64_t midp = 0;
-  while (true) {
-    midp = (lowp + highp) / 2;
-
-    if (midp == static_cast<int64_t>(ring_.size())) {
-      midp = 0;
-      break;
-    }
-
-    uint64_t midval = ring_[midp].hash_;
-    uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
-
-    if (h <= midval && h > midval1) {
-      break;
-    }
-
-    if (midval < h) {
-      lowp = midp + 1;
-    } else {
-      highp = midp - 1;
-    }
-
-    if (lowp > highp) {
-      midp = 0;
-      break;
-    }
+  // Find the first ring entry whose hash is greater than or equal to h, wrapping around to the
+  // first entry. Entries of earlier buckets all have smaller hashes and entries of later buckets
+  // all have larger ones, so only the bucket of h needs to be searched.
+  const uint64_t bucket = h >> bucket_shift_;
+  const auto bucket_begin = ring_.begin() + bucket_index_[bucket];
+  const auto bucket_end = ring_.begin() + bucket_index_[bucket + 1];
+  const auto it =
+      std::lower_bound(bucket_begin, bucket_end, h,
+                       [](const RingEntry& entry, uint64_t hash) { return entry.hash_ < hash; });
+  uint64_t index = it - ring_.begin();
+  if (index == ring_.size()) {
+    index = 0;
   }
 
   // If a retry host predicate is being applied, behave as if this host was not in the ring.
   // Note that this does not guarantee a different host: e.g., attempt == ring_.size() or
   // when the offset causes us to select the same host at another location in the ring.
   if (attempt > 0) {
-    midp = (midp + attempt) % ring_.size();
+    index = (index + attempt) % ring_.size();
   }
 
-  return ring_[midp].host_;
+  return ring_[index].host_;
 }
 
 using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
@@ -204,6 +187,8 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
     return lhs.hash_ < rhs.hash_;
   });
+
+  buildBucketIndex();
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (const auto& entry : ring_) {
       const absl::string_view key_to_hash = hashKey(entry.host_, use_hostname_for_hashing);
@@ -216,5 +201,23 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   stats_.max_hashes_per_host_.set(max_hashes_per_host);
 }
 
+void RingHashLoadBalancer::Ring::buildBucketIndex() {
+  // Index the sorted ring by the top bits of the hashes, with at least two buckets so that the
+  // shift stays below 64.
+  ASSERT(ring_.size() < std::numeric_limits<uint32_t>::max());
+  const uint32_t bucket_bits = std::max<uint32_t>(absl::bit_width(ring_.size()) - 1, 1);
+  const uint64_t num_buckets = uint64_t(1) << bucket_bits;
+  bucket_shift_ = 64 - bucket_bits;
+  bucket_index_.assign(num_buckets + 1, 0);
+  uint32_t entry_index = 0;
+  for (uint64_t bucket = 0; bucket < num_buckets; ++bucket) {
+    while (entry_index < ring_.size() && (ring_[entry_index].hash_ >> bucket_shift_) < bucket) {
+      ++entry_index;
+    }
+    bucket_index_[bucket] = entry_index;
+  }
+  bucket_index_[num_buckets] = ring_.size();
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -68,6 +68,8 @@ public:
   const RingHashLoadBalancerStats& stats() const { return stats_; }
 
 private:
+  friend class RingHashLoadBalancerPeer;
+
   using HashFunction = RingHashLbProto::HashFunction;
 
   struct RingEntry {
@@ -83,7 +85,16 @@ private:
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostSelectionResponse chooseHost(uint64_t hash, uint32_t attempt) const override;
 
+    // Builds bucket_index_ for the sorted ring_.
+    void buildBucketIndex();
+
     std::vector<RingEntry> ring_;
+    // The hash space is split into a power of two buckets, no more than there are ring entries, by
+    // the top bits of the hash. bucket_index_[b] is the index of the first ring entry in bucket b,
+    // and the last element is ring_.size(). A lookup only searches the entries of one bucket, of
+    // which there are one or two on average, instead of the whole ring.
+    std::vector<uint32_t> bucket_index_;
+    uint32_t bucket_shift_{};
 
     RingHashLoadBalancerStats& stats_;
   };
@@ -11,6 +11,7 @@
 #include "source/common/config/metadata.h"
 #include "source/common/config/well_known_names.h"
 #include "source/common/protobuf/utility.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "absl/container/node_hash_set.h"
 
@@ -61,9 +62,19 @@ SubsetLoadBalancer::SubsetLoadBalancer(const SubsetLoadBalancerConfig& lb_config
       locality_weight_aware_(lb_config_.subsetInfo().localityWeightAware()),
       scale_locality_weight_(lb_config_.subsetInfo().scaleLocalityWeight()),
       list_as_any_(lb_config_.subsetInfo().listAsAny()),
-      allow_redundant_keys_(lb_config_.subsetInfo().allowRedundantKeys()) {
+      allow_redundant_keys_(lb_config_.subsetInfo().allowRedundantKeys()),
+      lazy_subsets_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.subset_lb_lazy_subsets")) {
   ASSERT(lb_config_.subsetInfo().isEnabled());
 
+  if (lazy_subsets_) {
+    // Like the single host duplicate stat below, this is not part of `ClusterTrafficStats` as it is
+    // only used by few clusters. It is looked up once, so updating it is cheap.
+    Stats::StatNameManagedStorage name_storage("lb_subsets_materialized", scope_.symbolTable());
+    materialized_stat_ = &Stats::Utility::gaugeFromElements(scope_, {name_storage.statName()},
+                                                            Stats::Gauge::ImportMode::Accumulate);
+  }
+
   if (fallback_policy_ != envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK) {
     if (fallback_policy_ == envoy::config::cluster::v3::Cluster::LbSubsetConfig::ANY_ENDPOINT) {
       ENVOY_LOG(debug, "subset lb: creating any-endpoint fallback load balancer");
@@ -870,28 +881,89 @@ void SubsetLoadBalancer::PrioritySubsetImpl::update(uint32_t priority,
   }
 }
 
+SubsetLoadBalancer::PriorityLbSubset::PriorityLbSubset(const SubsetLoadBalancer& subset_lb,
+                                                       bool locality_weight_aware,
+                                                       bool scale_locality_weight)
+    : subset_lb_(subset_lb), locality_weight_aware_(locality_weight_aware),
+      scale_locality_weight_(scale_locality_weight),
+      materialized_stat_(subset_lb.materialized_stat_) {
+  if (!subset_lb.lazy_subsets_) {
+    subset_ = std::make_unique<PrioritySubsetImpl>(subset_lb_, locality_weight_aware_,
+                                                   scale_locality_weight_);
+  }
+}
+
+SubsetLoadBalancer::PriorityLbSubset::~PriorityLbSubset() {
+  if (subset_ != nullptr && materialized_stat_ != nullptr) {
+    materialized_stat_->dec();
+  }
+}
+
+HostSelectionResponse
+SubsetLoadBalancer::PriorityLbSubset::chooseHost(LoadBalancerContext* context) {
+  if (subset_ == nullptr) {
+    if (!active()) {
+      return {nullptr};
+    }
+    materialize();
+  }
+  std::fill(used_.begin(), used_.end(), true);
+  return subset_->lb_->chooseHost(context);
+}
+
+bool SubsetLoadBalancer::PriorityLbSubset::active() const {
+  if (subset_ != nullptr) {
+    return !subset_->empty();
+  }
+  return std::any_of(host_sets_.begin(), host_sets_.end(),
+                     [](const auto& host_sets) { return !host_sets.first.empty(); });
+}
+
+void SubsetLoadBalancer::PriorityLbSubset::materialize() {
+  ASSERT(subset_ == nullptr && materialized_stat_ != nullptr);
+  subset_ = std::make_unique<PrioritySubsetImpl>(subset_lb_, locality_weight_aware_,
+                                                 scale_locality_weight_);
+  for (uint32_t priority = 0; priority < host_sets_.size(); ++priority) {
+    const HostHashSet& hosts = host_sets_[priority].first;
+    subset_->update(priority, hosts, HostVector(hosts.begin(), hosts.end()), {},
+                    subset_lb_.random_.random());
+  }
+  materialized_stat_->inc();
+}
+
 void SubsetLoadBalancer::PriorityLbSubset::finalize(uint32_t priority, uint64_t seed) {
   while (host_sets_.size() <= priority) {
     host_sets_.push_back({HostHashSet(), HostHashSet()});
   }
   auto& [old_hosts, new_hosts] = host_sets_[priority];
+  // A priority seen for the first time does not make a subset in use look idle.
+  used_.resize(host_sets_.size(), true);
+
+  if (materialized_stat_ != nullptr && subset_ != nullptr && !used_[priority]) {
+    // Rather than keeping an idle subset up to date, create it again if it is selected later.
+    subset_.reset();
+    materialized_stat_->dec();
+  }
+  used_[priority] = false;
 
-  HostVector added;
-  HostVector removed;
+  if (subset_ != nullptr) {
+    HostVector added;
+    HostVector removed;
 
-  for (const auto& host : old_hosts) {
-    if (new_hosts.count(host) == 0) {
-      removed.emplace_back(host);
+    for (const auto& host : old_hosts) {
+      if (new_hosts.count(host) == 0) {
+        removed.emplace_back(host);
+      }
     }
-  }
 
-  for (const auto& host : new_hosts) {
-    if (old_hosts.count(host) == 0) {
-      added.emplace_back(host);
+    for (const auto& host : new_hosts) {
+      if (old_hosts.count(host) == 0) {
+        added.emplace_back(host);
+      }
     }
-  }
 
-  subset_.update(priority, new_hosts, added, removed, seed);
+    subset_->update(priority, new_hosts, added, removed, seed);
+  }
 
   old_hosts.swap(new_hosts);
   new_hosts.clear();
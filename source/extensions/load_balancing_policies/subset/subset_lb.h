@@ -224,7 +224,7 @@ private:
   class LbSubset {
   public:
     virtual ~LbSubset() = default;
-    virtual HostSelectionResponse chooseHost(LoadBalancerContext* context) const PURE;
+    virtual HostSelectionResponse chooseHost(LoadBalancerContext* context) PURE;
     virtual void pushHost(uint32_t priority, HostSharedPtr host) PURE;
     virtual void finalize(uint32_t priority, uint64_t seed) PURE;
     virtual bool active() const PURE;
@@ -234,13 +234,11 @@ private:
   class PriorityLbSubset : public LbSubset {
   public:
     PriorityLbSubset(const SubsetLoadBalancer& subset_lb, bool locality_weight_aware,
-                     bool scale_locality_weight)
-        : subset_(subset_lb, locality_weight_aware, scale_locality_weight) {}
+                     bool scale_locality_weight);
+    ~PriorityLbSubset() override;
 
     // Subset
-    HostSelectionResponse chooseHost(LoadBalancerContext* context) const override {
-      return subset_.lb_->chooseHost(context);
-    }
+    HostSelectionResponse chooseHost(LoadBalancerContext* context) override;
     void pushHost(uint32_t priority, HostSharedPtr host) override {
       while (host_sets_.size() <= priority) {
         host_sets_.push_back({HostHashSet(), HostHashSet()});
@@ -251,15 +249,31 @@ private:
     // is pushed then subset_ will be set to empty.
     void finalize(uint32_t priority, uint64_t seed) override;
 
-    bool active() const override { return !subset_.empty(); }
+    bool active() const override;
 
     std::vector<std::pair<HostHashSet, HostHashSet>> host_sets_;
-    PrioritySubsetImpl subset_;
+
+  private:
+    // Creates subset_ and its child load balancer from the hosts of the latest update.
+    void materialize();
+
+    const SubsetLoadBalancer& subset_lb_;
+    const bool locality_weight_aware_;
+    const bool scale_locality_weight_;
+    // Only set with lazy subsets, in which case subset_ is created by the first chooseHost() and
+    // released by the first update of a priority which finds it unused since the previous update
+    // of that priority.
+    Stats::Gauge* materialized_stat_;
+    std::unique_ptr<PrioritySubsetImpl> subset_;
+    // Whether the subset was selected since the previous update, per priority. Host updates
+    // finalize one priority at a time, so a single flag would be cleared by the first priority of
+    // an update and release a subset in use when finalizing the next one.
+    std::vector<bool> used_;
   };
 
   class SingleHostLbSubset : public LbSubset {
     // Subset
-    HostSelectionResponse chooseHost(LoadBalancerContext*) const override { return subset_; }
+    HostSelectionResponse chooseHost(LoadBalancerContext*) override { return subset_; }
     // This is called at most once for every update for single host subset.
     void pushHost(uint32_t priority, HostSharedPtr host) override {
       new_hosts_[priority] = std::move(host);
@@ -377,12 +391,15 @@ private:
   SubsetSelectorMapPtr selectors_;
 
   Stats::Gauge* single_duplicate_stat_{};
+  // Only set with lazy subsets.
+  Stats::Gauge* materialized_stat_{};
 
   // Keep small members (bools and enums) at the end of class, to reduce alignment overhead.
   const bool locality_weight_aware_ : 1;
   const bool scale_locality_weight_ : 1;
   const bool list_as_any_ : 1;
   const bool allow_redundant_keys_{};
+  const bool lazy_subsets_{};
 };
 
 } // namespace Upstream
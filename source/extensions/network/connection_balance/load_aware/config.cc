@@ -0,0 +1,34 @@
+#include "source/extensions/network/connection_balance/load_aware/config.h"
+
+#include "envoy/config/core/v3/extension.pb.h"
+#include "envoy/extensions/network/connection_balance/load_aware/v3/load_aware.pb.validate.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/network/connection_balance/load_aware/load_aware_balancer.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ConnectionBalance {
+namespace LoadAware {
+
+Envoy::Network::ConnectionBalancerSharedPtr
+LoadAwareConnectionBalanceFactory::createConnectionBalancerFromProto(
+    const Protobuf::Message& config, Server::Configuration::FactoryContext& context) {
+  const auto& typed_config =
+      dynamic_cast<const envoy::config::core::v3::TypedExtensionConfig&>(config);
+  envoy::extensions::network::connection_balance::load_aware::v3::LoadAwareConnectionBalance
+      balance_config;
+  THROW_IF_NOT_OK(MessageUtil::unpackTo(typed_config.typed_config(), balance_config));
+  MessageUtil::validate(balance_config, context.messageValidationVisitor());
+
+  return std::make_shared<LoadAwareConnectionBalancerImpl>(
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(balance_config, sample_interval, 100)),
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(balance_config, lag_tolerance, 5)));
+}
+
+REGISTER_FACTORY(LoadAwareConnectionBalanceFactory, Envoy::Network::ConnectionBalanceFactory);
+
+} // namespace LoadAware
+} // namespace ConnectionBalance
+} // namespace Extensions
+} // namespace Envoy
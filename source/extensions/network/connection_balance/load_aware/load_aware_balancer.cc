@@ -0,0 +1,163 @@
+#include "source/extensions/network/connection_balance/load_aware/load_aware_balancer.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ConnectionBalance {
+namespace LoadAware {
+
+LoadAwareConnectionBalancerImpl::LoadAwareConnectionBalancerImpl(
+    std::chrono::milliseconds sample_interval, std::chrono::milliseconds lag_tolerance)
+    : sample_interval_(sample_interval),
+      lag_tolerance_us_(
+          std::chrono::duration_cast<std::chrono::microseconds>(lag_tolerance).count()) {}
+
+LoadAwareConnectionBalancerImpl::~LoadAwareConnectionBalancerImpl() {
+  Slot* slot = slots_.load();
+  while (slot != nullptr) {
+    std::unique_ptr<Slot> owned(slot);
+    ASSERT(owned->handler_.load() == nullptr);
+    slot = owned->next_;
+  }
+}
+
+void LoadAwareConnectionBalancerImpl::registerHandler(
+    Envoy::Network::BalancedConnectionHandler& handler) {
+  Slot* slot = nullptr;
+  for (Slot* candidate = slots_.load(); candidate != nullptr; candidate = candidate->next_) {
+    Envoy::Network::BalancedConnectionHandler* expected = nullptr;
+    if (candidate->handler_.compare_exchange_strong(expected, &handler)) {
+      slot = candidate;
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    auto new_slot = std::make_unique<Slot>();
+    new_slot->handler_.store(&handler);
+    Slot* head = slots_.load();
+    do {
+      new_slot->next_ = head;
+    } while (!slots_.compare_exchange_weak(head, new_slot.get()));
+    slot = new_slot.release();
+  }
+  slot->loop_lag_us_.store(0);
+
+  // Handlers which do not run on a worker are only balanced by their number of connections.
+  OptRef<Event::Dispatcher> dispatcher = handler.workerDispatcher();
+  if (dispatcher.has_value()) {
+    Event::Dispatcher& worker_dispatcher = dispatcher.ref();
+    slot->sample_timer_ = worker_dispatcher.createTimer(
+        [this, slot, &worker_dispatcher]() { onSampleTimer(*slot, worker_dispatcher); });
+    slot->sample_deadline_ = worker_dispatcher.timeSource().monotonicTime() + sample_interval_;
+    slot->sample_timer_->enableTimer(sample_interval_);
+  }
+}
+
+void LoadAwareConnectionBalancerImpl::unregisterHandler(
+    Envoy::Network::BalancedConnectionHandler& handler) {
+  for (Slot* slot = slots_.load(); slot != nullptr; slot = slot->next_) {
+    if (slot->handler_.load() != &handler) {
+      continue;
+    }
+    slot->sample_timer_.reset();
+    slot->handler_.store(nullptr);
+    // Workers picking a target only hold on to the handler for a few loads and stores.
+    while (slot->readers_.load() != 0) {
+      std::this_thread::yield();
+    }
+    return;
+  }
+}
+
+Envoy::Network::BalancedConnectionHandler& LoadAwareConnectionBalancerImpl::pickTargetHandler(
+    Envoy::Network::BalancedConnectionHandler& current_handler) {
+  int64_t min_lag_us = std::numeric_limits<int64_t>::max();
+  for (Slot* slot = slots_.load(); slot != nullptr; slot = slot->next_) {
+    if (slot->handler_.load(std::memory_order_relaxed) != nullptr) {
+      min_lag_us = std::min(min_lag_us, slot->loop_lag_us_.load(std::memory_order_relaxed));
+    }
+  }
+
+  // Among the workers whose event loop is about as responsive as the best one, pick the one with
+  // the fewest connections. Ties stay on the current worker to save a hop between threads.
+  Slot* target = nullptr;
+  Envoy::Network::BalancedConnectionHandler* target_handler = nullptr;
+  uint64_t target_connections = 0;
+  for (Slot* slot = slots_.load(); slot != nullptr; slot = slot->next_) {
+    if (slot->loop_lag_us_.load(std::memory_order_relaxed) - lag_tolerance_us_ > min_lag_us) {
+      continue;
+    }
+    Envoy::Network::BalancedConnectionHandler* handler = acquire(*slot);
+    if (handler == nullptr) {
+      continue;
+    }
+    const uint64_t connections = handler->numConnections();
+    if (target == nullptr || connections < target_connections ||
+        (connections == target_connections && handler == &current_handler)) {
+      if (target != nullptr) {
+        release(*target);
+      }
+      target = slot;
+      target_handler = handler;
+      target_connections = connections;
+    } else {
+      release(*slot);
+    }
+  }
+
+  if (target == nullptr) {
+    current_handler.incNumConnections();
+    return current_handler;
+  }
+  target_handler->incNumConnections();
+  release(*target);
+  return *target_handler;
+}
+
+std::chrono::microseconds LoadAwareConnectionBalancerImpl::loopLag(
+    const Envoy::Network::BalancedConnectionHandler& handler) {
+  for (Slot* slot = slots_.load(); slot != nullptr; slot = slot->next_) {
+    if (slot->handler_.load() == &handler) {
+      return std::chrono::microseconds(slot->loop_lag_us_.load());
+    }
+  }
+  return std::chrono::microseconds(0);
+}
+
+Envoy::Network::BalancedConnectionHandler* LoadAwareConnectionBalancerImpl::acquire(Slot& slot) {
+  slot.readers_.fetch_add(1);
+  Envoy::Network::BalancedConnectionHandler* handler = slot.handler_.load();
+  if (handler == nullptr) {
+    slot.readers_.fetch_sub(1);
+  }
+  return handler;
+}
+
+void LoadAwareConnectionBalancerImpl::release(Slot& slot) { slot.readers_.fetch_sub(1); }
+
+void LoadAwareConnectionBalancerImpl::onSampleTimer(Slot& slot, Event::Dispatcher& dispatcher) {
+  const MonotonicTime now = dispatcher.timeSource().monotonicTime();
+  const int64_t lag_us = std::max<int64_t>(
+      0,
+      std::chrono::duration_cast<std::chrono::microseconds>(now - slot.sample_deadline_).count());
+  // A moving average, so that a single slow iteration of the event loop does not steer all new
+  // connections away from the worker.
+  const int64_t average_us = slot.loop_lag_us_.load(std::memory_order_relaxed);
+  slot.loop_lag_us_.store(average_us + (lag_us - average_us) / 4, std::memory_order_relaxed);
+  ENVOY_LOG(trace, "event loop lag {}us, average {}us", lag_us,
+            slot.loop_lag_us_.load(std::memory_order_relaxed));
+
+  slot.sample_deadline_ = now + sample_interval_;
+  slot.sample_timer_->enableTimer(sample_interval_);
+}
+
+} // namespace LoadAware
+} // namespace ConnectionBalance
+} // namespace Extensions
+} // namespace Envoy
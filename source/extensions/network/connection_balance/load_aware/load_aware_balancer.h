@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/connection_balancer.h"
+
+#include "source/common/common/logger.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ConnectionBalance {
+namespace LoadAware {
+
+/**
+ * Connection balancer which hands each accepted connection to the worker whose event loop is the
+ * least delayed and, among the workers within a tolerance of that delay, to the one with the
+ * fewest connections on the listener.
+ *
+ * Each worker measures the delay of its own event loop by how late a periodic timer runs, and
+ * publishes a moving average of it in an atomic counter. Picking a target only reads the atomic
+ * counters of the registered handlers, so unlike ExactConnectionBalancerImpl, workers accepting
+ * connections do not contend on a lock.
+ */
+class LoadAwareConnectionBalancerImpl : public Envoy::Network::ConnectionBalancer,
+                                        protected Logger::Loggable<Logger::Id::connection> {
+public:
+  LoadAwareConnectionBalancerImpl(std::chrono::milliseconds sample_interval,
+                                  std::chrono::milliseconds lag_tolerance);
+  ~LoadAwareConnectionBalancerImpl() override;
+
+  // Network::ConnectionBalancer
+  void registerHandler(Envoy::Network::BalancedConnectionHandler& handler) override;
+  void unregisterHandler(Envoy::Network::BalancedConnectionHandler& handler) override;
+  Envoy::Network::BalancedConnectionHandler&
+  pickTargetHandler(Envoy::Network::BalancedConnectionHandler& current_handler) override;
+
+  /**
+   * @return the event loop delay last published by the worker of the handler, or zero if the
+   *         handler is not registered.
+   */
+  std::chrono::microseconds loopLag(const Envoy::Network::BalancedConnectionHandler& handler);
+
+private:
+  // A registered handler and the load of its worker. Slots are only freed with the balancer, so
+  // that workers can walk the list without a lock. The slot of an unregistered handler is reused
+  // by the next registered one.
+  struct Slot {
+    std::atomic<Envoy::Network::BalancedConnectionHandler*> handler_{nullptr};
+    // The number of workers looking at handler_. Unregistering a handler waits for it to drop to
+    // zero, so that the handler is not destroyed while another worker uses it.
+    std::atomic<uint32_t> readers_{0};
+    std::atomic<int64_t> loop_lag_us_{0};
+    // Only used on the worker of the handler.
+    Event::TimerPtr sample_timer_;
+    MonotonicTime sample_deadline_;
+    // Immutable once the slot is published.
+    Slot* next_{};
+  };
+
+  Envoy::Network::BalancedConnectionHandler* acquire(Slot& slot);
+  void release(Slot& slot);
+  void onSampleTimer(Slot& slot, Event::Dispatcher& dispatcher);
+
+  const std::chrono::milliseconds sample_interval_;
+  const int64_t lag_tolerance_us_;
+  std::atomic<Slot*> slots_{nullptr};
+};
+
+} // namespace LoadAware
+} // namespace ConnectionBalance
+} // namespace Extensions
+} // namespace Envoy
@@ -41,10 +41,16 @@ public:
     virtual void writeBuffer(Buffer::Instance& data) PURE;
   };
 
+  /**
+   * @param changed_stats_only whether to only flush the counters and gauges that changed since the
+   * previous flush. This relies on the server keeping the last value of a gauge, which plain statsd
+   * does but e.g. DogStatsD does not.
+   */
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
                 const bool use_tag, const std::string& prefix = getDefaultPrefix(),
                 absl::optional<uint64_t> buffer_size = absl::nullopt,
-                const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat());
+                const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat(),
+                bool changed_stats_only = false);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
                 const bool use_tag, const std::string& prefix = getDefaultPrefix(),
@@ -60,6 +66,7 @@ public:
   // Stats::Sink
   void flush(Stats::MetricSnapshot& snapshot) override;
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override;
+  bool changedStatsOnly() const override { return changed_stats_only_; }
 
   bool getUseTagForTest() { return use_tag_; }
   uint64_t getBufferSizeForTest() { return buffer_size_; }
@@ -98,6 +105,7 @@ private:
   const std::string prefix_;
   const uint64_t buffer_size_;
   const Statsd::TagFormat tag_format_;
+  const bool changed_stats_only_{};
 };
 
 /**
@@ -116,6 +124,9 @@ public:
   // Stats::Sink
   void flush(Stats::MetricSnapshot& snapshot) override;
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override;
+  // Counters are sent as increments, so zero deltas carry nothing, and statsd keeps the last value
+  // of gauges.
+  bool changedStatsOnly() const override { return true; }
 
   const std::string& getPrefix() { return prefix_; }
 
@@ -1,5 +1,6 @@
 #include "source/server/server.h"
 
+#include <algorithm>
 #include <csignal>
 #include <cstdint>
 #include <ctime>
@@ -170,7 +171,8 @@ void InstanceBase::failHealthcheck(bool fail) {
 MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store,
                                        Upstream::ClusterManager& cluster_manager,
                                        TimeSource& time_source) {
-  store.forEachSinkedCounter(
+  // Unless the store tracks changed stats, these visit all sinked counters and gauges.
+  store.forEachChangedSinkedCounter(
       [this](std::size_t size) {
         snapped_counters_.reserve(size);
         counters_.reserve(size);
@@ -180,7 +182,7 @@ MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store,
         counters_.push_back({counter.latch(), counter});
       });
 
-  store.forEachSinkedGauge(
+  store.forEachChangedSinkedGauge(
       [this](std::size_t size) {
         snapped_gauges_.reserve(size);
         gauges_.reserve(size);
@@ -227,7 +229,8 @@ void InstanceUtil::flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, S
   // Create a snapshot and flush to all sinks.
   // NOTE: Even if there are no sinks, creating the snapshot has the important property that it
   //       latches all counters on a periodic basis. The hot restart code assumes this is being
-  //       done so this should not be removed.
+  //       done so this should not be removed. When only changed counters are snapshotted, the
+  //       others have nothing to latch.
   MetricSnapshotImpl snapshot(store, cm, time_source);
   for (const auto& sink : sinks) {
     sink->flush(snapshot);
@@ -284,6 +287,13 @@ void InstanceBase::updateServerStats() {
       enumToInt(Utility::serverState(initManager().state(), healthCheckFailed())));
   server_stats_->stats_recent_lookups_.set(
       stats_store_.symbolTable().getRecentLookups([](absl::string_view, uint64_t) {}));
+  const Buffer::SliceStoragePool::Stats slice_pool_stats = Buffer::SliceStoragePool::stats();
+  server_stats_->buffer_slice_pool_hits_.add(slice_pool_stats.hits_ - slice_pool_stats_.hits_);
+  server_stats_->buffer_slice_pool_misses_.add(slice_pool_stats.misses_ -
+                                               slice_pool_stats_.misses_);
+  server_stats_->buffer_slice_pool_remote_releases_.add(slice_pool_stats.remote_releases_ -
+                                                        slice_pool_stats_.remote_releases_);
+  slice_pool_stats_ = slice_pool_stats;
 }
 
 void InstanceBase::flushStatsInternal() {
@@ -835,6 +845,17 @@ absl::Status InstanceBase::initializeOrThrow(Network::Address::InstanceConstShar
   for (const Stats::SinkPtr& sink : stats_config.sinks()) {
     stats_store_.addSink(*sink);
   }
+  if (!stats_config.sinks().empty() &&
+      std::all_of(stats_config.sinks().begin(), stats_config.sinks().end(),
+                  [](const Stats::SinkPtr& sink) { return sink->changedStatsOnly(); }) &&
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.changed_stats_flush")) {
+    // Flushes only need to visit the counters and gauges that changed since the previous one.
+    if (stats_store_.trackChangedStats()) {
+      ENVOY_LOG(info, "stats flushes only visit the counters and gauges that changed");
+    } else {
+      ENVOY_LOG(warn, "stats store does not track changed stats, flushes visit all of them");
+    }
+  }
   if (!stats_config.flushOnAdmin()) {
     // Some of the stat sinks may need dispatcher support so don't flush until the main loop starts.
     // Just setup the timer.
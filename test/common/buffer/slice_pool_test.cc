@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/buffer/slice_pool.h"
+
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class SliceStoragePoolTest : public testing::Test {
+protected:
+  SliceStoragePoolTest() {
+    scoped_runtime_.mergeValues({{"envoy.reloadable_features.buffer_slice_storage_pool", "true"}});
+    SliceStoragePool::clearThreadCacheForTest();
+  }
+  ~SliceStoragePoolTest() override { SliceStoragePool::clearThreadCacheForTest(); }
+
+  TestScopedRuntime scoped_runtime_;
+};
+
+TEST_F(SliceStoragePoolTest, ReusesReleasedStorage) {
+  const SliceStoragePool::Stats before = SliceStoragePool::stats();
+  SliceStoragePool::StoragePtr first = SliceStoragePool::allocate(16384);
+  memset(first.get(), 0xab, 16384);
+  const uint8_t* first_mem = first.get();
+  first.reset();
+  EXPECT_EQ(1U, SliceStoragePool::cachedBlocksForTest(16384));
+
+  SliceStoragePool::StoragePtr second = SliceStoragePool::allocate(16384);
+  EXPECT_EQ(first_mem, second.get());
+  EXPECT_EQ(0U, SliceStoragePool::cachedBlocksForTest(16384));
+  second.reset();
+
+  const SliceStoragePool::Stats after = SliceStoragePool::stats();
+  EXPECT_EQ(1U, after.hits_ - before.hits_);
+  EXPECT_EQ(1U, after.misses_ - before.misses_);
+}
+
+TEST_F(SliceStoragePoolTest, SizeClassesAreSeparate) {
+  SliceStoragePool::StoragePtr small = SliceStoragePool::allocate(4096);
+  const uint8_t* small_mem = small.get();
+  small.reset();
+  EXPECT_EQ(1U, SliceStoragePool::cachedBlocksForTest(4096));
+  EXPECT_EQ(0U, SliceStoragePool::cachedBlocksForTest(8192));
+
+  SliceStoragePool::StoragePtr medium = SliceStoragePool::allocate(8192);
+  EXPECT_NE(small_mem, medium.get());
+  medium.reset();
+  EXPECT_EQ(1U, SliceStoragePool::cachedBlocksForTest(8192));
+}
+
+TEST_F(SliceStoragePoolTest, UnpooledSizes) {
+  const SliceStoragePool::Stats before = SliceStoragePool::stats();
+  for (const uint64_t size : {100U, 4097U, 32768U}) {
+    SliceStoragePool::StoragePtr mem = SliceStoragePool::allocate(size);
+    memset(mem.get(), 0, size);
+    mem.reset();
+    EXPECT_EQ(0U, SliceStoragePool::cachedBlocksForTest(size));
+  }
+
+  const SliceStoragePool::Stats after = SliceStoragePool::stats();
+  EXPECT_EQ(before.hits_, after.hits_);
+  EXPECT_EQ(before.misses_, after.misses_);
+}
+
+TEST_F(SliceStoragePoolTest, BoundedPerThreadCache) {
+  std::vector<SliceStoragePool::StoragePtr> blocks;
+  for (uint32_t i = 0; i < SliceStoragePool::MaxCachedPerClass + 4; i++) {
+    blocks.push_back(SliceStoragePool::allocate(16384));
+  }
+  blocks.clear();
+  EXPECT_EQ(SliceStoragePool::MaxCachedPerClass, SliceStoragePool::cachedBlocksForTest(16384));
+}
+
+// With the runtime guard disabled, storage comes from the heap and is not cached.
+TEST_F(SliceStoragePoolTest, Disabled) {
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.buffer_slice_storage_pool", "false"}});
+  const SliceStoragePool::Stats before = SliceStoragePool::stats();
+  SliceStoragePool::allocate(16384).reset();
+  EXPECT_EQ(0U, SliceStoragePool::cachedBlocksForTest(16384));
+
+  // Storage allocated while the pool was enabled still returns to it.
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.buffer_slice_storage_pool", "true"}});
+  SliceStoragePool::StoragePtr mem = SliceStoragePool::allocate(16384);
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.buffer_slice_storage_pool", "false"}});
+  mem.reset();
+  EXPECT_EQ(1U, SliceStoragePool::cachedBlocksForTest(16384));
+
+  const SliceStoragePool::Stats after = SliceStoragePool::stats();
+  EXPECT_EQ(0U, after.hits_ - before.hits_);
+  EXPECT_EQ(1U, after.misses_ - before.misses_);
+}
+
+// Storage released on another thread is returned to the allocating thread, which picks it up once
+// its local cache runs dry.
+TEST_F(SliceStoragePoolTest, CrossThreadRelease) {
+  const SliceStoragePool::Stats before = SliceStoragePool::stats();
+  std::vector<SliceStoragePool::StoragePtr> blocks;
+  std::vector<const uint8_t*> block_mems;
+  for (uint32_t i = 0; i < 4; i++) {
+    blocks.push_back(SliceStoragePool::allocate(16384));
+    block_mems.push_back(blocks.back().get());
+  }
+
+  Thread::threadFactoryForTest().createThread([&blocks]() { blocks.clear(); })->join();
+
+  // Returned blocks wait on the return stack until the next allocation drains it.
+  EXPECT_EQ(0U, SliceStoragePool::cachedBlocksForTest(16384));
+  SliceStoragePool::StoragePtr mem = SliceStoragePool::allocate(16384);
+  EXPECT_NE(block_mems.end(), std::find(block_mems.begin(), block_mems.end(), mem.get()));
+  EXPECT_EQ(3U, SliceStoragePool::cachedBlocksForTest(16384));
+  mem.reset();
+
+  // The consumer's cache is gone, but its releases are still counted.
+  const SliceStoragePool::Stats after = SliceStoragePool::stats();
+  EXPECT_EQ(4U, after.remote_releases_ - before.remote_releases_);
+  EXPECT_EQ(1U, after.hits_ - before.hits_);
+}
+
+// Storage allocated by a thread that has since exited is released to the heap, and the cache of
+// that thread is freed with its last block.
+TEST_F(SliceStoragePoolTest, ReleaseAfterOwnerExit) {
+  const uint32_t caches = SliceStoragePool::threadCachesForTest();
+  std::vector<SliceStoragePool::StoragePtr> blocks;
+  Thread::threadFactoryForTest()
+      .createThread([&blocks]() {
+        for (uint32_t i = 0; i < 2; i++) {
+          blocks.push_back(SliceStoragePool::allocate(16384));
+        }
+        // A cached block is freed when the thread exits.
+        SliceStoragePool::allocate(16384).reset();
+        EXPECT_EQ(1U, SliceStoragePool::cachedBlocksForTest(16384));
+      })
+      ->join();
+  EXPECT_EQ(caches + 1, SliceStoragePool::threadCachesForTest());
+
+  blocks.pop_back();
+  EXPECT_EQ(caches + 1, SliceStoragePool::threadCachesForTest());
+  blocks.pop_back();
+  EXPECT_EQ(caches, SliceStoragePool::threadCachesForTest());
+  EXPECT_EQ(0U, SliceStoragePool::cachedBlocksForTest(16384));
+}
+
+// The cache of a thread that exits with nothing outstanding is freed right away.
+TEST_F(SliceStoragePoolTest, ThreadCacheFreedOnExit) {
+  const uint32_t caches = SliceStoragePool::threadCachesForTest();
+  Thread::threadFactoryForTest()
+      .createThread([]() { SliceStoragePool::allocate(16384).reset(); })
+      ->join();
+  EXPECT_EQ(caches, SliceStoragePool::threadCachesForTest());
+}
+
+// A buffer moved to another thread returns its slice storage to the thread that filled it.
+TEST_F(SliceStoragePoolTest, OwnedImplMovedAcrossThreads) {
+  const SliceStoragePool::Stats before = SliceStoragePool::stats();
+  auto buffer = std::make_unique<OwnedImpl>();
+  for (int i = 0; i < 3; i++) {
+    buffer->add(std::string(16384, 'a'));
+  }
+  EXPECT_EQ(3U, buffer->getRawSlices().size());
+
+  Thread::threadFactoryForTest()
+      .createThread([&buffer]() {
+        OwnedImpl other;
+        other.move(*buffer);
+        buffer.reset();
+      })
+      ->join();
+
+  const SliceStoragePool::Stats after = SliceStoragePool::stats();
+  EXPECT_EQ(3U, after.remote_releases_ - before.remote_releases_);
+
+  OwnedImpl again;
+  again.add(std::string(16384, 'b'));
+  EXPECT_EQ(1U, SliceStoragePool::stats().hits_ - after.hits_);
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,96 @@
+#include <string>
+#include <vector>
+
+#include "source/common/common/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+class Base {
+public:
+  virtual ~Base() = default;
+  virtual size_t size() const PURE;
+};
+
+class Derived : public Base {
+public:
+  Derived(std::string value, int& destroyed) : value_(std::move(value)), destroyed_(destroyed) {}
+  ~Derived() override { destroyed_++; }
+  size_t size() const override { return value_.size(); }
+
+private:
+  const std::string value_;
+  int& destroyed_;
+};
+
+TEST(ArenaTest, BumpAllocation) {
+  Arena arena(256, 1024);
+  EXPECT_EQ(0U, arena.blockCount());
+
+  void* first = arena.allocate(16, 8);
+  void* second = arena.allocate(16, 8);
+  EXPECT_EQ(static_cast<char*>(first) + 16, second);
+  EXPECT_EQ(1U, arena.blockCount());
+  EXPECT_EQ(32U, arena.bytesAllocated());
+  EXPECT_EQ(256U, arena.bytesReserved());
+
+  // Alignment is honored within a block.
+  arena.allocate(1, 1);
+  void* aligned = arena.allocate(8, 8);
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(aligned) % 8);
+
+  // Exhausting a block allocates a bigger one.
+  arena.allocate(250, 8);
+  EXPECT_EQ(2U, arena.blockCount());
+  EXPECT_EQ(256U + 512U, arena.bytesReserved());
+
+  // Requests larger than the maximum block size get their own block.
+  arena.allocate(4096, 8);
+  EXPECT_EQ(3U, arena.blockCount());
+  EXPECT_EQ(256U + 512U + 4096U, arena.bytesReserved());
+}
+
+TEST(ArenaTest, InlineBlock) {
+  InlineArena<64> arena(256);
+  void* first = arena.allocate(32, 8);
+  void* second = arena.allocate(32, 8);
+  EXPECT_EQ(static_cast<char*>(first) + 32, second);
+  EXPECT_EQ(0U, arena.blockCount());
+  EXPECT_EQ(0U, arena.bytesReserved());
+  EXPECT_EQ(64U, arena.bytesAllocated());
+
+  // Once the inline block is exhausted, heap blocks grow from its size.
+  arena.allocate(8, 8);
+  EXPECT_EQ(1U, arena.blockCount());
+  EXPECT_EQ(64U, arena.bytesReserved());
+  arena.allocate(64, 8);
+  EXPECT_EQ(2U, arena.blockCount());
+  EXPECT_EQ(64U + 128U, arena.bytesReserved());
+}
+
+TEST(ArenaTest, MakeArenaPtr) {
+  int destroyed = 0;
+  Arena arena;
+  {
+    std::vector<ArenaPtr<Base>> objects;
+    for (int i = 0; i < 10; i++) {
+      objects.push_back(makeArenaPtr<Derived>(&arena, std::string(i, 'a'), destroyed));
+      EXPECT_TRUE(objects.back().get_deleter().inArena());
+    }
+    objects.push_back(makeArenaPtr<Derived>(nullptr, "heap", destroyed));
+    EXPECT_FALSE(objects.back().get_deleter().inArena());
+
+    size_t total = 0;
+    for (const auto& object : objects) {
+      total += object->size();
+    }
+    EXPECT_EQ(49U, total);
+    EXPECT_EQ(1U, arena.blockCount());
+  }
+  EXPECT_EQ(11, destroyed);
+}
+
+} // namespace
+} // namespace Envoy
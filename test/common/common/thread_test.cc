@@ -4,6 +4,7 @@
 #include "source/common/common/posix/thread_impl.h"
 #endif
 
+#include "source/common/common/lock_guard.h"
 #include "source/common/common/thread.h"
 #include "source/common/common/thread_synchronizer.h"
 
@@ -251,6 +252,47 @@ TEST_F(ThreadAsyncPtrTest, NameNotSpecifiedWait) {
   thread->join();
 }
 
+TEST(StripedMutexTest, WriterWaitsForReaders) {
+  StripedMutex mutex;
+  mutex.readerLock();
+  auto thread = threadFactoryForTest().createThread([&mutex]() { EXPECT_FALSE(mutex.tryLock()); });
+  thread->join();
+  mutex.readerUnlock();
+
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+}
+
+// Readers never observe a partial write.
+TEST(StripedMutexTest, ReadersAndWriters) {
+  StripedMutex mutex;
+  uint64_t first = 0;
+  uint64_t second = 0;
+  absl::Notification go;
+  std::vector<ThreadPtr> threads;
+  for (uint32_t i = 0; i < 8; ++i) {
+    threads.emplace_back(threadFactoryForTest().createThread([&, i]() {
+      go.WaitForNotification();
+      for (uint32_t count = 0; count < 10000; ++count) {
+        if ((count + i) % 16 == 0) {
+          LockGuard lock(mutex);
+          ++first;
+          ++second;
+        } else {
+          ReaderLockGuard lock(mutex);
+          EXPECT_EQ(first, second);
+        }
+      }
+    }));
+  }
+  go.Notify();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(8 * 10000 / 16, first);
+  EXPECT_EQ(first, second);
+}
+
 #if defined(__linux__) || defined(__APPLE__)
 TEST(PosixThreadTest, PThreadId) {
   auto thread_factory = PosixThreadFactory::create();
@@ -1,5 +1,6 @@
 #include "envoy/common/union_string.h"
 
+#include "absl/strings/ascii.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -322,6 +323,19 @@ TEST(UnionStringTest, All) {
     EXPECT_EQ(5U, string.size());
     EXPECT_FALSE(string.isReference());
   }
+
+  // inlineTransformBuffer
+  {
+    UnionString string;
+    string.setCopy("HELLO");
+    string.inlineTransformBuffer([](char* data, size_t size) {
+      for (size_t i = 0; i < size; i++) {
+        data[i] = absl::ascii_tolower(data[i]);
+      }
+    });
+    EXPECT_FALSE(string.isReference());
+    EXPECT_EQ(string.getStringView(), "hello");
+  }
 }
 
 } // namespace
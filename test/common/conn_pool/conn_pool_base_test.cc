@@ -6,6 +6,7 @@
 #include "test/mocks/upstream/cluster_info.h"
 #include "test/mocks/upstream/host.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -249,6 +250,29 @@ public:
   bool clients_support_early_data_{false};
 };
 
+// The runtime guard is latched when the pool is created, so it is set by a base class which is
+// constructed before the pool.
+class LeastLoadedClientRuntime {
+public:
+  LeastLoadedClientRuntime() {
+    scoped_runtime_.mergeValues(
+        {{"envoy.reloadable_features.conn_pool_least_loaded_client", "true"}});
+  }
+
+  TestScopedRuntime scoped_runtime_;
+};
+
+class ConnPoolImplLeastLoadedClientTest : public LeastLoadedClientRuntime,
+                                          public ConnPoolImplDispatcherBaseTest {
+public:
+  void closeStreams(TestActiveClient& client, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+      --client.active_streams_;
+      pool_.onStreamClosed(client, false);
+    }
+  }
+};
+
 TEST_F(ConnPoolImplBaseTest, DumpState) {
   std::stringstream out;
   pool_.dumpState(out, 0);
@@ -690,5 +714,47 @@ TEST_F(ConnPoolImplDispatcherBaseTest, PoolDrainsWithEarlyDataStreams) {
   closeStream();
 }
 
+TEST_F(ConnPoolImplLeastLoadedClientTest, AttachesToLeastLoadedClient) {
+  concurrent_streams_ = 4u;
+  ON_CALL(*cluster_, perUpstreamPreconnectRatio).WillByDefault(Return(1));
+
+  // Five pending streams need two connections.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(2);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  }
+  ASSERT_EQ(2u, clients_.size());
+  TestActiveClient& first = *clients_[0];
+  TestActiveClient& second = *clients_[1];
+
+  // The first client takes four streams and is busy until one of them closes, at which point it
+  // takes the last pending stream.
+  first.onEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(ActiveClient::State::Busy, first.state());
+  closeStreams(first, 4);
+  EXPECT_EQ(1u, first.active_streams_);
+  CHECK_STATE(1 /*active*/, 0 /*pending*/, 7 /*connecting capacity*/);
+
+  // The second client is the most recently ready one, but new streams go to it only while it is
+  // the least loaded. Ties go to the most recently ready client.
+  second.onEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(ActiveClient::State::Ready, second.state());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  }
+  EXPECT_EQ(2u, first.active_streams_);
+  EXPECT_EQ(2u, second.active_streams_);
+
+  // Draining closes the idle client without visiting the loaded one, which is drained.
+  closeStreams(second, 2);
+  pool_.drainConnectionsImpl(DrainBehavior::DrainExistingConnections);
+  EXPECT_EQ(ActiveClient::State::Closed, second.state());
+  EXPECT_EQ(ActiveClient::State::Draining, first.state());
+
+  // Clean up.
+  closeStreams(first, 2);
+  EXPECT_EQ(ActiveClient::State::Closed, first.state());
+}
+
 } // namespace ConnectionPool
 } // namespace Envoy
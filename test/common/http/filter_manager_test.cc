@@ -407,6 +407,43 @@ TEST_F(FilterManagerTest, ResetIdleTimer) {
   filter_manager_->destroyFilters();
 }
 
+// Filter wrappers are placed in the per-stream arena when it is enabled.
+TEST_F(FilterManagerTest, StreamArena) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.http_stream_arena", "true"}});
+  initialize();
+  ASSERT_NE(nullptr, filter_manager_->arena());
+
+  std::shared_ptr<MockStreamDecoderFilter> decoder_filter(new NiceMock<MockStreamDecoderFilter>());
+  std::shared_ptr<MockStreamFilter> stream_filter(new NiceMock<MockStreamFilter>());
+
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainManager& manager) -> bool {
+        auto decoder_factory = createDecoderFilterFactoryCb(decoder_filter);
+        manager.applyFilterFactoryCb({}, decoder_factory);
+        auto stream_factory = createStreamFilterFactoryCb(stream_filter);
+        manager.applyFilterFactoryCb({}, stream_factory);
+        return true;
+      }));
+  filter_manager_->createDownstreamFilterChain();
+  EXPECT_GT(filter_manager_->arena()->bytesAllocated(), 0U);
+  // Short filter chains fit in the inline block of the arena.
+  EXPECT_EQ(0U, filter_manager_->arena()->blockCount());
+
+  EXPECT_CALL(filter_manager_callbacks_, resetIdleTimer());
+  decoder_filter->callbacks_->resetIdleTimer();
+
+  EXPECT_CALL(*decoder_filter, onDestroy());
+  EXPECT_CALL(*stream_filter, onDestroy());
+  filter_manager_->destroyFilters();
+}
+
+TEST_F(FilterManagerTest, StreamArenaDisabled) {
+  initialize();
+  EXPECT_EQ(nullptr, filter_manager_->arena());
+  filter_manager_->destroyFilters();
+}
+
 TEST_F(FilterManagerTest, SetAndGetUpstreamOverrideHost) {
   initialize();
 
@@ -1,8 +1,10 @@
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -297,6 +299,42 @@ static void headerMapImplRemovePrefix(benchmark::State& state) {
 }
 BENCHMARK(headerMapImplRemovePrefix)->Arg(0)->Arg(1)->Arg(5)->Arg(10)->Arg(50);
 
+/**
+ * Measure the speed of creating, populating, iterating and destroying a request header map with
+ * a realistic number of headers, with and without arena backed entry storage. The first
+ * benchmark argument is the number of headers added, the second one enables the
+ * envoy.restart_features.header_map_arena_storage restart feature.
+ */
+static void headerMapImplArenaStorage(benchmark::State& state) {
+  Runtime::maybeSetRuntimeGuard("envoy.restart_features.header_map_arena_storage",
+                                state.range(1) != 0);
+  HeaderNodeArena::resetEnabledForTest();
+  std::vector<LowerCaseString> keys;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    keys.emplace_back(absl::StrCat("x-dummy-key-", i));
+  }
+  const std::string value("01234567890123456789");
+  uint64_t total_len = 0;
+  for (auto _ : state) { // NOLINT
+    auto headers = Http::RequestHeaderMapImpl::create();
+    headers->setReferencePath("/");
+    headers->setReferenceMethod(Http::Headers::get().MethodValues.Get);
+    for (const LowerCaseString& key : keys) {
+      headers->addReference(key, value);
+    }
+    headers->iterate([&total_len](const HeaderEntry& header) -> HeaderMap::Iterate {
+      total_len += header.key().size() + header.value().size();
+      return HeaderMap::Iterate::Continue;
+    });
+  }
+  benchmark::DoNotOptimize(total_len);
+  Runtime::maybeSetRuntimeGuard("envoy.restart_features.header_map_arena_storage", false);
+  HeaderNodeArena::resetEnabledForTest();
+}
+BENCHMARK(headerMapImplArenaStorage)
+    ->ArgsProduct({{5, 20, 40, 80}, {0, 1}})
+    ->ArgNames({"headers", "arena"});
+
 class StaticLookupBenchmarker {
 public:
   explicit StaticLookupBenchmarker(std::unique_ptr<HeaderMapImpl> impl)
@@ -11,6 +11,8 @@
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 using ::testing::ElementsAre;
@@ -1087,5 +1089,111 @@ TEST(HeaderMapImplTest, HeaderMapMaxLimits) {
   EXPECT_EQ(response_trailer->maxHeadersCount(), 3);
 }
 
+TEST(HeaderNodeArenaTest, ReusesFreedSlots) {
+  HeaderNodeArena arena;
+  std::vector<void*> slots;
+  for (uint32_t i = 0; i < HeaderNodeArena::InitialBlockSlots; i++) {
+    slots.push_back(arena.allocate(64, alignof(std::max_align_t)));
+  }
+  EXPECT_EQ(1UL, arena.blockCount());
+
+  // A freed slot is handed out again before a new block is allocated.
+  arena.deallocate(slots[3], 64, alignof(std::max_align_t));
+  EXPECT_EQ(slots[3], arena.allocate(64, alignof(std::max_align_t)));
+  EXPECT_EQ(1UL, arena.blockCount());
+
+  // Exhausting the first block allocates a second, twice as large one.
+  for (uint32_t i = 0; i < HeaderNodeArena::InitialBlockSlots * 2; i++) {
+    slots.push_back(arena.allocate(64, alignof(std::max_align_t)));
+  }
+  EXPECT_EQ(2UL, arena.blockCount());
+
+  // Allocations that do not match the slot size go to the heap.
+  void* other = arena.allocate(128, alignof(std::max_align_t));
+  EXPECT_EQ(2UL, arena.blockCount());
+  arena.deallocate(other, 128, alignof(std::max_align_t));
+
+  for (void* slot : slots) {
+    arena.deallocate(slot, 64, alignof(std::max_align_t));
+  }
+}
+
+// The allocator only creates an arena while arena storage is enabled.
+TEST(HeaderNodeArenaTest, CreatedLazily) {
+  TestScopedRuntime scoped_runtime;
+  std::unique_ptr<HeaderNodeArena> arena;
+  HeaderNodeAllocator<std::max_align_t> allocator(arena);
+
+  scoped_runtime.mergeValues({{"envoy.restart_features.header_map_arena_storage", "false"}});
+  HeaderNodeArena::resetEnabledForTest();
+  std::max_align_t* p = allocator.allocate(1);
+  EXPECT_EQ(nullptr, arena);
+  allocator.deallocate(p, 1);
+
+  // The restart feature is only read once, so flipping it alone has no effect.
+  scoped_runtime.mergeValues({{"envoy.restart_features.header_map_arena_storage", "true"}});
+  p = allocator.allocate(1);
+  EXPECT_EQ(nullptr, arena);
+  allocator.deallocate(p, 1);
+
+  HeaderNodeArena::resetEnabledForTest();
+  p = allocator.allocate(1);
+  ASSERT_NE(nullptr, arena);
+  EXPECT_EQ(1UL, arena->blockCount());
+  allocator.deallocate(p, 1);
+  HeaderNodeArena::resetEnabledForTest();
+}
+
+// Exercises the header map with arena backed entry storage.
+TEST(HeaderMapImplTest, ArenaStorage) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.restart_features.header_map_arena_storage", "true"}});
+  HeaderNodeArena::resetEnabledForTest();
+
+  TestRequestHeaderMapImpl headers;
+  for (int i = 0; i < 40; i++) {
+    headers.addCopy(LowerCaseString(absl::StrCat("x-key-", i)), absl::StrCat("value-", i));
+  }
+  headers.setPath("/");
+  headers.setMethod("GET");
+  EXPECT_EQ(42UL, headers.size());
+  headers.verifyByteSizeInternalForTest();
+
+  // Pseudo headers stay in front of the other headers.
+  std::vector<std::string> keys;
+  headers.iterate([&keys](const HeaderEntry& header) -> HeaderMap::Iterate {
+    keys.emplace_back(header.key().getStringView());
+    return HeaderMap::Iterate::Continue;
+  });
+  ASSERT_EQ(42UL, keys.size());
+  EXPECT_EQ(":path", keys[0]);
+  EXPECT_EQ(":method", keys[1]);
+  EXPECT_EQ("x-key-0", keys[2]);
+  EXPECT_EQ("x-key-39", keys[41]);
+
+  // Removal returns entries to the arena and later inserts reuse them.
+  EXPECT_EQ(1UL, headers.remove(LowerCaseString("x-key-7")));
+  EXPECT_EQ(16UL, headers.removeIf([](const HeaderEntry& header) {
+    return absl::EndsWith(header.value().getStringView(), "1") ||
+           absl::EndsWith(header.value().getStringView(), "3") ||
+           absl::EndsWith(header.value().getStringView(), "5") ||
+           absl::EndsWith(header.value().getStringView(), "9");
+  }));
+  EXPECT_EQ(25UL, headers.size());
+  headers.addCopy(LowerCaseString("x-key-7"), "reused");
+  EXPECT_EQ("reused", headers.get_("x-key-7"));
+  headers.verifyByteSizeInternalForTest();
+
+  TestRequestHeaderMapImpl copy(headers);
+  EXPECT_EQ(copy, headers);
+
+  headers.clear();
+  EXPECT_TRUE(headers.empty());
+  headers.addCopy(LowerCaseString("hello"), "world");
+  EXPECT_EQ("world", headers.get_("hello"));
+  EXPECT_EQ(1UL, headers.size());
+  HeaderNodeArena::resetEnabledForTest();
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -0,0 +1,62 @@
+#include <string>
+
+#include "source/common/http/header_utility.h"
+#include "source/common/http/http1/header_scan.h"
+
+#include "absl/strings/ascii.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Places every byte value at every position of values of various lengths, so both the vector
+// loop and the scalar tail see each character.
+TEST(HeaderScanTest, HeaderValueIsValidMatchesHeaderUtility) {
+  for (size_t length = 1; length <= 40; length++) {
+    for (size_t position = 0; position < length; position++) {
+      std::string value(length, 'a');
+      for (int c = 0; c < 256; c++) {
+        value[position] = static_cast<char>(c);
+        EXPECT_EQ(HeaderUtility::headerValueIsValid(value), HeaderScan::headerValueIsValid(value))
+            << "length " << length << " position " << position << " char " << c;
+        EXPECT_EQ(HeaderUtility::headerValueIsValid(value),
+                  HeaderScan::headerValueIsValidScalar(value));
+      }
+    }
+  }
+}
+
+TEST(HeaderScanTest, HeaderValueIsValid) {
+  EXPECT_TRUE(HeaderScan::headerValueIsValid(""));
+  EXPECT_TRUE(HeaderScan::headerValueIsValid("text/html; charset=utf-8"));
+  EXPECT_TRUE(HeaderScan::headerValueIsValid("tab\tseparated value with obs-text \xe9\xff"));
+  EXPECT_FALSE(HeaderScan::headerValueIsValid("a value that is longer than sixteen bytes\r\n"));
+  EXPECT_FALSE(HeaderScan::headerValueIsValid(absl::string_view("nul\0byte", 8)));
+  EXPECT_FALSE(HeaderScan::headerValueIsValid("delete\x7f"));
+}
+
+TEST(HeaderScanTest, ToLowerInPlace) {
+  for (size_t length = 0; length <= 40; length++) {
+    std::string value;
+    for (size_t i = 0; i < length * 7; i++) {
+      value.push_back(static_cast<char>(i * 37 + length));
+    }
+    std::string expected = value;
+    for (char& c : expected) {
+      c = absl::ascii_tolower(c);
+    }
+    HeaderScan::toLowerInPlace(value.data(), value.size());
+    EXPECT_EQ(expected, value);
+  }
+
+  std::string header = "X-Forwarded-For-Some-Long-Header-NAME";
+  HeaderScan::toLowerInPlace(header.data(), header.size());
+  EXPECT_EQ("x-forwarded-for-some-long-header-name", header);
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
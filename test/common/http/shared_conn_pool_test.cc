@@ -0,0 +1,294 @@
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/shared_conn_pool.h"
+
+#include "test/common/http/common.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
+#include "test/mocks/http/conn_pool.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/http/stream_decoder.h"
+#include "test/mocks/http/stream_encoder.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/upstream/host.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+class SharedConnPoolTest : public testing::Test {
+public:
+  SharedConnPoolTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("origin")),
+        owner_dispatcher_(api_->allocateDispatcher("owner")),
+        owner_(std::make_shared<SharedConnPool::Owner>(*owner_dispatcher_)) {
+    ON_CALL(owner_encoder_, getStream()).WillByDefault(ReturnRef(owner_encoder_.stream_));
+  }
+
+  ~SharedConnPoolTest() override {
+    pool_.reset();
+    runOwner();
+    runOrigin();
+  }
+
+  void initialize(uint32_t max_queued_streams) {
+    pool_ = std::make_unique<SharedConnPool>(
+        *dispatcher_, owner_, host_,
+        [this]() -> ConnectionPool::Instance* { return owner_available_ ? &owner_pool_ : nullptr; },
+        [this]() {
+          auto pool = std::make_unique<NiceMock<ConnectionPool::MockInstance>>();
+          local_pool_ = pool.get();
+          return pool;
+        },
+        max_queued_streams);
+  }
+
+  void runOwner() { owner_dispatcher_->run(Event::Dispatcher::RunType::NonBlock); }
+  void runOrigin() { dispatcher_->run(Event::Dispatcher::RunType::NonBlock); }
+
+  // Creates a stream for which the owner's pool has a stream ready, and returns its encoder.
+  RequestEncoder& readyStream() {
+    EXPECT_CALL(owner_pool_, newStream(_, _, _))
+        .WillOnce(Invoke([&](ResponseDecoder& decoder, ConnectionPool::Callbacks& callbacks,
+                             const ConnectionPool::Instance::StreamOptions&) {
+          owner_decoder_ = &decoder;
+          callbacks.onPoolReady(owner_encoder_, host_, owner_stream_info_, Protocol::Http2);
+          return nullptr;
+        }));
+    EXPECT_NE(nullptr, pool_->newStream(decoder_, callbacks_, {false, true}));
+    EXPECT_EQ(1, pool_->queuedStreams());
+    runOwner();
+
+    EXPECT_CALL(callbacks_.pool_ready_, ready());
+    runOrigin();
+    EXPECT_EQ(0, pool_->queuedStreams());
+    return *callbacks_.outer_encoder_;
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  Event::DispatcherPtr owner_dispatcher_;
+  SharedConnPool::OwnerSharedPtr owner_;
+  std::shared_ptr<NiceMock<Upstream::MockHost>> host_{
+      std::make_shared<NiceMock<Upstream::MockHost>>()};
+  NiceMock<ConnectionPool::MockInstance> owner_pool_;
+  NiceMock<MockRequestEncoder> owner_encoder_;
+  NiceMock<StreamInfo::MockStreamInfo> owner_stream_info_;
+  ResponseDecoder* owner_decoder_{};
+  bool owner_available_{true};
+  ConnectionPool::MockInstance* local_pool_{};
+  NiceMock<MockResponseDecoder> decoder_;
+  ConnPoolCallbacks callbacks_;
+  std::unique_ptr<SharedConnPool> pool_;
+};
+
+TEST_F(SharedConnPoolTest, RelaysRequestAndResponse) {
+  initialize(16);
+  RequestEncoder& encoder = readyStream();
+
+  TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
+  EXPECT_TRUE(encoder.encodeHeaders(request_headers, false).ok());
+  Buffer::OwnedImpl request_body("hello");
+  encoder.encodeData(request_body, true);
+  EXPECT_EQ(0, request_body.length());
+
+  EXPECT_CALL(owner_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  EXPECT_CALL(owner_encoder_, encodeData(BufferStringEqual("hello"), true));
+  runOwner();
+
+  owner_decoder_->decodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, false);
+  Buffer::OwnedImpl response_body("world");
+  owner_decoder_->decodeData(response_body, true);
+
+  EXPECT_CALL(decoder_, decodeHeaders_(_, false));
+  EXPECT_CALL(decoder_, decodeData(BufferStringEqual("world"), true));
+  runOrigin();
+
+  // Completed streams are released, and the pool only reports being idle once drained.
+  EXPECT_TRUE(pool_->isIdle());
+  testing::MockFunction<void()> idle_cb;
+  pool_->addIdleCallback(idle_cb.AsStdFunction());
+  EXPECT_CALL(idle_cb, Call());
+  pool_->drainConnections(Envoy::ConnectionPool::DrainBehavior::DrainAndDelete);
+}
+
+TEST_F(SharedConnPoolTest, StreamsBeyondQueueBoundUseLocalPool) {
+  initialize(1);
+  EXPECT_NE(nullptr, pool_->newStream(decoder_, callbacks_, {false, true}));
+  EXPECT_EQ(1, pool_->queuedStreams());
+
+  NiceMock<MockResponseDecoder> decoder;
+  ConnPoolCallbacks callbacks;
+  pool_->newStream(decoder, callbacks, {false, true});
+  ASSERT_NE(nullptr, local_pool_);
+  EXPECT_EQ(1, pool_->queuedStreams());
+
+  // Destroying the pool fails the queued stream and cancels it on the owner.
+  Envoy::ConnectionPool::MockCancellable owner_cancellable;
+  EXPECT_CALL(owner_pool_, newStream(_, _, _)).WillOnce(Return(&owner_cancellable));
+  runOwner();
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  pool_.reset();
+  EXPECT_CALL(owner_cancellable, cancel(_));
+  runOwner();
+}
+
+TEST_F(SharedConnPoolTest, OwnerUnavailable) {
+  initialize(16);
+  owner_available_ = false;
+  pool_->newStream(decoder_, callbacks_, {false, true});
+  runOwner();
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runOrigin();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+  EXPECT_EQ("shared connection pool owner unavailable", callbacks_.transport_failure_reason_);
+  EXPECT_EQ(0, pool_->queuedStreams());
+}
+
+TEST_F(SharedConnPoolTest, OwnerPoolFailure) {
+  initialize(16);
+  EXPECT_CALL(owner_pool_, newStream(_, _, _))
+      .WillOnce(Invoke([&](ResponseDecoder&, ConnectionPool::Callbacks& callbacks,
+                           const ConnectionPool::Instance::StreamOptions&) {
+        callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Timeout, "timeout", host_);
+        return nullptr;
+      }));
+  pool_->newStream(decoder_, callbacks_, {false, true});
+  runOwner();
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runOrigin();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::Timeout, callbacks_.reason_);
+  EXPECT_EQ("timeout", callbacks_.transport_failure_reason_);
+  EXPECT_EQ(host_, callbacks_.host_);
+}
+
+TEST_F(SharedConnPoolTest, CancelBeforeOwnerIsReady) {
+  initialize(16);
+  Envoy::ConnectionPool::MockCancellable owner_cancellable;
+  EXPECT_CALL(owner_pool_, newStream(_, _, _)).WillOnce(Return(&owner_cancellable));
+  ConnectionPool::Cancellable* cancellable = pool_->newStream(decoder_, callbacks_, {false, true});
+  cancellable->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+  EXPECT_EQ(0, pool_->queuedStreams());
+
+  EXPECT_CALL(owner_cancellable, cancel(_));
+  runOwner();
+  EXPECT_CALL(callbacks_.pool_ready_, ready()).Times(0);
+  runOrigin();
+}
+
+TEST_F(SharedConnPoolTest, OwnerShutdownFailsStreamsNotTakenOver) {
+  initialize(16);
+  pool_->newStream(decoder_, callbacks_, {false, true});
+  EXPECT_EQ(1, pool_->queuedStreams());
+  // The owner's dispatcher never runs again, so the stream is failed by the shutdown instead.
+  EXPECT_CALL(owner_pool_, newStream(_, _, _)).Times(0);
+  owner_->shutdown();
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runOrigin();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+  EXPECT_EQ("shared connection pool owner shut down", callbacks_.transport_failure_reason_);
+  EXPECT_EQ(0, pool_->queuedStreams());
+
+  // Further streams use a local pool.
+  NiceMock<MockResponseDecoder> decoder;
+  ConnPoolCallbacks callbacks;
+  pool_->newStream(decoder, callbacks, {false, true});
+  ASSERT_NE(nullptr, local_pool_);
+  EXPECT_EQ(0, pool_->queuedStreams());
+  runOwner();
+}
+
+TEST_F(SharedConnPoolTest, SslConnectionIsCopiedOnTheOwner) {
+  initialize(16);
+  const std::string sni = "example.com";
+  const std::string empty;
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  ON_CALL(*ssl, sha256PeerCertificateDigest()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, sha1PeerCertificateDigest()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, serialNumberPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, issuerPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, subjectPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, subjectLocalCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, urlEncodedPemEncodedPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, urlEncodedPemEncodedPeerCertificateChain()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, sessionId()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, tlsVersion()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, alpn()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl, sni()).WillByDefault(ReturnRef(sni));
+  owner_encoder_.stream_.connection_info_provider_.setSslConnection(ssl);
+
+  RequestEncoder& encoder = readyStream();
+  // The connection's own info computes its values lazily, so the origin must not share it.
+  Ssl::ConnectionInfoConstSharedPtr origin_ssl =
+      encoder.getStream().connectionInfoProvider().sslConnection();
+  ASSERT_NE(nullptr, origin_ssl);
+  EXPECT_NE(ssl.get(), origin_ssl.get());
+  EXPECT_EQ(sni, origin_ssl->sni());
+}
+
+TEST_F(SharedConnPoolTest, ResetByOwner) {
+  initialize(16);
+  RequestEncoder& encoder = readyStream();
+  MockStreamCallbacks stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  owner_encoder_.stream_.resetStream(StreamResetReason::RemoteReset);
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset, _));
+  runOrigin();
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolTest, ResetByOrigin) {
+  initialize(16);
+  RequestEncoder& encoder = readyStream();
+  encoder.getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_TRUE(pool_->isIdle());
+
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  runOwner();
+}
+
+TEST_F(SharedConnPoolTest, WatermarksAndReadDisable) {
+  initialize(16);
+  RequestEncoder& encoder = readyStream();
+  MockStreamCallbacks stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  owner_encoder_.stream_.runHighWatermarkCallbacks();
+  owner_encoder_.stream_.runLowWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  runOrigin();
+
+  encoder.getStream().readDisable(true);
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(true));
+  runOwner();
+
+  encoder.getStream().removeCallbacks(stream_callbacks);
+}
+
+TEST_F(SharedConnPoolTest, DestroyedWithPendingStream) {
+  initialize(16);
+  pool_->newStream(decoder_, callbacks_, {false, true});
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  pool_.reset();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+  EXPECT_EQ("shared connection pool destroyed", callbacks_.transport_failure_reason_);
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
@@ -1,3 +1,5 @@
+#include <sys/socket.h>
+
 #include <functional>
 
 #include "source/common/io/io_uring_impl.h"
@@ -321,6 +323,60 @@ TEST_F(IoUringImplTest, PrepareReadvAllDataFitsOneChunk) {
   EXPECT_STREQ(static_cast<char*>(iov.iov_base), "test text");
 }
 
+TEST_F(IoUringImplTest, PrepareWritevAndShutdown) {
+  os_fd_t fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+  auto dispatcher = api_->allocateDispatcher("test_thread");
+
+  char data[] = "test text";
+  struct iovec iov;
+  iov.iov_base = data;
+  iov.iov_len = strlen(data);
+
+  os_fd_t event_fd = io_uring_->registerEventfd();
+  const Event::FileTriggerType trigger = Event::PlatformDefaultTriggerType;
+  std::vector<int32_t> results;
+  auto file_event = dispatcher->createFileEvent(
+      event_fd,
+      [this, &results](uint32_t) {
+        io_uring_->forEveryCompletion(
+            [&results](Request*, int32_t res, bool) { results.push_back(res); });
+        return absl::OkStatus();
+      },
+      trigger, Event::FileReadyType::Read);
+
+  // Both entries have to fit into the submission queue.
+  int data1 = 1;
+  TestRequest request1(data1);
+  EXPECT_EQ(IoUringResult::Ok, io_uring_->prepareShutdown(fds[0], SHUT_RD, &request1));
+  int data2 = 2;
+  TestRequest request2(data2);
+  int data3 = 3;
+  TestRequest request3(data3);
+  EXPECT_EQ(IoUringResult::Failed,
+            io_uring_->prepareWritevAndShutdown(fds[0], &iov, 1, &request2, SHUT_WR, &request3));
+  EXPECT_EQ(IoUringResult::Ok, io_uring_->submit());
+  waitForCondition(*dispatcher, [&results]() { return results.size() == 1; });
+
+  EXPECT_EQ(IoUringResult::Ok,
+            io_uring_->prepareWritevAndShutdown(fds[0], &iov, 1, &request2, SHUT_WR, &request3));
+  EXPECT_EQ(IoUringResult::Ok, io_uring_->submit());
+  waitForCondition(*dispatcher, [&results]() { return results.size() == 3; });
+  // The linked entries complete in order.
+  EXPECT_EQ(strlen(data), results[1]);
+  EXPECT_EQ(0, results[2]);
+
+  // The peer reads the data, followed by the end of stream.
+  char buffer[16]{};
+  EXPECT_EQ(strlen(data), read(fds[1], buffer, sizeof(buffer)));
+  EXPECT_STREQ(data, buffer);
+  EXPECT_EQ(0, read(fds[1], buffer, sizeof(buffer)));
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
 TEST_F(IoUringImplTest, PrepareReadvQueueOverflow) {
   std::string test_file =
       TestEnvironment::writeStringToFileForTest("prepare_readv_overflow", "abcdefhg", true);
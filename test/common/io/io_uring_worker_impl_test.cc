@@ -5,6 +5,7 @@
 
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/io/mocks.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -693,6 +694,144 @@ TEST(IoUringWorkerImplTest, NoEnableReadOnConnectError) {
   delete static_cast<Request*>(connect_req);
 }
 
+TEST(IoUringWorkerImplTest, BatchedWritesAreSubmittedTogether) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.io_uring_batched_writes", "true"}});
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(dispatcher, createFileEvent_(_, _, Event::PlatformDefaultTriggerType,
+                                           Event::FileReadyType::Read));
+  auto* submit_cb = new NiceMock<Event::MockSchedulableCallback>(&dispatcher);
+  IoUringWorkerTestImpl worker(std::move(io_uring_instance), dispatcher);
+  IoUringServerSocket socket1(0, worker, [](uint32_t) { return absl::OkStatus(); }, 0, false);
+  IoUringServerSocket socket2(1, worker, [](uint32_t) { return absl::OkStatus(); }, 0, false);
+
+  // Nothing is prepared until the end of the event loop iteration.
+  EXPECT_CALL(mock_io_uring, prepareWritev(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(mock_io_uring, submit()).Times(0);
+  Buffer::OwnedImpl buf1("hello");
+  socket1.write(buf1);
+  Buffer::OwnedImpl buf2("world");
+  socket1.write(buf2);
+  socket1.shutdown(SHUT_WR);
+  Buffer::OwnedImpl buf3("hello");
+  socket2.write(buf3);
+  EXPECT_TRUE(submit_cb->enabled_);
+  testing::Mock::VerifyAndClearExpectations(&mock_io_uring);
+
+  // The writes of each socket are coalesced, the shutdown is linked to the write and everything is
+  // submitted at once.
+  Request* write_req1 = nullptr;
+  Request* shutdown_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareWritevAndShutdown(0, _, _, _, SHUT_WR, _))
+      .WillOnce(DoAll(SaveArg<3>(&write_req1), SaveArg<5>(&shutdown_req),
+                      Return<IoUringResult>(IoUringResult::Ok)));
+  Request* write_req2 = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareWritev(1, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<4>(&write_req2), Return<IoUringResult>(IoUringResult::Ok)));
+  EXPECT_CALL(mock_io_uring, submit());
+  submit_cb->invokeCallback();
+  EXPECT_FALSE(submit_cb->enabled_);
+
+  // A short write cancels the linked shutdown, which is linked again to the write of the remaining
+  // data.
+  socket1.onWrite(write_req1, 3, false);
+  Request* write_req3 = nullptr;
+  Request* shutdown_req2 = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareWritevAndShutdown(0, _, _, _, SHUT_WR, _))
+      .WillOnce(DoAll(SaveArg<3>(&write_req3), SaveArg<5>(&shutdown_req2),
+                      Return<IoUringResult>(IoUringResult::Ok)));
+  socket1.onShutdown(shutdown_req, -ECANCELED, false);
+  EXPECT_CALL(mock_io_uring, submit());
+  submit_cb->invokeCallback();
+
+  // No more requests once the write and the shutdown completed.
+  EXPECT_CALL(mock_io_uring, prepareShutdown(_, _, _)).Times(0);
+  socket1.onWrite(write_req3, 7, false);
+  socket1.onShutdown(shutdown_req2, 0, false);
+  socket2.onWrite(write_req2, 5, false);
+  EXPECT_FALSE(submit_cb->enabled_);
+
+  // The worker submits whatever is left when it is destroyed.
+  EXPECT_CALL(mock_io_uring, submit());
+  EXPECT_CALL(dispatcher, clearDeferredDeleteList());
+  delete write_req1;
+  delete shutdown_req;
+  delete write_req2;
+  delete write_req3;
+  delete shutdown_req2;
+}
+
+TEST(IoUringWorkerImplTest, CloseSubmitsScheduledWrite) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.io_uring_batched_writes", "true"}});
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(dispatcher, createFileEvent_(_, _, Event::PlatformDefaultTriggerType,
+                                           Event::FileReadyType::Read));
+  auto* submit_cb = new NiceMock<Event::MockSchedulableCallback>(&dispatcher);
+  IoUringWorkerTestImpl worker(std::move(io_uring_instance), dispatcher);
+  IoUringServerSocket socket(0, worker, [](uint32_t) { return absl::OkStatus(); }, 0, false);
+
+  Buffer::OwnedImpl buf("hello");
+  socket.write(buf);
+
+  // The close waits for the scheduled write instead of closing the fd right away.
+  Request* write_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareWritev(0, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<4>(&write_req), Return<IoUringResult>(IoUringResult::Ok)));
+  EXPECT_CALL(mock_io_uring, prepareClose(_, _)).Times(0);
+  socket.close(false);
+  testing::Mock::VerifyAndClearExpectations(&mock_io_uring);
+
+  Request* close_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareClose(0, _))
+      .WillOnce(DoAll(SaveArg<1>(&close_req), Return<IoUringResult>(IoUringResult::Ok)));
+  socket.onWrite(write_req, 5, false);
+
+  // The write was not prepared again by the scheduled submission.
+  EXPECT_CALL(mock_io_uring, prepareWritev(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(mock_io_uring, submit());
+  submit_cb->invokeCallback();
+
+  EXPECT_CALL(mock_io_uring, submit());
+  EXPECT_CALL(dispatcher, clearDeferredDeleteList());
+  delete write_req;
+  delete close_req;
+}
+
+TEST(IoUringWorkerImplTest, DestructorSubmitsScheduledWrites) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.io_uring_batched_writes", "true"}});
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(dispatcher, createFileEvent_(_, _, Event::PlatformDefaultTriggerType,
+                                           Event::FileReadyType::Read));
+  auto* submit_cb = new NiceMock<Event::MockSchedulableCallback>(&dispatcher);
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher);
+  IoUringServerSocket socket(0, *worker, [](uint32_t) { return absl::OkStatus(); }, 0, false);
+
+  Buffer::OwnedImpl buf("hello");
+  socket.write(buf);
+  EXPECT_TRUE(submit_cb->enabled_);
+
+  // The event loop does not run the scheduled submission anymore, so the worker prepares the write
+  // and submits it when it is destroyed.
+  Request* write_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareWritev(0, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<4>(&write_req), Return<IoUringResult>(IoUringResult::Ok)));
+  EXPECT_CALL(mock_io_uring, submit());
+  EXPECT_CALL(dispatcher, clearDeferredDeleteList());
+  worker.reset();
+  delete write_req;
+}
+
 } // namespace
 } // namespace Io
 } // namespace Envoy
@@ -6661,6 +6661,42 @@ TEST_P(ListenerManagerImplWithRealFiltersTest, MptcpNotSupported) {
       "listener mptcp-udp: enable_mptcp is set but MPTCP is not supported by the operating system");
 }
 
+TEST_P(ListenerManagerImplWithRealFiltersTest, ReusePortCpuSteeringOnUdp) {
+  envoy::config::listener::v3::Listener listener = parseListenerFromV3Yaml(R"EOF(
+      name: steering-udp
+      reuse_port_cpu_steering: true
+      address:
+        socket_address:
+          address: 127.0.0.1
+          port_value: 1111
+          protocol: UDP
+      filter_chains:
+      - filters: []
+        name: foo
+    )EOF");
+  EXPECT_THROW_WITH_MESSAGE(addOrUpdateListener(listener), EnvoyException,
+                            "listener steering-udp: reuse_port_cpu_steering can only be used with "
+                            "TCP listeners using reuse_port");
+}
+
+TEST_P(ListenerManagerImplWithRealFiltersTest, ReusePortCpuSteeringWithoutReusePort) {
+  envoy::config::listener::v3::Listener listener = parseListenerFromV3Yaml(R"EOF(
+      name: steering-no-reuse-port
+      reuse_port_cpu_steering: true
+      enable_reuse_port: false
+      address:
+        socket_address:
+          address: 127.0.0.1
+          port_value: 1111
+      filter_chains:
+      - filters: []
+        name: foo
+    )EOF");
+  EXPECT_THROW_WITH_MESSAGE(addOrUpdateListener(listener), EnvoyException,
+                            "listener steering-no-reuse-port: reuse_port_cpu_steering can only be "
+                            "used with TCP listeners using reuse_port");
+}
+
 // Set the resolver to the default IP resolver. The address resolver logic is unit tested in
 // resolver_impl_test.cc.
 TEST_P(ListenerManagerImplWithRealFiltersTest, AddressResolver) {
@@ -1,3 +1,7 @@
+#if defined(__linux__)
+#include <linux/filter.h>
+#endif
+
 #include "envoy/config/core/v3/base.pb.h"
 
 #include "source/common/network/address_impl.h"
@@ -298,6 +302,31 @@ TEST_F(SocketOptionFactoryTest, TestBuildBindAddressNoPortOptions) {
   EXPECT_EQ(expected_value, option_details->value_);
 }
 
+TEST_F(SocketOptionFactoryTest, TestBuildReusePortCpuSteeringOptions) {
+  const auto expected_option = ENVOY_ATTACH_REUSEPORT_CBPF;
+  CHECK_OPTION_SUPPORTED(expected_option);
+
+  auto socket_options = SocketOptionFactory::buildReusePortCpuSteeringOptions(4);
+  ASSERT_EQ(1U, socket_options->size());
+  auto option_details = socket_options->at(0)->getOptionDetails(
+      socket_mock_, envoy::config::core::v3::SocketOption::STATE_BOUND);
+  ASSERT_TRUE(option_details.has_value());
+  EXPECT_EQ(expected_option.level(), option_details->name_.level());
+  EXPECT_EQ(expected_option.option(), option_details->name_.option());
+  EXPECT_EQ(Socket::Type::Stream,
+            dynamic_pointer_cast<const SocketOptionImpl>(socket_options->at(0))->socketType());
+#if defined(__linux__)
+  // The program loads the receiving CPU and returns it modulo the number of sockets.
+  ASSERT_EQ(sizeof(sock_fprog), option_details->value_.size());
+  const auto* prog = reinterpret_cast<const sock_fprog*>(option_details->value_.data());
+  ASSERT_EQ(3, prog->len);
+  EXPECT_EQ(static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU), prog->filter[0].k);
+  EXPECT_EQ(BPF_ALU | BPF_MOD | BPF_K, prog->filter[1].code);
+  EXPECT_EQ(4U, prog->filter[1].k);
+  EXPECT_EQ(BPF_RET | BPF_A, prog->filter[2].code);
+#endif
+}
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
@@ -3,6 +3,7 @@
 
 #include "source/common/common/assert.h"
 #include "source/common/router/config_impl.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "test/mocks/server/instance.h"
 #include "test/mocks/stream_info/mocks.h"
@@ -59,7 +60,7 @@ static RouteConfiguration genRouteConfig(benchmark::State& state,
       break;
     }
     case RouteMatch::PathSpecifierCase::kPath: {
-      match->set_prefix(absl::StrCat("/shelves/shelf_", i, "/route_", i));
+      match->set_path(absl::StrCat("/shelves/shelf_", i, "/route_", i));
       break;
     }
     case RouteMatch::PathSpecifierCase::kSafeRegex: {
@@ -197,14 +198,15 @@ static RouteConfiguration genPrefixMatcherTreeRouteConfig(benchmark::State& stat
 
 /**
  * Measure the speed of doing a route match against a route table of varying sizes.
- * Why? Currently, route matching is linear in first-to-win ordering.
+ * Why? Without the route path index, route matching is linear in first-to-win ordering.
  *
  * We construct the first `n - 1` items in the route table so they are not
  * matched by the incoming request. Only the last route will be matched.
  * We then time how long it takes for the request to be matched against the
  * last route.
  */
-static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type) {
+static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type,
+                             bool use_route_index = false) {
   // Setup router for benchmarking.
   Api::ApiPtr api = Api::createApiForTest();
   NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
@@ -212,9 +214,13 @@ static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierC
   ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
 
   // Create router config.
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.route_path_index", use_route_index);
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.route_regex_set", use_route_index);
   std::shared_ptr<ConfigImpl> config =
       *ConfigImpl::create(genRouteConfig(state, match_type), factory_context,
                           ProtobufMessage::getNullValidationVisitor(), true);
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.route_path_index", false);
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.route_regex_set", false);
 
   for (auto _ : state) { // NOLINT
     // Do the actual timing here.
@@ -244,6 +250,20 @@ static void bmRouteTableSizeWithExactPathMatch(benchmark::State& state) {
   bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPath);
 }
 
+/**
+ * Same as bmRouteTableSizeWithPathPrefixMatch, with the route path index enabled.
+ */
+static void bmRouteTableSizeWithPathPrefixMatchIndexed(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPrefix, true);
+}
+
+/**
+ * Same as bmRouteTableSizeWithExactPathMatch, with the route path index enabled.
+ */
+static void bmRouteTableSizeWithExactPathMatchIndexed(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPath, true);
+}
+
 /**
  * Benchmark a route table with regex path matchers in the form of:
  * - /shelves/{shelf_id}/route_1
@@ -256,6 +276,13 @@ static void bmRouteTableSizeWithRegexMatch(benchmark::State& state) {
   bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kSafeRegex);
 }
 
+/**
+ * Same as bmRouteTableSizeWithRegexMatch, with the regex routes compiled into a single RE2::Set.
+ */
+static void bmRouteTableSizeWithRegexMatchIndexed(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kSafeRegex, true);
+}
+
 /**
  * Benchmark matcher tree route matching performance with exact path matchers in the form of:
  * - /shelves/shelf_1/route_1
@@ -315,6 +342,21 @@ BENCHMARK(bmRouteTableSizeWithPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1,
 BENCHMARK(bmRouteTableSizeWithExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithRegexMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 
+// Large tables, in the range of route tables with thousands of routes per virtual host.
+BENCHMARK(bmRouteTableSizeWithPathPrefixMatch)->Arg(5000)->Arg(20000);
+BENCHMARK(bmRouteTableSizeWithPathPrefixMatchIndexed)
+    ->RangeMultiplier(2)
+    ->Ranges({{1, 2 << 13}})
+    ->Arg(5000)
+    ->Arg(20000);
+BENCHMARK(bmRouteTableSizeWithExactPathMatch)->Arg(5000)->Arg(20000);
+BENCHMARK(bmRouteTableSizeWithExactPathMatchIndexed)
+    ->RangeMultiplier(2)
+    ->Ranges({{1, 2 << 13}})
+    ->Arg(5000)
+    ->Arg(20000);
+BENCHMARK(bmRouteTableSizeWithRegexMatchIndexed)->RangeMultiplier(2)->Ranges({{1, 2 << 10}});
+
 BENCHMARK(bmRouteTableSizeWithExactMatcherTree)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithPrefixMatcherTree)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 
@@ -11662,6 +11662,95 @@ virtual_hosts:
   }
 }
 
+// The route path index and the regex set must select the same route as the linear walk over the
+// route list.
+TEST_F(RouteMatcherTest, RoutePathIndex) {
+  const std::string yaml = R"EOF(
+ignore_path_parameters_in_path_matching: true
+virtual_hosts:
+- name: www
+  domains: ["*"]
+  routes:
+  - match:
+      prefix: "/api/v2/"
+      headers:
+      - name: x-canary
+        present_match: true
+    route:
+      cluster: canary
+  - match:
+      safe_regex:
+        regex: "^/api/v[0-9]+/users$"
+    route:
+      cluster: regex
+  - match:
+      path: "/api/v1/users"
+    route:
+      cluster: exact
+  - match:
+      prefix: "/API/"
+      case_sensitive: false
+    route:
+      cluster: case_insensitive
+  - match:
+      prefix: "/api/v1/"
+    route:
+      cluster: v1
+  - match:
+      path: "/health"
+    route:
+      cluster: health
+  - match:
+      prefix: "/"
+    route:
+      cluster: default
+  )EOF";
+
+  factory_context_.cluster_manager_.initializeClusters(
+      {"canary", "regex", "exact", "case_insensitive", "v1", "health", "default"}, {});
+
+  TestConfigImpl linear_config(parseRouteConfigurationFromYaml(yaml), factory_context_, true,
+                               creation_status_);
+  mergeValues({{"envoy.reloadable_features.route_path_index", "true"}});
+  TestConfigImpl indexed_config(parseRouteConfigurationFromYaml(yaml), factory_context_, true,
+                                creation_status_);
+  mergeValues({{"envoy.reloadable_features.route_regex_set", "true"}});
+  TestConfigImpl regex_set_config(parseRouteConfigurationFromYaml(yaml), factory_context_, true,
+                                  creation_status_);
+  mergeValues({{"envoy.reloadable_features.route_path_index", "false"}});
+  TestConfigImpl regex_set_only_config(parseRouteConfigurationFromYaml(yaml), factory_context_,
+                                       true, creation_status_);
+
+  const std::vector<std::pair<std::string, std::string>> cases = {
+      {"/api/v1/users", "regex"},
+      {"/api/v1/users?id=1", "regex"},
+      {"/api/v1/users/1", "case_insensitive"},
+      {"/api/v22/users", "regex"},
+      {"/api/vx/users", "case_insensitive"},
+      {"/api/v2/things", "case_insensitive"},
+      {"/Api/v1/things", "case_insensitive"},
+      {"/health", "health"},
+      {"/health?full=true", "health"},
+      {"/health;param", "health"},
+      {"/health#fragment", "health"},
+      {"/healthz", "default"},
+      {"/", "default"},
+  };
+  for (const auto& [path, cluster] : cases) {
+    Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", path, "GET");
+    EXPECT_EQ(cluster, linear_config.route(headers, 0)->routeEntry()->clusterName()) << path;
+    EXPECT_EQ(cluster, indexed_config.route(headers, 0)->routeEntry()->clusterName()) << path;
+    EXPECT_EQ(cluster, regex_set_config.route(headers, 0)->routeEntry()->clusterName()) << path;
+    EXPECT_EQ(cluster, regex_set_only_config.route(headers, 0)->routeEntry()->clusterName())
+        << path;
+  }
+
+  Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v2/things", "GET");
+  headers.addCopy("x-canary", "1");
+  EXPECT_EQ("canary", indexed_config.route(headers, 0)->routeEntry()->clusterName());
+  EXPECT_EQ("canary", regex_set_config.route(headers, 0)->routeEntry()->clusterName());
+}
+
 } // namespace
 } // namespace Router
 } // namespace Envoy
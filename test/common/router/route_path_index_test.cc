@@ -0,0 +1,152 @@
+#include "source/common/router/route_path_index.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+RoutePathIndex::Candidates lookup(const RoutePathIndex& index, absl::string_view path) {
+  RoutePathIndex::Candidates candidates;
+  index.candidates(path, candidates);
+  return candidates;
+}
+
+TEST(RoutePathIndexTest, Empty) {
+  RoutePathIndex index;
+  EXPECT_THAT(lookup(index, "/foo"), IsEmpty());
+  EXPECT_EQ(1U, index.nodeCount());
+}
+
+TEST(RoutePathIndexTest, PrefixAndExact) {
+  RoutePathIndex index;
+  index.addPrefix("/foo/", 0);
+  index.addExact("/foo", 1);
+  index.addPrefix("/foo/bar", 2);
+  index.addExact("/foo/bar", 3);
+  index.addPrefix("/", 4);
+
+  EXPECT_THAT(lookup(index, "/foo"), ElementsAre(1, 4));
+  EXPECT_THAT(lookup(index, "/foo/"), ElementsAre(0, 4));
+  EXPECT_THAT(lookup(index, "/foo/bar"), ElementsAre(0, 2, 3, 4));
+  EXPECT_THAT(lookup(index, "/foo/barbaz"), ElementsAre(0, 2, 4));
+  EXPECT_THAT(lookup(index, "/fo"), ElementsAre(4));
+  EXPECT_THAT(lookup(index, "/other"), ElementsAre(4));
+  EXPECT_THAT(lookup(index, ""), IsEmpty());
+}
+
+TEST(RoutePathIndexTest, EmptyPrefixMatchesEverything) {
+  RoutePathIndex index;
+  index.addExact("/a", 0);
+  index.addPrefix("", 1);
+
+  EXPECT_THAT(lookup(index, "/a"), ElementsAre(0, 1));
+  EXPECT_THAT(lookup(index, ""), ElementsAre(1));
+  EXPECT_THAT(lookup(index, "x"), ElementsAre(1));
+}
+
+// Unindexed routes are candidates for every path and keep their place in route order.
+TEST(RoutePathIndexTest, UnindexedRoutesKeepOrder) {
+  RoutePathIndex index;
+  index.addPrefix("/api", 0);
+  index.addUnindexed(1);
+  index.addExact("/api/v1", 2);
+  index.addUnindexed(3);
+  index.addPrefix("/api/", 4);
+
+  EXPECT_THAT(lookup(index, "/api/v1"), ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(lookup(index, "/api/v2"), ElementsAre(0, 1, 3, 4));
+  EXPECT_THAT(lookup(index, "/web"), ElementsAre(1, 3));
+}
+
+TEST(RoutePathIndexTest, DuplicateKeys) {
+  RoutePathIndex index;
+  index.addPrefix("/a", 0);
+  index.addPrefix("/a", 1);
+  index.addExact("/a", 2);
+  index.addExact("/a", 3);
+
+  EXPECT_THAT(lookup(index, "/a"), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(lookup(index, "/ab"), ElementsAre(0, 1));
+}
+
+// Inserting keys that share part of an existing edge splits the edge.
+TEST(RoutePathIndexTest, EdgeSplitting) {
+  RoutePathIndex index;
+  index.addPrefix("/shelves/shelf_10/", 0);
+  EXPECT_EQ(2U, index.nodeCount());
+  index.addPrefix("/shelves/shelf_11/", 1);
+  EXPECT_EQ(4U, index.nodeCount());
+  index.addPrefix("/shelves/", 2);
+  EXPECT_EQ(5U, index.nodeCount());
+  index.addPrefix("/shelves/shelf_1", 3);
+  EXPECT_EQ(5U, index.nodeCount());
+
+  EXPECT_THAT(lookup(index, "/shelves/shelf_10/route"), ElementsAre(0, 2, 3));
+  EXPECT_THAT(lookup(index, "/shelves/shelf_11/route"), ElementsAre(1, 2, 3));
+  EXPECT_THAT(lookup(index, "/shelves/shelf_12/route"), ElementsAre(2, 3));
+  EXPECT_THAT(lookup(index, "/shelves/shelf_2/route"), ElementsAre(2));
+  EXPECT_THAT(lookup(index, "/shelves"), IsEmpty());
+}
+
+TEST(RoutePathIndexTest, LargeTable) {
+  RoutePathIndex index;
+  for (uint32_t i = 0; i < 5000; i++) {
+    index.addPrefix(absl::StrCat("/shelves/shelf_", i, "/"), i);
+  }
+  index.addPrefix("/", 5000);
+
+  EXPECT_THAT(lookup(index, "/shelves/shelf_4999/route_1"), ElementsAre(4999, 5000));
+  EXPECT_THAT(lookup(index, "/shelves/shelf_5000/route_1"), ElementsAre(5000));
+}
+
+TEST(RoutePathIndexTest, RegexSet) {
+  RoutePathIndex index;
+  EXPECT_TRUE(index.addRegex("/shelves/[^/]+/route_1", 0));
+  index.addPrefix("/shelves/", 1);
+  EXPECT_TRUE(index.addRegex("/shelves/shelf_[0-9]+/.*", 2));
+  index.addUnindexed(3);
+  EXPECT_TRUE(index.addRegex("/other", 4));
+  index.finalize();
+  EXPECT_EQ(3U, index.regexSetSize());
+
+  EXPECT_THAT(lookup(index, "/shelves/shelf_1/route_1"), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(lookup(index, "/shelves/shelf_1/route_2"), ElementsAre(1, 2, 3));
+  // Patterns are anchored at both ends, like the route matchers.
+  EXPECT_THAT(lookup(index, "/shelves/shelf_1/route_10"), ElementsAre(1, 2, 3));
+  EXPECT_THAT(lookup(index, "/other"), ElementsAre(3, 4));
+  EXPECT_THAT(lookup(index, "/other/"), ElementsAre(3));
+}
+
+TEST(RoutePathIndexTest, InvalidRegexIsNotAdded) {
+  RoutePathIndex index;
+  EXPECT_FALSE(index.addRegex("(", 0));
+  index.addUnindexed(0);
+  EXPECT_TRUE(index.addRegex("/a", 1));
+  index.finalize();
+  EXPECT_EQ(1U, index.regexSetSize());
+
+  EXPECT_THAT(lookup(index, "/a"), ElementsAre(0, 1));
+  EXPECT_THAT(lookup(index, "/b"), ElementsAre(0));
+}
+
+TEST(RoutePathIndexTest, ManyRegexes) {
+  RoutePathIndex index;
+  for (uint32_t i = 0; i < 500; i++) {
+    EXPECT_TRUE(index.addRegex(absl::StrCat("/shelves/[^/]+/route_", i), i));
+  }
+  index.finalize();
+  EXPECT_EQ(500U, index.regexSetSize());
+
+  EXPECT_THAT(lookup(index, "/shelves/shelf_7/route_499"), ElementsAre(499));
+  EXPECT_THAT(lookup(index, "/shelves/shelf_7/route_500"), IsEmpty());
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
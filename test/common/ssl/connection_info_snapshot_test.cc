@@ -0,0 +1,117 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/ssl/connection_info_snapshot.h"
+
+#include "test/mocks/ssl/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Ssl {
+namespace {
+
+TEST(ConnectionInfoSnapshotTest, CopiesAllValues) {
+  const std::string digest = "digest";
+  const std::string serial = "serial";
+  const std::string issuer = "CN=issuer";
+  const std::string subject = "CN=subject,O=org";
+  const std::string local_subject = "CN=local";
+  const std::string pem = "pem";
+  const std::string pem_chain = "pem-chain";
+  const std::string session_id = "session";
+  const std::string tls_version = "TLSv1.3";
+  const std::string alpn = "h2";
+  const std::string sni = "example.com";
+  const std::vector<std::string> sans{"a", "b"};
+  const std::vector<std::string> no_sans;
+  const ParsedX509Name parsed_subject{"subject", {"org"}};
+  const SystemTime valid_from{std::chrono::seconds(1)};
+  const SystemTime expiration{std::chrono::seconds(2)};
+
+  auto info = std::make_unique<NiceMock<MockConnectionInfo>>();
+  ON_CALL(*info, peerCertificatePresented()).WillByDefault(Return(true));
+  ON_CALL(*info, peerCertificateValidated()).WillByDefault(Return(true));
+  ON_CALL(*info, sha256PeerCertificateDigest()).WillByDefault(ReturnRef(digest));
+  ON_CALL(*info, sha1PeerCertificateDigest()).WillByDefault(ReturnRef(digest));
+  ON_CALL(*info, serialNumberPeerCertificate()).WillByDefault(ReturnRef(serial));
+  ON_CALL(*info, issuerPeerCertificate()).WillByDefault(ReturnRef(issuer));
+  ON_CALL(*info, subjectPeerCertificate()).WillByDefault(ReturnRef(subject));
+  ON_CALL(*info, parsedSubjectPeerCertificate())
+      .WillByDefault(Return(ParsedX509NameOptConstRef(parsed_subject)));
+  ON_CALL(*info, subjectLocalCertificate()).WillByDefault(ReturnRef(local_subject));
+  ON_CALL(*info, urlEncodedPemEncodedPeerCertificate()).WillByDefault(ReturnRef(pem));
+  ON_CALL(*info, urlEncodedPemEncodedPeerCertificateChain()).WillByDefault(ReturnRef(pem_chain));
+  ON_CALL(*info, dnsSansPeerCertificate()).WillByDefault(Return(sans));
+  ON_CALL(*info, uriSanLocalCertificate()).WillByDefault(Return(no_sans));
+  ON_CALL(*info, validFromPeerCertificate()).WillByDefault(Return(valid_from));
+  ON_CALL(*info, expirationPeerCertificate()).WillByDefault(Return(expiration));
+  ON_CALL(*info, sessionId()).WillByDefault(ReturnRef(session_id));
+  ON_CALL(*info, ciphersuiteId()).WillByDefault(Return(0x1301));
+  ON_CALL(*info, ciphersuiteString()).WillByDefault(Return("TLS_AES_128_GCM_SHA256"));
+  ON_CALL(*info, tlsVersion()).WillByDefault(ReturnRef(tls_version));
+  ON_CALL(*info, alpn()).WillByDefault(ReturnRef(alpn));
+  ON_CALL(*info, sni()).WillByDefault(ReturnRef(sni));
+
+  const ConnectionInfoSnapshot snapshot(*info);
+  // The snapshot doesn't refer to the connection's info.
+  info.reset();
+
+  EXPECT_TRUE(snapshot.peerCertificatePresented());
+  EXPECT_TRUE(snapshot.peerCertificateValidated());
+  EXPECT_EQ(digest, snapshot.sha256PeerCertificateDigest());
+  EXPECT_EQ(digest, snapshot.sha1PeerCertificateDigest());
+  EXPECT_EQ(serial, snapshot.serialNumberPeerCertificate());
+  EXPECT_EQ(issuer, snapshot.issuerPeerCertificate());
+  EXPECT_EQ(subject, snapshot.subjectPeerCertificate());
+  ASSERT_TRUE(snapshot.parsedSubjectPeerCertificate().has_value());
+  EXPECT_EQ("subject", snapshot.parsedSubjectPeerCertificate()->commonName_);
+  EXPECT_THAT(snapshot.parsedSubjectPeerCertificate()->organizationName_,
+              testing::ElementsAre("org"));
+  EXPECT_EQ(local_subject, snapshot.subjectLocalCertificate());
+  EXPECT_EQ(pem, snapshot.urlEncodedPemEncodedPeerCertificate());
+  EXPECT_EQ(pem_chain, snapshot.urlEncodedPemEncodedPeerCertificateChain());
+  EXPECT_THAT(snapshot.dnsSansPeerCertificate(), testing::ElementsAre("a", "b"));
+  EXPECT_TRUE(snapshot.uriSanLocalCertificate().empty());
+  EXPECT_EQ(valid_from, snapshot.validFromPeerCertificate());
+  EXPECT_EQ(expiration, snapshot.expirationPeerCertificate());
+  EXPECT_EQ(session_id, snapshot.sessionId());
+  EXPECT_EQ(0x1301, snapshot.ciphersuiteId());
+  EXPECT_EQ("TLS_AES_128_GCM_SHA256", snapshot.ciphersuiteString());
+  EXPECT_EQ(tls_version, snapshot.tlsVersion());
+  EXPECT_EQ(alpn, snapshot.alpn());
+  EXPECT_EQ(sni, snapshot.sni());
+}
+
+TEST(ConnectionInfoSnapshotTest, NoPeerCertificate) {
+  const std::string empty;
+  NiceMock<MockConnectionInfo> info;
+  ON_CALL(info, sha256PeerCertificateDigest()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, sha1PeerCertificateDigest()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, serialNumberPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, issuerPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, subjectPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, subjectLocalCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, urlEncodedPemEncodedPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, urlEncodedPemEncodedPeerCertificateChain()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, sessionId()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, tlsVersion()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, alpn()).WillByDefault(ReturnRef(empty));
+  ON_CALL(info, sni()).WillByDefault(ReturnRef(empty));
+
+  const ConnectionInfoSnapshot snapshot(info);
+  EXPECT_FALSE(snapshot.peerCertificatePresented());
+  EXPECT_FALSE(snapshot.parsedSubjectPeerCertificate().has_value());
+  EXPECT_FALSE(snapshot.validFromPeerCertificate().has_value());
+  EXPECT_TRUE(snapshot.sha256PeerCertificateChainDigests().empty());
+}
+
+} // namespace
+} // namespace Ssl
+} // namespace Envoy
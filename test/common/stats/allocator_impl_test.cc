@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -626,6 +627,134 @@ TEST_F(AllocatorImplTest, ForEachSinkedTextReadout) {
   EXPECT_EQ(num_iterations, 0);
 }
 
+TEST_F(AllocatorImplTest, ForEachChangedSinkedCounter) {
+  std::vector<CounterSharedPtr> counters;
+  for (size_t idx = 0; idx < 4; ++idx) {
+    counters.emplace_back(
+        alloc_.makeCounter(makeStat(absl::StrCat("counter.", idx)), StatName(), {}));
+  }
+  auto changed_counters = [this]() {
+    std::vector<std::string> names;
+    alloc_.forEachChangedSinkedCounter(
+        nullptr, [&names](Counter& counter) { names.push_back(counter.name()); });
+    return names;
+  };
+
+  // Without tracking, all counters are visited.
+  counters[0]->inc();
+  EXPECT_EQ(4, changed_counters().size());
+
+  // The first flush after tracking starts visits all counters.
+  alloc_.trackChangedStats();
+  EXPECT_EQ(4, changed_counters().size());
+  EXPECT_TRUE(changed_counters().empty());
+
+  counters[1]->inc();
+  counters[1]->add(5);
+  counters[3]->inc();
+  EXPECT_THAT(changed_counters(), testing::UnorderedElementsAre("counter.1", "counter.3"));
+  EXPECT_TRUE(changed_counters().empty());
+
+  // Counters changed again after a flush are visited again.
+  counters[1]->inc();
+  EXPECT_THAT(changed_counters(), testing::ElementsAre("counter.1"));
+
+  // Released counters are no longer visited.
+  counters[2]->inc();
+  counters[2].reset();
+  EXPECT_TRUE(changed_counters().empty());
+}
+
+TEST_F(AllocatorImplTest, ForEachChangedSinkedGauge) {
+  GaugeSharedPtr gauge =
+      alloc_.makeGauge(makeStat("gauge"), StatName(), {}, Gauge::ImportMode::Accumulate);
+  GaugeSharedPtr hidden_gauge =
+      alloc_.makeGauge(makeStat("hidden"), StatName(), {}, Gauge::ImportMode::HiddenAccumulate);
+  auto changed_gauges = [this]() {
+    std::vector<std::string> names;
+    alloc_.forEachChangedSinkedGauge(nullptr,
+                                     [&names](Gauge& gauge) { names.push_back(gauge.name()); });
+    return names;
+  };
+
+  alloc_.trackChangedStats();
+  EXPECT_THAT(changed_gauges(), testing::ElementsAre("gauge"));
+  EXPECT_TRUE(changed_gauges().empty());
+
+  gauge->set(5);
+  hidden_gauge->set(5);
+  EXPECT_THAT(changed_gauges(), testing::ElementsAre("gauge"));
+
+  gauge->sub(1);
+  EXPECT_THAT(changed_gauges(), testing::ElementsAre("gauge"));
+  gauge->setParentValue(2);
+  EXPECT_THAT(changed_gauges(), testing::ElementsAre("gauge"));
+  EXPECT_TRUE(changed_gauges().empty());
+}
+
+TEST_F(AllocatorImplTest, ForEachChangedSinkedCounterPredicate) {
+  std::unique_ptr<TestUtil::TestSinkPredicates> moved_sink_predicates =
+      std::make_unique<TestUtil::TestSinkPredicates>();
+  TestUtil::TestSinkPredicates* sink_predicates = moved_sink_predicates.get();
+  alloc_.setSinkPredicates(std::move(moved_sink_predicates));
+
+  StatName sinked_name = makeStat("sinked");
+  sink_predicates->add(sinked_name);
+  CounterSharedPtr sinked = alloc_.makeCounter(sinked_name, StatName(), {});
+  CounterSharedPtr unsinked = alloc_.makeCounter(makeStat("unsinked"), StatName(), {});
+  size_t num_counters = 0;
+  std::vector<std::string> names;
+  auto flush = [&]() {
+    names.clear();
+    alloc_.forEachChangedSinkedCounter(
+        [&num_counters](std::size_t size) { num_counters = size; },
+        [&names](Counter& counter) { names.push_back(counter.name()); });
+  };
+
+  alloc_.trackChangedStats();
+  flush();
+  EXPECT_EQ(1, num_counters);
+  EXPECT_THAT(names, testing::ElementsAre("sinked"));
+
+  sinked->inc();
+  unsinked->inc();
+  flush();
+  EXPECT_EQ(1, num_counters);
+  EXPECT_THAT(names, testing::ElementsAre("sinked"));
+
+  unsinked->inc();
+  flush();
+  EXPECT_EQ(0, num_counters);
+  EXPECT_TRUE(names.empty());
+}
+
+// Increments racing with flushes are all reported, in the flush that follows them at the latest.
+TEST_F(AllocatorImplTest, ChangedCounterRace) {
+  constexpr uint64_t NumIncrements = 100000;
+  CounterSharedPtr counter = alloc_.makeCounter(makeStat("counter"), StatName(), {});
+  alloc_.trackChangedStats();
+  std::atomic<bool> done{false};
+
+  Thread::ThreadPtr thread = Thread::threadFactoryForTest().createThread([&]() {
+    for (uint64_t i = 0; i < NumIncrements; ++i) {
+      counter->inc();
+    }
+    done = true;
+  });
+
+  uint64_t total = 0;
+  auto flush = [&]() {
+    alloc_.forEachChangedSinkedCounter(nullptr,
+                                       [&total](Counter& counter) { total += counter.latch(); });
+  };
+  while (!done) {
+    flush();
+  }
+  thread->join();
+  flush();
+  EXPECT_EQ(NumIncrements, total);
+}
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "source/common/stats/log_linear_histogram.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+class HistPtr {
+public:
+  HistPtr() : histogram_(hist_alloc()) {}
+  ~HistPtr() { hist_free(histogram_); }
+  histogram_t* get() { return histogram_; }
+
+private:
+  histogram_t* histogram_;
+};
+
+TEST(LogLinearHistogramTest, BucketPrecision) {
+  for (uint32_t bits = LogLinearHistogram::MinSignificantBits;
+       bits <= LogLinearHistogram::MaxSignificantBits; bits++) {
+    LogLinearHistogram histogram(bits);
+    EXPECT_EQ(bits, histogram.significantBits());
+    // Small values are kept exactly.
+    for (uint64_t value = 0; value < (1U << bits); value++) {
+      EXPECT_EQ(value, histogram.bucketValue(value));
+    }
+    const double max_error = 1.0 / (1U << bits);
+    for (uint64_t value = 1U << bits; value < (uint64_t(1) << 40); value = value * 3 / 2 + 1) {
+      const double error =
+          std::abs(static_cast<double>(histogram.bucketValue(value)) - value) / value;
+      EXPECT_LE(error, max_error) << value;
+    }
+    EXPECT_GT(histogram.bucketValue(UINT64_MAX), UINT64_MAX - (UINT64_MAX >> bits));
+  }
+}
+
+TEST(LogLinearHistogramTest, PrecisionIsClamped) {
+  EXPECT_EQ(LogLinearHistogram::MinSignificantBits, LogLinearHistogram(0).significantBits());
+  EXPECT_EQ(LogLinearHistogram::MaxSignificantBits, LogLinearHistogram(20).significantBits());
+}
+
+TEST(LogLinearHistogramTest, MergesIntervals) {
+  LogLinearHistogram histogram(LogLinearHistogram::DefaultSignificantBits);
+  std::vector<LogLinearHistogram*> histograms{&histogram};
+  for (uint64_t value = 0; value < 1000; value++) {
+    histogram.recordValue(value);
+  }
+
+  HistPtr first;
+  LogLinearHistogram::mergeIntervals(histograms, first.get());
+  EXPECT_EQ(1000U, hist_sample_count(first.get()));
+
+  // Values are only merged once.
+  HistPtr empty;
+  LogLinearHistogram::mergeIntervals(histograms, empty.get());
+  EXPECT_EQ(0U, hist_sample_count(empty.get()));
+
+  histogram.recordValue(5);
+  histogram.recordValue(1000000);
+  HistPtr second;
+  LogLinearHistogram::mergeIntervals(histograms, second.get());
+  EXPECT_EQ(2U, hist_sample_count(second.get()));
+}
+
+TEST(LogLinearHistogramTest, MergesMultipleHistograms) {
+  LogLinearHistogram a(4);
+  LogLinearHistogram b(4);
+  LogLinearHistogram c(4);
+  std::vector<LogLinearHistogram*> histograms{&a, &b, &c};
+  for (int i = 0; i < 10; i++) {
+    a.recordValue(100);
+    b.recordValue(100);
+  }
+  b.recordValue(3);
+
+  HistPtr target;
+  LogLinearHistogram::mergeIntervals(histograms, target.get());
+  EXPECT_EQ(21U, hist_sample_count(target.get()));
+  EXPECT_EQ(1U, hist_approx_count_below(target.get(), 10));
+}
+
+// Values recorded on one thread while another thread merges are all merged exactly once.
+TEST(LogLinearHistogramTest, ConcurrentRecordAndMerge) {
+  constexpr uint64_t NumValues = 200000;
+  LogLinearHistogram histogram(LogLinearHistogram::DefaultSignificantBits);
+  std::vector<LogLinearHistogram*> histograms{&histogram};
+  std::atomic<bool> done{false};
+
+  std::thread recorder([&]() {
+    for (uint64_t value = 0; value < NumValues; value++) {
+      histogram.recordValue(value);
+    }
+    done = true;
+  });
+
+  HistPtr target;
+  while (!done) {
+    LogLinearHistogram::mergeIntervals(histograms, target.get());
+  }
+  recorder.join();
+  LogLinearHistogram::mergeIntervals(histograms, target.get());
+  EXPECT_EQ(NumValues, hist_sample_count(target.get()));
+}
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
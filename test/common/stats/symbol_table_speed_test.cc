@@ -13,6 +13,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -63,6 +64,50 @@ static void bmCreateRace(benchmark::State& state) {
 }
 BENCHMARK(bmCreateRace)->Unit(::benchmark::kMillisecond);
 
+// Encodes and frees names whose tokens are already in the table from a varying
+// number of threads, as workers do when they look up stats by dynamic name. The
+// names share few tokens, so threads mostly touch different symbol table shards.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmEncodeContention(benchmark::State& state) {
+  const uint32_t num_threads = state.range(0);
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  Envoy::Stats::SymbolTableImpl table;
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    names.push_back(absl::StrCat("cluster.cluster_", i, ".upstream_rq_", i % 7, "xx"));
+  }
+  Envoy::Stats::StatNamePool pool(table);
+  for (const std::string& name : names) {
+    pool.add(name);
+  }
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    std::vector<Envoy::Thread::ThreadPtr> threads;
+    threads.reserve(num_threads);
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads.push_back(thread_factory.createThread([&names, &table, i]() {
+        for (uint32_t count = 0; count < 100 * 1000; ++count) {
+          Envoy::Stats::StatNameManagedStorage storage(names[(count + i * 131) % names.size()],
+                                                       table);
+          benchmark::DoNotOptimize(storage.statName());
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread->join();
+    }
+  }
+}
+BENCHMARK(bmEncodeContention)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Unit(::benchmark::kMillisecond)
+    ->UseRealTime();
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void bmJoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
@@ -27,6 +27,7 @@
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/logging.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "absl/strings/str_split.h"
@@ -1768,6 +1769,48 @@ TEST_F(HistogramTest, BasicHistogramMergeSummary) {
             name_histogram_map["h1"]->cumulativeStatistics().bucketSummary());
 }
 
+// Values below 2^significant_bits are kept exactly by the log-linear worker histograms, so the
+// merged statistics match those of the circllhist worker histograms.
+TEST_F(HistogramTest, LogLinearHistogramMerge) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.log_linear_tls_histograms", "true"}});
+
+  Histogram& h1 = scope_.histogramFromString("h1", Histogram::Unit::Unspecified);
+  Histogram& h2 = scope_.histogramFromString("h2", Histogram::Unit::Unspecified);
+
+  expectCallAndAccumulate(h1, 1);
+  expectCallAndAccumulate(h1, 13);
+  expectCallAndAccumulate(h2, 0);
+  expectCallAndAccumulate(h2, 31);
+  EXPECT_EQ(2, validateMerge());
+
+  expectCallAndAccumulate(h1, 13);
+  expectCallAndAccumulate(h2, 7);
+  EXPECT_EQ(2, validateMerge());
+
+  // Nothing recorded since the previous merge.
+  EXPECT_EQ(2, validateMerge());
+}
+
+// With log-linear worker histograms, a merge does not run on the worker threads. Circllhist
+// histograms created before the runtime guard was enabled and recorded on the main thread are
+// still merged.
+TEST_F(HistogramTest, LogLinearHistogramMergeSkipsWorkers) {
+  Histogram& h1 = scope_.histogramFromString("h1", Histogram::Unit::Unspecified);
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.log_linear_tls_histograms", "true"}});
+  Histogram& h2 = scope_.histogramFromString("h2", Histogram::Unit::Unspecified);
+
+  EXPECT_CALL(tls_, runOnAllThreads(_, _)).Times(0);
+  expectCallAndAccumulate(h1, 5);
+  expectCallAndAccumulate(h2, 7);
+  EXPECT_EQ(2, validateMerge());
+
+  expectCallAndAccumulate(h1, 9);
+  EXPECT_EQ(2, validateMerge());
+  testing::Mock::VerifyAndClearExpectations(&tls_);
+}
+
 TEST_F(HistogramTest, BasicHistogramUsed) {
   ScopeSharedPtr scope1 = store_->createScope("scope1.");
 
@@ -5,13 +5,17 @@
 #include "envoy/config/config_validator.h"
 #include "envoy/config/core/v3/base.pb.h"
 
+#include "source/common/common/hash.h"
 #include "source/common/config/null_grpc_mux_impl.h"
 #include "source/common/config/xds_resource.h"
+#include "source/common/http/shared_conn_pool.h"
 #include "source/common/network/raw_buffer_socket.h"
 #include "source/common/network/resolver_impl.h"
+#include "source/common/network/transport_socket_options_impl.h"
 #include "source/common/router/context_impl.h"
 #include "source/extensions/transport_sockets/raw_buffer/config.h"
 
+#include "test/common/http/common.h"
 #include "test/common/upstream/cluster_manager_impl_test_common.h"
 #include "test/common/upstream/test_cluster_manager.h"
 #include "test/config/v2_link_hacks.h"
@@ -2223,6 +2227,260 @@ TEST_F(ClusterManagerImplTest, ConnectionPoolPerDownstreamConnection) {
                   ResourcePriority::Default, Http::Protocol::Http11, &lb_context)));
 }
 
+// Tests the choice of the HTTP connection pools which hand their streams over to the pools of
+// other workers. The thread local cluster manager of the tests is one of the workers, and the
+// other ones are fake workers, which take over streams with the clusters of that same cluster
+// manager.
+class ClusterManagerSharedConnPoolTest : public ClusterManagerImplTest {
+public:
+  ~ClusterManagerSharedConnPoolTest() override {
+    // The pools which hand streams over refer to the dispatchers of the fake workers.
+    cluster_manager_.reset();
+  }
+
+  // A cluster with a single host, whose HTTP/2 connection pools are shared across workers.
+  envoy::config::cluster::v3::Cluster
+  sharedCluster(uint32_t port, absl::string_view http_config = "http2_protocol_options: {}",
+                absl::string_view cluster_options = "") {
+    return parseClusterFromV3Yaml(fmt::format(R"EOF(
+    name: shared
+    connect_timeout: 0.250s
+    type: STATIC
+    lb_policy: ROUND_ROBIN
+    {}
+    typed_extension_protocol_options:
+      envoy.extensions.upstreams.http.v3.HttpProtocolOptions:
+        "@type": type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions
+        upstream_http_protocol_options:
+          shared_connection_pool: {{}}
+        explicit_http_config:
+          {}
+    load_assignment:
+      cluster_name: shared
+      endpoints:
+      - lb_endpoints:
+        - endpoint:
+            address:
+              socket_address:
+                address: 127.0.0.1
+                port_value: {}
+  )EOF",
+                                              cluster_options, http_config, port));
+  }
+
+  void createSharedCluster(absl::string_view http_config = "http2_protocol_options: {}",
+                           absl::string_view cluster_options = "") {
+    createWithBasicStaticCluster();
+    EXPECT_TRUE(*cluster_manager_->addOrUpdateCluster(
+        sharedCluster(11002, http_config, cluster_options), "v1"));
+  }
+
+  HostConstSharedPtr sharedHost() {
+    return cluster_manager_->getThreadLocalCluster("shared")->chooseHost(nullptr).host;
+  }
+
+  // Registers a fake worker, whose posts are queued until runWorkerPosts().
+  Event::Dispatcher& addWorker(const std::string& name) {
+    workers_.push_back(std::make_unique<NiceMock<Event::MockDispatcher>>(name));
+    Event::MockDispatcher& worker = *workers_.back();
+    ON_CALL(worker, post(_)).WillByDefault(Invoke([this](Event::PostCb cb) {
+      worker_posts_.push_back(std::move(cb));
+    }));
+    cluster_manager_->addSharedPoolWorker(worker);
+    return worker;
+  }
+
+  // Registers a second worker, named so that it is the owner of the given host if owns_host is
+  // true, and otherwise hands it over to the worker of the cluster manager, named "test_thread".
+  Event::Dispatcher& addWorkerForHost(const Host& host, bool owns_host) {
+    const bool first_owns_host = HashUtil::xxHash64(host.address()->asStringView()) % 2 == 0;
+    return addWorker(owns_host == first_owns_host ? "a_worker" : "z_worker");
+  }
+
+  void runWorkerPosts() {
+    std::vector<Event::PostCb> posts;
+    posts.swap(worker_posts_);
+    for (Event::PostCb& post : posts) {
+      post();
+    }
+  }
+
+  Http::ConnectionPool::Instance* sharedConnPool(LoadBalancerContext* context) {
+    ThreadLocalCluster* cluster = cluster_manager_->getThreadLocalCluster("shared");
+    return HttpPoolDataPeer::getInstance(cluster->httpConnPool(
+        cluster->chooseHost(context).host, ResourcePriority::Default, Http::Protocol::Http2,
+        context));
+  }
+
+  // Expects the worker of the cluster manager to use a pool of its own.
+  void expectOwnPool(LoadBalancerContext* context) {
+    auto* pool = new NiceMock<Http::ConnectionPool::MockInstance>();
+    EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _, _, _)).WillOnce(Return(pool));
+    EXPECT_EQ(pool, sharedConnPool(context));
+  }
+
+  // Expects the worker of the cluster manager to hand its streams over to the owner of the host.
+  void expectHandedOverPool(LoadBalancerContext* context) {
+    EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _, _, _)).Times(0);
+    EXPECT_NE(nullptr, dynamic_cast<Http::SharedConnPool*>(sharedConnPool(context)));
+  }
+
+  std::vector<std::unique_ptr<NiceMock<Event::MockDispatcher>>> workers_;
+  std::vector<Event::PostCb> worker_posts_;
+};
+
+TEST_F(ClusterManagerSharedConnPoolTest, HostsAreOwnedByTheWorkerTheirAddressHashesTo) {
+  createSharedCluster();
+  HostConstSharedPtr host = sharedHost();
+  Event::Dispatcher& self = factory_.tls_.dispatcher_;
+
+  // There is no other worker to hand over to.
+  EXPECT_EQ(nullptr, cluster_manager_->sharedPoolOwnerDispatcher(self, *host, 1));
+
+  // Sorted by name, the workers are test_thread, worker_1, worker_2 and worker_3.
+  std::vector<Event::Dispatcher*> workers{&self};
+  for (int i = 1; i <= 3; i++) {
+    workers.push_back(&addWorker(absl::StrCat("worker_", i)));
+  }
+  const size_t owner = HashUtil::xxHash64(host->address()->asStringView()) % workers.size();
+  for (size_t i = 0; i < workers.size(); i++) {
+    EXPECT_EQ(i == owner ? nullptr : workers[owner],
+              cluster_manager_->sharedPoolOwnerDispatcher(*workers[i], *host, 1));
+  }
+
+  // The main thread isn't a worker.
+  EXPECT_EQ(nullptr, cluster_manager_->sharedPoolOwnerDispatcher(factory_.dispatcher_, *host, 1));
+
+  // Once the other workers are gone, the remaining one owns all the hosts.
+  for (int i = 1; i <= 3; i++) {
+    cluster_manager_->removeSharedPoolWorker(*workers[i]);
+  }
+  EXPECT_EQ(nullptr, cluster_manager_->sharedPoolOwnerDispatcher(self, *host, 1));
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, WorkersAreSpreadOverTheOwnersOfAHost) {
+  createSharedCluster();
+  HostConstSharedPtr host = sharedHost();
+
+  std::vector<Event::Dispatcher*> workers{&factory_.tls_.dispatcher_};
+  for (int i = 1; i <= 5; i++) {
+    workers.push_back(&addWorker(absl::StrCat("worker_", i)));
+  }
+  const size_t num_workers = workers.size();
+  const size_t first_owner = HashUtil::xxHash64(host->address()->asStringView()) % num_workers;
+
+  // The owners are the two workers starting at the one the address hashes to, and each of the
+  // other workers hands over to the owner picked by its own index.
+  std::map<Event::Dispatcher*, int> workers_by_owner;
+  for (size_t i = 0; i < num_workers; i++) {
+    Event::Dispatcher* owner = cluster_manager_->sharedPoolOwnerDispatcher(*workers[i], *host, 2);
+    if ((i + num_workers - first_owner) % num_workers < 2) {
+      EXPECT_EQ(nullptr, owner);
+    } else {
+      EXPECT_EQ(workers[(first_owner + i % 2) % num_workers], owner);
+      workers_by_owner[owner]++;
+    }
+  }
+  EXPECT_EQ(2, workers_by_owner.size());
+  EXPECT_EQ(2, workers_by_owner[workers[first_owner]]);
+  EXPECT_EQ(2, workers_by_owner[workers[(first_owner + 1) % num_workers]]);
+
+  // With as many owners as workers, none hands over.
+  for (Event::Dispatcher* worker : workers) {
+    EXPECT_EQ(nullptr, cluster_manager_->sharedPoolOwnerDispatcher(*worker, *host, 6));
+    EXPECT_EQ(nullptr, cluster_manager_->sharedPoolOwnerDispatcher(*worker, *host, 100));
+  }
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, StreamsAreHandedOverToTheOwner) {
+  createSharedCluster();
+  addWorkerForHost(*sharedHost(), true);
+  expectHandedOverPool(nullptr);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, OwnerUsesItsOwnPool) {
+  createSharedCluster();
+  addWorkerForHost(*sharedHost(), false);
+  expectOwnPool(nullptr);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, SingleWorkerUsesItsOwnPool) {
+  createSharedCluster();
+  expectOwnPool(nullptr);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, Http1PoolsAreNotShared) {
+  createSharedCluster("http_protocol_options: {}");
+  addWorkerForHost(*sharedHost(), true);
+  expectOwnPool(nullptr);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, PoolsWithSocketOptionsAreNotShared) {
+  createSharedCluster();
+  addWorkerForHost(*sharedHost(), true);
+  NiceMock<MockLoadBalancerContext> context;
+  ON_CALL(context, upstreamSocketOptions())
+      .WillByDefault(Return(Network::SocketOptionFactory::buildIpTransparentOptions()));
+  expectOwnPool(&context);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, PoolsWithTransportSocketOptionsAreNotShared) {
+  createSharedCluster();
+  addWorkerForHost(*sharedHost(), true);
+  NiceMock<MockLoadBalancerContext> context;
+  ON_CALL(context, upstreamTransportSocketOptions())
+      .WillByDefault(
+          Return(std::make_shared<Network::TransportSocketOptionsImpl>("www.example.com")));
+  expectOwnPool(&context);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, PoolsPerDownstreamConnectionAreNotShared) {
+  createSharedCluster("http2_protocol_options: {}",
+                      "connection_pool_per_downstream_connection: true");
+  addWorkerForHost(*sharedHost(), true);
+  NiceMock<MockLoadBalancerContext> context;
+  NiceMock<Network::MockConnection> downstream_connection;
+  Network::Socket::OptionsSharedPtr no_options;
+  ON_CALL(context, downstreamConnection()).WillByDefault(Return(&downstream_connection));
+  ON_CALL(downstream_connection, socketOptions()).WillByDefault(ReturnRef(no_options));
+  expectOwnPool(&context);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, StreamFailsIfTheOwnerRemovedTheCluster) {
+  createSharedCluster();
+  addWorkerForHost(*sharedHost(), true);
+  Http::ConnectionPool::Instance* pool = sharedConnPool(nullptr);
+  ASSERT_NE(nullptr, dynamic_cast<Http::SharedConnPool*>(pool));
+
+  NiceMock<Http::MockResponseDecoder> decoder;
+  Http::ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, pool->newStream(decoder, callbacks, {false, true}));
+
+  // The pool outlives the cluster until its stream is done.
+  EXPECT_TRUE(cluster_manager_->removeCluster("shared"));
+  EXPECT_CALL(callbacks.pool_failure_, ready());
+  runWorkerPosts();
+  EXPECT_EQ(Http::ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks.reason_);
+  EXPECT_EQ("shared connection pool owner unavailable", callbacks.transport_failure_reason_);
+}
+
+TEST_F(ClusterManagerSharedConnPoolTest, StreamFailsIfTheOwnerRemovedTheHost) {
+  createSharedCluster();
+  addWorkerForHost(*sharedHost(), true);
+  Http::ConnectionPool::Instance* pool = sharedConnPool(nullptr);
+  ASSERT_NE(nullptr, dynamic_cast<Http::SharedConnPool*>(pool));
+
+  NiceMock<Http::MockResponseDecoder> decoder;
+  Http::ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, pool->newStream(decoder, callbacks, {false, true}));
+
+  // The host is replaced by another one before the owner takes the stream over.
+  EXPECT_TRUE(*cluster_manager_->addOrUpdateCluster(sharedCluster(11003), "v2"));
+  EXPECT_CALL(callbacks.pool_failure_, ready());
+  runWorkerPosts();
+  EXPECT_EQ("shared connection pool owner unavailable", callbacks.transport_failure_reason_);
+}
+
 #ifdef ENVOY_ENABLE_QUIC
 TEST_F(ClusterManagerImplTest, PassDownNetworkObserverRegistryToConnectionPool) {
   const std::string yaml = R"EOF(
@@ -40,6 +40,11 @@ public:
     ASSERT(data.has_value());
     return dynamic_cast<Http::ConnectionPool::MockInstance*>(data.value().pool_);
   }
+
+  static Http::ConnectionPool::Instance* getInstance(absl::optional<HttpPoolData> data) {
+    ASSERT(data.has_value());
+    return data.value().pool_;
+  }
 };
 
 class TcpPoolDataPeer {
@@ -9,6 +9,11 @@ namespace Upstream {
 
 class EdfSchedulerTest : public testing::Test {
 public:
+  template <typename T, bool Updatable>
+  static size_t queueSize(const EdfScheduler<T, Updatable>& scheduler) {
+    return scheduler.queue_.size();
+  }
+
   template <typename T>
   static void compareEdfSchedulers(EdfScheduler<T>& scheduler1, EdfScheduler<T>& scheduler2) {
     // Compares that the given EdfSchedulers internal queues are equal up
@@ -175,6 +180,162 @@ TEST_F(EdfSchedulerTest, ManyPeekahead) {
   }
 }
 
+// Validate that removed entries are no longer picked or peeked.
+TEST_F(EdfSchedulerTest, Remove) {
+  UpdatableEdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 8;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(1, entries[i]);
+  }
+  EXPECT_EQ(0, *sched.peekAgain([](const double&) { return 1; }));
+
+  EXPECT_TRUE(sched.remove(*entries[0]));
+  EXPECT_TRUE(sched.remove(*entries[3]));
+  EXPECT_FALSE(sched.remove(*entries[3]));
+  EXPECT_EQ(num_entries - 2, sched.size());
+  EXPECT_FALSE(sched.weight(*entries[3]).has_value());
+
+  for (uint32_t rounds = 0; rounds < 3; ++rounds) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+      if (i == 0 || i == 3) {
+        continue;
+      }
+      EXPECT_EQ(i, *sched.pickAndAdd([](const double&) { return 1; }));
+    }
+  }
+}
+
+// Validate that an updated entry is rescheduled with its new weight.
+TEST_F(EdfSchedulerTest, Update) {
+  UpdatableEdfScheduler<uint32_t> sched;
+  auto first_entry = std::make_shared<uint32_t>(0);
+  auto second_entry = std::make_shared<uint32_t>(1);
+  sched.add(1, first_entry);
+  sched.add(1, second_entry);
+  EXPECT_EQ(1, sched.weight(*first_entry).value());
+
+  EXPECT_TRUE(sched.update(3, first_entry));
+  EXPECT_EQ(3, sched.weight(*first_entry).value());
+  EXPECT_EQ(2, sched.size());
+  EXPECT_FALSE(sched.update(3, std::make_shared<uint32_t>(2)));
+
+  // Picks use the weights returned by the calculate_weight callback from now on.
+  auto calculate_weight = [](const uint32_t& entry) { return entry == 0 ? 3 : 1; };
+  uint32_t pick_count[2] = {0, 0};
+  for (uint32_t i = 0; i < 400; ++i) {
+    ++pick_count[*sched.pickAndAdd(calculate_weight)];
+  }
+  EXPECT_EQ(300, pick_count[0]);
+  EXPECT_EQ(100, pick_count[1]);
+}
+
+// Validate that adding an entry that is already scheduled reschedules it instead of scheduling it
+// twice.
+TEST_F(EdfSchedulerTest, AddScheduledEntry) {
+  UpdatableEdfScheduler<uint32_t> sched;
+  auto first_entry = std::make_shared<uint32_t>(0);
+  auto second_entry = std::make_shared<uint32_t>(1);
+  sched.add(1, first_entry);
+  sched.add(1, second_entry);
+  sched.add(2, first_entry);
+  EXPECT_EQ(2, sched.size());
+  EXPECT_EQ(2, sched.weight(*first_entry).value());
+
+  uint32_t pick_count[2] = {0, 0};
+  for (uint32_t i = 0; i < 100; ++i) {
+    ++pick_count[*sched.pickAndAdd([](const double&) { return 1; })];
+  }
+  EXPECT_EQ(50, pick_count[0]);
+  EXPECT_EQ(50, pick_count[1]);
+}
+
+// Validate that removing entries drops the ones that match and the expired ones.
+TEST_F(EdfSchedulerTest, RemoveIf) {
+  UpdatableEdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 8;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(1, entries[i]);
+  }
+  entries[1].reset();
+  sched.removeIf([](const uint32_t& entry) { return entry % 2 == 0; });
+  EXPECT_EQ(3, sched.size());
+
+  for (uint32_t rounds = 0; rounds < 3; ++rounds) {
+    EXPECT_EQ(3, *sched.pickAndAdd([](const double&) { return 1; }));
+    EXPECT_EQ(5, *sched.pickAndAdd([](const double&) { return 1; }));
+    EXPECT_EQ(7, *sched.pickAndAdd([](const double&) { return 1; }));
+  }
+}
+
+// Validate that a removed entry that was peeked is not picked.
+TEST_F(EdfSchedulerTest, RemovedPeekedIsNotPicked) {
+  UpdatableEdfScheduler<uint32_t> sched;
+  auto first_entry = std::make_shared<uint32_t>(0);
+  auto second_entry = std::make_shared<uint32_t>(1);
+  sched.add(2, first_entry);
+  sched.add(1, second_entry);
+  EXPECT_EQ(0, *sched.peekAgain([](const double&) { return 1; }));
+
+  EXPECT_TRUE(sched.remove(*first_entry));
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(1, *sched.pickAndAdd([](const double&) { return 1; }));
+  }
+}
+
+// Validate that the queue does not grow with the number of removed and rescheduled entries.
+TEST_F(EdfSchedulerTest, StaleEntriesAreDropped) {
+  UpdatableEdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 16;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i + 1, entries[i]);
+  }
+  for (uint32_t rounds = 0; rounds < 100; ++rounds) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+      sched.update(rounds % 7 + 1, entries[i]);
+    }
+    EXPECT_TRUE(sched.remove(*entries[rounds % num_entries]));
+    sched.add(1, entries[rounds % num_entries]);
+    EXPECT_LE(queueSize(sched), 2 * num_entries);
+  }
+
+  // All entries have the same weight, apart from the last one added.
+  const uint32_t last = 99 % num_entries;
+  uint32_t pick_count[num_entries] = {};
+  for (uint32_t i = 0; i < 10 * (num_entries - 1) * (99 % 7 + 1) + 10; ++i) {
+    ++pick_count[*sched.pickAndAdd([&entries](const uint32_t& entry) {
+      return entry == *entries[last] ? 1 : 99 % 7 + 1;
+    })];
+  }
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_NEAR(i == last ? 10 : 10 * (99 % 7 + 1), pick_count[i], 1) << i;
+  }
+}
+
+// Validate that keeping track of the entries does not change the schedule.
+TEST_F(EdfSchedulerTest, UpdatablePicksLikePlain) {
+  constexpr uint32_t num_entries = 16;
+  std::vector<std::shared_ptr<uint32_t>> entries;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries.emplace_back(std::make_shared<uint32_t>(i + 1));
+  }
+  auto calculate_weight = [](const uint32_t& entry) { return entry % 5 + 1; };
+  EdfScheduler<uint32_t> sched1 = EdfScheduler<uint32_t>::createWithPicks(entries,
+                                                                          calculate_weight, 17);
+  UpdatableEdfScheduler<uint32_t> sched2 =
+      UpdatableEdfScheduler<uint32_t>::createWithPicks(entries, calculate_weight, 17);
+  for (uint32_t i = 0; i < 10 * num_entries; ++i) {
+    EXPECT_EQ(*sched1.peekAgain(calculate_weight), *sched2.peekAgain(calculate_weight));
+    EXPECT_EQ(*sched1.pickAndAdd(calculate_weight), *sched2.pickAndAdd(calculate_weight));
+    EXPECT_EQ(*sched1.pickAndAdd(calculate_weight), *sched2.pickAndAdd(calculate_weight));
+  }
+}
+
 // Validates that creating a scheduler using the createWithPicks (with 0 picks)
 // is equal to creating an empty scheduler and adding entries one after the other.
 TEST_F(EdfSchedulerTest, SchedulerWithZeroPicksEqualToEmptyWithAddedEntries) {
@@ -2758,6 +2758,11 @@ TEST(OutlierUtility, SRThreshold) {
       DetectorImpl::successRateEjectionThreshold(sum, data, 1.9);
   EXPECT_EQ(90.0, success_rate_nums.success_rate_average_); // average success rate
   EXPECT_EQ(52.0, success_rate_nums.ejection_threshold_);   //  ejection threshold
+
+  const std::vector<double> success_rates = {50, 100, 100, 100, 100};
+  success_rate_nums = DetectorImpl::successRateEjectionThreshold(sum, success_rates, 1.9);
+  EXPECT_EQ(90.0, success_rate_nums.success_rate_average_);
+  EXPECT_EQ(52.0, success_rate_nums.ejection_threshold_);
 }
 
 } // namespace
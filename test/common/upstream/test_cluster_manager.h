@@ -13,6 +13,7 @@
 #include "source/common/api/api_impl.h"
 #include "source/common/config/utility.h"
 #include "source/common/http/context_impl.h"
+#include "source/common/http/shared_conn_pool.h"
 #include "source/common/network/socket_option_factory.h"
 #include "source/common/network/socket_option_impl.h"
 #include "source/common/network/transport_socket_options_impl.h"
@@ -205,6 +206,32 @@ public:
     return ClusterManagerImpl::createAndSwapClusterDiscoveryManager(std::move(thread_name));
   }
 
+  // Registers another worker for shared HTTP connection pools, running the given dispatcher.
+  // Streams it takes over are served by the clusters of the worker that registered first.
+  Http::SharedConnPool::OwnerSharedPtr addSharedPoolWorker(Event::Dispatcher& dispatcher) {
+    std::shared_ptr<SharedPoolWorker> worker;
+    {
+      absl::MutexLock lock(&shared_pool_workers_mutex_);
+      ASSERT(!shared_pool_workers_.empty());
+      worker = shared_pool_workers_.front().worker_.lock();
+    }
+    auto owner = std::make_shared<Http::SharedConnPool::Owner>(dispatcher);
+    ClusterManagerImpl::addSharedPoolWorker(owner, worker);
+    return owner;
+  }
+
+  void removeSharedPoolWorker(Event::Dispatcher& dispatcher) {
+    ClusterManagerImpl::removeSharedPoolWorker(dispatcher);
+  }
+
+  // Returns the dispatcher of the worker that the given worker hands its streams to the host
+  // over to, or nullptr if it doesn't hand them over.
+  Event::Dispatcher* sharedPoolOwnerDispatcher(Event::Dispatcher& dispatcher, const Host& host,
+                                               uint32_t owner_workers) {
+    absl::optional<SharedPoolOwner> owner = sharedPoolOwner(dispatcher, host, owner_workers);
+    return owner.has_value() ? &owner->owner_->dispatcher() : nullptr;
+  }
+
 protected:
   using ClusterManagerImpl::ClusterManagerImpl;
 
@@ -17,6 +17,7 @@
 #include "source/extensions/config_subscription/grpc/grpc_mux_impl.h"
 #include "source/extensions/config_subscription/grpc/grpc_subscription_impl.h"
 #include "source/extensions/config_subscription/grpc/xds_mux/grpc_mux_impl.h"
+#include "source/extensions/load_balancing_policies/round_robin/round_robin_lb.h"
 #include "source/server/transport_socket_config_impl.h"
 
 #include "test/benchmark/main.h"
@@ -118,7 +119,18 @@ public:
   void priorityAndLocalityWeightedHelper(bool ignore_unknown_dynamic_fields, size_t num_hosts,
                                          bool healthy) {
     state_.PauseTiming();
+    auto response = buildResponse(ignore_unknown_dynamic_fields, num_hosts, healthy);
+    state_.ResumeTiming();
+    deliverResponse(std::move(response));
+    ASSERT(cluster_->prioritySet().hostSetsPerPriority()[1]->hostsPerLocality().get()[0].size() ==
+           num_hosts);
+  }
 
+  // Builds an EDS response with num_hosts endpoints in a single locality, starting at the
+  // endpoint with index first_host.
+  std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+  buildResponse(bool ignore_unknown_dynamic_fields, size_t num_hosts, bool healthy,
+                size_t first_host = 0) {
     envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
     cluster_load_assignment.set_cluster_name("fare");
 
@@ -132,8 +144,11 @@ public:
     endpoints->mutable_load_balancing_weight()->set_value(1);
 
     uint32_t port = 1000;
-    for (size_t i = 0; i < num_hosts; ++i) {
+    for (size_t i = first_host; i < first_host + num_hosts; ++i) {
       auto* lb_endpoint = endpoints->add_lb_endpoints();
+      if (weighted_hosts_) {
+        lb_endpoint->mutable_load_balancing_weight()->set_value(1 + i % 3);
+      }
       if (healthy) {
         lb_endpoint->set_health_status(envoy::config::core::v3::HEALTHY);
       } else {
@@ -153,7 +168,11 @@ public:
     response->set_version_info(fmt::format("version-{}", version_++));
     auto* resource = response->mutable_resources()->Add();
     resource->PackFrom(cluster_load_assignment);
-    state_.ResumeTiming();
+    return response;
+  }
+
+  void
+  deliverResponse(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse> response) {
     if (use_unified_mux_) {
       dynamic_cast<Config::XdsMux::GrpcMuxSotw&>(*grpc_mux_)
           .grpcStreamForTest()
@@ -163,10 +182,36 @@ public:
           .grpcStreamForTest()
           .onReceiveMessage(std::move(response));
     }
-    ASSERT(cluster_->prioritySet().hostSetsPerPriority()[1]->hostsPerLocality().get()[0].size() ==
-           num_hosts);
   }
 
+  // Mirrors what ClusterManagerImpl keeps for the cluster on each worker: a priority set that
+  // receives the host set updates of the cluster, and a round robin load balancer on top of it.
+  void addWorkers(uint32_t num_workers) {
+    for (uint32_t i = 0; i < num_workers; ++i) {
+      auto worker = std::make_unique<Worker>();
+      worker->lb_ = std::make_unique<RoundRobinLoadBalancer>(
+          worker->priority_set_, nullptr, lb_stats_, server_context_.runtime_loader_, random_, 50,
+          round_robin_config_, server_context_.timeSource());
+      workers_.push_back(std::move(worker));
+    }
+    worker_update_cb_ = cluster_->prioritySet().addPriorityUpdateCb(
+        [this](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
+          const HostSet& host_set = *cluster_->prioritySet().hostSetsPerPriority()[priority];
+          for (auto& worker : workers_) {
+            worker->priority_set_.updateHosts(
+                priority, HostSetImpl::updateHostsParams(host_set), host_set.localityWeights(),
+                hosts_added, hosts_removed, random_.random(), host_set.weightedPriorityHealth(),
+                host_set.overprovisioningFactor());
+          }
+          return absl::OkStatus();
+        });
+  }
+
+  struct Worker {
+    PrioritySetImpl priority_set_;
+    std::unique_ptr<RoundRobinLoadBalancer> lb_;
+  };
+
   NiceMock<Server::Configuration::MockServerFactoryContext> server_context_;
   Stats::TestUtil::TestStore& stats_ = server_context_.store_;
 
@@ -193,6 +238,12 @@ public:
   Config::GrpcMuxSharedPtr grpc_mux_;
   Config::GrpcSubscriptionImplPtr subscription_;
   NiceMock<AccessLog::MockAccessLogManager> access_log_manager_;
+  bool weighted_hosts_{};
+  ClusterLbStatNames lb_stat_names_{stats_.symbolTable()};
+  ClusterLbStats lb_stats_{lb_stat_names_, scope_};
+  envoy::extensions::load_balancing_policies::round_robin::v3::RoundRobin round_robin_config_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  Common::CallbackHandlePtr worker_update_cb_;
 };
 
 } // namespace Upstream
@@ -245,3 +296,33 @@ static void healthOnlyUpdate(State& state) {
 }
 
 BENCHMARK(healthOnlyUpdate)->Ranges({{1, 100000}, {false, true}})->Unit(benchmark::kMillisecond);
+
+// Replaces one endpoint of a cluster that is shared with a number of workers, each with a round
+// robin load balancer, and measures how long it takes until the update is applied everywhere.
+// With weighted endpoints, the load balancers either rebuild their schedules or update them with
+// the replaced endpoints, depending on the last argument.
+static void workerMembershipUpdate(State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  Envoy::TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.edf_lb_incremental_refresh",
+                               state.range(3) ? "true" : "false"}});
+  const uint32_t endpoints = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const uint32_t num_workers = skipExpensiveBenchmarks() ? 1 : state.range(2);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    state.PauseTiming();
+    Envoy::Upstream::EdsSpeedTest speed_test(state, false);
+    speed_test.weighted_hosts_ = state.range(1);
+    speed_test.addWorkers(num_workers);
+    speed_test.deliverResponse(speed_test.buildResponse(true, endpoints, true));
+    auto response = speed_test.buildResponse(true, endpoints, true, 1);
+    state.ResumeTiming();
+
+    speed_test.deliverResponse(std::move(response));
+  }
+}
+
+BENCHMARK(workerMembershipUpdate)
+    ->Ranges({{1000, 50000}, {false, true}, {1, 16}, {false, true}})
+    ->Unit(benchmark::kMillisecond);
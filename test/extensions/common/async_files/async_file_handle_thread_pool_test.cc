@@ -1,3 +1,5 @@
+#include <sys/mman.h>
+
 #include <future>
 #include <memory>
 #include <string>
@@ -138,6 +140,41 @@ TEST_F(AsyncFileHandleTest, WriteReadClose) {
   close(handle);
 }
 
+TEST_F(AsyncFileHandleTest, ReadMappedReturnsFileContents) {
+  auto handle = createAnonymousFile();
+  absl::StatusOr<size_t> write_status;
+  absl::StatusOr<Buffer::InstancePtr> read_status, short_read_status, past_end_read_status;
+  Buffer::OwnedImpl contents("hello world");
+  ASSERT_OK(handle->write(dispatcher_.get(), contents, 0, [&](absl::StatusOr<size_t> status) {
+    write_status = std::move(status);
+  }));
+  resolveFileActions();
+  EXPECT_THAT(write_status, IsOkAndHolds(11U));
+  ASSERT_OK(handle->readMapped(dispatcher_.get(), 6, 5,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  ASSERT_OK(handle->readMapped(dispatcher_.get(), 8, 10,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 short_read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  ASSERT_OK(handle->readMapped(dispatcher_.get(), 20, 5,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 past_end_read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  close(handle);
+  // The mapped contents outlive the file handle.
+  ASSERT_OK(read_status);
+  EXPECT_THAT(*read_status.value(), BufferStringEqual("world"));
+  ASSERT_OK(short_read_status);
+  EXPECT_THAT(*short_read_status.value(), BufferStringEqual("rld"));
+  ASSERT_OK(past_end_read_status);
+  EXPECT_EQ(past_end_read_status.value()->length(), 0);
+}
+
 TEST_F(AsyncFileHandleTest, LinkCreatesNamedFile) {
   auto handle = createAnonymousFile();
   absl::StatusOr<size_t> write_status;
@@ -493,6 +530,71 @@ TEST_F(AsyncFileHandleWithMockPosixTest, StatFailureReportsError) {
   close(handle);
 }
 
+TEST_F(AsyncFileHandleWithMockPosixTest, ReadMappedUnmapsWhenBufferIsDrained) {
+  auto handle = createAnonymousFile();
+  char mapped_memory[] = "hello";
+  EXPECT_CALL(mock_posix_file_operations_, fstat(_, _)).WillOnce([](int, struct stat* buffer) {
+    buffer->st_size = 5;
+    return Api::SysCallIntResult{0, 0};
+  });
+  EXPECT_CALL(mock_posix_file_operations_, mmap(_, 5, PROT_READ, _, _, 0))
+      .WillOnce(Return(Api::SysCallPtrResult{mapped_memory, 0}));
+  absl::StatusOr<Buffer::InstancePtr> read_status;
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), 0, 5,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  ASSERT_OK(read_status);
+  EXPECT_THAT(*read_status.value(), BufferStringEqual("hello"));
+  EXPECT_CALL(mock_posix_file_operations_, munmap(mapped_memory, 5))
+      .WillOnce(Return(Api::SysCallIntResult{0, 0}));
+  read_status.value()->drain(5);
+  close(handle);
+}
+
+TEST_F(AsyncFileHandleWithMockPosixTest, ReadMappedFailureReportsError) {
+  auto handle = createAnonymousFile();
+  EXPECT_CALL(mock_posix_file_operations_, fstat(_, _)).WillOnce([](int, struct stat* buffer) {
+    buffer->st_size = 5;
+    return Api::SysCallIntResult{0, 0};
+  });
+  EXPECT_CALL(mock_posix_file_operations_, mmap(_, 5, PROT_READ, _, _, 0))
+      .WillOnce(Return(Api::SysCallPtrResult{MAP_FAILED, EACCES}));
+  absl::StatusOr<Buffer::InstancePtr> read_status;
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), 0, 5,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  EXPECT_THAT(read_status, StatusIs(absl::StatusCode::kFailedPrecondition));
+  close(handle);
+}
+
+TEST_F(AsyncFileHandleWithMockPosixTest, ReadMappedCopiesWhenOutOfMappings) {
+  auto handle = createAnonymousFile();
+  EXPECT_CALL(mock_posix_file_operations_, fstat(_, _)).WillOnce([](int, struct stat* buffer) {
+    buffer->st_size = 5;
+    return Api::SysCallIntResult{0, 0};
+  });
+  EXPECT_CALL(mock_posix_file_operations_, mmap(_, 5, PROT_READ, _, _, 0))
+      .WillOnce(Return(Api::SysCallPtrResult{MAP_FAILED, ENOMEM}));
+  EXPECT_CALL(mock_posix_file_operations_, pread(_, _, 5, 0))
+      .WillOnce([](int, void* buf, size_t, off_t) {
+        memcpy(buf, "hello", 5);
+        return Api::SysCallSizeResult{5, 0};
+      });
+  absl::StatusOr<Buffer::InstancePtr> read_status;
+  EXPECT_OK(handle->readMapped(dispatcher_.get(), 0, 5,
+                               [&](absl::StatusOr<Buffer::InstancePtr> status) {
+                                 read_status = std::move(status);
+                               }));
+  resolveFileActions();
+  ASSERT_OK(read_status);
+  EXPECT_THAT(*read_status.value(), BufferStringEqual("hello"));
+  close(handle);
+}
+
 TEST_F(AsyncFileHandleWithMockPosixTest, CloseFailureReportsError) {
   auto handle = createAnonymousFile();
   EXPECT_CALL(mock_posix_file_operations_, close(1))
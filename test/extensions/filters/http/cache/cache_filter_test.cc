@@ -33,8 +33,11 @@ class CacheFilterTest : public ::testing::Test {
 protected:
   // The filter has to be created as a shared_ptr to enable shared_from_this() which is used in the
   // cache callbacks.
-  CacheFilterSharedPtr makeFilter(std::shared_ptr<HttpCache> cache, bool auto_destroy = true) {
-    auto config = std::make_shared<CacheFilterConfig>(config_, context_.server_factory_context_);
+  CacheFilterSharedPtr makeFilter(std::shared_ptr<HttpCache> cache, bool auto_destroy = true,
+                                  std::shared_ptr<const CacheFilterConfig> config = nullptr) {
+    if (config == nullptr) {
+      config = std::make_shared<CacheFilterConfig>(config_, context_.server_factory_context_);
+    }
     std::shared_ptr<CacheFilter> filter(new CacheFilter(config, cache),
                                         [auto_destroy](CacheFilter* f) {
                                           if (auto_destroy) {
@@ -381,6 +384,57 @@ TEST_F(CacheFilterTest, CacheMiss) {
   }
 }
 
+TEST_F(CacheFilterTest, CoalescedCacheMissWaitsForInsert) {
+  request_headers_.setHost("CoalescedCacheMiss");
+  config_.mutable_request_coalescing();
+  auto config = std::make_shared<CacheFilterConfig>(config_, context_.server_factory_context_);
+  CacheFilterSharedPtr leader = makeFilter(simple_cache_, true, config);
+  testDecodeRequestMiss(0, leader);
+
+  // The second miss waits for the first one instead of going upstream.
+  CacheFilterSharedPtr follower = makeFilter(simple_cache_, true, config);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+  pumpDispatcher();
+  EXPECT_EQ(1U, mock_upstreams_.size());
+
+  // Once the response is inserted, the second request is served from the cache.
+  receiveUpstreamHeaders(0, response_headers_, true);
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(IsSupersetOfHeaders(response_headers_), true));
+  pumpDispatcher();
+  ::testing::Mock::VerifyAndClearExpectations(&decoder_callbacks_);
+  EXPECT_EQ(1U, mock_upstreams_.size());
+
+  follower->onStreamComplete();
+  EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheHit));
+  EXPECT_THAT(insertStatus(), IsOkAndHolds(InsertStatus::NoInsertCacheHit));
+}
+
+TEST_F(CacheFilterTest, CoalescedCacheMissGoesUpstreamIfResponseNotCacheable) {
+  request_headers_.setHost("CoalescedUncacheableResponse");
+  config_.mutable_request_coalescing();
+  auto config = std::make_shared<CacheFilterConfig>(config_, context_.server_factory_context_);
+  CacheFilterSharedPtr leader = makeFilter(simple_cache_, true, config);
+  testDecodeRequestMiss(0, leader);
+  CacheFilterSharedPtr follower = makeFilter(simple_cache_, true, config);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+  pumpDispatcher();
+  EXPECT_EQ(1U, mock_upstreams_.size());
+
+  Http::TestResponseHeaderMapImpl uncacheable_headers{{":status", "200"},
+                                                      {"cache-control", "no-store"}};
+  receiveUpstreamHeaders(0, uncacheable_headers, true);
+  pumpDispatcher();
+  ASSERT_EQ(2U, mock_upstreams_.size());
+  EXPECT_THAT(mock_upstreams_headers_sent_[1], testing::Optional(request_headers_));
+  receiveUpstreamHeaders(1, uncacheable_headers, true);
+
+  follower->onStreamComplete();
+  EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheMiss));
+  EXPECT_THAT(insertStatus(), IsOkAndHolds(InsertStatus::NoInsertResponseNotCacheable));
+}
+
 TEST_F(CacheFilterTest, Disabled) {
   request_headers_.setHost("CacheDisabled");
   CacheFilterSharedPtr filter = makeFilter(std::shared_ptr<HttpCache>{});
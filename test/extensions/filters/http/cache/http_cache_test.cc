@@ -375,6 +375,21 @@ TEST_F(LookupRequestTest, HttpsScheme) {
   EXPECT_EQ(lookup_request.key().scheme(), Key::HTTPS);
 }
 
+TEST_F(LookupRequestTest, CopyKeepsKeyHeadersAndCacheControl) {
+  request_headers_.setReferenceKey(Http::CustomHeaders::get().CacheControl, "no-cache");
+  auto original =
+      std::make_unique<LookupRequest>(request_headers_, currentTime(), vary_allow_list_);
+  const LookupRequest copy(*original);
+  original.reset();
+  const Http::TestResponseHeaderMapImpl response_headers(
+      {{"date", formatter_.fromTime(currentTime())}, {"cache-control", "public, max-age=3600"}});
+  EXPECT_EQ(copy.requestHeaders().getPathValue(), request_headers_.getPathValue());
+  EXPECT_TRUE(TestUtility::protoEqual(
+      copy.key(), LookupRequest(request_headers_, currentTime(), vary_allow_list_).key()));
+  EXPECT_EQ(CacheEntryStatus::RequiresValidation,
+            makeLookupResult(copy, response_headers).cache_entry_status_);
+}
+
 } // namespace
 } // namespace Cache
 } // namespace HttpFilters
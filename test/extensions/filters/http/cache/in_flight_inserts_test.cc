@@ -0,0 +1,113 @@
+#include "source/extensions/filters/http/cache/in_flight_inserts.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using testing::NiceMock;
+
+class InFlightInsertsTest : public ::testing::Test {
+protected:
+  InFlightInsertsTest() {
+    key_.set_host("example.com");
+    key_.set_path("/hot");
+  }
+
+  void initialize(const std::string& yaml) {
+    InFlightInserts::Config config;
+    TestUtility::loadFromYaml(yaml, config);
+    in_flight_ = std::make_shared<InFlightInserts>(config);
+  }
+
+  // Joins key_ as a follower, recording how it is released.
+  void follow() {
+    EXPECT_EQ(nullptr, in_flight_->join(key_, dispatcher_, [this](bool lookup_again) {
+      released_.push_back(lookup_again);
+    }));
+  }
+
+  InFlightInsertLeasePtr lead() {
+    return in_flight_->join(key_, dispatcher_, [](bool) { FAIL() << "leader was released"; });
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  InFlightInsertsSharedPtr in_flight_;
+  Key key_;
+  std::vector<bool> released_;
+};
+
+TEST_F(InFlightInsertsTest, FollowersLookUpAgainOnceInserted) {
+  initialize("{}");
+  InFlightInsertLeasePtr lease = lead();
+  ASSERT_NE(nullptr, lease);
+  follow();
+  lease->onInsertStarted(100);
+  follow();
+  EXPECT_TRUE(released_.empty());
+
+  lease->onInsertComplete();
+  lease = nullptr;
+  EXPECT_THAT(released_, testing::ElementsAre(true, true));
+
+  // The next miss leads a new insertion.
+  EXPECT_NE(nullptr, lead());
+}
+
+TEST_F(InFlightInsertsTest, FollowersGoUpstreamIfInsertAbandoned) {
+  initialize("{}");
+  InFlightInsertLeasePtr lease = lead();
+  follow();
+  lease = nullptr;
+  EXPECT_THAT(released_, testing::ElementsAre(false));
+}
+
+TEST_F(InFlightInsertsTest, ActionPerResponseSize) {
+  initialize(R"EOF(
+max_small_response_bytes: 10
+large_response_action: BYPASS
+)EOF");
+  InFlightInsertLeasePtr lease = lead();
+  follow();
+  lease->onInsertStarted(11);
+  // Both the waiting follower and the next one go upstream right away.
+  EXPECT_THAT(released_, testing::ElementsAre(false));
+  follow();
+  EXPECT_THAT(released_, testing::ElementsAre(false, false));
+  lease->onInsertComplete();
+  lease = nullptr;
+  EXPECT_EQ(2U, released_.size());
+
+  lease = lead();
+  follow();
+  lease->onInsertStarted(10);
+  lease->onInsertComplete();
+  lease = nullptr;
+  EXPECT_THAT(released_, testing::ElementsAre(false, false, true));
+
+  // Unknown lengths wait by default.
+  lease = lead();
+  follow();
+  lease->onInsertStarted(absl::nullopt);
+  EXPECT_EQ(3U, released_.size());
+}
+
+TEST_F(InFlightInsertsTest, DistinctKeysDoNotCoalesce) {
+  initialize("{}");
+  InFlightInsertLeasePtr lease = lead();
+  key_.set_path("/cold");
+  EXPECT_NE(nullptr, lead());
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
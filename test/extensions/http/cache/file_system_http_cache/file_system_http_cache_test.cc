@@ -20,6 +20,7 @@
 #include "test/test_common/utility.h"
 
 #include "absl/cleanup/cleanup.h"
+#include "absl/strings/str_format.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -64,6 +65,8 @@ public:
     }
     ON_CALL(context_.server_factory_context_.api_, threadFactory())
         .WillByDefault([]() -> Thread::ThreadFactory& { return Thread::threadFactoryForTest(); });
+    ON_CALL(context_.server_factory_context_.api_, fileSystem())
+        .WillByDefault([]() -> Filesystem::Instance& { return Filesystem::fileSystemForTest(); });
   }
 
   void initCache() {
@@ -73,6 +76,8 @@ public:
 
   void waitForEvictionThreadIdle() { cache_->cache_eviction_thread_.waitForIdle(); }
 
+  CacheShared& cacheShared() { return *cache_->shared_; }
+
   ConfigProto testConfig() {
     envoy::extensions::filters::http::cache::v3::CacheConfig cache_config;
     TestUtility::loadFromYaml(std::string(yaml_config), cache_config);
@@ -144,8 +149,8 @@ TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictsOldestFilesUntilUnderCou
   EXPECT_EQ(cache_->stats().size_count_.value(), 2);
   env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-c"), file_contents, true);
   env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-d"), file_contents, true);
-  cache_->trackFileAdded(file_contents.size());
-  cache_->trackFileAdded(file_contents.size());
+  cache_->trackFileAdded("cache-c", file_contents.size());
+  cache_->trackFileAdded("cache-d", file_contents.size());
   waitForEvictionThreadIdle();
   EXPECT_EQ(cache_->stats().size_bytes_.value(), file_contents.size() * 2);
   EXPECT_EQ(cache_->stats().size_count_.value(), 2);
@@ -176,7 +181,7 @@ TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictsOldestFilesUntilUnderSiz
   env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-c"), large_file_contents, true);
   EXPECT_EQ(cache_->stats().size_bytes_.value(), file_contents.size() * 2);
   EXPECT_EQ(cache_->stats().size_count_.value(), 2);
-  cache_->trackFileAdded(large_file_contents.size());
+  cache_->trackFileAdded("cache-c", large_file_contents.size());
   waitForEvictionThreadIdle();
   EXPECT_EQ(cache_->stats().size_bytes_.value(), large_file_contents.size());
   EXPECT_EQ(cache_->stats().size_count_.value(), 1);
@@ -186,6 +191,146 @@ TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictsOldestFilesUntilUnderSiz
   EXPECT_EQ(cache_->stats().eviction_runs_.value(), 1);
 }
 
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictsLeastRecentlyTouchedFiles) {
+  const std::string file_contents = "XXXXX";
+  ConfigProto cfg = testConfig();
+  cfg.mutable_max_cache_entry_count()->set_value(2);
+  cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+      http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  waitForEvictionThreadIdle();
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-a"), file_contents, true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-b"), file_contents, true);
+  cache_->trackFileAdded("cache-a", file_contents.size());
+  cache_->trackFileAdded("cache-b", file_contents.size());
+  cache_->trackFileTouched("cache-a");
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-c"), file_contents, true);
+  cache_->trackFileAdded("cache-c", file_contents.size());
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache_->stats().size_count_.value(), 2);
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-a")));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-b")));
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-c")));
+  EXPECT_EQ(cache_->stats().eviction_runs_.value(), 1);
+}
+
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictingAMissingFileUncountsItOnce) {
+  const std::string file_contents = "XXXXX";
+  ConfigProto cfg = testConfig();
+  cfg.mutable_max_cache_entry_count()->set_value(1);
+  cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+      http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  waitForEvictionThreadIdle();
+  // cache-a is indexed but not on disk, as if another process had already removed it.
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-b"), file_contents, true);
+  cache_->trackFileAdded("cache-a", file_contents.size());
+  cache_->trackFileAdded("cache-b", file_contents.size());
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), file_contents.size());
+  EXPECT_EQ(cache_->stats().size_count_.value(), 1);
+  // A lookup invalidating the entry that eviction already took must not uncount it again.
+  cache_->trackFileRemoved("cache-a");
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), file_contents.size());
+  EXPECT_EQ(cache_->stats().size_count_.value(), 1);
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-b")));
+}
+
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, SubdividedCachePlacesFilesInSubdirectories) {
+  ConfigProto cfg = testConfig();
+  cfg.set_cache_subdivisions(4);
+  cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+      http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  waitForEvictionThreadIdle();
+  for (absl::string_view subdirectory : {"cache-0000", "cache-0001", "cache-0002", "cache-0003"}) {
+    EXPECT_TRUE(Filesystem::fileSystemForTest().directoryExists(
+        absl::StrCat(cache_path_, subdirectory)));
+  }
+  EXPECT_FALSE(
+      Filesystem::fileSystemForTest().directoryExists(absl::StrCat(cache_path_, "cache-0004")));
+  Key key;
+  key.set_host("example.com");
+  const uint64_t hash = stableHashKey(key);
+  EXPECT_EQ(cache_->generateFilename(key),
+            absl::StrFormat("cache-%04x/cache-%d", hash % 4, hash));
+}
+
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, RemovesFilesInWrongSubdirectoryAtStartup) {
+  const std::string file_contents = "XXXXX";
+  ConfigProto cfg = testConfig();
+  cfg.set_cache_subdivisions(4);
+  env_.createPath(absl::StrCat(cache_path_, "cache-0000"));
+  env_.createPath(absl::StrCat(cache_path_, "cache-0001"));
+  env_.createPath(absl::StrCat(cache_path_, "cache-0007"));
+  // 8 % 4 is 0, so only the first file is where it belongs.
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-0000/cache-8"), file_contents,
+                                true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-0001/cache-4"), file_contents,
+                                true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-0007/cache-7"), file_contents,
+                                true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-12"), file_contents, true);
+  cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+      http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  waitForEvictionThreadIdle();
+  EXPECT_EQ(cache_->stats().size_count_.value(), 1);
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), file_contents.size());
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(
+      absl::StrCat(cache_path_, "cache-0000/cache-8")));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(
+      absl::StrCat(cache_path_, "cache-0001/cache-4")));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(
+      absl::StrCat(cache_path_, "cache-0007/cache-7")));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-12")));
+}
+
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, TracksFilesInEverySubdirectory) {
+  ConfigProto cfg = testConfig();
+  cfg.set_cache_subdivisions(4);
+  cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+      http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  waitForEvictionThreadIdle();
+  cache_->trackFileAdded("cache-0000/cache-4", 1);
+  cache_->trackFileAdded("cache-0001/cache-5", 2);
+  cache_->trackFileAdded("cache-0003/cache-7", 4);
+  cache_->trackFileTouched("cache-0001/cache-5");
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), 7);
+  EXPECT_EQ(cache_->stats().size_count_.value(), 3);
+  cache_->trackFileRemoved("cache-0001/cache-5");
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), 5);
+  EXPECT_EQ(cache_->stats().size_count_.value(), 2);
+}
+
+TEST_F(FileSystemHttpCacheTestWithNoDefaultCache, EvictionSparesAFileReAddedWhileItsBatchIsTaken) {
+  const std::string file_contents = "XXXXX";
+  ConfigProto cfg = testConfig();
+  cfg.mutable_max_cache_entry_count()->set_value(1);
+  cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+      http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  waitForEvictionThreadIdle();
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-1"), file_contents, true);
+  env_.writeStringToFileForTest(absl::StrCat(cache_path_, "cache-2"), file_contents, true);
+  // Tracking through CacheShared doesn't signal the eviction thread, so the test plays its part.
+  CacheShared& shared = cacheShared();
+  shared.trackFileAdded("cache-1", file_contents.size());
+  shared.trackFileAdded("cache-2", file_contents.size());
+  std::vector<CacheShared::IndexedFile> batch = shared.takeEvictionBatch();
+  ASSERT_EQ(batch.size(), 1);
+  EXPECT_EQ(batch[0].name_, "cache-1");
+  EXPECT_EQ(cache_->stats().size_count_.value(), 1);
+  // A worker inserts the same entry again before the batch is unlinked.
+  shared.trackFileAdded("cache-1", file_contents.size());
+  EXPECT_TRUE(shared.unlinkEvictionBatch(std::move(batch)));
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-1")));
+  EXPECT_EQ(cache_->stats().size_count_.value(), 2);
+  // The next batch takes the file that is now the least recently used.
+  batch = shared.takeEvictionBatch();
+  ASSERT_EQ(batch.size(), 1);
+  EXPECT_EQ(batch[0].name_, "cache-2");
+  EXPECT_TRUE(shared.unlinkEvictionBatch(std::move(batch)));
+  EXPECT_FALSE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-2")));
+  EXPECT_TRUE(Filesystem::fileSystemForTest().fileExists(absl::StrCat(cache_path_, "cache-1")));
+  EXPECT_EQ(cache_->stats().size_count_.value(), 1);
+}
+
 class FileSystemHttpCacheTest : public FileSystemCacheTestContext, public ::testing::Test {
   void SetUp() override { initCache(); }
 };
@@ -221,15 +366,26 @@ TEST_F(FileSystemHttpCacheTest, StatsAreConstructedCorrectly) {
                                      IsStatTag("event_type", "miss")));
 }
 
-TEST_F(FileSystemHttpCacheTest, TrackFileRemovedClampsAtZero) {
-  cache_->trackFileAdded(1);
+TEST_F(FileSystemHttpCacheTest, TrackFileRemovedOnlyUncountsIndexedFiles) {
+  cache_->trackFileAdded("cache-a", 1);
   EXPECT_EQ(cache_->stats().size_bytes_.value(), 1);
   EXPECT_EQ(cache_->stats().size_count_.value(), 1);
-  cache_->trackFileRemoved(8);
+  cache_->trackFileRemoved("cache-a");
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), 0);
+  EXPECT_EQ(cache_->stats().size_count_.value(), 0);
+  // Removing a second time, or removing a file that was never added, changes nothing.
+  cache_->trackFileRemoved("cache-a");
+  cache_->trackFileRemoved("cache-b");
   EXPECT_EQ(cache_->stats().size_bytes_.value(), 0);
   EXPECT_EQ(cache_->stats().size_count_.value(), 0);
-  // Remove a second time to ensure that count going below zero also clamps at zero.
-  cache_->trackFileRemoved(8);
+}
+
+TEST_F(FileSystemHttpCacheTest, TrackFileAddedReplacesTheSizeOfAnIndexedFile) {
+  cache_->trackFileAdded("cache-a", 5);
+  cache_->trackFileAdded("cache-a", 8);
+  EXPECT_EQ(cache_->stats().size_bytes_.value(), 8);
+  EXPECT_EQ(cache_->stats().size_count_.value(), 1);
+  cache_->trackFileRemoved("cache-a");
   EXPECT_EQ(cache_->stats().size_bytes_.value(), 0);
   EXPECT_EQ(cache_->stats().size_count_.value(), 0);
 }
@@ -483,9 +639,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedOpenForReadReturnsMiss) {
 }
 
 TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedReadOfHeaderBlockInvalidatesTheCacheEntry) {
-  // Fake-add two files of size 12345, so we can validate the stats decrease of removing a file.
-  cache_->trackFileAdded(12345);
-  cache_->trackFileAdded(12345);
+  // Fake-add two files of size 12345, one of them the file of the entry being looked up, so we
+  // can validate the stats decrease of removing a file.
+  cache_->trackFileAdded(cache_->generateFilename(key_), 12345);
+  cache_->trackFileAdded("cache-b", 12345);
   EXPECT_EQ(cache_->stats().size_bytes_.value(), 2 * 12345);
   EXPECT_EQ(cache_->stats().size_count_.value(), 2);
   auto lookup = testLookupContext();
@@ -497,16 +654,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedReadOfHeaderBlockInvalidatesT
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<AsyncFileHandle>(mock_async_file_handle_));
   pumpDispatcher();
-  EXPECT_CALL(*mock_async_file_manager_, stat(_, _, _));
   EXPECT_CALL(*mock_async_file_manager_, unlink(_, _, _));
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<Buffer::InstancePtr>(absl::UnknownError("intentional failure to read")));
   pumpDispatcher();
-  struct stat stat_result = {};
-  stat_result.st_size = 12345;
-  // stat
-  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{stat_result});
-  pumpDispatcher();
   // unlink
   mock_async_file_manager_->nextActionCompletes(absl::OkStatus());
   pumpDispatcher();
@@ -540,14 +691,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, ReadWithInvalidHeaderBlockInvalidat
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<AsyncFileHandle>(mock_async_file_handle_));
   pumpDispatcher();
-  EXPECT_CALL(*mock_async_file_manager_, stat(_, _, _));
   EXPECT_CALL(*mock_async_file_manager_, unlink(_, _, _));
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<Buffer::InstancePtr>(invalidHeaderBlock()));
   pumpDispatcher();
-  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{
-      absl::UnknownError("intentionally failed to stat, for coverage")});
-  pumpDispatcher();
   mock_async_file_manager_->nextActionCompletes(
       absl::UnknownError("intentionally failed to unlink, for coverage"));
   pumpDispatcher();
@@ -568,14 +715,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedReadOfHeaderProtoInvalidatesT
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<Buffer::InstancePtr>(testHeaderBlock(0)));
   pumpDispatcher();
-  EXPECT_CALL(*mock_async_file_manager_, stat(_, _, _));
   EXPECT_CALL(*mock_async_file_manager_, unlink(_, _, _));
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<Buffer::InstancePtr>(absl::UnknownError("intentional failure to read")));
   pumpDispatcher();
-  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{
-      absl::UnknownError("intentionally failed to stat, for coverage")});
-  pumpDispatcher();
   mock_async_file_manager_->nextActionCompletes(
       absl::UnknownError("intentionally failed to unlink, for coverage"));
   pumpDispatcher();
@@ -610,14 +753,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedReadOfBodyInvalidatesTheCache
   lookup->getBody(AdjustedByteRange(0, 8), [&](Buffer::InstancePtr body, bool /*end_stream*/) {
     EXPECT_EQ(body.get(), nullptr);
   });
-  EXPECT_CALL(*mock_async_file_manager_, stat(_, _, _));
   EXPECT_CALL(*mock_async_file_manager_, unlink(_, _, _));
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<Buffer::InstancePtr>(absl::UnknownError("intentional failure to read")));
   pumpDispatcher();
-  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{
-      absl::UnknownError("intentionally failed to stat, for coverage")});
-  pumpDispatcher();
   mock_async_file_manager_->nextActionCompletes(
       absl::UnknownError("intentionally failed to unlink, for coverage"));
   pumpDispatcher();
@@ -659,14 +798,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedReadOfTrailersInvalidatesTheC
   // No point validating that the trailers are empty since that's not even particularly
   // desirable behavior - it's a quirk of the filter that we can't properly signify an error.
   lookup->getTrailers([&](Http::ResponseTrailerMapPtr) {});
-  EXPECT_CALL(*mock_async_file_manager_, stat(_, _, _));
   EXPECT_CALL(*mock_async_file_manager_, unlink(_, _, _));
   mock_async_file_manager_->nextActionCompletes(absl::StatusOr<Buffer::InstancePtr>(
       absl::UnknownError("intentional failure to read trailers")));
   pumpDispatcher();
-  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{
-      absl::UnknownError("intentionally failed to stat, for coverage")});
-  pumpDispatcher();
   mock_async_file_manager_->nextActionCompletes(
       absl::UnknownError("intentionally failed to unlink, for coverage"));
   pumpDispatcher();
@@ -858,7 +993,6 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, InsertAbortsOnFailureToLinkFile) {
   absl::Cleanup destroy_inserter([&inserter]() { inserter->onDestroy(); });
   EXPECT_CALL(*mock_async_file_manager_, createAnonymousFile(_, _, _));
   EXPECT_CALL(*mock_async_file_handle_, write(_, _, _, _)).Times(5);
-  EXPECT_CALL(*mock_async_file_manager_, stat(_, _, _));
   EXPECT_CALL(*mock_async_file_manager_, unlink(_, _, _));
   EXPECT_CALL(*mock_async_file_handle_, createHardLink(_, _, _));
   inserter->insertHeaders(response_headers_, metadata_, expect_true_callback_, false);
@@ -882,9 +1016,6 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, InsertAbortsOnFailureToLinkFile) {
   mock_async_file_manager_->nextActionCompletes(
       absl::StatusOr<size_t>(CacheFileFixedBlock::size()));
   pumpDispatcher();
-  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<struct stat>{
-      absl::UnknownError("intentionally failed to stat, for coverage")});
-  pumpDispatcher();
   mock_async_file_manager_->nextActionCompletes(absl::OkStatus());
   pumpDispatcher();
   mock_async_file_manager_->nextActionCompletes(
@@ -1386,6 +1517,28 @@ INSTANTIATE_TEST_SUITE_P(FileSystemHttpCacheTest, HttpCacheImplementationTest,
                            return "FileSystemHttpCache";
                          });
 
+// Runs the standard cache tests with every body read served by mapping the cache file.
+class FileSystemHttpCacheMappedReadsTestDelegate : public HttpCacheTestDelegate,
+                                                   public FileSystemCacheTestContext {
+public:
+  FileSystemHttpCacheMappedReadsTestDelegate() {
+    ConfigProto cfg = testConfig();
+    cfg.mutable_min_memory_mapped_read_bytes()->set_value(0);
+    cache_ = std::dynamic_pointer_cast<FileSystemHttpCache>(
+        http_cache_factory_->getCache(cacheConfig(cfg), context_));
+  }
+  std::shared_ptr<HttpCache> cache() override { return cache_; }
+  bool validationEnabled() const override { return true; }
+  void beforePumpingDispatcher() override { cache_->drainAsyncFileActionsForTest(); }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    FileSystemHttpCacheMappedReadsTest, HttpCacheImplementationTest,
+    testing::Values(std::make_unique<FileSystemHttpCacheMappedReadsTestDelegate>),
+    [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+      return "FileSystemHttpCacheMappedReads";
+    });
+
 TEST(Registration, GetCacheFromFactory) {
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
       "envoy.extensions.http.cache.file_system_http_cache.v3.FileSystemHttpCacheConfig");
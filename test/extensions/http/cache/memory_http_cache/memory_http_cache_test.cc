@@ -0,0 +1,164 @@
+#include <string>
+
+#include "envoy/extensions/http/cache/memory_http_cache/v3/memory_http_cache.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/http/header_map_impl.h"
+#include "source/extensions/filters/http/cache/cache_headers_utils.h"
+#include "source/extensions/http/cache/memory_http_cache/memory_http_cache.h"
+
+#include "test/extensions/filters/http/cache/http_cache_implementation_test_common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace MemoryHttpCache {
+namespace {
+
+class MemoryHttpCacheTestDelegate : public HttpCacheTestDelegate {
+public:
+  MemoryHttpCacheTestDelegate() {
+    ConfigProto config;
+    config.set_max_cache_size_bytes(64 * 1024 * 1024);
+    cache_ = std::make_shared<MemoryHttpCache>(config);
+  }
+  std::shared_ptr<HttpCache> cache() override { return cache_; }
+  bool validationEnabled() const override { return true; }
+
+private:
+  std::shared_ptr<MemoryHttpCache> cache_;
+};
+
+INSTANTIATE_TEST_SUITE_P(MemoryHttpCacheTest, HttpCacheImplementationTest,
+                         testing::Values(std::make_unique<MemoryHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "MemoryHttpCache";
+                         });
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache.memory_http_cache.v3.MemoryHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  envoy::extensions::filters::http::cache::v3::CacheConfig config;
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigProto memory_config;
+  memory_config.set_max_cache_size_bytes(1024);
+  config.mutable_typed_config()->PackFrom(memory_config);
+  std::shared_ptr<HttpCache> cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache->cacheInfo().name_, "envoy.extensions.http.cache.memory_http_cache");
+  // Equivalent configs share a cache.
+  EXPECT_EQ(factory->getCache(config, factory_context), cache);
+}
+
+Key keyFor(absl::string_view path) {
+  Key key;
+  key.set_host("example.com");
+  key.set_path(std::string(path));
+  return key;
+}
+
+// An entry of exactly size bytes, all of them body.
+MemoryHttpCache::Entry entryOfSize(uint64_t size) {
+  return {Http::ResponseHeaderMapImpl::create(), {},
+          std::make_shared<const std::string>(size, 'x'), nullptr};
+}
+
+class MemoryHttpCacheShardTest : public testing::Test {
+protected:
+  void insert(absl::string_view path) {
+    const Key key = keyFor(path);
+    shard_.insert(key, stableHashKey(key), entryOfSize(EntrySize));
+  }
+  bool contains(absl::string_view path) {
+    return shard_.lookup(keyFor(path)).response_headers_ != nullptr;
+  }
+  void insertOneHitWonders(absl::string_view prefix, int count) {
+    for (int i = 0; i < count; ++i) {
+      insert(absl::StrCat(prefix, i));
+    }
+  }
+
+  static constexpr uint64_t EntrySize = 100;
+  // Room for ten entries, one of them in the small queue.
+  MemoryHttpCache::Shard shard_{10 * EntrySize};
+};
+
+TEST_F(MemoryHttpCacheShardTest, StaysWithinCapacity) {
+  insertOneHitWonders("/scan", 25);
+  EXPECT_EQ(shard_.sizeBytes(), 10 * EntrySize);
+  EXPECT_EQ(shard_.entryCount(), 10);
+  EXPECT_FALSE(contains("/scan0"));
+  EXPECT_TRUE(contains("/scan24"));
+}
+
+TEST_F(MemoryHttpCacheShardTest, EntryLookedUpWhileNewSurvivesScan) {
+  insert("/popular");
+  EXPECT_TRUE(contains("/popular"));
+  insertOneHitWonders("/scan", 50);
+  EXPECT_TRUE(contains("/popular"));
+  EXPECT_LE(shard_.sizeBytes(), 10 * EntrySize);
+}
+
+TEST_F(MemoryHttpCacheShardTest, EntryNeverLookedUpIsEvictedByScan) {
+  insert("/unpopular");
+  insertOneHitWonders("/scan", 50);
+  EXPECT_FALSE(contains("/unpopular"));
+}
+
+TEST_F(MemoryHttpCacheShardTest, RecentlyEvictedEntryIsAdmittedToMainQueue) {
+  insert("/returning");
+  // Fills the shard, then evicts /returning, leaving it as a ghost.
+  insertOneHitWonders("/scan", 10);
+  EXPECT_FALSE(contains("/returning"));
+  insert("/returning");
+  insertOneHitWonders("/later", 50);
+  EXPECT_TRUE(contains("/returning"));
+}
+
+TEST_F(MemoryHttpCacheShardTest, ReplacingAnEntryUpdatesItsSize) {
+  insert("/a");
+  const Key key = keyFor("/a");
+  shard_.insert(key, stableHashKey(key), entryOfSize(3 * EntrySize));
+  EXPECT_EQ(shard_.sizeBytes(), 3 * EntrySize);
+  EXPECT_EQ(shard_.entryCount(), 1);
+}
+
+TEST(MemoryHttpCacheTest, RejectsEntriesLargerThanTheLimit) {
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigProto config;
+  config.set_max_cache_size_bytes(1000);
+  config.mutable_shards()->set_value(1);
+  config.mutable_max_cache_entry_size_bytes()->set_value(100);
+  MemoryHttpCache cache(config);
+  EXPECT_EQ(cache.maxEntrySizeBytes(), 100);
+
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":path", "/large"}, {":method", "GET"}, {":scheme", "https"}, {":authority", "example.com"}};
+  VaryAllowList vary_allow_list({}, factory_context.serverFactoryContext());
+  LookupRequest request(request_headers, SystemTime(), vary_allow_list);
+  EXPECT_FALSE(cache.insert(request, entryOfSize(101)));
+  EXPECT_EQ(cache.lookup(request).response_headers_, nullptr);
+  EXPECT_TRUE(cache.insert(request, entryOfSize(100)));
+  EXPECT_NE(cache.lookup(request).response_headers_, nullptr);
+  EXPECT_EQ(cache.sizeBytes(), 100);
+}
+
+TEST(MemoryHttpCacheTest, EntriesAreLimitedToAShard) {
+  ConfigProto config;
+  config.set_max_cache_size_bytes(1000);
+  config.mutable_shards()->set_value(4);
+  EXPECT_EQ(MemoryHttpCache(config).maxEntrySizeBytes(), 250);
+}
+
+} // namespace
+} // namespace MemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,161 @@
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/http/cache/memory_http_cache/v3/memory_http_cache.pb.h"
+#include "envoy/extensions/http/cache/simple_http_cache/v3/config.pb.h"
+#include "envoy/extensions/http/cache/tiered_http_cache/v3/tiered_http_cache.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/extensions/http/cache/memory_http_cache/memory_http_cache.h"
+#include "source/extensions/http/cache/simple_http_cache/simple_http_cache.h"
+#include "source/extensions/http/cache/tiered_http_cache/tiered_http_cache.h"
+
+#include "test/extensions/filters/http/cache/http_cache_implementation_test_common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/status_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace TieredHttpCache {
+namespace {
+
+class TieredHttpCacheTestDelegate : public HttpCacheTestDelegate {
+public:
+  TieredHttpCacheTestDelegate() {
+    MemoryHttpCache::ConfigProto l1_config;
+    l1_config.set_max_cache_size_bytes(64 * 1024 * 1024);
+    l1_ = std::make_shared<MemoryHttpCache::MemoryHttpCache>(l1_config);
+    cache_ = std::make_shared<TieredHttpCache>(l1_, l2_);
+  }
+  std::shared_ptr<HttpCache> cache() override { return cache_; }
+  bool validationEnabled() const override { return true; }
+
+  HttpCache& l1() { return *l1_; }
+  HttpCache& l2() { return *l2_; }
+
+private:
+  std::shared_ptr<HttpCache> l1_;
+  std::shared_ptr<HttpCache> l2_ = std::make_shared<SimpleHttpCache>();
+  std::shared_ptr<TieredHttpCache> cache_;
+};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCacheTest, HttpCacheImplementationTest,
+                         testing::Values(std::make_unique<TieredHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "TieredHttpCache";
+                         });
+
+class TieredHttpCacheTest : public HttpCacheImplementationTest {
+protected:
+  TieredHttpCacheTestDelegate& tiers() {
+    return static_cast<TieredHttpCacheTestDelegate&>(*delegate_);
+  }
+
+  // Looks up request_path in a single tier.
+  CacheEntryStatus lookupIn(HttpCache& tier, absl::string_view request_path) {
+    LookupContextPtr context =
+        tier.makeLookupContext(makeLookupRequest(request_path), decoder_callbacks_);
+    CacheEntryStatus status = CacheEntryStatus::LookupError;
+    context->getHeaders(
+        [&status](LookupResult&& result, bool) { status = result.cache_entry_status_; });
+    pumpDispatcher();
+    context->onDestroy();
+    return status;
+  }
+
+  // Inserts a response with a body into a single tier.
+  void insertInto(HttpCache& tier, absl::string_view request_path, absl::string_view body) {
+    LookupContextPtr context =
+        tier.makeLookupContext(makeLookupRequest(request_path), decoder_callbacks_);
+    InsertContextPtr inserter = tier.makeInsertContext(std::move(context), encoder_callbacks_);
+    bool inserted = false;
+    inserter->insertHeaders(
+        responseHeaders(), ResponseMetadata{time_system_.systemTime()},
+        [&inserted](bool ready) { inserted = ready; }, /*end_stream=*/false);
+    pumpDispatcher();
+    ASSERT_TRUE(inserted);
+    inserter->insertBody(
+        Buffer::OwnedImpl(body), [&inserted](bool ready) { inserted = ready; },
+        /*end_stream=*/true);
+    pumpDispatcher();
+    ASSERT_TRUE(inserted);
+    inserter->onDestroy();
+  }
+
+  Http::TestResponseHeaderMapImpl responseHeaders() {
+    return {{":status", "200"},
+            {"date", formatter_.fromTime(time_system_.systemTime())},
+            {"cache-control", "public,max-age=3600"}};
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCacheTest, TieredHttpCacheTest,
+                         testing::Values(std::make_unique<TieredHttpCacheTestDelegate>));
+
+TEST_P(TieredHttpCacheTest, InsertsIntoBothTiers) {
+  ASSERT_OK(insert("/both", responseHeaders(), "body"));
+  EXPECT_EQ(lookupIn(tiers().l1(), "/both"), CacheEntryStatus::Ok);
+  EXPECT_EQ(lookupIn(tiers().l2(), "/both"), CacheEntryStatus::Ok);
+}
+
+TEST_P(TieredHttpCacheTest, PromotesEntryReadFromL2IntoL1) {
+  insertInto(tiers().l2(), "/promoted", "body");
+  EXPECT_EQ(lookupIn(tiers().l1(), "/promoted"), CacheEntryStatus::Unusable);
+
+  LookupContextPtr context = lookup("/promoted");
+  EXPECT_EQ(lookup_result_.cache_entry_status_, CacheEntryStatus::Ok);
+  EXPECT_THAT(getBody(*context, 0, 4), testing::Pair("body", true));
+  pumpDispatcher();
+  context->onDestroy();
+
+  EXPECT_EQ(lookupIn(tiers().l1(), "/promoted"), CacheEntryStatus::Ok);
+}
+
+TEST_P(TieredHttpCacheTest, DoesNotPromotePartialReads) {
+  insertInto(tiers().l2(), "/partial", "body");
+
+  LookupContextPtr context = lookup("/partial");
+  EXPECT_EQ(lookup_result_.cache_entry_status_, CacheEntryStatus::Ok);
+  EXPECT_THAT(getBody(*context, 1, 4), testing::Pair("ody", true));
+  pumpDispatcher();
+  context->onDestroy();
+
+  EXPECT_EQ(lookupIn(tiers().l1(), "/partial"), CacheEntryStatus::Unusable);
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache.tiered_http_cache.v3.TieredHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::http::cache::memory_http_cache::v3::MemoryHttpCacheConfig l1_config;
+  l1_config.set_max_cache_size_bytes(1024);
+  ConfigProto tiered_config;
+  tiered_config.mutable_l1_cache()->PackFrom(l1_config);
+  tiered_config.mutable_l2_cache()->PackFrom(
+      envoy::extensions::http::cache::simple_http_cache::v3::SimpleHttpCacheConfig());
+  envoy::extensions::filters::http::cache::v3::CacheConfig config;
+  config.mutable_typed_config()->PackFrom(tiered_config);
+  EXPECT_EQ(factory->getCache(config, factory_context)->cacheInfo().name_,
+            "envoy.extensions.http.cache.tiered_http_cache");
+
+  tiered_config.mutable_l2_cache()->PackFrom(ProtobufWkt::StringValue());
+  config.mutable_typed_config()->PackFrom(tiered_config);
+  EXPECT_THROW_WITH_MESSAGE(
+      factory->getCache(config, factory_context), EnvoyException,
+      "Didn't find a registered implementation for type: 'google.protobuf.StringValue'");
+}
+
+} // namespace
+} // namespace TieredHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -67,6 +67,8 @@ void benchmarkMaglevLoadBalancerBuildTable(::benchmark::State& state) {
     const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
     state.counters["memory"] = end_mem - start_mem;
     state.counters["memory_per_host"] = (end_mem - start_mem) / num_hosts;
+    state.counters["memory_per_table_entry"] =
+        static_cast<double>(end_mem - start_mem) / tester.maglev_lb_->tableSize();
     state.ResumeTiming();
   }
 }
@@ -74,6 +76,35 @@ BENCHMARK(benchmarkMaglevLoadBalancerBuildTable)
     ->Arg(100)
     ->Arg(200)
     ->Arg(500)
+    ->Arg(2000)
+    ->Arg(5000)
+    ->Arg(10000)
+    ->Unit(::benchmark::kMillisecond);
+
+// Rebuilds the table of a cluster whose hosts all change, as happens on EDS updates.
+void benchmarkMaglevLoadBalancerRebuildTable(::benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  MaglevTester tester(num_hosts);
+  ASSERT_TRUE(tester.maglev_lb_->initialize().ok());
+  HostVector hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  HostVector other_hosts;
+  for (uint64_t i = 0; i < num_hosts; i++) {
+    other_hosts.push_back(makeTestHost(
+        tester.info_, fmt::format("tcp://10.1.{}.{}:6379", i / 256, i % 256), tester.simTime()));
+  }
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    std::swap(hosts, other_hosts);
+    // Replacing the hosts of the priority set synchronously rebuilds the table.
+    HostVectorConstSharedPtr updated_hosts = std::make_shared<HostVector>(hosts);
+    tester.priority_set_.updateHosts(
+        0, HostSetImpl::partitionHosts(updated_hosts, makeHostsPerLocality({hosts})), {}, hosts,
+        other_hosts, tester.random_.random(), absl::nullopt);
+  }
+}
+BENCHMARK(benchmarkMaglevLoadBalancerRebuildTable)
+    ->Arg(500)
+    ->Arg(5000)
     ->Unit(::benchmark::kMillisecond);
 
 void benchmarkMaglevLoadBalancerHostLoss(::benchmark::State& state) {
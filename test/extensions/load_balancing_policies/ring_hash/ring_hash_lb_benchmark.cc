@@ -84,6 +84,7 @@ BENCHMARK(benchmarkRingHashLoadBalancerChooseHost)
     ->Args({100, 256000, 100000})
     ->Args({200, 256000, 100000})
     ->Args({500, 256000, 100000})
+    ->Args({500, 1048576, 100000})
     ->Unit(::benchmark::kMillisecond);
 
 void benchmarkRingHashLoadBalancerHostLoss(::benchmark::State& state) {
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cstdint>
 #include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/router/router.h"
@@ -19,6 +21,7 @@
 #include "test/mocks/upstream/load_balancer_context.h"
 #include "test/mocks/upstream/priority_set.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_random_generator.h"
 
 #include "absl/container/node_hash_map.h"
 #include "absl/types/optional.h"
@@ -30,6 +33,62 @@ using testing::Return;
 
 namespace Envoy {
 namespace Upstream {
+
+class RingHashLoadBalancerPeer {
+public:
+  using Ring = RingHashLoadBalancer::Ring;
+
+  static RingHashLoadBalancerStats generateStats(Stats::Scope& scope) {
+    return RingHashLoadBalancer::generateStats(scope);
+  }
+
+  // Builds a ring from the given hashes, with the i-th hash pointing at hosts[i].
+  static std::unique_ptr<Ring> makeRing(const std::vector<uint64_t>& hashes,
+                                        const HostVector& hosts, RingHashLoadBalancerStats& stats) {
+    auto ring = std::make_unique<Ring>(NormalizedHostWeightVector(), 0, 0, 0,
+                                       RingHashLbProto::XX_HASH, false, stats);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+      ring->ring_.push_back({hashes[i], hosts[i]});
+    }
+    std::sort(ring->ring_.begin(), ring->ring_.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.hash_ < rhs.hash_; });
+    ring->buildBucketIndex();
+    return ring;
+  }
+
+  static uint64_t hashAt(const Ring& ring, uint64_t index) { return ring.ring_[index].hash_; }
+  static HostConstSharedPtr hostAt(const Ring& ring, uint64_t index) {
+    return ring.ring_[index].host_;
+  }
+
+  // The ketama binary search that chooseHost() used before the bucket index, returning the index
+  // of the selected ring entry.
+  static uint64_t ketamaIndex(const Ring& ring, uint64_t h) {
+    int64_t lowp = 0;
+    int64_t highp = ring.ring_.size();
+    int64_t midp = 0;
+    while (true) {
+      midp = (lowp + highp) / 2;
+      if (midp == static_cast<int64_t>(ring.ring_.size())) {
+        return 0;
+      }
+      const uint64_t midval = ring.ring_[midp].hash_;
+      const uint64_t midval1 = midp == 0 ? 0 : ring.ring_[midp - 1].hash_;
+      if (h <= midval && h > midval1) {
+        return midp;
+      }
+      if (midval < h) {
+        lowp = midp + 1;
+      } else {
+        highp = midp - 1;
+      }
+      if (lowp > highp) {
+        return 0;
+      }
+    }
+  }
+};
+
 namespace {
 
 class TestLoadBalancerContext : public LoadBalancerContextBase {
@@ -1001,6 +1060,83 @@ TEST_P(RingHashLoadBalancerTest, LopsidedWeightSmallScale) {
   }
 }
 
+// The bucket index selects the same ring entry as the ketama binary search it replaced, for random
+// rings with clustered and duplicate hashes, at bucket boundaries and past the last entry.
+TEST(RingHashBucketIndexTest, MatchesBinarySearch) {
+  TestRandomGenerator random;
+  auto random64 = [&random]() { return (random.random() << 32) ^ random.random(); };
+  Stats::IsolatedStoreImpl stats_store;
+  RingHashLoadBalancerStats stats =
+      RingHashLoadBalancerPeer::generateStats(*stats_store.rootScope());
+
+  // Every ring entry gets its own host, so that the selected host identifies the selected entry.
+  constexpr uint64_t MaxRingSize = 3000;
+  HostVector hosts;
+  for (uint64_t i = 0; i < MaxRingSize; ++i) {
+    hosts.push_back(std::make_shared<NiceMock<MockHost>>());
+  }
+
+  for (uint32_t iteration = 0; iteration < 400; ++iteration) {
+    const uint64_t ring_size =
+        1 + random.random() % (iteration % 10 == 0 ? MaxRingSize : uint64_t(64));
+    std::vector<uint64_t> hashes;
+    for (uint64_t i = 0; i < ring_size; ++i) {
+      uint64_t hash;
+      switch (iteration % 4) {
+      case 0:
+        hash = random64();
+        break;
+      case 1:
+        // Evenly spaced hashes, many of them duplicated, which fall on bucket boundaries.
+        hash = random.random() % (ring_size / 2 + 1) *
+               (std::numeric_limits<uint64_t>::max() / (ring_size / 2 + 1));
+        break;
+      case 2:
+        // A few small duplicated hashes, all in the first bucket.
+        hash = random.random() % 8;
+        break;
+      default:
+        // Hashes clustered towards the start of the ring.
+        hash = random64() >> (random.random() % 64);
+        break;
+      }
+      if (random.random() % 20 == 0) {
+        hash = 0;
+      } else if (random.random() % 20 == 0) {
+        hash = std::numeric_limits<uint64_t>::max();
+      }
+      hashes.push_back(hash);
+    }
+    auto ring = RingHashLoadBalancerPeer::makeRing(hashes, hosts, stats);
+
+    std::vector<uint64_t> lookups = {0, 1, std::numeric_limits<uint64_t>::max() - 1,
+                                     std::numeric_limits<uint64_t>::max()};
+    for (uint64_t i = 0; i < ring_size; ++i) {
+      const uint64_t hash = RingHashLoadBalancerPeer::hashAt(*ring, i);
+      lookups.push_back(hash - 1);
+      lookups.push_back(hash);
+      lookups.push_back(hash + 1);
+    }
+    for (uint32_t bucket = 0; bucket + 1 < ring->bucket_index_.size(); ++bucket) {
+      const uint64_t bucket_start = uint64_t(bucket) << ring->bucket_shift_;
+      lookups.push_back(bucket_start - 1);
+      lookups.push_back(bucket_start);
+    }
+    for (uint32_t i = 0; i < 50; ++i) {
+      lookups.push_back(random64());
+    }
+
+    for (const uint64_t hash : lookups) {
+      const uint64_t index = RingHashLoadBalancerPeer::ketamaIndex(*ring, hash);
+      EXPECT_EQ(RingHashLoadBalancerPeer::hostAt(*ring, index), ring->chooseHost(hash, 0).host)
+          << "ring size " << ring_size << ", hash " << hash;
+      EXPECT_EQ(RingHashLoadBalancerPeer::hostAt(*ring, (index + 1) % ring_size),
+                ring->chooseHost(hash, 1).host)
+          << "ring size " << ring_size << ", hash " << hash;
+    }
+  }
+}
+
 TEST(TypedRingHashLbConfigTest, TypedRingHashLbConfigTest) {
   {
     envoy::config::cluster::v3::Cluster::RingHashLbConfig legacy;
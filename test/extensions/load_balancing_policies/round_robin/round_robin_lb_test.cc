@@ -453,6 +453,128 @@ TEST_P(RoundRobinLoadBalancerTest, Weighted) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr).host);
 }
 
+// Validate that weighted schedules follow host and weight changes when they are updated in place.
+TEST_P(RoundRobinLoadBalancerTest, WeightedIncrementalRefresh) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.edf_lb_incremental_refresh", "true"}});
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 2)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+  const auto pick = [this](uint32_t picks) {
+    absl::flat_hash_map<HostConstSharedPtr, uint32_t> counts;
+    for (uint32_t i = 0; i < picks; ++i) {
+      counts[lb_->chooseHost(nullptr).host]++;
+    }
+    return counts;
+  };
+  HostVector hosts = hostSet().hosts_;
+  auto counts = pick(30);
+  EXPECT_EQ(10, counts[hosts[0]]);
+  EXPECT_EQ(20, counts[hosts[1]]);
+
+  // Add a host.
+  hosts.push_back(makeTestHost(info_, "tcp://127.0.0.1:82", simTime(), 3));
+  hostSet().healthy_hosts_ = hosts;
+  hostSet().hosts_ = hosts;
+  hostSet().runCallbacks({hosts[2]}, {});
+  counts = pick(60);
+  EXPECT_NEAR(10, counts[hosts[0]], 1);
+  EXPECT_NEAR(20, counts[hosts[1]], 1);
+  EXPECT_NEAR(30, counts[hosts[2]], 1);
+
+  // Change the weight of a host.
+  hosts[0]->weight(6);
+  hostSet().runCallbacks({}, {});
+  counts = pick(110);
+  EXPECT_NEAR(60, counts[hosts[0]], 1);
+  EXPECT_NEAR(20, counts[hosts[1]], 1);
+  EXPECT_NEAR(30, counts[hosts[2]], 1);
+
+  // Remove a host.
+  hostSet().healthy_hosts_ = {hosts[0], hosts[2]};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {hosts[1]});
+  counts = pick(90);
+  EXPECT_NEAR(60, counts[hosts[0]], 1);
+  EXPECT_EQ(0, counts[hosts[1]]);
+  EXPECT_NEAR(30, counts[hosts[2]], 1);
+
+  // Once all weights are equal, hosts are picked in turn.
+  hosts[0]->weight(3);
+  hostSet().runCallbacks({}, {});
+  counts = pick(10);
+  EXPECT_EQ(5, counts[hosts[0]]);
+  EXPECT_EQ(5, counts[hosts[2]]);
+}
+
+// Validate that a schedule updated in place with the removal of the only host of a different
+// weight keeps picking the remaining hosts in turn.
+TEST_P(RoundRobinLoadBalancerTest, WeightedIncrementalRefreshToEqualWeights) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.edf_lb_incremental_refresh", "true"}});
+  HostVector hosts = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 2),
+                      makeTestHost(info_, "tcp://127.0.0.1:82", simTime(), 1)};
+  hostSet().healthy_hosts_ = hosts;
+  hostSet().hosts_ = hosts;
+  init(false);
+
+  hostSet().healthy_hosts_ = {hosts[0], hosts[2]};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {hosts[1]});
+  const HostConstSharedPtr first = lb_->chooseHost(nullptr).host;
+  const HostConstSharedPtr second = lb_->chooseHost(nullptr).host;
+  EXPECT_NE(first, second);
+  EXPECT_NE(hosts[1], first);
+  EXPECT_NE(hosts[1], second);
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(first, lb_->chooseHost(nullptr).host);
+    EXPECT_EQ(second, lb_->chooseHost(nullptr).host);
+  }
+}
+
+// Validate that schedules updated in place follow health changes that come with added hosts, even
+// when they leave the number of healthy hosts unchanged.
+TEST_P(RoundRobinLoadBalancerTest, WeightedIncrementalRefreshWithHealthChanges) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.edf_lb_incremental_refresh", "true"}});
+  HostVector hosts = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 2),
+                      makeTestHost(info_, "tcp://127.0.0.1:82", simTime(), 3),
+                      makeTestHost(info_, "tcp://127.0.0.1:83", simTime(), 4)};
+  hosts[3]->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  hostSet().healthy_hosts_ = {hosts[0], hosts[1], hosts[2]};
+  hostSet().hosts_ = hosts;
+  init(false);
+  const auto pick = [this](uint32_t picks) {
+    absl::flat_hash_map<HostConstSharedPtr, uint32_t> counts;
+    for (uint32_t i = 0; i < picks; ++i) {
+      counts[lb_->chooseHost(nullptr).host]++;
+    }
+    return counts;
+  };
+  auto counts = pick(60);
+  EXPECT_NEAR(10, counts[hosts[0]], 1);
+  EXPECT_NEAR(20, counts[hosts[1]], 1);
+  EXPECT_NEAR(30, counts[hosts[2]], 1);
+
+  // A host fails and another one recovers in the same update that adds an unhealthy host.
+  hosts[1]->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  hosts[3]->healthFlagClear(Host::HealthFlag::FAILED_ACTIVE_HC);
+  hosts.push_back(makeTestHost(info_, "tcp://127.0.0.1:84", simTime(), 5));
+  hosts[4]->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  hostSet().healthy_hosts_ = {hosts[0], hosts[2], hosts[3]};
+  hostSet().hosts_ = hosts;
+  hostSet().runCallbacks({hosts[4]}, {});
+  counts = pick(80);
+  EXPECT_NEAR(10, counts[hosts[0]], 2);
+  EXPECT_EQ(0, counts[hosts[1]]);
+  EXPECT_NEAR(30, counts[hosts[2]], 2);
+  EXPECT_NEAR(40, counts[hosts[3]], 2);
+  EXPECT_EQ(0, counts[hosts[4]]);
+}
+
 // Validate that the RNG seed influences pick order when weighted RR.
 TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
@@ -9,6 +9,8 @@
 
 #include "source/common/common/random_generator.h"
 #include "source/common/memory/stats.h"
+#include "source/common/router/metadatamatchcriteria_impl.h"
+#include "source/common/runtime/runtime_features.h"
 #include "source/common/upstream/upstream_impl.h"
 #include "source/extensions/load_balancing_policies/subset/subset_lb.h"
 
@@ -18,11 +20,14 @@
 #include "test/mocks/server/factory_context.h"
 #include "test/mocks/upstream/cluster_info.h"
 #include "test/mocks/upstream/load_balancer.h"
+#include "test/mocks/upstream/load_balancer_context.h"
 #include "test/test_common/simulated_time_system.h"
 
 #include "absl/types/optional.h"
 #include "benchmark/benchmark.h"
 
+using testing::Return;
+
 namespace Envoy {
 namespace Extensions {
 namespace LoadBalancingPolices {
@@ -31,8 +36,10 @@ namespace {
 
 class SubsetLbTester : public Upstream::BaseTester {
 public:
-  SubsetLbTester(uint64_t num_hosts, bool single_host_per_subset)
+  SubsetLbTester(uint64_t num_hosts, bool single_host_per_subset, bool lazy_subsets = false)
       : BaseTester(num_hosts, 0, 0, true /* attach metadata */) {
+    Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.subset_lb_lazy_subsets",
+                                  lazy_subsets);
     envoy::extensions::load_balancing_policies::subset::v3::Subset subset_config_proto{};
     subset_config_proto.set_fallback_policy(
         envoy::extensions::load_balancing_policies::subset::v3::Subset::ANY_ENDPOINT);
@@ -87,6 +94,7 @@ public:
 void benchmarkSubsetLoadBalancerCreate(::benchmark::State& state) {
   const bool single_host_per_subset = state.range(0);
   const uint64_t num_hosts = state.range(1);
+  const bool lazy_subsets = state.range(2);
 
   if (benchmark::skipExpensiveBenchmarks() && num_hosts > 100) {
     state.SkipWithError("Skipping expensive benchmark");
@@ -94,30 +102,74 @@ void benchmarkSubsetLoadBalancerCreate(::benchmark::State& state) {
   }
 
   for (auto _ : state) { // NOLINT: Silences warning about dead store
-    SubsetLbTester tester(num_hosts, single_host_per_subset);
+    const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+    SubsetLbTester tester(num_hosts, single_host_per_subset, lazy_subsets);
+    state.PauseTiming();
+    const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+    state.counters["memory"] = end_mem - start_mem;
+    state.ResumeTiming();
   }
 }
 
 BENCHMARK(benchmarkSubsetLoadBalancerCreate)
-    ->Ranges({{false, true}, {50, 2500}})
+    ->Ranges({{false, true}, {50, 2500}, {false, true}})
     ->Unit(::benchmark::kMillisecond);
 
 void benchmarkSubsetLoadBalancerUpdate(::benchmark::State& state) {
   const bool single_host_per_subset = state.range(0);
   const uint64_t num_hosts = state.range(1);
+  const bool lazy_subsets = state.range(2);
   if (benchmark::skipExpensiveBenchmarks() && num_hosts > 100) {
     state.SkipWithError("Skipping expensive benchmark");
     return;
   }
 
-  SubsetLbTester tester(num_hosts, single_host_per_subset);
+  SubsetLbTester tester(num_hosts, single_host_per_subset, lazy_subsets);
   for (auto _ : state) { // NOLINT: Silences warning about dead store
     tester.update();
   }
 }
 
 BENCHMARK(benchmarkSubsetLoadBalancerUpdate)
-    ->Ranges({{false, true}, {50, 2500}})
+    ->Ranges({{false, true}, {50, 2500}, {false, true}})
+    ->Unit(::benchmark::kMillisecond);
+
+// Every host is in its own subset, of which only the first `hot_subsets` are selected between
+// host updates.
+void benchmarkSubsetLoadBalancerChooseHostAfterUpdate(::benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t hot_subsets = state.range(1);
+  const bool lazy_subsets = state.range(2);
+  if (benchmark::skipExpensiveBenchmarks() && num_hosts > 100) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  std::vector<std::unique_ptr<Router::MetadataMatchCriteriaImpl>> criteria;
+  std::vector<std::unique_ptr<NiceMock<Upstream::MockLoadBalancerContext>>> contexts;
+  for (uint64_t i = 0; i < hot_subsets; ++i) {
+    ProtobufWkt::Struct metadata_matches;
+    (*metadata_matches.mutable_fields())[std::string(Upstream::BaseTester::metadata_key)]
+        .set_number_value(i);
+    criteria.push_back(std::make_unique<Router::MetadataMatchCriteriaImpl>(metadata_matches));
+    contexts.push_back(std::make_unique<NiceMock<Upstream::MockLoadBalancerContext>>());
+    ON_CALL(*contexts.back(), metadataMatchCriteria()).WillByDefault(Return(criteria.back().get()));
+  }
+
+  SubsetLbTester tester(num_hosts, false, lazy_subsets);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    tester.update();
+    for (auto& context : contexts) {
+      tester.lb_->chooseHost(context.get());
+    }
+  }
+}
+
+BENCHMARK(benchmarkSubsetLoadBalancerChooseHostAfterUpdate)
+    ->Args({2500, 10, false})
+    ->Args({2500, 10, true})
+    ->Args({2500, 500, false})
+    ->Args({2500, 500, true})
     ->Unit(::benchmark::kMillisecond);
 
 } // namespace
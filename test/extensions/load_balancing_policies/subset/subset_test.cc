@@ -29,6 +29,7 @@
 #include "test/mocks/upstream/load_balancer_context.h"
 #include "test/mocks/upstream/priority_set.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 
 #include "absl/types/optional.h"
 #include "gmock/gmock.h"
@@ -976,6 +977,115 @@ TEST_P(SubsetLoadBalancerTest, BalancesSubsetAfterUpdate) {
   EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
 }
 
+// With lazy subsets, the load balancer of a subset only exists while the subset is in use.
+TEST_F(SubsetLoadBalancerTest, LazySubsets) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.subset_lb_lazy_subsets", "true"}});
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::ANY_ENDPOINT));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector(
+      {"version"},
+      envoy::config::cluster::v3::Cluster::LbSubsetConfig::LbSubsetSelector::NOT_DEFINED)};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:82", {{"version", "1.1"}}},
+      {"tcp://127.0.0.1:83", {{"version", "1.1"}}},
+  });
+  auto materialized = [this]() {
+    return TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_materialized")->value();
+  };
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(0U, materialized());
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_11({{"version", "1.1"}});
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(1U, materialized());
+
+  // A subset which was used since the previous update is kept up to date.
+  host_set_.hosts_[1]->metadata(buildMetadata("1.1"));
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11).host);
+  EXPECT_EQ(2U, materialized());
+
+  // Subsets which were not used since the previous update are released, and created again on
+  // demand.
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(2U, materialized());
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(0U, materialized());
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11).host);
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_11).host);
+  EXPECT_EQ(1U, materialized());
+
+  // The fallback subset is created lazily as well.
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(nullptr).host);
+  EXPECT_EQ(1U, stats_.lb_subsets_fallback_.value());
+  EXPECT_EQ(2U, materialized());
+  EXPECT_EQ(5U, stats_.lb_subsets_selected_.value());
+
+  lb_.reset();
+  EXPECT_EQ(0U, materialized());
+}
+
+// A host update which touches several priorities keeps the subsets used before the update.
+TEST_F(SubsetLoadBalancerTest, LazySubsetsMultiplePriorities) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.subset_lb_lazy_subsets", "true"}});
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector(
+      {"version"},
+      envoy::config::cluster::v3::Cluster::LbSubsetConfig::LbSubsetSelector::NOT_DEFINED)};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init(
+      {
+          {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+          {"tcp://127.0.0.1:81", {{"version", "1.1"}}},
+      },
+      {
+          {"tcp://127.0.0.1:82", {{"version", "1.0"}}},
+          {"tcp://127.0.0.1:83", {{"version", "1.1"}}},
+      });
+  MockHostSet& failover_host_set = *priority_set_.getMockHostSet(1);
+  auto materialized = [this]() {
+    return TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_materialized")->value();
+  };
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(1U, materialized());
+
+  // Both priorities are updated after the subset was used.
+  host_set_.runCallbacks({}, {});
+  failover_host_set.runCallbacks({}, {});
+  EXPECT_EQ(1U, materialized());
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(1U, materialized());
+
+  // Updating one priority alone does not release a subset used since that priority's update.
+  failover_host_set.runCallbacks({}, {});
+  EXPECT_EQ(1U, materialized());
+
+  // Without traffic since the previous update of priority 1, the subset is released.
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(1U, materialized());
+  failover_host_set.runCallbacks({}, {});
+  EXPECT_EQ(0U, materialized());
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10).host);
+  EXPECT_EQ(1U, materialized());
+}
+
 TEST_P(SubsetLoadBalancerTest, ListAsAnyEnabled) {
   EXPECT_CALL(subset_info_, fallbackPolicy())
       .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
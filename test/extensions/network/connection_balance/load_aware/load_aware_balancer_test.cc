@@ -0,0 +1,185 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "envoy/config/core/v3/extension.pb.h"
+#include "envoy/extensions/network/connection_balance/load_aware/v3/load_aware.pb.h"
+
+#include "source/extensions/network/connection_balance/load_aware/config.h"
+#include "source/extensions/network/connection_balance/load_aware/load_aware_balancer.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace ConnectionBalance {
+namespace LoadAware {
+namespace {
+
+class TestHandler : public Envoy::Network::BalancedConnectionHandler {
+public:
+  explicit TestHandler(Event::Dispatcher* dispatcher = nullptr) : dispatcher_(dispatcher) {}
+
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() const override { return connections_; }
+  void incNumConnections() override { ++connections_; }
+  void post(Envoy::Network::ConnectionSocketPtr&&) override {}
+  void onAcceptWorker(Envoy::Network::ConnectionSocketPtr&&, bool, bool) override {}
+  OptRef<Event::Dispatcher> workerDispatcher() override { return makeOptRefFromPtr(dispatcher_); }
+
+  std::atomic<uint64_t> connections_{};
+
+private:
+  Event::Dispatcher* dispatcher_;
+};
+
+TEST(LoadAwareConnectionBalancerTest, BalancesConnectionCounts) {
+  LoadAwareConnectionBalancerImpl balancer(std::chrono::milliseconds(100),
+                                           std::chrono::milliseconds(5));
+  TestHandler handler1;
+  TestHandler handler2;
+  TestHandler handler3;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  // Ties stay on the current handler.
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+  for (int i = 0; i < 5; ++i) {
+    balancer.pickTargetHandler(handler1);
+  }
+  EXPECT_EQ(2U, handler1.numConnections());
+  EXPECT_EQ(2U, handler2.numConnections());
+  EXPECT_EQ(2U, handler3.numConnections());
+
+  handler2.connections_ = 10;
+  EXPECT_NE(&handler2, &balancer.pickTargetHandler(handler2));
+  EXPECT_NE(&handler2, &balancer.pickTargetHandler(handler2));
+  EXPECT_EQ(3U, handler1.numConnections());
+  EXPECT_EQ(3U, handler3.numConnections());
+
+  // The slot of an unregistered handler is reused.
+  balancer.unregisterHandler(handler3);
+  TestHandler handler4;
+  balancer.registerHandler(handler4);
+  EXPECT_EQ(&handler4, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(3U, handler3.numConnections());
+
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler2);
+  balancer.unregisterHandler(handler4);
+}
+
+TEST(LoadAwareConnectionBalancerTest, AvoidsDelayedEventLoops) {
+  Event::SimulatedTimeSystem time_system;
+  LoadAwareConnectionBalancerImpl balancer(std::chrono::milliseconds(100),
+                                           std::chrono::milliseconds(5));
+  NiceMock<Event::MockDispatcher> dispatcher1;
+  NiceMock<Event::MockDispatcher> dispatcher2;
+  auto* timer1 = new NiceMock<Event::MockTimer>(&dispatcher1);
+  auto* timer2 = new NiceMock<Event::MockTimer>(&dispatcher2);
+  TestHandler handler1(&dispatcher1);
+  TestHandler handler2(&dispatcher2);
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  EXPECT_TRUE(timer1->enabled());
+  EXPECT_TRUE(timer2->enabled());
+
+  // The second worker samples on time, and the first one 40ms late.
+  time_system.advanceTimeWait(std::chrono::milliseconds(100));
+  timer2->invokeCallback();
+  time_system.advanceTimeWait(std::chrono::milliseconds(40));
+  timer1->invokeCallback();
+  EXPECT_TRUE(timer1->enabled());
+  EXPECT_EQ(std::chrono::milliseconds(10), balancer.loopLag(handler1));
+  EXPECT_EQ(std::chrono::milliseconds(0), balancer.loopLag(handler2));
+
+  // Connections go to the responsive worker even though it has more of them.
+  handler2.connections_ = 5;
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(6U, handler2.numConnections());
+
+  // Once the first worker catches up, its average delay decays to within the tolerance.
+  for (int i = 0; i < 3; ++i) {
+    time_system.advanceTimeWait(std::chrono::milliseconds(100));
+    timer1->invokeCallback();
+  }
+  EXPECT_GE(std::chrono::milliseconds(5), balancer.loopLag(handler1));
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler2));
+
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler2);
+  EXPECT_EQ(std::chrono::milliseconds(0), balancer.loopLag(handler1));
+}
+
+// Workers picking targets concurrently account for every connection.
+TEST(LoadAwareConnectionBalancerTest, ConcurrentPicks) {
+  constexpr int NumWorkers = 4;
+  constexpr int NumPicks = 10000;
+  LoadAwareConnectionBalancerImpl balancer(std::chrono::milliseconds(100),
+                                           std::chrono::milliseconds(5));
+  std::vector<std::unique_ptr<TestHandler>> handlers;
+  for (int i = 0; i < NumWorkers; ++i) {
+    handlers.push_back(std::make_unique<TestHandler>());
+    balancer.registerHandler(*handlers.back());
+  }
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < NumWorkers; ++i) {
+    workers.emplace_back([&balancer, &handler = *handlers[i]]() {
+      for (int pick = 0; pick < NumPicks; ++pick) {
+        balancer.pickTargetHandler(handler);
+      }
+    });
+  }
+  // Handlers come and go while the workers pick, and may be picked as well.
+  uint64_t total = 0;
+  for (int i = 0; i < 100; ++i) {
+    TestHandler transient;
+    balancer.registerHandler(transient);
+    balancer.unregisterHandler(transient);
+    total += transient.numConnections();
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  for (auto& handler : handlers) {
+    EXPECT_LT(0U, handler->numConnections());
+    total += handler->numConnections();
+    balancer.unregisterHandler(*handler);
+  }
+  EXPECT_EQ(static_cast<uint64_t>(NumWorkers * NumPicks), total);
+}
+
+TEST(LoadAwareConnectionBalanceFactoryTest, CreatesBalancer) {
+  auto* factory =
+      Registry::FactoryRegistry<Envoy::Network::ConnectionBalanceFactory>::getFactory(
+          "envoy.network.connection_balance.load_aware");
+  ASSERT_NE(nullptr, factory);
+
+  envoy::extensions::network::connection_balance::load_aware::v3::LoadAwareConnectionBalance
+      config;
+  config.mutable_sample_interval()->set_seconds(1);
+  envoy::config::core::v3::TypedExtensionConfig typed_config;
+  typed_config.set_name("envoy.network.connection_balance.load_aware");
+  typed_config.mutable_typed_config()->PackFrom(config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  Envoy::Network::ConnectionBalancerSharedPtr balancer =
+      factory->createConnectionBalancerFromProto(typed_config, context);
+  EXPECT_NE(nullptr, dynamic_cast<LoadAwareConnectionBalancerImpl*>(balancer.get()));
+}
+
+} // namespace
+} // namespace LoadAware
+} // namespace ConnectionBalance
+} // namespace Extensions
+} // namespace Envoy
@@ -52,6 +52,8 @@ TEST_P(DogStatsdConfigLoopbackTest, ValidUdpIp) {
   EXPECT_NE(udp_sink, nullptr);
   EXPECT_EQ(udp_sink->getUseTagForTest(), true);
   EXPECT_EQ(udp_sink->getPrefix(), Common::Statsd::getDefaultPrefix());
+  // DogStatsD does not keep the value of gauges that are not sent.
+  EXPECT_FALSE(udp_sink->changedStatsOnly());
 }
 
 // Negative test for protoc-gen-validate constraints for dog_statsd.
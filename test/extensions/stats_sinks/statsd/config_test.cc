@@ -40,6 +40,7 @@ TEST(StatsConfigTest, ValidTcpStatsd) {
   Stats::SinkPtr sink = factory->createStatsSink(*message, server).value();
   EXPECT_NE(sink, nullptr);
   EXPECT_NE(dynamic_cast<Common::Statsd::TcpStatsdSink*>(sink.get()), nullptr);
+  EXPECT_TRUE(sink->changedStatsOnly());
 }
 
 class StatsConfigParameterizedTest : public testing::TestWithParam<Network::Address::IpVersion> {};
@@ -181,6 +182,7 @@ TEST_P(StatsConfigLoopbackTest, ValidUdpIpStatsd) {
   EXPECT_NE(sink, nullptr);
   EXPECT_NE(dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get()), nullptr);
   EXPECT_EQ(dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get())->getUseTagForTest(), false);
+  EXPECT_TRUE(sink->changedStatsOnly());
 }
 
 // Negative test for protoc-gen-validate constraints for statsd.
@@ -1062,4 +1062,43 @@ TEST_P(MultiplexedUpstreamIntegrationTest, ConnPoolQueuingNonSafeRequest) {
   ASSERT_TRUE(response4->waitForEndStream());
 }
 
+
+// Tests that with shared connection pools, the streams of two workers are multiplexed over the same
+// upstream connection, owned by one of them.
+TEST_P(MultiplexedUpstreamIntegrationTest, SharedConnectionPoolAcrossWorkers) {
+  concurrency_ = 2;
+  config_helper_.addConfigModifier([](envoy::config::bootstrap::v3::Bootstrap& bootstrap) {
+    // Each of the two downstream connections is handled by a different worker.
+    bootstrap.mutable_static_resources()
+        ->mutable_listeners(0)
+        ->mutable_connection_balance_config()
+        ->mutable_exact_balance();
+    ConfigHelper::HttpProtocolOptions protocol_options;
+    protocol_options.mutable_upstream_http_protocol_options()->mutable_shared_connection_pool();
+    ConfigHelper::setProtocolOptions(*bootstrap.mutable_static_resources()->mutable_clusters(0),
+                                     protocol_options);
+  });
+  initialize();
+
+  codec_client_ = makeHttpConnection(lookupPort("http"));
+  IntegrationCodecClientPtr codec_client2 = makeHttpConnection(lookupPort("http"));
+
+  auto response = codec_client_->makeHeaderOnlyRequest(default_request_headers_);
+  waitForNextUpstreamRequest();
+  auto response2 = codec_client2->makeHeaderOnlyRequest(default_request_headers_);
+  FakeStreamPtr upstream_request2;
+  ASSERT_TRUE(fake_upstream_connection_->waitForNewStream(*dispatcher_, upstream_request2));
+  ASSERT_TRUE(upstream_request2->waitForEndStream(*dispatcher_));
+
+  upstream_request_->encodeHeaders(default_response_headers_, true);
+  upstream_request2->encodeHeaders(default_response_headers_, true);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response2->waitForEndStream());
+  EXPECT_EQ("200", response->headers().getStatusValue());
+  EXPECT_EQ("200", response2->headers().getStatusValue());
+  EXPECT_EQ(1, test_server_->counter("cluster.cluster_0.upstream_cx_total")->value());
+
+  codec_client2->close();
+}
+
 } // namespace Envoy
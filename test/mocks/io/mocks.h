@@ -28,6 +28,9 @@ public:
   MOCK_METHOD(IoUringResult, prepareClose, (os_fd_t fd, Request* user_data));
   MOCK_METHOD(IoUringResult, prepareCancel, (Request * cancelling_user_data, Request* user_data));
   MOCK_METHOD(IoUringResult, prepareShutdown, (os_fd_t fd, int how, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareWritevAndShutdown,
+              (os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs, Request* write_user_data,
+               int how, Request* shutdown_user_data));
   MOCK_METHOD(IoUringResult, submit, ());
   MOCK_METHOD(void, injectCompletion, (os_fd_t fd, Request* user_data, int32_t result));
   MOCK_METHOD(void, removeInjectedCompletion, (os_fd_t fd));
@@ -77,6 +80,9 @@ public:
   MOCK_METHOD(Request*, submitCloseRequest, (IoUringSocket & socket));
   MOCK_METHOD(Request*, submitCancelRequest, (IoUringSocket & socket, Request* request_to_cancel));
   MOCK_METHOD(Request*, submitShutdownRequest, (IoUringSocket & socket, int how));
+  MOCK_METHOD(Request*, submitWriteAndShutdownRequest,
+              (IoUringSocket & socket, const Buffer::RawSliceVector& slices, int how,
+               Request*& shutdown_req));
   MOCK_METHOD(uint32_t, getNumOfSockets, (), (const));
 };
 
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
@@ -44,24 +46,29 @@ private:
 
 class StatsSinkFlushSpeedTest {
 public:
-  StatsSinkFlushSpeedTest(size_t const num_stats, bool set_sink_predicates = false)
+  StatsSinkFlushSpeedTest(size_t const num_stats, bool set_sink_predicates = false,
+                          bool track_changed_stats = false)
       : pool_(symbol_table_), stats_allocator_(symbol_table_), stats_store_(stats_allocator_) {
     if (set_sink_predicates) {
       stats_store_.setSinkPredicates(
           std::unique_ptr<Stats::SinkPredicates>{std::make_unique<TestSinkPredicates>()});
     }
+    if (track_changed_stats) {
+      stats_store_.trackChangedStats();
+    }
 
     // Create counters
     for (uint64_t idx = 0; idx < num_stats; ++idx) {
       auto stat_name = pool_.add(absl::StrCat("counter.", idx));
-      stats_store_.rootScope()->counterFromStatName(stat_name).inc();
+      counters_.push_back(&stats_store_.rootScope()->counterFromStatName(stat_name));
+      counters_.back()->inc();
     }
     // Create gauges
     for (uint64_t idx = 0; idx < num_stats; ++idx) {
       auto stat_name = pool_.add(absl::StrCat("gauge.", idx));
-      stats_store_.rootScope()
-          ->gaugeFromStatName(stat_name, Stats::Gauge::ImportMode::NeverImport)
-          .set(idx);
+      gauges_.push_back(&stats_store_.rootScope()->gaugeFromStatName(
+          stat_name, Stats::Gauge::ImportMode::NeverImport));
+      gauges_.back()->set(idx);
     }
 
     // Create text readouts
@@ -87,6 +94,24 @@ public:
     }
   }
 
+  // Changes 1% of the counters and gauges before each flush.
+  void testWithChanges(::benchmark::State& state) {
+    size_t next = 0;
+    for (auto _ : state) {
+      UNREFERENCED_PARAMETER(_);
+      state.PauseTiming();
+      for (size_t i = 0; i < std::max<size_t>(counters_.size() / 100, 1); ++i) {
+        counters_[next]->inc();
+        gauges_[next]->inc();
+        next = (next + 1) % counters_.size();
+      }
+      state.ResumeTiming();
+      std::list<Stats::SinkPtr> sinks;
+      sinks.emplace_back(new testing::NiceMock<Stats::MockSink>());
+      Server::InstanceUtil::flushMetricsToSinks(sinks, stats_store_, cm_, time_system_);
+    }
+  }
+
 private:
   Stats::SymbolTableImpl symbol_table_;
   Stats::StatNamePool pool_;
@@ -94,6 +119,8 @@ private:
   Stats::ThreadLocalStoreImpl stats_store_;
   Event::SimulatedTimeSystem time_system_;
   FastMockClusterManager cm_;
+  std::vector<Stats::Counter*> counters_;
+  std::vector<Stats::Gauge*> gauges_;
 };
 
 static void bmFlushToSinks(::benchmark::State& state) {
@@ -118,10 +145,26 @@ static void bmFlushToSinksWithPredicatesSet(::benchmark::State& state) {
   speed_test.test(state);
 }
 
+// The second argument selects whether the store tracks changed stats, in which case flushes only
+// visit the counters and gauges changed since the previous flush.
+static void bmFlushToSinksWithChanges(::benchmark::State& state) {
+  // Skip expensive benchmarks for unit tests.
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 100) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  StatsSinkFlushSpeedTest speed_test(state.range(0), false, state.range(1));
+  speed_test.testWithChanges(state);
+}
+
 BENCHMARK(bmFlushToSinks)->Unit(::benchmark::kMillisecond)->RangeMultiplier(10)->Range(10, 1000000);
 BENCHMARK(bmFlushToSinksWithPredicatesSet)
     ->Unit(::benchmark::kMillisecond)
     ->RangeMultiplier(10)
     ->Range(10, 1000000);
+BENCHMARK(bmFlushToSinksWithChanges)
+    ->Unit(::benchmark::kMillisecond)
+    ->ArgsProduct({{10, 1000, 100000, 1000000}, {0, 1}});
 
 } // namespace Envoy